@@ -0,0 +1,79 @@
+/*
+  alloc_track.h - Учёт выделений памяти по модулям
+
+  Включается сборкой с -DALLOC_TRACKING (окружение esp32cam_alloc
+  в platformio.ini): malloc/calloc/realloc оборачиваются через --wrap
+  линкера. Выделения в задаче loop() относятся к модулю, заданному
+  ALLOC_SCOPE, выделения из других задач (WiFi, lwIP) - к ALLOC_OTHER_TASKS.
+
+  В установившемся режиме (после ALLOC_WARMUP_MS) итерация loop() не должна
+  ничего выделять: такие итерации считаются в
+  feeder_loop_alloc_iterations_total и пишутся в журнал. Исключения:
+    - ALLOC_WEB - только в итерации, где обслужен HTTP запрос
+      (allocWebRequest): библиотека WebServer держит URI, аргументы
+      и заголовки запроса в String. Простой веб-сервера выделять не должен;
+    - ALLOC_OTHER_TASKS - выделения стека WiFi и lwIP в своих задачах
+      (буферы пакетов): это не работа loop(), они лишь совпали по времени.
+  Проверка на хосте: test/test_loop_alloc (pio test -e native).
+  Без ALLOC_TRACKING все макросы пустые.
+*/
+
+#ifndef ALLOC_TRACK_H
+#define ALLOC_TRACK_H
+
+#include <Arduino.h>
+#include "config.h"
+
+enum AllocModule {
+  ALLOC_CORE,
+  ALLOC_WIFI,
+  ALLOC_MQTT,
+  ALLOC_WEB,
+  ALLOC_FEED,
+  ALLOC_SCHEDULE,
+  ALLOC_OTHER_TASKS,
+  ALLOC_MODULE_COUNT
+};
+
+#ifdef ALLOC_TRACKING
+
+// Привязка к задаче loop() (вызывать в начале setup)
+void allocTrackSetup();
+
+// Границы итерации loop()
+void allocLoopBegin();
+void allocLoopEnd();
+
+// Итерация обслужила HTTP запрос (обёртка обработчиков веб-сервера)
+void allocWebRequest();
+
+// Итерации loop() с выделениями в установившемся режиме
+uint32_t allocLoopViolations();
+
+// Текущий модуль задачи loop()
+extern AllocModule allocCurrentModule;
+
+class AllocScope {
+public:
+  explicit AllocScope(AllocModule m) : _prev(allocCurrentModule) { allocCurrentModule = m; }
+  ~AllocScope() { allocCurrentModule = _prev; }
+private:
+  AllocModule _prev;
+};
+
+#define ALLOC_CONCAT_(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_(a, b)
+#define ALLOC_SCOPE(m) AllocScope ALLOC_CONCAT(_allocScope, __LINE__)(m)
+
+#else
+
+inline void allocTrackSetup() {}
+inline void allocLoopBegin() {}
+inline void allocLoopEnd() {}
+inline void allocWebRequest() {}
+inline uint32_t allocLoopViolations() { return 0; }
+#define ALLOC_SCOPE(m) do {} while (0)
+
+#endif // ALLOC_TRACKING
+
+#endif // ALLOC_TRACK_H
@@ -0,0 +1,102 @@
+/*
+  arena.h - Статические буферы для временных данных
+
+  StaticArena - линейный аллокатор поверх статического массива: выделение
+  сдвигает указатель, reset() освобождает всё сразу. Используется для
+  временных буферов обработчиков вместо String и malloc.
+  BufWriter - форматированная запись в готовый буфер char.
+*/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+template <size_t N>
+class StaticArena {
+public:
+  // Выделение блока; nullptr, если арена исчерпана
+  void* alloc(size_t size, size_t align = 4) {
+    size_t start = (_used + align - 1) & ~(align - 1);
+    if (start + size > N) {
+      _failed++;
+      return nullptr;
+    }
+    _used = start + size;
+    if (_used > _peak) _peak = _used;
+    return _buf + start;
+  }
+
+  // Освобождение всех блоков
+  void reset() { _used = 0; }
+
+  size_t used() const { return _used; }
+  size_t peak() const { return _peak; }
+  size_t capacity() const { return N; }
+  uint32_t failed() const { return _failed; }
+
+private:
+  alignas(8) uint8_t _buf[N];
+  size_t _used = 0;
+  size_t _peak = 0;
+  uint32_t _failed = 0;
+};
+
+// Запись строки в буфер фиксированного размера (обрезает при переполнении)
+class BufWriter {
+public:
+  BufWriter(char* buf, size_t size) : _buf(buf), _size(size), _len(0), _overflow(false) {
+    if (_size) _buf[0] = '\0';
+  }
+
+  BufWriter& print(const char* s) {
+    size_t n = strlen(s);
+    return write(s, n);
+  }
+
+  BufWriter& write(const char* s, size_t n) {
+    if (_len + n >= _size) {
+      n = _size > _len + 1 ? _size - _len - 1 : 0;
+      _overflow = true;
+    }
+    memcpy(_buf + _len, s, n);
+    _len += n;
+    _buf[_len] = '\0';
+    return *this;
+  }
+
+  BufWriter& printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    if (_len + 1 >= _size) {
+      _overflow = true;
+      return *this;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(_buf + _len, _size - _len, fmt, args);
+    va_end(args);
+    if (n < 0) return *this;
+    if ((size_t)n >= _size - _len) {
+      _len = _size - 1;
+      _overflow = true;
+    } else {
+      _len += n;
+    }
+    return *this;
+  }
+
+  const char* c_str() const { return _buf; }
+  size_t length() const { return _len; }
+  bool overflow() const { return _overflow; }
+
+private:
+  char* _buf;
+  size_t _size;
+  size_t _len;
+  bool _overflow;
+};
+
+#endif // ARENA_H
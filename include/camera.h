@@ -0,0 +1,58 @@
+/*
+  camera.h - Камера ESP32-CAM: захват в пул кадров и MJPEG поток
+
+  Задача захвата снимает кадры сенсора в пул (frame_pool.h) с частотой
+  и разрешением, которые просит MJPEG сервер (mjpeg_stream.h) по скорости
+  зрителей, а без зрителей - с фоновой частотой (cameraSetBackground)
+  и по запросу (/api/capture). В простое (power_manager.h) фоновая частота
+  не выше POWER_IDLE_CAMERA_FPS; когда кадры не нужны совсем, сенсор
+  переводится в standby до запроса.
+  Поток отдаёт отдельная задача на порту CAMERA_STREAM_PORT.
+*/
+
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "frame_source.h"
+#include "frame_pool.h"
+
+// Камера AI-Thinker ESP32-CAM (OV2640) через esp32-camera
+class CameraFrameSource : public FrameSource {
+public:
+  bool begin(FrameSize size) override;
+  bool setSize(FrameSize size) override;
+  FrameSize size() const override { return _size; }
+  bool capture(uint8_t* buf, size_t cap, FrameInfo& info) override;
+
+private:
+  FrameSize _size = FRAME_QVGA;
+};
+
+// Сенсор, пул кадров, задачи захвата и MJPEG сервера
+void cameraSetup();
+
+bool cameraReady();
+
+// Свежий кадр (+1 ссылка; вернуть через cameraRelease). Без зрителей
+// запрашивает захват и ждёт сигнала задачи захвата до timeoutMs (не дольше
+// CAMERA_CAPTURE_TIMEOUT); nullptr - кадра нет
+FrameSlot* cameraAcquireFrame(uint32_t timeoutMs);
+void cameraRelease(FrameSlot* slot);
+
+// Последний кадр новее newerThan без ожидания (+1 ссылка) или nullptr
+FrameSlot* cameraLatestFrame(uint32_t newerThan);
+
+// Фоновый захват без зрителей (для роликов и детектора). Из запросов
+// нескольких модулей берутся наибольшие частота и разрешение.
+// При зрителях кадры идут с частотой потока, но не реже фоновой
+void cameraSetBackground(uint16_t fps, FrameSize size);
+
+// Зрителей MJPEG потока
+uint8_t cameraStreamClients();
+
+// Сенсор в standby: кадры не нужны (в простое при POWER_IDLE_CAMERA_FPS 0)
+bool cameraAsleep();
+
+#endif // CAMERA_H
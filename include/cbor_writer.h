@@ -0,0 +1,46 @@
+/*
+  cbor_writer.h - Запись CBOR (RFC 8949) в буфер фиксированного размера
+
+  Компактная двоичная замена JSON для событий и телеметрии в MQTT:
+  целые занимают 1-9 байт, ключи карт - малые целые из telemetry.h,
+  а не строки. Пишутся только определённые длины (число элементов карты
+  или массива известно заранее). При переполнении запись прекращается,
+  overflow() == true - такой буфер отправлять нельзя.
+  Модуль не зависит от Arduino.
+*/
+
+#ifndef CBOR_WRITER_H
+#define CBOR_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class CborWriter {
+public:
+  CborWriter(uint8_t* buf, size_t size) : _buf(buf), _size(size), _len(0), _overflow(false) {}
+
+  CborWriter& map(uint32_t pairs) { return head(5, pairs); }
+  CborWriter& array(uint32_t items) { return head(4, items); }
+  CborWriter& unsignedInt(uint64_t v) { return head(0, v); }
+  CborWriter& signedInt(int64_t v);
+  CborWriter& text(const char* s);
+  CborWriter& boolean(bool v) { return byte(v ? 0xF5 : 0xF4); }
+  CborWriter& null() { return byte(0xF6); }
+  // Тег 1: время эпохи в секундах (следующее значение - целое)
+  CborWriter& epochTag() { return head(6, 1); }
+
+  const uint8_t* data() const { return _buf; }
+  size_t length() const { return _len; }
+  bool overflow() const { return _overflow; }
+
+private:
+  CborWriter& head(uint8_t major, uint64_t v);
+  CborWriter& byte(uint8_t b);
+
+  uint8_t* _buf;
+  size_t _size;
+  size_t _len;
+  bool _overflow;
+};
+
+#endif // CBOR_WRITER_H
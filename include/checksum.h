@@ -0,0 +1,21 @@
+/*
+  checksum.h - Контрольная сумма для данных в RTC памяти и NVS
+*/
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// FNV-1a (32 бита). seed позволяет продолжить подсчёт по нескольким блокам
+inline uint32_t fnv1a(const void* data, size_t len, uint32_t seed = 2166136261u) {
+  const uint8_t* p = (const uint8_t*)data;
+  uint32_t h = seed;
+  for (size_t i = 0; i < len; i++) {
+    h = (h ^ p[i]) * 16777619u;
+  }
+  return h;
+}
+
+#endif // CHECKSUM_H
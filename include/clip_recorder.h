@@ -0,0 +1,33 @@
+/*
+  clip_recorder.h - Ролики кормлений с предзаписью
+
+  Камера в фоне снимает CLIP_FPS кадров в секунду в разрешении CLIP_SIZE,
+  задача ролика копирует их в кольцо (clip_ring.h) в PSRAM, где всегда
+  лежат последние CLIP_PREROLL_MS. Кормление замораживает кольцо,
+  дописывается CLIP_POSTROLL_MS, и ролик уходит в хранилище файлом
+  /clip_<id>.mjpeg в формате multipart (как MJPEG поток), после чего
+  кольцо снова крутится. Хранятся последние CLIP_KEEP роликов.
+
+  Память ограничена кольцом CLIP_RING_BYTES и CLIP_KEEP файлами.
+*/
+
+#ifndef CLIP_RECORDER_H
+#define CLIP_RECORDER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Кольцо, фоновый захват камеры и задача записи (после cameraSetup)
+void clipSetup();
+
+// Начало ролика по кормлению; возвращает номер ролика или -1
+// (камеры нет или предыдущий ролик ещё пишется)
+int clipTrigger(const char* source);
+
+// Путь файла ролика
+void clipPath(uint32_t id, char* buf, size_t size);
+
+// Список сохранённых роликов в JSON: [{"id":N,"size":B},...]
+void clipWriteListJson(Print& out);
+
+#endif // CLIP_RECORDER_H
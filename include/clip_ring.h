@@ -0,0 +1,62 @@
+/*
+  clip_ring.h - Кольцо JPEG кадров для роликов с предзаписью
+
+  Кадры разного размера копируются в одну область фиксированного размера
+  (на ESP32 - в PSRAM), новые вытесняют самые старые, поэтому память
+  ограничена заранее. freeze() фиксирует накопленную предзапись: после
+  этого кадры только дописываются, а когда место кончается, push()
+  отказывает - ролик обрезается, но ничего не вытесняется.
+  Модуль не зависит от Arduino.
+*/
+
+#ifndef CLIP_RING_H
+#define CLIP_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class ClipRing {
+public:
+  // Область bytes байт, не больше maxFrames кадров
+  bool begin(size_t bytes, uint16_t maxFrames);
+
+  // Копия кадра в кольцо (false - не влез: больше области или кольцо заморожено)
+  bool push(const uint8_t* data, size_t len, uint32_t timeMs);
+
+  // Заморозка предзаписи и возврат к обычному кольцу (с очисткой)
+  void freeze() { _frozen = true; }
+  void clear();
+  bool frozen() const { return _frozen; }
+
+  // Вытеснение кадров старше timeMs (держит предзапись в пределах времени;
+  // на замороженное кольцо не действует)
+  void dropBefore(uint32_t timeMs);
+
+  uint16_t count() const { return _count; }
+  size_t bytesUsed() const { return _used; }
+
+  // Кадр i от самого старого
+  bool frame(uint16_t i, const uint8_t*& data, size_t& len, uint32_t& timeMs) const;
+
+private:
+  struct Entry {
+    uint32_t off;
+    uint32_t len;
+    uint32_t timeMs;
+  };
+
+  bool findSpace(size_t len, uint32_t& pos) const;
+  void dropOldest();
+
+  uint8_t* _buf = nullptr;
+  size_t _size = 0;
+  Entry* _entries = nullptr;
+  uint16_t _maxFrames = 0;
+  uint16_t _head = 0;     // Самый старый кадр
+  uint16_t _count = 0;
+  uint32_t _writePos = 0; // Конец самого нового кадра
+  size_t _used = 0;
+  bool _frozen = false;
+};
+
+#endif // CLIP_RING_H
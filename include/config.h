@@ -10,6 +10,8 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <stdint.h>
+
 // ==================== ВЕРСИЯ ====================
 #define FIRMWARE_VERSION "3.2.0"
 #define FIRMWARE_MODEL "ESP32-CAM Feeder"
@@ -20,18 +22,64 @@
 #define NUM_LEDS 2          // Количество светодиодов
 #define LED_BRIGHTNESS 50   // Яркость LED (0-255)
 
-// Пины драйвера мотора (фазаА1, фазаА2, фазаВ1, фазаВ2)
-const byte MOTOR_PINS[] = {12, 13, 15, 14};
+// Количество шнеков (мисок), у каждого свой мотор и своя порция
+#ifndef NUM_AUGERS
+  #define NUM_AUGERS 1
+#endif
+
+// Пины драйверов моторов по шнекам (фазаА1, фазаА2, фазаВ1, фазаВ2).
+// Для NUM_AUGERS > 1 добавьте строки со свободными GPIO своей платы
+const uint8_t AUGER_PINS[][4] = {
+  {12, 13, 15, 14},
+};
+
+// ==================== КНОПКА ====================
+#define BTN_DEBOUNCE_MS 30          // Антидребезг (мс)
+#define BTN_HOLD_MS 500             // Порог удержания (мс)
+#define BTN_DOUBLE_CLICK_MS 300     // Окно двойного клика (мс)
+
+// ==================== ИНДИКАЦИЯ ====================
+#define LED_FRAME_MS 20             // Период отрисовки кадра анимации (мс)
+#define LED_STATUS_BRIGHTNESS 15    // Яркость маяка состояния (0-255)
+#define LED_BEACON_MS 50            // Длительность вспышки маяка (мс)
+#define LED_BEACON_OK_PERIOD 30000  // Период маяка: всё хорошо (мс)
+#define LED_BEACON_WIFI_PERIOD 10000  // Период маяка: нет WiFi (мс)
+#define LED_BEACON_ERROR_PERIOD 3000  // Период маяка: ошибка (мс)
+#define LED_FADE_MS 200             // Затухание в конце вспышки (мс)
 
 // ==================== МОТОР ====================
-#define FEED_SPEED 3000     // Задержка между шагами мотора (мкс)
+#define FEED_SPEED 3000     // Интервал между шагами мотора (мкс)
 #define STEPS_FRW 19        // Шаги вперёд
 #define STEPS_BKW 12        // Шаги назад
 #define DEFAULT_FEED_AMOUNT 15  // Порция по умолчанию (оборотов)
 
+// ==================== ЖУРНАЛ КОРМЛЕНИЙ ====================
+// Прогресс кормления в RTC памяти и NVS на случай сброса (feed_journal.h)
+#define FEED_JOURNAL_CHECKPOINT_REVS 10   // Контрольная точка в NVS (оборотов)
+#define FEED_JOURNAL_RESUME 1             // 0 - прерванное кормление только отмечается
+#define FEED_JOURNAL_MAX_RESUMES 1        // Попыток докормить (сброс при докармливании - частичное)
+#define FEED_JOURNAL_RESUME_DELAY 10000   // Докармливание после загрузки (мс)
+
 // ==================== РАСПИСАНИЕ ====================
 #define MAX_SCHEDULES 5     // Максимальное количество расписаний
 
+// ==================== НАСТРОЙКА ИЗ JSON ====================
+// Сеть, пояс и кормление из data/config.json, POST /api/config и MQTT
+// (provisioning.h); значения из .env - умолчания до первого документа
+#define PROV_MAX_AMOUNT 200 // Наибольшая порция в документе (оборотов)
+#define PROV_TRIAL_TIMEOUT 60000  // Новые WiFi/MQTT должны подключиться, иначе возврат прежних (мс)
+
+// ==================== ТЕНЬ УСТРОЙСТВА ====================
+// Сообщаемое и желаемое состояние в MQTT (shadow.h)
+#define SHADOW_CHECK_INTERVAL 1000    // Проверка локальных изменений настроек (мс)
+#define SHADOW_REPORT_INTERVAL 300000 // Повтор reported со свежими link и stats (мс)
+#define SHADOW_DOC_MAX 896            // Документ reported (байт, меньше буфера MQTT)
+
+// ==================== УСТРОЙСТВО (из .env) ====================
+// DEVICE_NAME - имя кормушки (необязательно). Без него идентификатор
+// строится из MAC: feeder_a1b2c3
+#define DEVICE_ID_LEN 32            // Максимальная длина идентификатора (с нулём)
+
 // ==================== WIFI (из .env) ====================
 #ifndef WIFI_SSID
   #define WIFI_SSID "NOT_SET"
@@ -42,20 +90,51 @@ const byte MOTOR_PINS[] = {12, 13, 15, 14};
 #endif
 
 #define WIFI_CONNECT_TIMEOUT 20000  // Таймаут подключения (мс)
+#define WIFI_FAST_CONNECT_TIMEOUT 3000  // Таймаут быстрого подключения по кэшу (мс)
+#define WIFI_BACKOFF_MIN 1000       // Начальная задержка переподключения (мс)
+#define WIFI_BACKOFF_MAX 60000      // Максимальная задержка переподключения (мс)
+#define WIFI_STALE_EVENT_MS 500     // Окно игнорирования устаревших событий отключения (мс)
+#define WIFI_BOOT_WAIT 10000        // Ожидание WiFi при старте (мс)
+
+// ==================== ВЕБ (из .env) ====================
+// Пароль HTTP Basic для сетевых ключей в POST /api/config (пользователь
+// WEB_ADMIN_USER). Пусто - сеть и учётные данные по HTTP не меняются
+#ifndef WEB_ADMIN_PASSWORD
+  #define WEB_ADMIN_PASSWORD ""
+#endif
+#define WEB_ADMIN_USER "admin"
 
 // ==================== OTA (из .env) ====================
 #ifndef OTA_HOSTNAME
   #define OTA_HOSTNAME "ESP32-Feeder"
 #endif
 
+// Пароль POST /api/ota (пользователь WEB_ADMIN_USER). Пусто - WEB_ADMIN_PASSWORD,
+// пусты оба - HTTP OTA выключено
 #ifndef OTA_PASSWORD
   #define OTA_PASSWORD ""
 #endif
 
+#define OTA_VALIDATE_TIMEOUT 180000   // Время на самопроверки новой прошивки (мс)
+#define OTA_MAX_BOOT_ATTEMPTS 3       // Загрузок без подтверждения до отката
+#define OTA_SESSION_TIMEOUT 300000    // Сессия без новых кусков закрывается (мс)
+#define OTA_REBOOT_DELAY 1000         // Перезагрузка после записи образа (мс)
+
+// ==================== UDP УПРАВЛЕНИЕ (из .env) ====================
+// Команды кормления по локальной сети в обход брокера (udp_control.h).
+// Без ключа канал выключен
+#ifndef UDP_CONTROL_KEY
+  #define UDP_CONTROL_KEY ""
+#endif
+
+#define UDP_CONTROL_PORT 4210         // Порт команд (объявляется в mDNS как _feeder._udp)
+#define UDP_CONTROL_QUEUE 4           // Проверенных команд в очереди на loop
+
 // ==================== NTP ====================
 #define NTP_SERVER "ru.pool.ntp.org"
-#define GMT_OFFSET_SEC 10800    // GMT+3 (Москва)
-#define DAYLIGHT_OFFSET_SEC 0
+// Часовой пояс - POSIX строка с правилами летнего времени,
+// например "CET-1CEST,M3.5.0,M10.5.0/3" (Берлин)
+#define TIME_ZONE "MSK-3"             // Москва, без летнего времени
 
 // ==================== MQTT (из .env) ====================
 #ifndef MQTT_SERVER
@@ -74,20 +153,137 @@ const byte MOTOR_PINS[] = {12, 13, 15, 14};
   #define MQTT_PASSWORD ""
 #endif
 
-#ifndef MQTT_CLIENT_ID
-  #define MQTT_CLIENT_ID "ESP32-Feeder"
+#ifndef MQTT_TLS
+  #define MQTT_TLS 0                  // 1 - MQTT через TLS (tls_client.h), порт обычно 8883
 #endif
 
+#define MQTT_TLS_CA_FILE "/mqtt_ca.pem" // Корневой сертификат брокера в хранилище (data/)
+#define TLS_SESSION_MAX 2048          // Сохранённая TLS сессия в RTC памяти (байт)
+#define TLS_CONNECT_TIMEOUT 5000      // TCP подключение и запись (мс)
+#define TLS_HANDSHAKE_TIMEOUT 15000   // Рукопожатие TLS (мс)
+
 #define MQTT_RECONNECT_INTERVAL 5000  // Интервал переподключения (мс)
+#define MQTT_MESSAGE_MAX_LEN 256      // Максимальная длина входящей команды (байт)
+#define MQTT_CBOR_ENABLED 1           // Дублировать события и метрики в CBOR (для сборщиков на брокере)
+#define MQTT_DISCOVERY_INTERVAL 100   // Пауза между конфигурациями Discovery (мс, без задержки loop)
 
-// MQTT топики
-#define MQTT_TOPIC_BOOT_TIME "homeassistant/sensor/feeder/boot_time/state"
-#define MQTT_TOPIC_FEED_CMD "homeassistant/button/feeder/feed/set"
-#define MQTT_TOPIC_LAST_FEEDING "homeassistant/sensor/feeder/last_feeding/state"
-#define MQTT_TOPIC_AVAILABILITY "homeassistant/binary_sensor/feeder/availability/state"
+// MQTT топики ("%s" - идентификатор устройства, см. device_id.h)
+#define MQTT_TOPIC_LEN 96             // Размер буфера топика (байт)
+#define MQTT_TOPIC_BOOT_TIME "homeassistant/sensor/%s/boot_time/state"
+#define MQTT_TOPIC_FEED_CMD "homeassistant/button/%s/feed/set"              // Шнек 1
+#define MQTT_TOPIC_FEED_CMD_AUGER "homeassistant/button/%s/feed_%d/set"     // Шнеки 2..N
+#define MQTT_TOPIC_LAST_FEEDING "homeassistant/sensor/%s/last_feeding/state"
+#define MQTT_TOPIC_AVAILABILITY "homeassistant/binary_sensor/%s/availability/state"
+#define MQTT_TOPIC_METRICS "homeassistant/sensor/%s/metrics/state"
+#define MQTT_TOPIC_PET_PRESENT "homeassistant/binary_sensor/%s/pet_present/state"
+#define MQTT_TOPIC_EATING "homeassistant/sensor/%s/eating_duration/state"
+#define MQTT_TOPIC_LOG "%s/log"
+#define MQTT_TOPIC_LOG_LEVEL "%s/log/level/set"
+#define MQTT_TOPIC_EVENTS "%s/events"                   // События в CBOR (telemetry.h)
+#define MQTT_TOPIC_TELEMETRY "%s/telemetry"             // Метрики в CBOR
+#define MQTT_TOPIC_CONFIG "%s/config/set"               // Настройки одной кормушки
+#define MQTT_TOPIC_CONFIG_RESULT "%s/config/result"     // Итог применения
+#define MQTT_TOPIC_CONFIG_FLEET "feeder/config/set"     // Настройки всех кормушек брокера
+#define MQTT_TOPIC_SHADOW_REPORTED "%s/shadow/reported" // Состояние устройства (retained)
+#define MQTT_TOPIC_SHADOW_DESIRED "%s/shadow/desired"   // Дельта желаемого состояния
+#define MQTT_TOPIC_SHADOW_RESULT "%s/shadow/result"     // Итог применения дельты
+#define MQTT_TOPIC_FEED_RECOVERY "%s/feeding/recovery" // Кормления, прерванные сбросом (retained)
+
+// ==================== ПИТАНИЕ ====================
+// Экономный режим между событиями (power_manager.h)
+#define POWER_MANAGEMENT 1            // 0 - всегда полная частота, WiFi без энергосбережения
+#define POWER_ACTIVE_CPU_MHZ 240      // Частота при работе
+#define POWER_IDLE_CPU_MHZ 80         // Частота в простое (не ниже 80 - от APB зависят таймеры)
+#define POWER_IDLE_DELAY 30000        // После последнего события до простоя (мс)
+#define POWER_ACTIVE_LOOP_MS 10       // Пауза loop() при работе (мс)
+#define POWER_IDLE_LOOP_MS 200        // Пауза loop() в простое (мс)
+#define POWER_LIGHT_SLEEP 1           // Автоматический light sleep в простое (сборки с CONFIG_PM_ENABLE)
+#define POWER_IDLE_CAMERA_FPS 1       // Фоновый захват в простое (0 - сенсор в standby: без предзаписи и детектора)
 
 // ==================== ТАЙМЕРЫ ====================
 #define HEARTBEAT_INTERVAL 30000    // Интервал heartbeat в Serial (мс)
 #define SCHEDULE_CHECK_INTERVAL 1000  // Интервал проверки расписания (мс)
 
+// ==================== МЕТРИКИ ====================
+#define METRICS_MAX_BUCKETS 10        // Максимум корзин в гистограмме
+#define METRICS_SAMPLE_INTERVAL 1000  // Интервал обновления heap/uptime (мс)
+#define METRICS_MQTT_ENABLED 1        // Публиковать метрики как сенсоры Home Assistant
+#define METRICS_MQTT_INTERVAL 60000   // Интервал публикации метрик в MQTT (мс)
+
+// ==================== ЖУРНАЛ ====================
+// Максимальный уровень задаётся флагом сборки -DLOG_MAX_LEVEL=N
+// (0 - выкл, 1 - ошибки, 2 - предупреждения, 3 - информация, 4 - отладка)
+#define LOG_QUEUE_SLOTS 32            // Слотов в очереди (степень двойки)
+#define LOG_LINE_LEN 160              // Максимальная длина строки (байт)
+#define LOG_TAIL_LINES 32             // Строк в истории для /api/log и MQTT
+#define LOG_DRAIN_PERIOD 20           // Период опроса очереди задачей вывода (мс)
+#define LOG_MQTT_DEFAULT_LEVEL "warn" // Уровень пересылки в MQTT (none/error/warn/info/debug)
+#define LOG_MQTT_MAX_PER_LOOP 4       // Не больше строк в MQTT за одну итерацию loop
+#define LOG_FILE_LEVEL 2              // Уровень записи в файл (2 - предупреждения и ошибки)
+#define LOG_FILE_PATH "/log.txt"      // Файл журнала в хранилище
+#define LOG_FILE_OLD_PATH "/log.1.txt" // Предыдущий файл после ротации
+#define LOG_FILE_MAX_SIZE 65536       // Размер файла до ротации (байт)
+
+// ==================== КАМЕРА ====================
+// Кадры берутся из пула CAMERA_POOL_SLOTS буферов в PSRAM, MJPEG поток
+// отдаётся отдельным сервером на CAMERA_STREAM_PORT
+#define CAMERA_STREAM_PORT 81         // Порт MJPEG потока (/api/stream)
+#define CAMERA_STREAM_MAX_CLIENTS 4   // Одновременных зрителей
+#define CAMERA_POOL_SLOTS 4           // Буферов кадров в пуле
+#define CAMERA_FRAME_MAX (96 * 1024)  // Максимальный размер JPEG кадра (байт)
+#define CAMERA_JPEG_QUALITY 12        // Качество JPEG (0-63, меньше - лучше)
+#define CAMERA_MAX_FPS 15             // Предел частоты кадров потока
+#define CAMERA_MIN_FPS 4              // Ниже - уменьшаем разрешение
+#define CAMERA_MAX_SIZE FRAME_SVGA    // Наибольшее разрешение потока (frame_source.h)
+#define CAMERA_ADAPT_INTERVAL 2000    // Период пересчёта частоты и разрешения (мс)
+#define CAMERA_STREAM_STALL_MS 10000  // Клиент без прогресса отключается (мс)
+#define CAMERA_CAPTURE_TIMEOUT 400    // Ожидание кадра для /api/capture, меньше TRACE_STALL_MS (мс)
+#define CAMERA_ACCEPT_POLL_MS 100     // Опрос новых зрителей, пока потока нет (мс)
+#define CAMERA_STANDBY_POLL_MS 1000   // Сенсор в standby: проверка режима задачами камеры (мс)
+
+// ==================== РОЛИКИ ====================
+// Кольцо предзаписи в PSRAM, при кормлении ролик сохраняется в хранилище
+#define CLIP_FPS 2                    // Частота фонового захвата
+#define CLIP_SIZE FRAME_QQVGA         // Разрешение роликов (frame_source.h)
+#define CLIP_PREROLL_MS 5000          // Предзапись до кормления (мс)
+#define CLIP_POSTROLL_MS 15000        // Запись после начала кормления (мс)
+#define CLIP_RING_BYTES (192 * 1024)  // Кольцо кадров в PSRAM (байт)
+#define CLIP_RING_FRAMES 64           // Кадров в кольце не больше
+#define CLIP_KEEP 3                   // Хранится последних роликов
+
+// ==================== ДЕТЕКТОР КОТА ====================
+// Кадры фонового захвата уменьшаются до PRESENCE_W x PRESENCE_H в оттенках
+// серого и сравниваются с фоном блоками 8x8 (presence_detect.h)
+#define PRESENCE_FPS 4                // Кадров в секунду на детектор
+#define PRESENCE_CPU_PERCENT 15       // Доля времени ядра 0 на детектор (%)
+#define PRESENCE_W 80                 // Ширина уменьшенного кадра (кратно 8)
+#define PRESENCE_H 60                 // Высота уменьшенного кадра
+#define PRESENCE_PIXEL_DIFF 18        // Средняя разность пикселя в активном блоке
+#define PRESENCE_MIN_BLOCKS 4         // Активных блоков для движения
+#define PRESENCE_GLOBAL_PERCENT 70    // Больше активных блоков (%) - смена света
+#define PRESENCE_ON_FRAMES 3          // Кадров с движением подряд до "кот есть"
+#define PRESENCE_OFF_MS 8000          // Без движения до "кота нет" (мс)
+#define PRESENCE_BG_SHIFT 4           // Скорость фона: 1/16 разности за кадр
+#define PRESENCE_RELEARN_MS 600000    // Движение дольше - переучить фон (мс)
+#define PRESENCE_EAT_WINDOW_MS 1800000 // Окно учёта еды после кормления (мс)
+
+// ==================== ХРАНИЛИЩЕ ====================
+// Раздел LittleFS из partitions.csv; образ собирается из data/ (pio run -t buildfs)
+#define STORAGE_PARTITION "littlefs"  // Метка раздела
+#define STORAGE_BASE_PATH "/littlefs" // Точка монтирования в VFS
+#define STORAGE_MAX_OPEN_FILES 5      // Одновременно открытых файлов
+
+// ==================== ПАМЯТЬ ====================
+#define WEB_ARENA_SIZE 2048           // Арена временных буферов веб-обработчиков (байт)
+#define ALLOC_WARMUP_MS 60000         // После этого времени loop() не должен выделять память (мс)
+#define ALLOC_REPORT_INTERVAL 10000   // Интервал предупреждений о выделениях (мс)
+
+// ==================== ТРАССИРОВКА ====================
+#define TRACE_RING_SIZE 64            // Событий в кольцевом буфере
+#define TRACE_MAX_DEPTH 8             // Максимальная вложенность участков
+#define TRACE_NAME_LEN 16             // Длина имени участка (с нулём)
+#define TRACE_MIN_DURATION_US 1000    // Более короткие участки не записываются (мкс)
+#define TRACE_STALL_MS 500            // Итерация loop() дольше - зависание (мс)
+#define TRACE_WATCHDOG_PERIOD 100     // Период проверки сторожа (мс)
+
 #endif // CONFIG_H
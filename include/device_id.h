@@ -0,0 +1,31 @@
+/*
+  device_id.h - Идентификатор устройства для работы нескольких кормушек
+
+  Идентификатор строится один раз при старте: из DEVICE_NAME (.env),
+  приведённого к виду [a-z0-9_], или из последних трёх байт eFuse MAC
+  ("feeder_a1b2c3"). Если имя при этом изменилось ("Кухня" - одни
+  подчёркивания), к нему добавляется хэш исходного имени. Из него
+  собираются MQTT топики, Client ID и идентификаторы Home Assistant
+  Discovery, поэтому кормушки на одном брокере не пересекаются.
+*/
+
+#ifndef DEVICE_ID_H
+#define DEVICE_ID_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Построение идентификатора (вызывать в начале setup)
+void deviceIdSetup();
+
+// Идентификатор из имени: [a-z0-9_], не длиннее size - 1; изменённое
+// или обрезанное имя получает суффикс "_" + 6 hex цифр FNV-1a имени
+void deviceIdFromName(const char* name, char* id, size_t size);
+
+// Идентификатор для топиков и unique_id ("feeder_a1b2c3")
+const char* deviceId();
+
+// Имя устройства в Home Assistant
+const char* deviceName();
+
+#endif // DEVICE_ID_H
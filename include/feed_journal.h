@@ -0,0 +1,82 @@
+/*
+  feed_journal.h - Журнал кормлений на случай сброса посреди порции
+
+  Мотор на слабом блоке питания может уронить напряжение и перезагрузить
+  плату посреди кормления. Журнал упреждающей записи хранит по каждому
+  шнеку цель и прогресс текущего кормления в двух местах:
+    - RTC память: обновляется на каждом обороте (запись в ОЗУ, без износа),
+      переживает программный сброс, сторожевые таймеры, панику и обычно
+      просадку питания (brownout);
+    - NVS: при запуске (до первого шага), каждые FEED_JOURNAL_CHECKPOINT_REVS
+      оборотов и по завершении. Переживает отключение питания. Запись NVS
+      атомарна, оборванная запись оставляет прошлую контрольную точку.
+      Пока идёт запись во flash, шаги мотора ждут (единицы мс), поэтому
+      контрольные точки редкие; время записи - feeder_journal_write_us.
+
+  При загрузке незавершённое кормление:
+    - докармливается (остаток, источник "resume") через
+      FEED_JOURNAL_RESUME_DELAY, если запись уцелела в RTC памяти (сброс
+      был коротким) и FEED_JOURNAL_MAX_RESUMES попыток ещё не исчерпаны;
+    - иначе отмечается как частичное: питание пропадало на неизвестное
+      время, и лишняя порция не ко времени хуже недоданной.
+  Итог публикуется в MQTT_TOPIC_FEED_RECOVERY и отдаётся GET /api/journal.
+  Точность - оборот: начатый к сбросу оборот повторяется.
+*/
+
+#ifndef FEED_JOURNAL_H
+#define FEED_JOURNAL_H
+
+#include <Arduino.h>
+#include "config.h"
+
+enum JournalState : uint8_t {
+  JOURNAL_IDLE,                // Кормление завершено или записи нет
+  JOURNAL_ACTIVE               // Шнек выдаёт порцию
+};
+
+// Запись шнека (одинакова в RTC памяти и NVS)
+struct JournalRecord {
+  uint32_t id;                 // Номер кормления (растёт через перезагрузки, 0 - записи нет)
+  uint32_t epoch;              // Начало (0 - время неизвестно)
+  int32_t target;              // Оборотов в порции
+  int32_t done;                // Выдано к последней записи
+  uint8_t state;               // JournalState
+  uint8_t attempts;            // Возобновлений после сброса
+  char source[10];
+  uint32_t check;              // fnv1a полей выше
+};
+
+enum JournalOutcome : uint8_t {
+  JOURNAL_NONE,                // Прерванных кормлений не было
+  JOURNAL_RESUMED,             // Остаток докармливается
+  JOURNAL_PARTIAL              // Выдана только часть порции
+};
+
+// Чтение журнала и решение по прерванным кормлениям (из feederSetup)
+void journalSetup();
+
+// Начало кормления: запись до первого шага мотора
+void journalBegin(uint8_t auger, int target, const char* source);
+
+// Прогресс (из feederLoop): RTC - при каждом новом обороте, NVS - на
+// контрольных точках
+void journalProgress(uint8_t auger, int done);
+
+// Кормление завершено
+void journalEnd(uint8_t auger, int done);
+
+// Прерванное кормление, которое пора докормить (однократно). Запись снова
+// активна, число возобновлений увеличено и сохранено до запуска мотора
+bool journalTakeResume(uint8_t auger, JournalRecord& rec);
+
+// Наибольший размер JSON журнала (байт)
+#define JOURNAL_JSON_MAX (64 + 320 * NUM_AUGERS)
+
+// Итог восстановления после загрузки (для MQTT)
+bool journalHasRecovery();
+size_t journalRecoveryJson(char* buf, size_t size);
+
+// Текущие записи, итог восстановления и число записей во flash (GET /api/journal)
+size_t journalStatusJson(char* buf, size_t size);
+
+#endif // FEED_JOURNAL_H
@@ -1,41 +1,45 @@
 /*
-  feeder.h - Управление мотором и кормлением
+  feeder.h - Кормление шнеками и калибровка порций
 */
 
 #ifndef FEEDER_H
 #define FEEDER_H
 
 #include <Arduino.h>
-#include <FastLED.h>
 #include "config.h"
 
-// LED массив
-extern CRGB leds[NUM_LEDS];
-
-// Текущая порция кормления
-extern int feedAmount;
+// Базовые порции по шнекам
+extern int feedAmount[NUM_AUGERS];
+
+// Статистика кормлений с загрузки
+struct FeederStats {
+  uint32_t feeds;              // Завершённых кормлений
+  uint32_t revolutions;        // Выдано оборотов
+  time_t lastEpoch;            // Последнее кормление (0 - не было или время неизвестно)
+  uint8_t lastAuger;
+  int lastAmount;
+  const char* lastSource;      // nullptr - кормлений не было
+};
 
-// Инициализация LED и моторных пинов
+// Инициализация моторов шнеков
 void feederSetup();
 
-// Управление мотором
-void runMotor(int8_t dir);
-void disableMotor();
-void oneRev();
+// Завершение кормлений и калибровки, индикация прогресса
+void feederLoop();
 
-// LED эффекты
-void flashLights();
-void feedAnimation(int revCount);
+// Запуск кормления шнека auger (с нуля; amount <= 0 - его базовая порция).
+// Не ждёт мотор: по завершении feederLoop() публикует последнее кормление
+// с источником source (строковый литерал). false - шнек занят или не существует
+bool feed(uint8_t auger, int amount, const char* source);
 
-// Индикация состояния системы (мигание как маяк)
-enum SystemStatus {
-  STATUS_OK,           // Все хорошо - зеленый раз в 30 сек
-  STATUS_WIFI_ISSUE,   // Проблемы с WiFi - синий раз в 10 сек
-  STATUS_ERROR         // Ошибка - красный
-};
-void updateStatusLed(SystemStatus status);
+// Шнек крутится (кормление или калибровка)
+bool feederBusy(uint8_t auger);
+
+const FeederStats& feederGetStats();
 
-// Процесс кормления
-void feed(int amount = 0);
+// Калибровка порции: мотор крутится до calibrationStop(), обороты
+// считаются в фоне, остановка - на границе оборота
+bool calibrationStart(uint8_t auger);
+void calibrationStop(uint8_t auger);
 
 #endif
@@ -0,0 +1,37 @@
+/*
+  file_frame_source.h - Кадры из файлов вместо камеры
+
+  Отдаёт по кругу JPEG файлы <dir>/000.jpg, 001.jpg, ... из хранилища
+  (storage.h): на хосте это обычный каталог, на устройстве - LittleFS.
+  Разрешение файлов не меняется, setSize() только запоминается и
+  попадает в описание кадра, чтобы адаптация потока работала как с камерой.
+*/
+
+#ifndef FILE_FRAME_SOURCE_H
+#define FILE_FRAME_SOURCE_H
+
+#include "frame_source.h"
+
+class FileFrameSource : public FrameSource {
+public:
+  // dir - каталог кадров в хранилище ("/frames")
+  explicit FileFrameSource(const char* dir) : _dir(dir) {}
+
+  bool begin(FrameSize size) override;
+  bool setSize(FrameSize size) override { _size = size; return true; }
+  FrameSize size() const override { return _size; }
+  bool capture(uint8_t* buf, size_t cap, FrameInfo& info) override;
+
+  // Найдено файлов кадров
+  uint16_t count() const { return _count; }
+
+private:
+  void framePath(char* path, size_t size, uint16_t index) const;
+
+  const char* _dir;
+  FrameSize _size = FRAME_QVGA;
+  uint16_t _count = 0;
+  uint16_t _next = 0;
+};
+
+#endif // FILE_FRAME_SOURCE_H
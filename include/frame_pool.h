@@ -0,0 +1,55 @@
+/*
+  frame_pool.h - Пул буферов кадров в PSRAM
+
+  Захват пишет кадр в свободный слот пула и делает его последним;
+  читатели (MJPEG клиенты, /api/capture) берут последний кадр по ссылке
+  и отдают его в сокет прямо из слота, без копий. Слот возвращается
+  в оборот, когда его отпустил последний читатель, поэтому медленный
+  клиент держит только свой кадр, а остальные получают свежие.
+
+  Без блокировок: писатель один (задача захвата), читатели только
+  увеличивают счётчик ссылок последнего слота и перепроверяют, что он
+  всё ещё последний.
+*/
+
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <atomic>
+#include "frame_source.h"
+
+struct FrameSlot {
+  uint8_t* data = nullptr;
+  FrameInfo info = {};
+  std::atomic<uint16_t> refs{0};
+};
+
+class FramePool {
+public:
+  // Выделение slots буферов по frameMax байт (на ESP32 - в PSRAM)
+  bool begin(uint8_t slots, size_t frameMax);
+
+  // Захват одного кадра из источника в свободный слот и публикация.
+  // false - все слоты заняты читателями или источник не дал кадр
+  bool captureFrom(FrameSource& source, uint32_t nowMs);
+
+  // Последний кадр новее newerThan (+1 ссылка) или nullptr
+  FrameSlot* acquireLatest(uint32_t newerThan = 0);
+  void release(FrameSlot* slot);
+
+  // Номер последнего опубликованного кадра (0 - кадров ещё не было)
+  uint32_t latestSeq() const;
+
+  size_t frameMax() const { return _frameMax; }
+  uint32_t droppedNoSlot() const { return _droppedNoSlot.load(std::memory_order_relaxed); }
+
+private:
+  FrameSlot* _slots = nullptr;
+  uint8_t _count = 0;
+  size_t _frameMax = 0;
+  std::atomic<int8_t> _latest{-1};
+  uint32_t _seq = 0;  // Только писатель
+  std::atomic<uint32_t> _droppedNoSlot{0};
+};
+
+#endif // FRAME_POOL_H
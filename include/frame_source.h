@@ -0,0 +1,60 @@
+/*
+  frame_source.h - Источник JPEG кадров
+
+  Конвейер кадров (пул, MJPEG поток, запись роликов) берёт кадры только
+  через FrameSource, поэтому камеру можно заменить файлами: на устройстве -
+  CameraFrameSource (camera.h), на хосте и для проверки без сенсора -
+  FileFrameSource (file_frame_source.h). Интерфейс не зависит от Arduino.
+*/
+
+#ifndef FRAME_SOURCE_H
+#define FRAME_SOURCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Разрешения по возрастанию (адаптация потока шагает по ним)
+enum FrameSize : uint8_t {
+  FRAME_QQVGA,   // 160x120
+  FRAME_QVGA,    // 320x240
+  FRAME_VGA,     // 640x480
+  FRAME_SVGA,    // 800x600
+  FRAME_SIZE_COUNT
+};
+
+inline uint16_t frameWidth(FrameSize size) {
+  static const uint16_t widths[FRAME_SIZE_COUNT] = {160, 320, 640, 800};
+  return widths[size < FRAME_SIZE_COUNT ? size : FRAME_QQVGA];
+}
+
+inline uint16_t frameHeight(FrameSize size) {
+  static const uint16_t heights[FRAME_SIZE_COUNT] = {120, 240, 480, 600};
+  return heights[size < FRAME_SIZE_COUNT ? size : FRAME_QQVGA];
+}
+
+// Описание кадра
+struct FrameInfo {
+  uint32_t len;      // Размер JPEG (байт)
+  uint16_t width;
+  uint16_t height;
+  uint32_t timeMs;   // Время захвата
+  uint32_t seq;      // Порядковый номер (назначает пул, с единицы)
+};
+
+class FrameSource {
+public:
+  virtual ~FrameSource() {}
+
+  // Подготовка источника с начальным разрешением
+  virtual bool begin(FrameSize size) = 0;
+
+  // Смена разрешения (действует со следующего кадра)
+  virtual bool setSize(FrameSize size) = 0;
+  virtual FrameSize size() const = 0;
+
+  // Захват кадра в buf (не больше cap байт); заполняет len, width, height.
+  // false - кадра нет или он не поместился
+  virtual bool capture(uint8_t* buf, size_t cap, FrameInfo& info) = 0;
+};
+
+#endif // FRAME_SOURCE_H
@@ -0,0 +1,74 @@
+/*
+  gzip_stream.h - Потоковая распаковка gzip
+
+  Данные подаются кусками любого размера, распакованный поток отдаётся
+  приёмнику блоками (не больше словаря 32 КБ). Заголовок gzip (с необязательными
+  полями) и трейлер разбираются по ходу, CRC32 и длина проверяются в конце.
+  Inflate - tinfl из miniz (на ESP32 - копия в ROM), на хосте - его замена
+  inflate_native. От Arduino модуль не зависит.
+*/
+
+#ifndef GZIP_STREAM_H
+#define GZIP_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class GzipStream {
+public:
+  // Приёмник распакованных данных (false - прервать распаковку)
+  typedef bool (*Sink)(const uint8_t* data, size_t len, void* ctx);
+
+  // Проверка сигнатуры gzip (нужны первые 2 байта)
+  static bool isGzip(const uint8_t* data, size_t len);
+
+  // Выделение буферов (~43 КБ) и сброс состояния
+  bool begin(Sink sink, void* ctx);
+
+  // Освобождение буферов
+  void end();
+
+  // Очередной кусок сжатого потока (false - ошибка, см. error())
+  bool write(const uint8_t* data, size_t len);
+
+  // Поток разобран до конца, CRC32 и длина совпали
+  bool finished() const { return _stage == STAGE_DONE; }
+
+  const char* error() const { return _error; }
+  uint32_t outputSize() const { return _outSize; }
+
+private:
+  enum Stage : uint8_t {
+    STAGE_HEADER,     // 10 байт фиксированного заголовка
+    STAGE_EXTRA_LEN,  // FEXTRA: длина
+    STAGE_EXTRA,      // FEXTRA: данные
+    STAGE_NAME,       // FNAME: строка до нуля
+    STAGE_COMMENT,    // FCOMMENT: строка до нуля
+    STAGE_HCRC,       // FHCRC: 2 байта
+    STAGE_BODY,       // deflate
+    STAGE_TRAILER,    // CRC32 + ISIZE
+    STAGE_DONE,
+    STAGE_FAILED
+  };
+
+  bool fail(const char* error);
+  void nextHeaderStage();
+  bool inflate(const uint8_t*& data, size_t& len);
+
+  Sink _sink = nullptr;
+  void* _ctx = nullptr;
+  void* _inflator = nullptr;    // tinfl_decompressor
+  uint8_t* _dict = nullptr;     // Кольцевой словарь 32 КБ
+  size_t _dictPos = 0;
+
+  Stage _stage = STAGE_HEADER;
+  uint8_t _flags = 0;
+  uint8_t _buf[10];             // Заголовок / трейлер / длина FEXTRA
+  size_t _bufLen = 0;
+  uint32_t _skip = 0;
+  uint32_t _crc = 0;
+  uint32_t _outSize = 0;
+  const char* _error = nullptr;
+};
+
+#endif // GZIP_STREAM_H
@@ -0,0 +1,60 @@
+/*
+  inflate_native.h - Inflate (RFC 1951) для сборки на хосте
+
+  На ESP32 gzip_stream распаковывает tinfl из ROM (esp32/rom/miniz.h).
+  На хосте miniz нет, поэтому здесь та же часть интерфейса tinfl, которой
+  пользуется gzip_stream: потоковая распаковка в кольцевой словарь 32 КБ
+  с остановкой на любой границе входа и выхода. Как и tinfl, распаковщик
+  забирает вход в битовый буфер с запасом: после TINFL_STATUS_DONE в
+  m_bit_buf могут остаться целые байты, следующие за потоком.
+*/
+
+#ifndef INFLATE_NATIVE_H
+#define INFLATE_NATIVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TINFL_LZ_DICT_SIZE 32768
+
+// Флаги tinfl_decompress
+#define TINFL_FLAG_HAS_MORE_INPUT 2    // Вход ещё будет (иначе нехватка - ошибка)
+
+typedef enum {
+  TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS = -4,
+  TINFL_STATUS_FAILED = -1,
+  TINFL_STATUS_DONE = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+// Канонический код Хаффмана: число кодов каждой длины и символы по порядку
+struct TinflHuff {
+  uint16_t count[16];
+  uint16_t symbol[288];
+};
+
+struct tinfl_decompressor {
+  uint32_t m_state;
+  uint32_t m_num_bits;            // Бит в m_bit_buf
+  uint64_t m_bit_buf;             // Младшие биты - следующие
+  uint32_t m_final;               // Последний блок
+  uint32_t m_counter;             // Остаток хранимого блока или копии
+  uint32_t m_dist;
+  uint32_t m_nlen, m_ndist, m_ncode, m_index;
+  uint32_t m_total;               // Распаковано (до размера словаря)
+  uint8_t m_lens[320];            // Длины кодов: литералы/длины, затем дистанции
+  TinflHuff m_lit, m_distcode, m_clen;
+};
+
+#define tinfl_init(r) \
+  do { (r)->m_state = 0; (r)->m_num_bits = 0; (r)->m_bit_buf = 0; (r)->m_total = 0; } while (0)
+
+// Распаковка в кольцевой буфер [pOut_buf_start, +TINFL_LZ_DICT_SIZE) с позиции
+// pOut_buf_next. На входе *pIn_buf_size и *pOut_buf_size - доступные байты,
+// на выходе - забранные и записанные
+tinfl_status tinfl_decompress(tinfl_decompressor* r, const uint8_t* pIn_buf_next, size_t* pIn_buf_size,
+                              uint8_t* pOut_buf_start, uint8_t* pOut_buf_next, size_t* pOut_buf_size,
+                              uint32_t decomp_flags);
+
+#endif // INFLATE_NATIVE_H
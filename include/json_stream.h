@@ -0,0 +1,110 @@
+/*
+  json_stream.h - Потоковый разбор JSON без выделения памяти
+
+  Документ подаётся кусками любой длины (чтение файла, тело HTTP запроса,
+  сообщение MQTT), разборщик - конечный автомат по символам. На каждое
+  значение вызывается обработчик с типом и текстом; путь к значению
+  (ключи объектов и номера элементов массивов по уровням) доступен через
+  key() и index(). Перед входом в объект или массив обработчик получает
+  JSON_OBJECT / JSON_ARRAY на уровне самого контейнера.
+
+  Вся память - внутри объекта: глубина до JSON_MAX_DEPTH, ключи до
+  JSON_KEY_LEN - 1 байт (длиннее - обрезаются), строки и числа до
+  JSON_TOKEN_LEN - 1 байт (длиннее - ошибка разбора).
+  Модуль не зависит от Arduino.
+*/
+
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define JSON_MAX_DEPTH 6
+#define JSON_KEY_LEN 24
+#define JSON_TOKEN_LEN 72
+
+enum JsonType : uint8_t {
+  JSON_OBJECT,
+  JSON_ARRAY,
+  JSON_STRING,
+  JSON_NUMBER,
+  JSON_TRUE,
+  JSON_FALSE,
+  JSON_NULL
+};
+
+class JsonStream {
+public:
+  // text - строка без кавычек (с раскрытыми escape) или текст числа;
+  // для контейнеров и литералов - пустая строка
+  typedef void (*ValueFn)(void* ctx, const JsonStream& json, JsonType type, const char* text);
+
+  void begin(ValueFn fn, void* ctx);
+
+  // Очередной кусок; false - ошибка разбора (остальное игнорируется)
+  bool feed(const char* data, size_t len);
+
+  // Документ закончен (корневое значение закрыто)
+  bool done() const { return _state == ST_DONE; }
+  bool failed() const { return _state == ST_ERROR; }
+
+  // Смещение ошибки от начала документа
+  size_t offset() const { return _offset; }
+
+  // Текущая глубина (1 - внутри корневого контейнера)
+  uint8_t depth() const { return _depth; }
+
+  // Ключ на уровне level (1..depth; "" - уровень массива)
+  const char* key(uint8_t level) const;
+
+  // Номер элемента на уровне level (-1 - уровень объекта)
+  int index(uint8_t level) const;
+
+private:
+  enum State : uint8_t {
+    ST_VALUE,        // Ждём значение
+    ST_FIRST_VALUE,  // После '[': значение или ']'
+    ST_FIRST_KEY,    // После '{': ключ или '}'
+    ST_KEY,          // После ',' в объекте: ключ
+    ST_COLON,
+    ST_NEXT,         // После значения: ',' или конец контейнера
+    ST_STRING,
+    ST_LITERAL,      // Число, true, false, null
+    ST_DONE,
+    ST_ERROR
+  };
+
+  struct Level {
+    bool array;
+    int16_t index;
+    char key[JSON_KEY_LEN];
+  };
+
+  void step(char c);
+  void startValue(char c);
+  bool push(bool array);
+  void pop(bool array);
+  void afterValue();
+  void append(char c);
+  void appendUtf8(uint16_t code);
+  void finishString();
+  void finishLiteral();
+  void emit(JsonType type, const char* text);
+  void fail() { _state = ST_ERROR; }
+
+  ValueFn _fn = nullptr;
+  void* _ctx = nullptr;
+  State _state = ST_VALUE;
+  Level _levels[JSON_MAX_DEPTH + 1];  // [0] не используется
+  uint8_t _depth = 0;
+  char _token[JSON_TOKEN_LEN];
+  uint8_t _tokenLen = 0;
+  bool _isKey = false;
+  bool _escape = false;
+  uint8_t _unicode = 0;     // Осталось цифр \uXXXX
+  uint16_t _code = 0;
+  size_t _offset = 0;
+};
+
+#endif // JSON_STREAM_H
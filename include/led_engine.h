@@ -0,0 +1,59 @@
+/*
+  led_engine.h - Неблокирующая индикация на адресных светодиодах
+
+  Индикация собирается из слоёв (снизу вверх): маяк состояния, подключение
+  WiFi, кормление/калибровка, OTA, короткие вспышки. Каждый кадр слои
+  смешиваются по своей прозрачности, кадр рисуется по таймеру esp_timer:
+  раз в LED_FRAME_MS, пока идёт анимация, а в покое - только на фронтах
+  вспышки маяка (таймер не будит процессор в простое).
+  FastLED.show() (запрещает прерывания на время передачи) вызывается
+  только если кадр отличается от уже показанного.
+  Функции слоёв только меняют состояние и сразу возвращаются.
+*/
+
+#ifndef LED_ENGINE_H
+#define LED_ENGINE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Индикация состояния системы (мигание как маяк)
+enum SystemStatus {
+  STATUS_OK,           // Все хорошо - зеленый раз в 30 сек
+  STATUS_WIFI_ISSUE,   // Проблемы с WiFi - синий раз в 10 сек
+  STATUS_ERROR         // Ошибка - красный раз в 3 сек
+};
+
+// Короткие вспышки поверх остальных слоёв
+enum LedFlash {
+  LED_FLASH_BOOT,      // Мигалка синим-красным при старте
+  LED_FLASH_OK,        // Зелёный - успех (WiFi подключен, OTA завершено)
+  LED_FLASH_FAIL       // Красный - ошибка
+};
+
+// Инициализация ленты и таймера отрисовки
+void ledSetup();
+
+// Слой маяка состояния
+void ledSetStatus(SystemStatus status);
+
+// Слой подключения WiFi (жёлтое перемигивание)
+void ledSetWifiConnecting(bool active);
+
+// Слой кормления: радуга, второй светодиод показывает прогресс
+void ledFeedStart();
+void ledFeedProgress(int done, int total);
+void ledFeedStop();
+
+// Калибровка (постоянный зелёный в слое кормления)
+void ledSetCalibrating(bool active);
+
+// Слой OTA (фиолетовый, яркость по прогрессу)
+void ledOtaStart();
+void ledOtaProgress(uint8_t percent);
+void ledOtaEnd(bool ok);
+
+// Вспышка поверх всех слоёв
+void ledFlash(LedFlash flash);
+
+#endif // LED_ENGINE_H
@@ -0,0 +1,74 @@
+/*
+  logger.h - Асинхронное журналирование с уровнями и тегами
+
+  LOGE/LOGW/LOGI/LOGD форматируют сообщение в кольцевую очередь без
+  блокировок и сразу возвращаются. Низкоприоритетная задача выводит очередь
+  в Serial и сохраняет последние строки для удалённого просмотра
+  (/api/log и MQTT); предупреждения и ошибки дописываются в файл журнала
+  в хранилище (с ротацией). Уровни выше LOG_MAX_LEVEL вырезаются
+  при компиляции.
+*/
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#define LOG_LVL_NONE  0
+#define LOG_LVL_ERROR 1
+#define LOG_LVL_WARN  2
+#define LOG_LVL_INFO  3
+#define LOG_LVL_DEBUG 4
+
+#ifndef LOG_MAX_LEVEL
+  #define LOG_MAX_LEVEL LOG_LVL_INFO
+#endif
+
+// Запуск задачи вывода
+void logSetup();
+
+// Запись сообщения (используйте макросы LOGx)
+void logWrite(uint8_t level, const char* tag, const char* fmt, ...)
+  __attribute__((format(printf, 3, 4)));
+
+// Последние строки журнала: выводит строки с номерами >= since в JSON,
+// возвращает номер следующей строки
+uint32_t logWriteTailJson(Print& out, uint32_t since);
+
+// Строка JSON в кавычках с экранированием (и для других модулей)
+void printJsonString(Print& out, const char* s);
+
+// Следующая строка журнала с номером >= since и уровнем <= maxLevel
+// (для пересылки в MQTT). Возвращает false, если новых строк нет
+bool logNextLine(uint32_t& since, uint8_t maxLevel, char* buf, size_t size);
+
+// Буква и имя уровня
+char logLevelChar(uint8_t level);
+uint8_t logLevelFromName(const char* name);
+
+#if LOG_MAX_LEVEL >= LOG_LVL_ERROR
+  #define LOGE(tag, fmt, ...) logWrite(LOG_LVL_ERROR, tag, fmt, ##__VA_ARGS__)
+#else
+  #define LOGE(tag, fmt, ...) do {} while (0)
+#endif
+
+#if LOG_MAX_LEVEL >= LOG_LVL_WARN
+  #define LOGW(tag, fmt, ...) logWrite(LOG_LVL_WARN, tag, fmt, ##__VA_ARGS__)
+#else
+  #define LOGW(tag, fmt, ...) do {} while (0)
+#endif
+
+#if LOG_MAX_LEVEL >= LOG_LVL_INFO
+  #define LOGI(tag, fmt, ...) logWrite(LOG_LVL_INFO, tag, fmt, ##__VA_ARGS__)
+#else
+  #define LOGI(tag, fmt, ...) do {} while (0)
+#endif
+
+#if LOG_MAX_LEVEL >= LOG_LVL_DEBUG
+  #define LOGD(tag, fmt, ...) logWrite(LOG_LVL_DEBUG, tag, fmt, ##__VA_ARGS__)
+#else
+  #define LOGD(tag, fmt, ...) do {} while (0)
+#endif
+
+#endif // LOGGER_H
@@ -0,0 +1,115 @@
+/*
+  metrics.h - Реестр метрик (счётчики, gauge, гистограммы)
+
+  Метрики объявляются глобальными объектами в модуле, который их обновляет,
+  и сами регистрируются в общем списке при статической инициализации.
+  Обновление - атомарные операции без блокировок, можно из любой задачи.
+  Экспорт - в текстовом формате Prometheus (/metrics).
+*/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+enum MetricType {
+  METRIC_COUNTER,
+  METRIC_GAUGE,
+  METRIC_HISTOGRAM
+};
+
+// Базовый класс: имя, описание, метки и место в реестре
+class Metric {
+public:
+  Metric(const char* name, const char* help, const char* labels, MetricType type);
+
+  const char* name() const { return _name; }
+  const char* help() const { return _help; }
+  const char* labels() const { return _labels; }
+  MetricType type() const { return _type; }
+  Metric* next() const { return _next; }
+
+  // Первая метрика в реестре
+  static Metric* first() { return _head; }
+
+private:
+  const char* _name;
+  const char* _help;
+  const char* _labels;  // Например: route="/api/feed" (или nullptr)
+  MetricType _type;
+  Metric* _next;
+  static Metric* _head;
+};
+
+// Монотонный счётчик
+class Counter : public Metric {
+public:
+  Counter(const char* name, const char* help, const char* labels = nullptr)
+    : Metric(name, help, labels, METRIC_COUNTER), _value(0) {}
+
+  void inc(uint32_t n = 1) { _value.fetch_add(n, std::memory_order_relaxed); }
+  // Зеркалирование внешнего счётчика (например, из WifiStats)
+  void set(uint32_t v) { _value.store(v, std::memory_order_relaxed); }
+  uint32_t value() const { return _value.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint32_t> _value;
+};
+
+// Текущее значение
+class Gauge : public Metric {
+public:
+  Gauge(const char* name, const char* help, const char* labels = nullptr)
+    : Metric(name, help, labels, METRIC_GAUGE), _value(0) {}
+
+  void set(int32_t v) { _value.store(v, std::memory_order_relaxed); }
+  // Обновить, только если новое значение больше (пиковые значения)
+  void setMax(int32_t v) {
+    int32_t cur = _value.load(std::memory_order_relaxed);
+    while (v > cur && !_value.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {}
+  }
+  int32_t value() const { return _value.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<int32_t> _value;
+};
+
+// Гистограмма с фиксированными границами корзин (верхние границы, по возрастанию).
+// Сумма 64-битная: 32 бит микросекунд хватило бы лишь на ~71 минуту наблюдений
+class Histogram : public Metric {
+public:
+  Histogram(const char* name, const char* help, const char* labels,
+            const uint32_t* bounds, uint8_t numBounds);
+
+  void observe(uint32_t v);
+
+  uint8_t numBounds() const { return _numBounds; }
+  uint32_t bound(uint8_t i) const { return _bounds[i]; }
+  // Количество наблюдений в корзине i (i == numBounds - корзина +Inf)
+  uint32_t bucket(uint8_t i) const { return _buckets[i].load(std::memory_order_relaxed); }
+  uint32_t count() const { return _count.load(std::memory_order_relaxed); }
+  uint64_t sum() const { return _sum.load(std::memory_order_relaxed); }
+
+private:
+  const uint32_t* _bounds;
+  uint8_t _numBounds;
+  std::atomic<uint32_t> _buckets[METRICS_MAX_BUCKETS + 1];
+  std::atomic<uint32_t> _count;
+  std::atomic<uint64_t> _sum;    // На ESP32 без аппаратной поддержки - критическая секция IDF
+};
+
+// Стандартные границы корзин
+extern const uint32_t METRICS_BUCKETS_US[];   // Микросекунды: 100 мкс .. 1 с
+extern const uint8_t METRICS_BUCKETS_US_COUNT;
+extern const uint32_t METRICS_BUCKETS_MS[];   // Миллисекунды: 100 мс .. 2 мин
+extern const uint8_t METRICS_BUCKETS_MS_COUNT;
+
+// Периодическое обновление системных метрик (heap, uptime, WiFi)
+void metricsLoop();
+
+// Экспорт всех метрик в формате Prometheus
+void metricsWritePrometheus(Print& out);
+
+#endif // METRICS_H
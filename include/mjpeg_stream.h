@@ -0,0 +1,94 @@
+/*
+  mjpeg_stream.h - MJPEG поток для нескольких зрителей
+
+  Сервер на сокетах (lwIP на устройстве, POSIX на хосте) без блокировок:
+  service() за один проход принимает клиентов, разбирает запросы и
+  досылает каждому столько, сколько влезло в сокет. Кадр отдаётся прямо
+  из слота пула (FramePool), копий нет; клиент, не успевший дослать
+  кадр, пропускает промежуточные и сразу получает последний.
+
+  По времени отправки кадра у клиентов считается спрос для захвата:
+  частота - по самому быстрому зрителю (не выше CAMERA_MAX_FPS), разрешение
+  уменьшается, если даже он не тянет CAMERA_MIN_FPS, и растёт, когда
+  запас позволяет. Так один захват обслуживает всех зрителей.
+*/
+
+#ifndef MJPEG_STREAM_H
+#define MJPEG_STREAM_H
+
+#include <atomic>
+#include "config.h"
+#include "frame_pool.h"
+
+// Что нужно захвату
+struct StreamDemand {
+  uint8_t clients;   // Зрителей (0 - поток никому не нужен)
+  uint16_t fps;      // Частота кадров
+  FrameSize size;    // Разрешение
+};
+
+struct StreamStats {
+  uint8_t clients;
+  uint32_t framesSent;
+  uint32_t framesSkipped;   // Кадры, пропущенные медленными клиентами
+  uint32_t bytesSent;
+};
+
+class MjpegStreamer {
+public:
+  // Слушающий сокет на port; кадры из pool
+  bool begin(uint16_t port, FramePool* pool);
+  void end();
+
+  // Один неблокирующий проход; true - была работа (иначе можно поспать)
+  bool service(uint32_t nowMs);
+
+  StreamDemand demand() const;
+  StreamStats stats() const;
+
+private:
+  enum ClientState : uint8_t { CLIENT_FREE, CLIENT_REQUEST, CLIENT_STREAM };
+
+  struct Client {
+    int fd;
+    ClientState state;
+    char request[256];
+    uint16_t requestLen;
+
+    // Отправляемая часть: заголовок + тело кадра + "\r\n"
+    char head[192];
+    uint16_t headLen;
+    FrameSlot* frame;
+    uint32_t outPos;
+    uint32_t outLen;
+
+    uint32_t lastSeq;        // Последний отправленный кадр
+    uint32_t frameStartMs;
+    uint32_t lastProgressMs;
+    uint32_t avgSendMs;      // Скользящее среднее времени отправки кадра
+  };
+
+  void acceptClients(uint32_t nowMs);
+  bool readRequest(Client& c, uint32_t nowMs);
+  bool sendPending(Client& c, uint32_t nowMs);
+  void startFrame(Client& c, uint32_t nowMs);
+  void closeClient(Client& c);
+  void adapt(uint32_t nowMs);
+
+  int _listenFd = -1;
+  FramePool* _pool = nullptr;
+  Client _clients[CAMERA_STREAM_MAX_CLIENTS];
+  uint32_t _lastAdaptMs = 0;
+
+  // Спрос упакован в одно слово: его читает задача захвата
+  std::atomic<uint32_t> _demand{0};
+  uint16_t _fps = CAMERA_MAX_FPS;
+  FrameSize _size = FRAME_QVGA;
+
+  std::atomic<uint8_t> _clientCount{0};
+  std::atomic<uint32_t> _framesSent{0};
+  std::atomic<uint32_t> _framesSkipped{0};
+  std::atomic<uint32_t> _bytesSent{0};
+};
+
+#endif // MJPEG_STREAM_H
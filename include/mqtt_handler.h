@@ -12,19 +12,22 @@
 
 // Внешние переменные
 extern PubSubClient mqttClient;
-extern WiFiClient espClient;
 extern bool mqttConnected;
 extern bool bootTimePublished;
 
-// Прототип функции кормления (определена в feeder.cpp)
-extern void feed(int amount);
-
 // Функции
 void mqttSetup();
 void mqttConnect();
 void mqttLoop();
+void mqttReconfigure();
 void publishBootTime();
-void publishLastFeeding(int amount, const char* source);
+void publishLastFeeding(uint8_t auger, int amount, const char* source, int clip);
+void publishFeedRecovery();
+void publishPetPresence(bool present);
+void publishEatingDuration(uint32_t seconds);
 void publishHomeAssistantDiscovery();
+void publishMetrics();
+void publishTelemetry();
+bool publishShadowReported();
 
 #endif // MQTT_HANDLER_H
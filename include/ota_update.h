@@ -0,0 +1,55 @@
+/*
+  ota_update.h - Обновление прошивки через HTTP с докачкой и откатом
+
+  Образ (gzip или несжатый .bin) приходит кусками POST /api/ota?offset=&size=
+  и сразу, без буфера на весь файл, распаковывается в неактивный раздел.
+  Оборванную передачу можно продолжить со смещения, которое вернул сервер,
+  пока устройство не перезагрузилось.
+
+  Новая прошивка загружается непроверенной: отметка в NVS (пространство "ota")
+  хранит прошлый раздел и число попыток загрузки. Если за OTA_VALIDATE_TIMEOUT
+  не прошли самопроверки (см. ota_validate.h) или прошивка перезагрузилась
+  больше OTA_MAX_BOOT_ATTEMPTS раз, загрузчик переключается на прошлый раздел.
+*/
+
+#ifndef OTA_UPDATE_H
+#define OTA_UPDATE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+enum OtaState : uint8_t {
+  OTA_IDLE,
+  OTA_RECEIVING,   // Сессия открыта, ждём следующий кусок
+  OTA_REBOOTING,   // Образ записан, перезагрузка через OTA_REBOOT_DELAY
+  OTA_FAILED
+};
+
+struct OtaStatus {
+  OtaState state;
+  uint32_t received;    // Принято байт образа (как передан: сжатым)
+  uint32_t total;       // Объявленный размер образа
+  uint32_t written;     // Записано во flash (после распаковки)
+  bool compressed;
+  bool validating;      // Текущая прошивка ещё не подтверждена
+  const char* error;    // Последняя ошибка (nullptr - нет)
+};
+
+// Счётчик загрузок и откат непроверенной прошивки (вызывать в начале setup)
+void otaUpdateSetup();
+
+// Самопроверки новой прошивки, таймаут сессии, отложенная перезагрузка
+void otaUpdateLoop();
+
+// Отметка "новая прошивка не проверена" (после записи раздела, в т.ч. ArduinoOTA)
+void otaMarkPending();
+
+// Кусок образа: начало (offset == 0 - новая сессия), данные, конец.
+// false - кусок отклонён (смещение не совпало или ошибка, см. otaUpdateStatus)
+bool otaChunkBegin(uint32_t offset, uint32_t size);
+bool otaChunkWrite(const uint8_t* data, size_t len);
+bool otaChunkEnd();
+
+OtaStatus otaUpdateStatus();
+
+#endif // OTA_UPDATE_H
@@ -0,0 +1,39 @@
+/*
+  ota_validate.h - Решение о подтверждении новой прошивки
+
+  Чистая логика без Arduino: после загрузки непроверенной прошивки
+  самопроверки (WiFi, MQTT, расписание) должны пройти за отведённое время,
+  иначе - откат. Зависание или перезагрузка до подтверждения считаются
+  неудачной попыткой; после исчерпания попыток - тоже откат.
+*/
+
+#ifndef OTA_VALIDATE_H
+#define OTA_VALIDATE_H
+
+#include <stdint.h>
+
+// Результаты самопроверок
+struct OtaSelfTest {
+  bool wifi;      // Линк WiFi поднят
+  bool mqtt;      // Есть соединение с брокером
+  bool schedule;  // Время синхронизировано - расписание может сработать
+};
+
+enum OtaVerdict : uint8_t {
+  OTA_VERDICT_WAIT,      // Проверки ещё идут
+  OTA_VERDICT_VALID,     // Прошивка подтверждена
+  OTA_VERDICT_ROLLBACK   // Откат на прошлый раздел
+};
+
+// Вердикт по самопроверкам через elapsedMs после старта
+inline OtaVerdict otaValidate(const OtaSelfTest& t, uint32_t elapsedMs, uint32_t timeoutMs) {
+  if (t.wifi && t.mqtt && t.schedule) return OTA_VERDICT_VALID;
+  return elapsedMs >= timeoutMs ? OTA_VERDICT_ROLLBACK : OTA_VERDICT_WAIT;
+}
+
+// Исчерпаны ли попытки загрузки (boots - номер текущей загрузки с единицы)
+inline bool otaBootsExhausted(uint8_t boots, uint8_t maxBoots) {
+  return boots > maxBoots;
+}
+
+#endif // OTA_VALIDATE_H
@@ -0,0 +1,70 @@
+/*
+  power_manager.h - Экономный режим между событиями
+
+  Работа у кормушки бывает несколько раз в день, остальное время loop()
+  только опрашивает сеть. Режимы:
+    - активный: POWER_ACTIVE_CPU_MHZ, WiFi без энергосбережения, пауза
+      loop() POWER_ACTIVE_LOOP_MS. Пока крутится шнек, смотрят MJPEG
+      поток, идёт OTA, и ещё POWER_IDLE_DELAY после последнего события
+      (кнопка, HTTP запрос, команда MQTT или UDP);
+    - простой: POWER_IDLE_CPU_MHZ, WiFi modem sleep (WIFI_PS_MAX_MODEM:
+      радио просыпается к маякам точки доступа, соединение сохраняется),
+      пауза loop() POWER_IDLE_LOOP_MS.
+
+  Паузу loop() прерывают powerWake() (команда UDP из задачи приёма) и
+  фронт кнопки (powerWakeFromIsr), так что они обрабатываются сразу.
+  Расписание проверяется раз в секунду в любом режиме; кормление по нему
+  переводит в активный.
+
+  Автоматический light sleep (POWER_LIGHT_SLEEP) нужен сборке с
+  CONFIG_PM_ENABLE: тогда частоту меняет esp_pm по блокировкам, а в
+  простое ядро засыпает, когда задачам нечего делать; будят его таймеры
+  и маяки WiFi. Пока сенсор камеры снимает, камера держит блокировку
+  сна (POWER_IDLE_CAMERA_FPS 0 - в простое сенсор в standby и сну не
+  мешает). Во сне кнопка прерываний не даёт - нажатие заметит опрос
+  уровня в loop() (раз в POWER_IDLE_LOOP_MS). Готовые библиотеки
+  arduino-esp32 собраны без CONFIG_PM_ENABLE, там остаются частота и
+  modem sleep. Оценка суточной нагрузки - tools/power_sim.py.
+*/
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+enum PowerMode : uint8_t {
+  POWER_ACTIVE,
+  POWER_IDLE
+};
+
+struct PowerStats {
+  PowerMode mode;
+  uint32_t transitions;        // Смен режима
+  uint32_t activeSec;          // Времени в активном режиме с загрузки
+  uint32_t idleSec;
+  uint32_t wakeups;            // Пробуждений loop()
+  bool lightSleep;             // Автоматический light sleep включён
+};
+
+// Режим питания (после wifiSetup; вызывать из loop-задачи - её будит powerWake)
+void powerSetup();
+
+// Выбор режима по занятости модулей (в loop)
+void powerLoop();
+
+// Событие, после которого нужна быстрая реакция: активный режим ещё
+// на POWER_IDLE_DELAY
+void powerActivity();
+
+// Пауза loop(): по режиму или до powerWake()
+void powerIdle();
+
+// Разбудить loop() из другой задачи или из прерывания (кнопка)
+void powerWake();
+void IRAM_ATTR powerWakeFromIsr();
+
+PowerMode powerMode();
+const PowerStats& powerGetStats();
+
+#endif // POWER_MANAGER_H
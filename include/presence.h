@@ -0,0 +1,34 @@
+/*
+  presence.h - Кот у миски: детектор на кадрах камеры и сенсоры Home Assistant
+
+  Задача на ядре 0 берёт кадры фонового захвата (PRESENCE_FPS), уменьшает
+  JPEG при декодировании до PRESENCE_W x PRESENCE_H в оттенках серого и
+  отдаёт их детектору (presence_detect.h). Паузы между кадрами растягиваются
+  так, чтобы декодирование и детектор занимали не больше
+  PRESENCE_CPU_PERCENT времени ядра.
+
+  В MQTT публикуются "кот у миски" (binary_sensor) и время еды после
+  кормления: сколько кот провёл у миски за PRESENCE_EAT_WINDOW_MS после
+  последнего кормления.
+*/
+
+// PRESENCE_H занято высотой кадра в config.h
+#ifndef PRESENCE_MODULE_H
+#define PRESENCE_MODULE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Детектор и его задача (после cameraSetup)
+void presenceSetup();
+
+// Учёт времени еды и публикация в MQTT (в loop)
+void presenceLoop();
+
+// Начало окна учёта еды (из feed())
+void presenceOnFeed();
+
+// Кот у миски
+bool presenceDetected();
+
+#endif // PRESENCE_MODULE_H
@@ -0,0 +1,71 @@
+/*
+  presence_detect.h - Детектор кота у миски по уменьшенным серым кадрам
+
+  Кадр (PRESENCE_W x PRESENCE_H, по байту на пиксель) сравнивается с фоном
+  блоками 8x8: сумма модулей разностей (SAD) на блок. Блок "активен", если
+  средняя разность на пиксель больше PRESENCE_PIXEL_DIFF. Кот есть, если
+  активных блоков не меньше PRESENCE_MIN_BLOCKS PRESENCE_ON_FRAMES кадров
+  подряд, и пропал, если кадр совпадает с фоном PRESENCE_OFF_MS. Фон
+  медленно подтягивается к кадрам без отличий; резкая смена почти всего кадра
+  (свет, экспозиция) и слишком долгое "присутствие" (сдвинули миску)
+  переучивают фон целиком.
+
+  Ядра обрабатывают по четыре пикселя за операцию в 32-битном слове
+  (две 16-битные полосы, без переносов между ними) - на ESP32 нет SIMD,
+  а так работают обычные 32-битные инструкции. Для каждого ядра есть
+  скалярная эталонная версия (...Ref) с тем же результатом.
+  Модуль не зависит от Arduino.
+*/
+
+#ifndef PRESENCE_DETECT_H
+#define PRESENCE_DETECT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+#define PRESENCE_BLOCK 8  // Сторона блока (пикселей)
+
+// SAD блоков 8x8 кадра cur относительно фона bg (w кратно 8 и не больше
+// PRESENCE_W; неполная нижняя полоса блоков не считается).
+// sad - (w / 8) * (h / 8) значений
+void presenceSadRef(const uint8_t* cur, const uint8_t* bg, uint16_t w, uint16_t h, uint16_t* sad);
+void presenceSad(const uint8_t* cur, const uint8_t* bg, uint16_t w, uint16_t h, uint16_t* sad);
+
+// Подтягивание фона к кадру: bg += round((cur - bg) / 2^shift), shift 1..7,
+// n кратно 4
+void presenceBlendRef(uint8_t* bg, const uint8_t* cur, size_t n, uint8_t shift);
+void presenceBlend(uint8_t* bg, const uint8_t* cur, size_t n, uint8_t shift);
+
+class PresenceDetector {
+public:
+  // Фон и таблица блоков под кадр w x h
+  bool begin(uint16_t w, uint16_t h);
+
+  // Очередной кадр; возвращает устойчивое состояние (кот у миски)
+  bool update(const uint8_t* gray, uint32_t nowMs);
+
+  bool present() const { return _present; }
+  uint16_t activeBlocks() const { return _active; }
+  uint16_t blocks() const { return _blocks; }
+  uint32_t relearns() const { return _relearns; }
+
+private:
+  void relearn(const uint8_t* gray);
+
+  uint16_t _w = 0;
+  uint16_t _h = 0;
+  uint16_t _blocks = 0;
+  uint8_t* _bg = nullptr;
+  uint16_t* _sad = nullptr;
+  bool _hasBg = false;
+
+  bool _present = false;
+  uint16_t _active = 0;
+  uint8_t _hits = 0;          // Кадров с отличием от фона подряд
+  uint32_t _lastForegroundMs = 0;
+  uint32_t _presentSinceMs = 0;
+  uint32_t _relearns = 0;
+};
+
+#endif // PRESENCE_DETECT_H
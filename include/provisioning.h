@@ -0,0 +1,84 @@
+/*
+  provisioning.h - Настройки устройства из JSON документа без перепрошивки
+
+  Сетевые параметры (WiFi, MQTT) и часовой пояс хранятся в NVS
+  (пространство "prov"); значения из .env - только умолчания для чистой
+  NVS. Документ вида data/config.json применяется:
+    - из /config.json в хранилище после монтирования, если файл изменился
+      с прошлого применения (иначе более поздние HTTP/MQTT изменения
+      перетирались бы при каждой загрузке);
+    - из POST /api/config;
+    - из MQTT: <id>/config/set (одна кормушка) и MQTT_TOPIC_CONFIG_FLEET
+      (все кормушки брокера); результат - в <id>/config/result.
+
+  Документ разбирается потоком (json_stream.h) в черновик; если разбор
+  или проверка не прошли, не меняется ничего. Отсутствующие ключи
+  оставляют текущие значения. Изменения применяются на ходу: порции и
+  расписания сразу, пояс сразу, WiFi и MQTT переподключаются на
+  следующем проходе loop (чтобы успел уйти ответ).
+
+  Новые WiFi и MQTT параметры пробные: в NVS они попадают, только когда
+  связь с ними поднялась за PROV_TRIAL_TIMEOUT, иначе возвращаются
+  последние рабочие (ошибка в пароле не отрезает кормушку от сети).
+  Сетевые ключи (wifi_*, mqtt_*) принимаются не из любого источника:
+  общий топик кормушек и HTTP без пароля WEB_ADMIN_PASSWORD могут
+  менять только пояс, порции и расписания.
+
+  Ключи: wifi_ssid, wifi_password, mqtt_server, mqtt_port, mqtt_user,
+  mqtt_password, time_zone, feedAmount (число - шнек 1, массив - по
+  шнекам), schedules ([{hour, minute, amount, auger, enabled}], массив
+  заменяет список: остальные расписания выключаются).
+*/
+
+#ifndef PROVISIONING_H
+#define PROVISIONING_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Что изменил документ
+enum ProvisionChange : uint8_t {
+  PROV_WIFI = 1,
+  PROV_MQTT = 2,
+  PROV_FEED = 4,     // Порции и расписания
+  PROV_TIME = 8
+};
+
+// Что разрешено менять источнику документа
+#define PROV_ALLOW_ALL (PROV_WIFI | PROV_MQTT | PROV_FEED | PROV_TIME)
+#define PROV_ALLOW_LOCAL (PROV_FEED | PROV_TIME)   // Без сети и учётных данных
+
+struct ProvisionResult {
+  bool ok;
+  uint8_t changed;       // Биты ProvisionChange
+  const char* error;     // При ok == false
+};
+
+// Значения из NVS (до wifiSetup, mqttSetup и timeServiceSetup)
+void provisioningSetup();
+
+// /config.json после монтирования, отложенные переподключения (в loop)
+void provisioningLoop();
+
+// Приём документа кусками (source - для журнала, строковый литерал;
+// allowed - биты ProvisionChange, ключи остальных групп - ошибка)
+void provisionBegin(const char* source, uint8_t allowed);
+bool provisionFeed(const char* data, size_t len);
+ProvisionResult provisionEnd();
+
+// Итог для ответа: {"ok":true,"changed":{...}} или {"ok":false,"error":"..."}
+size_t provisionResultJson(const ProvisionResult& r, char* buf, size_t size);
+
+// Текущие настройки в JSON (пароли не выводятся)
+void provisionWriteJson(Print& out);
+
+// Действующие значения
+const char* provWifiSsid();
+const char* provWifiPassword();
+const char* provMqttServer();
+uint16_t provMqttPort();
+const char* provMqttUser();
+const char* provMqttPassword();
+const char* provTimeZone();
+
+#endif // PROVISIONING_H
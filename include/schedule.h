@@ -14,6 +14,7 @@ struct Schedule {
   uint8_t hour;
   uint8_t minute;
   int amount;
+  uint8_t auger;  // Номер шнека (с нуля)
   bool enabled;
   bool fed;  // Флаг, что уже покормили в это время
 };
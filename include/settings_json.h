@@ -0,0 +1,33 @@
+/*
+  settings_json.h - Общие проверки полей настроек в JSON документах
+
+  Документ настроек (provisioning.h) и дельта тени (shadow.h) разбираются
+  каждый своим обработчиком json_stream.h, но порции и поля расписаний
+  проверяются одинаково: диапазоны и PROV_MAX_AMOUNT заданы только здесь.
+  Ошибка - строка "ключ: что не так" в буфере черновика; первая
+  записанная не перетирается последующими.
+*/
+
+#ifndef SETTINGS_JSON_H
+#define SETTINGS_JSON_H
+
+#include "json_stream.h"
+#include "schedule.h"
+
+#define SETTINGS_ERROR_LEN 64
+
+// Ошибка разбора в error (SETTINGS_ERROR_LEN байт), если её ещё нет
+void settingsError(char* error, const char* key, const char* what);
+
+// Целое в [min, max]; false - ошибка записана
+bool settingsInt(char* error, long& v, const char* key, JsonType type, const char* text,
+                 long min, long max);
+
+// Порция шнека (1..PROV_MAX_AMOUNT оборотов); false - ошибка записана
+bool settingsAmount(char* error, int& amount, const char* key, JsonType type, const char* text);
+
+// Поле расписания: hour, minute, amount, auger (с единицы), enabled.
+// false - поле неизвестно (ошибка не записывается, решает вызывающий)
+bool settingsScheduleField(char* error, Schedule& s, const char* key, JsonType type, const char* text);
+
+#endif // SETTINGS_JSON_H
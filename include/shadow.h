@@ -0,0 +1,59 @@
+/*
+  shadow.h - Тень устройства: сообщаемое и желаемое состояние
+
+  Сообщаемое (reported) - retained документ в <id>/shadow/reported и
+  GET /api/shadow: версия, порции и расписания (state), связь (link),
+  статистика (stats). Публикуется при подключении к брокеру, при
+  изменении настроек и раз в SHADOW_REPORT_INTERVAL.
+
+  Желаемое (desired) - дельта в <id>/shadow/desired или POST /api/shadow:
+    {"version":12,"state":{"feedAmount":[20,null],
+                           "schedules":[null,{"enabled":false},{"hour":8}]}}
+  Меняются только указанные поля; null и пропущенные элементы массивов
+  оставляют значение как есть. feedAmount - число (шнек 1) или массив по
+  шнекам; schedules - массив по номерам расписаний, поля как в
+  provisioning.h. Итог - в <id>/shadow/result.
+
+  Версия растёт при каждом изменении порций и расписаний - дельтой,
+  через HTTP, кнопкой или документом настроек - и хранится в NVS.
+  Дельта обязана нести версию, на которой она основана: если с тех пор
+  настройки менялись, дельта отклоняется как устаревшая (кроме случая,
+  когда она уже ничего не меняет). Так повторно доставленное или
+  опоздавшее сообщение не откатит более свежие изменения.
+*/
+
+#ifndef SHADOW_H
+#define SHADOW_H
+
+#include <Arduino.h>
+#include "config.h"
+
+struct ShadowResult {
+  bool ok;
+  bool stale;            // Отклонена: версия устарела
+  uint8_t changed;       // Изменённых полей
+  uint32_t version;      // Версия после применения (или текущая)
+  const char* error;     // При ok == false
+};
+
+// Версия из NVS (после scheduleSetup)
+void shadowSetup();
+
+// Отслеживание локальных изменений и публикация reported (в loop)
+void shadowLoop();
+
+// Опубликовать reported при ближайшей возможности (подключение к брокеру)
+void shadowRequestReport();
+
+// Применение desired (source - для журнала, строковый литерал)
+ShadowResult shadowApplyDesired(const char* data, size_t len, const char* source);
+
+// {"ok":true,"version":13,"changed":2} или {"ok":false,"version":12,"error":"..."}
+size_t shadowResultJson(const ShadowResult& r, char* buf, size_t size);
+
+// Документ reported; 0 - не поместился в size
+size_t shadowReportedJson(char* buf, size_t size);
+
+uint32_t shadowVersion();
+
+#endif // SHADOW_H
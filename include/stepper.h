@@ -0,0 +1,80 @@
+/*
+  stepper.h - Шаговые моторы шнеков и общий планировщик шагов
+
+  Stepper - один униполярный мотор на 4 пинах с профилем шагов (оборот
+  шнека: шаги назад против заклинивания, затем вперёд). Все моторы шагает
+  один однократный таймер esp_timer: колбэк делает шаги, время которых
+  подошло, и взводит таймер на ближайший следующий. Фазы моторов сдвинуты
+  на долю интервала, поэтому несколько шнеков крутятся одновременно,
+  не суммируя задержки и не переключая обмотки в один момент.
+*/
+
+#ifndef STEPPER_H
+#define STEPPER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Профиль шагов
+struct StepProfile {
+  uint16_t stepsBackward;   // Шагов назад в начале оборота
+  uint16_t stepsForward;    // Шагов вперёд
+  uint32_t stepIntervalUs;  // Интервал между шагами (мкс)
+};
+
+enum StepperMode : uint8_t {
+  STEPPER_IDLE,
+  STEPPER_RUN,         // Заданное число оборотов
+  STEPPER_CONTINUOUS   // До requestStop(STEPPER_CONTINUOUS) (обороты считаются)
+};
+
+// Снимок состояния мотора
+struct StepperStatus {
+  StepperMode mode;
+  StepperMode finishedMode;  // Режим последнего завершённого прогона
+  int revs;
+  int target;
+};
+
+class Stepper {
+public:
+  // Настройка пинов и регистрация в планировщике
+  void begin(const uint8_t* pins, const StepProfile& profile);
+
+  // Запуск прогона (false - мотор занят или завершение прошлого прогона
+  // ещё не забрано через clearFinished)
+  bool start(StepperMode mode, int target);
+
+  // Остановка прогона в режиме mode на ближайшей границе оборота
+  // (прогон в другом режиме не трогается)
+  void requestStop(StepperMode mode);
+
+  StepperStatus status();
+
+  // Сброс отметки о завершённом прогоне
+  void clearFinished();
+
+  // Шаг, если подошло время; возвращает время следующего шага
+  // (0 - мотор стоит). Вызывается только планировщиком
+  int64_t service(int64_t nowUs);
+
+private:
+  void writePhase(int8_t dir);
+  void release();
+
+  const uint8_t* _pins = nullptr;
+  StepProfile _profile = {0, 0, 0};
+  uint8_t _index = 0;
+  uint8_t _phase = 0;
+
+  // Меняется планировщиком и loop() под общей блокировкой планировщика
+  StepperMode _mode = STEPPER_IDLE;
+  StepperMode _finishedMode = STEPPER_IDLE;
+  bool _stopRequested = false;
+  uint16_t _revStep = 0;
+  int _revs = 0;
+  int _target = 0;
+  int64_t _due = 0;
+};
+
+#endif // STEPPER_H
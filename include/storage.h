@@ -0,0 +1,57 @@
+/*
+  storage.h - Файловое хранилище (веб-файлы, журнал, история)
+
+  Модули работают с файлами только через эти функции, поэтому файловая
+  система подменяется целиком: на устройстве - LittleFS (storage.cpp),
+  на хосте - обычный каталог (storage_native.cpp). Пути - от корня
+  хранилища ("/index.html").
+
+  Монтирование идёт в фоновой задаче и не задерживает загрузку: пока
+  storageReady() возвращает false, чтение и запись завершаются ошибкой.
+  При повреждённом разделе он форматируется там же, в фоне.
+*/
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ARDUINO
+  #include <FS.h>
+#endif
+
+// Запуск монтирования (на устройстве - в фоне)
+void storageSetup();
+
+// Хранилище смонтировано
+bool storageReady();
+
+bool storageExists(const char* path);
+
+// Размер файла (-1 - файла нет)
+long storageFileSize(const char* path);
+
+// Чтение до size байт с позиции offset; возвращает прочитанное
+size_t storageRead(const char* path, size_t offset, void* buf, size_t size);
+
+// Запись файла целиком (с заменой) и дозапись в конец
+bool storageWrite(const char* path, const void* data, size_t len);
+bool storageAppend(const char* path, const void* data, size_t len);
+
+bool storageRename(const char* from, const char* to);
+bool storageRemove(const char* path);
+
+// Занято и всего байт
+size_t storageUsedBytes();
+size_t storageTotalBytes();
+
+#ifdef ARDUINO
+// Файловая система для потоковой отдачи (WebServer::streamFile)
+fs::FS& storageFs();
+#else
+// Корневой каталог хранилища на хосте (вызывать до storageSetup)
+void storageSetRoot(const char* dir);
+#endif
+
+#endif // STORAGE_H
@@ -0,0 +1,73 @@
+/*
+  telemetry.h - Схема и кодирование событий и телеметрии в CBOR
+
+  Каждое сообщение - карта CBOR с целыми ключами TelemetryKey; ключ
+  TLM_KEY_TYPE задаёт вид сообщения (TelemetryType) и набор остальных
+  ключей. Время - тег 1 (секунды эпохи), только если часы выставлены.
+  Отсутствующий ключ - значения нет (например, ролик не пишется).
+
+  Это же перечисление читает декодер tools/telemetry_decode.py, поэтому
+  номера здесь - единственное место схемы: новые ключи только добавляются
+  в конец, старые номера не переиспользуются.
+
+  Топики (MQTT_CBOR_ENABLED): события - MQTT_TOPIC_EVENTS, метрики -
+  MQTT_TOPIC_TELEMETRY. Топики состояния Home Assistant остаются в JSON.
+  Модуль не зависит от Arduino.
+*/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// Вид сообщения (значение TLM_KEY_TYPE)
+enum TelemetryType {
+  TLM_FEEDING = 1,             // Кормление: amount, auger, source, clip
+  TLM_PRESENCE = 2,            // Кот у миски: present
+  TLM_EATING = 3,              // Время у миски после кормления: seconds
+  TLM_METRICS = 4              // Память, WiFi, аптайм
+};
+
+// Ключи карты
+enum TelemetryKey {
+  TLM_KEY_TYPE = 0,
+  TLM_KEY_TIME = 1,            // Тег 1 + секунды эпохи
+  TLM_KEY_UPTIME = 2,          // Секунды с загрузки
+  TLM_KEY_AMOUNT = 3,          // Оборотов
+  TLM_KEY_AUGER = 4,           // Номер шнека (с единицы)
+  TLM_KEY_SOURCE = 5,          // Строка: schedule, button, web, mqtt, udp, resume
+  TLM_KEY_CLIP = 6,            // Номер ролика (/api/clip?id=N)
+  TLM_KEY_PRESENT = 7,         // true / false
+  TLM_KEY_SECONDS = 8,
+  TLM_KEY_HEAP_FREE = 9,
+  TLM_KEY_HEAP_MIN = 10,
+  TLM_KEY_HEAP_LARGEST = 11,
+  TLM_KEY_WIFI_OUTAGES = 12,
+  TLM_KEY_WIFI_RECONNECT_MS = 13,
+  TLM_KEY_RSSI = 14            // дБм (отрицательное)
+};
+
+// Наибольший размер сообщения (байт)
+#define TELEMETRY_MAX_LEN 96
+
+struct TelemetryMetrics {
+  uint32_t heapFree;
+  uint32_t heapMin;
+  uint32_t heapLargest;
+  uint32_t wifiOutages;
+  uint32_t wifiReconnectMs;
+  int8_t rssi;
+};
+
+// Кодирование в buf; возвращают длину (0 - не поместилось).
+// epoch == 0 - время неизвестно, ключ TLM_KEY_TIME не пишется
+size_t telemetryFeeding(uint8_t* buf, size_t size, time_t epoch, uint32_t uptime,
+                        uint8_t auger, int amount, const char* source, int clip);
+size_t telemetryPresence(uint8_t* buf, size_t size, time_t epoch, uint32_t uptime, bool present);
+size_t telemetryEating(uint8_t* buf, size_t size, time_t epoch, uint32_t uptime, uint32_t seconds);
+size_t telemetryMetrics(uint8_t* buf, size_t size, time_t epoch, uint32_t uptime,
+                        const TelemetryMetrics& m);
+
+#endif // TELEMETRY_H
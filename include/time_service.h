@@ -0,0 +1,58 @@
+/*
+  time_service.h - Местное время: часовой пояс, кэш, синхронизация NTP
+
+  Часовой пояс задаётся POSIX строкой TIME_ZONE (с правилами перехода на
+  летнее время), смещение в ISO строках берётся из неё же. Разложенное
+  местное время кэшируется: секунды идут от монотонного таймера, а
+  localtime_r с правилами пояса пересчитывается раз в минуту (переходы
+  на летнее время бывают только на границе минуты).
+
+  При каждой синхронизации SNTP запоминается, насколько время по
+  монотонному таймеру разошлось с NTP (дрейф кварца), и возраст
+  синхронизации. Последнее известное время хранится в RTC памяти: после
+  программного сброса (паника, watchdog, OTA) время восстанавливается
+  до ответа NTP.
+
+  Кэш читается из loop (расписание, MQTT, веб).
+*/
+
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <Arduino.h>
+#include <time.h>
+#include "config.h"
+
+struct TimeStatus {
+  bool valid;           // Время известно (NTP или восстановлено)
+  bool synced;          // Была синхронизация NTP с загрузки
+  uint32_t syncs;       // Синхронизаций NTP
+  uint32_t syncAgeS;    // Секунд с последней синхронизации
+  int32_t driftMs;      // Расхождение таймера с NTP на последней синхронизации
+};
+
+// Часовой пояс, SNTP, восстановление из RTC памяти
+void timeServiceSetup();
+
+// Обновление кэша, сохранение в RTC память, метрики (в loop)
+void timeServiceLoop();
+
+// Смена часового пояса на ходу (строка POSIX TZ)
+void timeSetZone(const char* tz);
+
+bool timeValid();
+
+// Местное время из кэша; false - время неизвестно
+bool timeNow(struct tm& out);
+
+// Секунды эпохи (0 - время неизвестно)
+time_t timeEpoch();
+
+// Местное время в ISO 8601 со смещением пояса ("2025-12-16T14:30:00+03:00");
+// при неизвестном времени - начало эпохи UTC
+size_t timeIso(char* buf, size_t size);
+size_t timeIsoAt(time_t epoch, char* buf, size_t size);
+
+TimeStatus timeStatus();
+
+#endif // TIME_SERVICE_H
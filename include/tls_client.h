@@ -0,0 +1,81 @@
+/*
+  tls_client.h - TLS поверх lwip сокета с возобновлением сессий
+
+  Client для PubSubClient (MQTT_TLS). Полное TLS рукопожатие на ESP32
+  занимает секунды, поэтому после него сессия (идентификатор или билет
+  сервера) сериализуется в RTC память (tls_session.h), и следующее
+  подключение к тому же host:port - после обрыва WiFi или программного
+  сброса - предлагает её серверу. Если сервер её принял, рукопожатие
+  сокращённое: без сертификатов и обмена ключами.
+
+  Проверка сервера обязательна: корневой сертификат в PEM задаётся
+  setCaCert(), имя хоста сверяется с сертификатом.
+*/
+
+#ifndef TLS_CLIENT_H
+#define TLS_CLIENT_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/x509_crt.h>
+#include "config.h"
+
+// Статистика рукопожатий (для метрик и журнала)
+struct TlsStats {
+  uint32_t handshakes;        // Успешных рукопожатий
+  uint32_t resumed;           // Из них по сохранённой сессии
+  uint32_t failures;
+  uint32_t lastHandshakeMs;
+  bool lastResumed;
+  int lastError;              // Код mbedtls последней ошибки (0 - нет)
+};
+
+class TlsClient : public Client {
+public:
+  TlsClient();
+  ~TlsClient();
+
+  // Корневой сертификат брокера (PEM, строка с нулём); false - не разобран
+  bool setCaCert(const char* pem);
+  bool hasCaCert() const { return _caLoaded; }
+
+  // Сохранённая сессия больше не годится (сменился брокер)
+  static void forgetSession();
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char* host, uint16_t port) override;
+  size_t write(uint8_t b) override { return write(&b, 1); }
+  size_t write(const uint8_t* buf, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size) override;
+  int peek() override;
+  void flush() override {}
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+
+  const TlsStats& stats() const { return _stats; }
+
+private:
+  int connectTo(const char* host, uint32_t ip, uint16_t port);
+  bool handshake(const char* host, uint16_t port);
+  void saveSession(const char* host, uint16_t port);
+
+  mbedtls_ssl_context _ssl;
+  mbedtls_ssl_config _conf;
+  mbedtls_x509_crt _ca;
+  mbedtls_entropy_context _entropy;
+  mbedtls_ctr_drbg_context _drbg;
+  bool _configured = false;
+  int _sock = -1;
+  bool _caLoaded = false;
+  bool _connected = false;
+  int _peeked = -1;
+  TlsStats _stats = {};
+};
+
+#endif // TLS_CLIENT_H
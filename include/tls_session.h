@@ -0,0 +1,31 @@
+/*
+  tls_session.h - Сохранённая TLS сессия в RTC памяти
+
+  Последняя сессия (mbedtls_ssl_session_save) и host:port, для которых
+  она получена. RTC память переживает программный сброс, но после
+  включения питания в ней мусор: запись принимается только с магическим
+  числом, длиной не больше TLS_SESSION_MAX и верной контрольной суммой.
+  Без mbedtls, поэтому проверяется на хосте (tls_client.cpp там не
+  собирается).
+*/
+
+#ifndef TLS_SESSION_H
+#define TLS_SESSION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+// Сессия для host:port (nullptr - нет, от другого брокера или испорчена)
+const uint8_t* tlsSessionFind(const char* host, uint16_t port, size_t* len);
+
+// Буфер на TLS_SESSION_MAX байт для сериализации новой сессии. Прежняя
+// сессия при этом забывается; новая действительна после tlsSessionStore
+uint8_t* tlsSessionBuffer();
+
+// Запомнить len байт буфера для host:port; false - больше TLS_SESSION_MAX
+bool tlsSessionStore(const char* host, uint16_t port, size_t len);
+
+void tlsSessionForget();
+
+#endif // TLS_SESSION_H
@@ -0,0 +1,47 @@
+/*
+  trace.h - Трассировка блокирующих участков и сторож зависаний loop()
+
+  TRACE_SCOPE("name") отмечает участок кода: по выходу из области видимости
+  событие записывается в кольцевой буфер в RAM (короткие участки отбрасываются).
+  Сторожевая задача на ядре 0 следит за loop(): если итерация длится дольше
+  TRACE_STALL_MS, кольцо и стек открытых участков копируются в RTC память
+  (снимок переживает мягкую перезагрузку). Оба буфера выгружаются
+  в формате Chrome trace (chrome://tracing, Perfetto) через /api/trace.
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Запуск сторожевой задачи, проверка снимка с прошлой загрузки
+void traceSetup();
+
+// Отметка начала итерации loop() (для сторожа)
+void traceLoopTick();
+
+// Начало/конец участка (используйте TRACE_SCOPE)
+void traceBegin(const char* name);
+void traceEnd();
+
+// Есть ли сохранённый снимок зависания
+bool traceHasSnapshot();
+
+// Выгрузка в формате Chrome trace JSON (snapshot = снимок зависания)
+void traceWriteChromeJson(Print& out, bool snapshot);
+
+// RAII-обёртка для участка
+class TraceScope {
+public:
+  explicit TraceScope(const char* name) { traceBegin(name); }
+  ~TraceScope() { traceEnd(); }
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(_traceScope, __LINE__)(name)
+
+#endif // TRACE_H
@@ -0,0 +1,88 @@
+/*
+  udp_control.h - Команды кормления по UDP в локальной сети
+
+  Канал в обход MQTT брокера и однопоточного WebServer: одна датаграмма
+  запроса, одна датаграмма ответа. Сервис объявляется в mDNS как
+  _feeder._udp (TXT: id - идентификатор устройства, v - версия протокола).
+
+  Пакеты - little-endian, без выравнивания. Последние UDP_MAC_LEN байт -
+  HMAC-SHA256 (ключ UDP_CONTROL_KEY из .env), усечённый до 16 байт, от
+  всех предыдущих байт пакета. Пакеты с неверной подписью отбрасываются
+  без ответа.
+
+  Защита от повтора: counter команды кормления должен быть больше
+  последнего принятого (хранится в NVS). Запрос состояния counter не
+  расходует; в ответе есть последний принятый counter, с которого
+  клиент без своего состояния начинает нумерацию.
+
+  Приём и проверка подписи - в задаче на ядре 0; проверенная команда
+  будит loop() (powerWake), и тот сразу вызывает feed() и отвечает.
+  Клиент: tools/udp_feed.py.
+*/
+
+#ifndef UDP_CONTROL_H
+#define UDP_CONTROL_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#define UDP_MAGIC 0x46       // 'F'
+#define UDP_VERSION 1
+#define UDP_MAC_LEN 16
+
+enum UdpCommandType : uint8_t {
+  UDP_CMD_FEED = 1,
+  UDP_CMD_STATUS = 2,
+  UDP_REPLY_FLAG = 0x80      // Ответ: тип запроса | UDP_REPLY_FLAG
+};
+
+enum UdpResult : uint8_t {
+  UDP_OK = 0,
+  UDP_BUSY = 1,              // Шнек уже крутится
+  UDP_BAD_AUGER = 2,
+  UDP_REPLAY = 3,            // counter не больше последнего принятого
+  UDP_BAD_REQUEST = 4        // Неизвестная команда
+};
+
+struct __attribute__((packed)) UdpRequest {
+  uint8_t magic;
+  uint8_t version;
+  uint8_t cmd;
+  uint8_t auger;             // С единицы (0 - шнек 1)
+  uint16_t amount;           // Оборотов (0 - базовая порция)
+  uint16_t reserved;
+  uint32_t counter;
+  uint8_t mac[UDP_MAC_LEN];
+};
+
+struct __attribute__((packed)) UdpReply {
+  uint8_t magic;
+  uint8_t version;
+  uint8_t cmd;
+  uint8_t result;            // UdpResult
+  uint32_t counter;          // counter запроса (ответ на этот запрос)
+  uint32_t lastCounter;      // Последний принятый counter кормления
+  uint32_t uptime;           // Секунд с загрузки
+  uint32_t epoch;            // Время устройства (0 - неизвестно)
+  uint8_t busyMask;          // Бит на шнек: крутится
+  uint8_t petPresent;
+  uint16_t reserved;
+  uint8_t mac[UDP_MAC_LEN];
+};
+
+static_assert(sizeof(UdpRequest) == 28, "UdpRequest layout is part of the protocol");
+static_assert(sizeof(UdpReply) == 40, "UdpReply layout is part of the protocol");
+
+// Сокет, задача приёма, объявление в mDNS (после запуска ArduinoOTA)
+void udpControlSetup();
+
+// Выполнение проверенных команд и ответы (в loop)
+void udpControlLoop();
+
+#ifndef ARDUINO
+// На хосте задачи не запускаются: приём одной датаграммы без ожидания
+// вместо задачи; false - датаграмм нет
+bool udpControlPoll();
+#endif
+
+#endif // UDP_CONTROL_H
@@ -7,7 +7,6 @@
 
 #include <Arduino.h>
 #include <WebServer.h>
-#include <SPIFFS.h>
 #include "config.h"
 
 // Глобальный объект веб-сервера
@@ -28,5 +27,21 @@ void handleFeed();
 void handleToggle();
 void handleSetBase();
 void handleCapture();
+void handleStream();
+void handleClip();
+void handleClips();
+void handleMetrics();
+void handleTrace();
+void handleLog();
+void handleGetConfig();
+void handleConfigUpload();
+void handleConfigDone();
+void handleGetShadow();
+void handleSaveShadow();
+void handleJournal();
+void handleOtaUpload();
+void handleOtaDone();
+void handleOtaStatus();
+void handleNotFound();
 
 #endif
@@ -0,0 +1,51 @@
+/*
+  wifi_manager.h - Управление WiFi подключением
+
+  Состояние линка отслеживается по событиям WiFi.onEvent, переподключение
+  выполняется с экспоненциальной задержкой. BSSID и канал последнего
+  успешного подключения кэшируются в RTC памяти: каждое переподключение -
+  после обрыва связи и после мягкой перезагрузки - идёт без сканирования.
+  Адрес всегда выдаёт DHCP.
+*/
+
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "config.h"
+
+// Состояние линка
+enum WifiLinkState {
+  LINK_DOWN,        // Нет подключения, ждём следующей попытки
+  LINK_CONNECTING,  // Идёт попытка подключения
+  LINK_UP           // Подключены и получили IP
+};
+
+// Статистика линка (для метрик)
+struct WifiStats {
+  uint32_t outages;            // Количество потерь связи
+  uint32_t connectAttempts;    // Всего попыток подключения
+  uint32_t fastConnects;       // Успешных подключений по кэшу из RTC
+  uint32_t lastReconnectMs;    // Длительность последнего восстановления связи
+  uint32_t totalDowntimeMs;    // Суммарное время без связи
+  uint8_t lastDisconnectReason;
+};
+
+// Запуск подключения (не блокирует)
+void wifiSetup();
+
+// Обработка событий и переподключение (вызывать в loop)
+void wifiLoop();
+
+// Переподключение с новыми SSID и паролем (provisioning.h)
+void wifiReconnect();
+
+// Состояние линка
+WifiLinkState wifiLinkState();
+bool wifiLinkUp();
+
+// Статистика
+const WifiStats& wifiGetStats();
+
+#endif // WIFI_MANAGER_H
@@ -40,7 +40,6 @@ if not env_vars:
         'MQTT_PORT': '1883',
         'MQTT_USER': '',
         'MQTT_PASSWORD': '',
-        'MQTT_CLIENT_ID': 'ESP32-Feeder',
         'OTA_HOSTNAME': 'ESP32-Feeder',
         'OTA_PASSWORD': '',
         'ESP_IP': '192.168.1.1'
@@ -54,11 +53,20 @@ build_flags = [
     f'-DMQTT_PORT={env_vars.get("MQTT_PORT", "1883")}',
     f'-DMQTT_USER=\\"{env_vars.get("MQTT_USER", "")}\\"',
     f'-DMQTT_PASSWORD=\\"{env_vars.get("MQTT_PASSWORD", "")}\\"',
-    f'-DMQTT_CLIENT_ID=\\"{env_vars.get("MQTT_CLIENT_ID", "ESP32-Feeder")}\\"',
     f'-DOTA_HOSTNAME=\\"{env_vars.get("OTA_HOSTNAME", "ESP32-Feeder")}\\"',
     f'-DOTA_PASSWORD=\\"{env_vars.get("OTA_PASSWORD", "")}\\"',
+    f'-DUDP_CONTROL_KEY=\\"{env_vars.get("UDP_CONTROL_KEY", "")}\\"',
+    f'-DWEB_ADMIN_PASSWORD=\\"{env_vars.get("WEB_ADMIN_PASSWORD", "")}\\"',
 ]
 
+# MQTT через TLS - необязательно (корневой сертификат - data/mqtt_ca.pem)
+if env_vars.get("MQTT_TLS"):
+    build_flags.append(f'-DMQTT_TLS={env_vars["MQTT_TLS"]}')
+
+# Имя устройства - необязательно (без него идентификатор строится из MAC)
+if env_vars.get("DEVICE_NAME"):
+    build_flags.append(f'-DDEVICE_NAME=\\"{env_vars["DEVICE_NAME"]}\\"')
+
 # Добавляем флаги
 for flag in build_flags:
     env.Append(BUILD_FLAGS=[flag])
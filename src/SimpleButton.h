@@ -1,55 +1,148 @@
 // Простая библиотека для работы с кнопкой (в стиле EncButton от AlexGyver)
+//
+// Фронты ловятся прерыванием GPIO и складываются в кольцо с метками времени,
+// tick() в loop() разбирает их с антидребезгом и кладёт жесты в очередь:
+// клик, двойной клик, начало удержания, отпускание после удержания.
+// Опрос пина в tick() нужен только для восстановления после потерянного фронта.
 #pragma once
 #include <Arduino.h>
 
+enum ButtonGesture : uint8_t {
+  BTN_NONE,
+  BTN_CLICK,          // Одиночный клик (после окна двойного клика)
+  BTN_DOUBLE_CLICK,   // Два клика подряд
+  BTN_HOLD_START,     // Кнопка удерживается дольше порога
+  BTN_HOLD_RELEASE    // Отпущена после удержания
+};
+
 class SimpleButton {
 public:
-  SimpleButton(uint8_t pin) : _pin(pin) {
+  SimpleButton(uint8_t pin) : _pin(pin) {}
+
+  // Настройка пина и прерывания (вызывать в setup)
+  void begin() {
     pinMode(_pin, INPUT_PULLUP);
+    _stable = readPin();
+    _lastEdge = millis();
+    attachInterruptArg(digitalPinToInterrupt(_pin), isr, this, CHANGE);
   }
-  
+
   void tick() {
-    bool currentState = (digitalRead(_pin) == LOW);
-    
-    // Определяем события
-    _clicked = false;
-    _held = false;
-    
-    if (currentState && !_lastState) {
-      // Кнопка только что нажата
-      _pressTime = millis();
-      _holding = false;
+    uint32_t now = millis();
+
+    // Фронты из прерывания
+    while (_edgeTail != _edgeHead) {
+      Edge e = _edges[_edgeTail];
+      _edgeTail = (_edgeTail + 1) % EDGE_SLOTS;
+      onEdge(e.pressed, e.time);
+    }
+
+    // Потерянный фронт (короче антидребезга или переполнение кольца)
+    bool level = readPin();
+    if (level != _stable && now - _lastEdge >= _debounceTime) {
+      onEdge(level, now);
     }
-    
-    if (currentState && !_holding && (millis() - _pressTime > _holdTime)) {
-      // Удержание
+
+    // Удержание
+    if (_stable && !_holding && now - _pressTime >= _holdTime) {
       _holding = true;
-      _held = true;
+      _clicks = 0;
+      push(BTN_HOLD_START);
     }
-    
-    if (!currentState && _lastState && !_holding) {
-      // Кнопка отпущена после короткого нажатия
-      _clicked = true;
+
+    // Одиночный клик - когда вышло окно двойного
+    if (_clicks == 1 && !_stable && now - _releaseTime >= _doubleClickTime) {
+      _clicks = 0;
+      push(BTN_CLICK);
     }
-    
-    _lastState = currentState;
-    _isPressed = currentState;
   }
-  
-  bool click() { return _clicked; }
-  bool hold() { return _held; }
+
+  // Следующий жест из очереди (BTN_NONE - очередь пуста)
+  ButtonGesture getGesture() {
+    if (_queueTail == _queueHead) return BTN_NONE;
+    ButtonGesture g = _queue[_queueTail];
+    _queueTail = (_queueTail + 1) % QUEUE_SLOTS;
+    return g;
+  }
+
+  // Вызывается из прерывания на каждом фронте (например, разбудить loop)
+  void setIsrHook(void (*hook)()) { _isrHook = hook; }
+
+  bool isPressed() { return _stable; }
   bool isHold() { return _holding; }
-  bool isPressed() { return _isPressed; }
-  
+
   void setHoldTimeout(uint16_t timeout) { _holdTime = timeout; }
-  
+  void setDebounce(uint16_t timeout) { _debounceTime = timeout; }
+  void setDoubleClickTimeout(uint16_t timeout) { _doubleClickTime = timeout; }
+
 private:
+  static const uint8_t EDGE_SLOTS = 16;
+  static const uint8_t QUEUE_SLOTS = 8;
+
+  struct Edge {
+    uint32_t time;
+    bool pressed;
+  };
+
+  static void IRAM_ATTR isr(void* arg) {
+    SimpleButton* self = static_cast<SimpleButton*>(arg);
+    uint8_t next = (self->_edgeHead + 1) % EDGE_SLOTS;
+    if (next == self->_edgeTail) return;  // Кольцо полно - уровень восстановит tick()
+    self->_edges[self->_edgeHead].time = millis();
+    self->_edges[self->_edgeHead].pressed = gpio_get_level((gpio_num_t)self->_pin) == 0;
+    self->_edgeHead = next;
+    if (self->_isrHook) self->_isrHook();
+  }
+
+  bool readPin() { return digitalRead(_pin) == LOW; }
+
+  // Фронт после антидребезга
+  void onEdge(bool pressed, uint32_t time) {
+    if (pressed == _stable) return;
+    if (time - _lastEdge < _debounceTime) return;  // Дребезг
+    _stable = pressed;
+    _lastEdge = time;
+
+    if (pressed) {
+      _pressTime = time;
+      _holding = false;
+    } else if (_holding) {
+      _holding = false;
+      push(BTN_HOLD_RELEASE);
+    } else if (++_clicks >= 2) {
+      _clicks = 0;
+      push(BTN_DOUBLE_CLICK);
+    } else {
+      _releaseTime = time;
+    }
+  }
+
+  void push(ButtonGesture g) {
+    uint8_t next = (_queueHead + 1) % QUEUE_SLOTS;
+    if (next == _queueTail) return;  // Никто не читает очередь - старые жесты важнее
+    _queue[_queueHead] = g;
+    _queueHead = next;
+  }
+
   uint8_t _pin;
-  bool _lastState = false;
-  bool _clicked = false;
-  bool _held = false;
+  void (*_isrHook)() = nullptr;
+
+  // Кольцо фронтов: голову двигает прерывание, хвост - tick()
+  Edge _edges[EDGE_SLOTS];
+  volatile uint8_t _edgeHead = 0;
+  volatile uint8_t _edgeTail = 0;
+
+  ButtonGesture _queue[QUEUE_SLOTS];
+  uint8_t _queueHead = 0;
+  uint8_t _queueTail = 0;
+
+  bool _stable = false;
   bool _holding = false;
-  bool _isPressed = false;
+  uint8_t _clicks = 0;
+  uint32_t _lastEdge = 0;
   uint32_t _pressTime = 0;
+  uint32_t _releaseTime = 0;
   uint16_t _holdTime = 500;
+  uint16_t _debounceTime = 30;
+  uint16_t _doubleClickTime = 300;
 };
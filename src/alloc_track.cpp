@@ -0,0 +1,124 @@
+/*
+  alloc_track.cpp - Учёт выделений памяти по модулям (сборка с -DALLOC_TRACKING)
+*/
+
+#include "alloc_track.h"
+
+#ifdef ALLOC_TRACKING
+
+#include "metrics.h"
+#include "logger.h"
+
+AllocModule allocCurrentModule = ALLOC_CORE;
+
+static TaskHandle_t loopTask = nullptr;
+
+static const char* MODULE_NAMES[ALLOC_MODULE_COUNT] = {
+  "core", "wifi", "mqtt", "web", "feed", "schedule", "other_tasks"
+};
+
+// Счётчики по модулям (список инициализации без копирования - атомики не копируются)
+static Counter allocCounts[ALLOC_MODULE_COUNT] = {
+  {"feeder_alloc_total", "Heap allocations", "module=\"core\""},
+  {"feeder_alloc_total", "Heap allocations", "module=\"wifi\""},
+  {"feeder_alloc_total", "Heap allocations", "module=\"mqtt\""},
+  {"feeder_alloc_total", "Heap allocations", "module=\"web\""},
+  {"feeder_alloc_total", "Heap allocations", "module=\"feed\""},
+  {"feeder_alloc_total", "Heap allocations", "module=\"schedule\""},
+  {"feeder_alloc_total", "Heap allocations", "module=\"other_tasks\""},
+};
+static Counter allocBytes[ALLOC_MODULE_COUNT] = {
+  {"feeder_alloc_bytes_total", "Heap bytes allocated", "module=\"core\""},
+  {"feeder_alloc_bytes_total", "Heap bytes allocated", "module=\"wifi\""},
+  {"feeder_alloc_bytes_total", "Heap bytes allocated", "module=\"mqtt\""},
+  {"feeder_alloc_bytes_total", "Heap bytes allocated", "module=\"web\""},
+  {"feeder_alloc_bytes_total", "Heap bytes allocated", "module=\"feed\""},
+  {"feeder_alloc_bytes_total", "Heap bytes allocated", "module=\"schedule\""},
+  {"feeder_alloc_bytes_total", "Heap bytes allocated", "module=\"other_tasks\""},
+};
+static Counter loopAllocIterations("feeder_loop_alloc_iterations_total",
+                                   "Steady-state loop() iterations that allocated");
+
+static uint32_t loopStartCounts[ALLOC_MODULE_COUNT];
+static bool webRequest = false;      // В итерации обслужен HTTP запрос
+
+static inline void allocRecord(size_t size) {
+  AllocModule m = (loopTask && xTaskGetCurrentTaskHandle() == loopTask)
+                    ? allocCurrentModule : ALLOC_OTHER_TASKS;
+  allocCounts[m].inc();
+  allocBytes[m].inc(size);
+}
+
+extern "C" {
+  void* __real_malloc(size_t size);
+  void* __real_calloc(size_t n, size_t size);
+  void* __real_realloc(void* ptr, size_t size);
+
+  void* __wrap_malloc(size_t size) {
+    allocRecord(size);
+    return __real_malloc(size);
+  }
+
+  void* __wrap_calloc(size_t n, size_t size) {
+    allocRecord(n * size);
+    return __real_calloc(n, size);
+  }
+
+  void* __wrap_realloc(void* ptr, size_t size) {
+    allocRecord(size);
+    return __real_realloc(ptr, size);
+  }
+}
+
+void allocTrackSetup() {
+  loopTask = xTaskGetCurrentTaskHandle();
+  LOGI("ALLOC", "Учёт выделений памяти включен");
+}
+
+void allocWebRequest() {
+  webRequest = true;
+}
+
+uint32_t allocLoopViolations() {
+  return loopAllocIterations.value();
+}
+
+// Выделения модуля в итерации разрешены (см. alloc_track.h)
+static bool allocExempt(int m) {
+  return m == ALLOC_OTHER_TASKS || (m == ALLOC_WEB && webRequest);
+}
+
+void allocLoopBegin() {
+  allocCurrentModule = ALLOC_CORE;
+  webRequest = false;
+  for (int i = 0; i < ALLOC_MODULE_COUNT; i++) {
+    loopStartCounts[i] = allocCounts[i].value();
+  }
+}
+
+void allocLoopEnd() {
+  if (millis() < ALLOC_WARMUP_MS) return;
+
+  // Выделения задачи loop() вне разрешённых путей
+  uint32_t total = 0;
+  uint32_t diff[ALLOC_MODULE_COUNT];
+  for (int i = 0; i < ALLOC_MODULE_COUNT; i++) {
+    diff[i] = allocCounts[i].value() - loopStartCounts[i];
+    if (!allocExempt(i)) total += diff[i];
+  }
+  if (total == 0) return;
+
+  loopAllocIterations.inc();
+
+  static unsigned long lastReport = 0;
+  if (lastReport != 0 && millis() - lastReport < ALLOC_REPORT_INTERVAL) return;
+  lastReport = millis();
+
+  for (int i = 0; i < ALLOC_MODULE_COUNT; i++) {
+    if (diff[i] && !allocExempt(i)) {
+      LOGW("ALLOC", "Выделение в установившемся режиме: %s x%u", MODULE_NAMES[i], diff[i]);
+    }
+  }
+}
+
+#endif // ALLOC_TRACKING
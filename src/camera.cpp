@@ -0,0 +1,319 @@
+/*
+  camera.cpp - Камера ESP32-CAM: захват в пул кадров и MJPEG поток
+*/
+
+#include "camera.h"
+#include "mjpeg_stream.h"
+#include "power_manager.h"
+#include "metrics.h"
+#include "logger.h"
+#include <esp_camera.h>
+#include <freertos/queue.h>
+#include <atomic>
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+
+// Пины камеры AI-Thinker ESP32-CAM
+#define CAM_PIN_PWDN 32
+#define CAM_PIN_RESET -1
+#define CAM_PIN_XCLK 0
+#define CAM_PIN_SIOD 26
+#define CAM_PIN_SIOC 27
+#define CAM_PIN_D7 35
+#define CAM_PIN_D6 34
+#define CAM_PIN_D5 39
+#define CAM_PIN_D4 36
+#define CAM_PIN_D3 21
+#define CAM_PIN_D2 19
+#define CAM_PIN_D1 18
+#define CAM_PIN_D0 5
+#define CAM_PIN_VSYNC 25
+#define CAM_PIN_HREF 23
+#define CAM_PIN_PCLK 22
+
+// OV2640: COM2 в банке сенсора (бит 8 номера - банк для set_reg), бит standby
+#define OV2640_COM2 0x109
+#define OV2640_COM2_STANDBY 0x10
+
+static_assert(CAMERA_CAPTURE_TIMEOUT < TRACE_STALL_MS, "Still frame wait must not stall loop()");
+
+static const framesize_t sensorSizes[FRAME_SIZE_COUNT] = {
+  FRAMESIZE_QQVGA, FRAMESIZE_QVGA, FRAMESIZE_VGA, FRAMESIZE_SVGA
+};
+
+static CameraFrameSource source;
+static FramePool pool;
+static MjpegStreamer streamer;
+static bool ready = false;
+static std::atomic<bool> standby(false);     // Меняет только задача захвата
+static TaskHandle_t captureTaskHandle = nullptr;
+#if CONFIG_PM_ENABLE
+// Light sleep останавливает тактирование сенсора: разрешён только в standby
+static esp_pm_lock_handle_t noSleepLock = nullptr;
+#endif
+static std::atomic<bool> captureRequested(false);
+static std::atomic<bool> frameWaiting(false);   // cameraAcquireFrame ждёт кадр
+static QueueHandle_t frameReady = nullptr;       // Захват закончен (удачно или нет)
+static std::atomic<uint32_t> background(0);  // fps | (размер << 16)
+
+static Counter cameraFrames("feeder_camera_frames_total", "Frames captured into the pool");
+static Counter cameraFailures("feeder_camera_capture_failures_total", "Captures failed or dropped (no free slot)");
+static Gauge cameraStandby("feeder_camera_standby", "Camera sensor in standby (1) while no frames are needed");
+static Gauge streamClients("feeder_camera_stream_clients", "MJPEG viewers connected");
+static Gauge streamFps("feeder_camera_stream_fps", "Capture rate requested by the stream");
+static Gauge streamSize("feeder_camera_stream_size", "Stream resolution step (0 - QQVGA .. 3 - SVGA)");
+static Counter streamFrames("feeder_camera_stream_frames_total", "Frames sent to MJPEG viewers");
+static Counter streamSkipped("feeder_camera_stream_skipped_total", "Frames skipped by slow viewers");
+static Counter streamBytes("feeder_camera_stream_bytes_total", "Bytes sent to MJPEG viewers");
+
+// ==================== ИСТОЧНИК ====================
+bool CameraFrameSource::begin(FrameSize size) {
+  camera_config_t config = {};
+  config.pin_pwdn = CAM_PIN_PWDN;
+  config.pin_reset = CAM_PIN_RESET;
+  config.pin_xclk = CAM_PIN_XCLK;
+  config.pin_sscb_sda = CAM_PIN_SIOD;
+  config.pin_sscb_scl = CAM_PIN_SIOC;
+  config.pin_d7 = CAM_PIN_D7;
+  config.pin_d6 = CAM_PIN_D6;
+  config.pin_d5 = CAM_PIN_D5;
+  config.pin_d4 = CAM_PIN_D4;
+  config.pin_d3 = CAM_PIN_D3;
+  config.pin_d2 = CAM_PIN_D2;
+  config.pin_d1 = CAM_PIN_D1;
+  config.pin_d0 = CAM_PIN_D0;
+  config.pin_vsync = CAM_PIN_VSYNC;
+  config.pin_href = CAM_PIN_HREF;
+  config.pin_pclk = CAM_PIN_PCLK;
+  config.xclk_freq_hz = 20000000;
+  config.ledc_timer = LEDC_TIMER_0;
+  config.ledc_channel = LEDC_CHANNEL_0;
+  config.pixel_format = PIXFORMAT_JPEG;
+  // Буферы драйвера - под наибольшее разрешение, дальше размер меняется на лету
+  config.frame_size = sensorSizes[CAMERA_MAX_SIZE];
+  config.jpeg_quality = CAMERA_JPEG_QUALITY;
+  config.fb_count = 2;
+  config.fb_location = CAMERA_FB_IN_PSRAM;
+  config.grab_mode = CAMERA_GRAB_LATEST;
+
+  esp_err_t err = esp_camera_init(&config);
+  if (err != ESP_OK) {
+    LOGE("CAM", "Ошибка инициализации камеры: 0x%x", err);
+    return false;
+  }
+  return setSize(size);
+}
+
+bool CameraFrameSource::setSize(FrameSize size) {
+  sensor_t* s = esp_camera_sensor_get();
+  if (!s || s->set_framesize(s, sensorSizes[size]) != 0) return false;
+  _size = size;
+
+  // Кадр, снятый ещё в старом разрешении, выбрасываем
+  camera_fb_t* fb = esp_camera_fb_get();
+  if (fb) esp_camera_fb_return(fb);
+  return true;
+}
+
+// Буфер драйвера копируется в слот пула и сразу возвращается драйверу,
+// дальше кадр идёт к клиентам без копий
+bool CameraFrameSource::capture(uint8_t* buf, size_t cap, FrameInfo& info) {
+  camera_fb_t* fb = esp_camera_fb_get();
+  if (!fb) return false;
+  bool ok = fb->len <= cap;
+  if (ok) {
+    memcpy(buf, fb->buf, fb->len);
+    info.len = fb->len;
+    info.width = fb->width;
+    info.height = fb->height;
+  }
+  esp_camera_fb_return(fb);
+  return ok;
+}
+
+// ==================== ЗАДАЧИ ====================
+// Standby сенсора: он перестаёт выдавать кадры и потреблять ток сенсора,
+// регистры и экспозиция сохраняются. Первый кадр после пробуждения -
+// старый из буфера драйвера, он выбрасывается
+static void setStandby(bool on) {
+  if (on == standby.load(std::memory_order_relaxed)) return;
+#if CONFIG_PM_ENABLE
+  if (!on && noSleepLock) esp_pm_lock_acquire(noSleepLock);
+#endif
+  sensor_t* s = esp_camera_sensor_get();
+  if (!s || s->set_reg(s, OV2640_COM2, OV2640_COM2_STANDBY, on ? OV2640_COM2_STANDBY : 0) != 0) {
+    LOGW("CAM", "Не удалось %s сенсор", on ? "усыпить" : "разбудить");
+#if CONFIG_PM_ENABLE
+    if (!on && noSleepLock) esp_pm_lock_release(noSleepLock);
+#endif
+    return;
+  }
+  standby.store(on, std::memory_order_relaxed);
+  cameraStandby.set(on);
+  if (on) {
+#if CONFIG_PM_ENABLE
+    if (noSleepLock) esp_pm_lock_release(noSleepLock);
+#endif
+  } else {
+    camera_fb_t* fb = esp_camera_fb_get();
+    if (fb) esp_camera_fb_return(fb);
+  }
+}
+
+// Захват: по спросу MJPEG сервера, с фоновой частотой или по разовому запросу.
+// В простое фон не чаще POWER_IDLE_CAMERA_FPS; когда кадры не нужны,
+// сенсор в standby, а задача ждёт запроса
+static void captureTask(void*) {
+  uint32_t lastCapture = 0;
+  for (;;) {
+    StreamDemand d = streamer.demand();
+    uint32_t bg = background.load(std::memory_order_relaxed);
+    uint16_t bgFps = bg & 0xFFFF;
+    if (powerMode() == POWER_IDLE && bgFps > POWER_IDLE_CAMERA_FPS) bgFps = POWER_IDLE_CAMERA_FPS;
+    uint16_t fps = d.clients ? (d.fps > bgFps ? d.fps : bgFps) : bgFps;
+    uint32_t now = millis();
+    uint32_t period = fps ? 1000 / fps : 0;
+    bool due = fps && now - lastCapture >= period;
+    bool requested = captureRequested.load(std::memory_order_acquire);
+
+    if (!due && !requested) {
+      // До следующего кадра (при зрителях не дольше 20 мс - их спрос
+      // меняется) или, без кадров, до запроса
+      if (!fps) setStandby(true);
+      uint32_t waitMs = fps ? period - (now - lastCapture) : CAMERA_STANDBY_POLL_MS;
+      if (d.clients && waitMs > 20) waitMs = 20;
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs) + 1);
+      continue;
+    }
+    setStandby(false);
+
+    // Размер - по потоку; без зрителей фоновый, а разовый снимок -
+    // в наибольшем разрешении
+    FrameSize size = d.clients ? d.size
+                   : (bgFps && !requested) ? (FrameSize)(bg >> 16)
+                   : (FrameSize)CAMERA_MAX_SIZE;
+    if (size != source.size() && !source.setSize(size)) {
+      LOGW("CAM", "Не удалось сменить разрешение на %ux%u", frameWidth(size), frameHeight(size));
+    }
+
+    captureRequested.store(false, std::memory_order_release);
+    if (pool.captureFrom(source, now)) {
+      cameraFrames.inc();
+    } else {
+      cameraFailures.inc();
+    }
+    if (frameWaiting.load(std::memory_order_acquire)) {
+      uint8_t done = 1;
+      xQueueSend(frameReady, &done, 0);
+    }
+    lastCapture = now;
+  }
+}
+
+// MJPEG сервер: спит, только когда не было работы
+static void streamTask(void*) {
+  for (;;) {
+    bool busy = streamer.service(millis());
+
+    StreamStats st = streamer.stats();
+    StreamDemand d = streamer.demand();
+    streamClients.set(st.clients);
+    streamFps.set(st.clients ? d.fps : 0);
+    streamSize.set(d.size);
+    streamFrames.set(st.framesSent);
+    streamSkipped.set(st.framesSkipped);
+    streamBytes.set(st.bytesSent);
+
+    // Без зрителей - только приём подключений, реже
+    vTaskDelay(pdMS_TO_TICKS(busy ? 1 : st.clients ? 10 : CAMERA_ACCEPT_POLL_MS));
+  }
+}
+
+void cameraSetup() {
+  if (!psramFound()) {
+    LOGE("CAM", "PSRAM не найдена - камера отключена");
+    return;
+  }
+  if (!source.begin(FRAME_QVGA)) return;
+  if (!pool.begin(CAMERA_POOL_SLOTS, CAMERA_FRAME_MAX)) {
+    LOGE("CAM", "Не хватило памяти под пул кадров");
+    return;
+  }
+  if (!streamer.begin(CAMERA_STREAM_PORT, &pool)) {
+    LOGE("CAM", "Не удалось открыть порт %d для MJPEG", CAMERA_STREAM_PORT);
+    return;
+  }
+  frameReady = xQueueCreate(1, sizeof(uint8_t));
+  if (!frameReady) {
+    LOGE("CAM", "Не хватило памяти под очередь снимков");
+    return;
+  }
+
+#if CONFIG_PM_ENABLE
+  if (esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "camera", &noSleepLock) == ESP_OK) {
+    esp_pm_lock_acquire(noSleepLock);
+  } else {
+    noSleepLock = nullptr;
+  }
+#endif
+  xTaskCreatePinnedToCore(captureTask, "cam_capture", 4096, nullptr, 2, &captureTaskHandle, 0);
+  xTaskCreatePinnedToCore(streamTask, "cam_stream", 4096, nullptr, 1, nullptr, 0);
+  ready = true;
+  LOGI("CAM", "Камера готова, поток на порту %d, пул %d x %u КБ",
+       CAMERA_STREAM_PORT, CAMERA_POOL_SLOTS, (unsigned)(CAMERA_FRAME_MAX / 1024));
+}
+
+uint8_t cameraStreamClients() {
+  return streamClients.value();
+}
+
+bool cameraReady() {
+  return ready;
+}
+
+bool cameraAsleep() {
+  return standby.load(std::memory_order_relaxed);
+}
+
+FrameSlot* cameraAcquireFrame(uint32_t timeoutMs) {
+  if (!ready) return nullptr;
+  if (timeoutMs > CAMERA_CAPTURE_TIMEOUT) timeoutMs = CAMERA_CAPTURE_TIMEOUT;
+
+  // Кадр потока свежий сам по себе; иначе просим снимок. Ждём сигнала
+  // задачи захвата, а не опрашиваем пул: loop() стоит только до кадра
+  uint8_t done;
+  while (xQueueReceive(frameReady, &done, 0) == pdTRUE) {}
+  uint32_t seq = pool.latestSeq();
+  frameWaiting.store(true, std::memory_order_release);
+  if (streamer.demand().clients == 0) {
+    captureRequested.store(true, std::memory_order_release);
+    xTaskNotifyGive(captureTaskHandle);
+  }
+  uint32_t start = millis();
+  while (pool.latestSeq() == seq) {
+    uint32_t waited = millis() - start;
+    if (waited >= timeoutMs ||
+        xQueueReceive(frameReady, &done, pdMS_TO_TICKS(timeoutMs - waited)) != pdTRUE) {
+      break;
+    }
+  }
+  frameWaiting.store(false, std::memory_order_release);
+  return pool.acquireLatest(seq);
+}
+
+void cameraRelease(FrameSlot* slot) {
+  pool.release(slot);
+}
+
+FrameSlot* cameraLatestFrame(uint32_t newerThan) {
+  return ready ? pool.acquireLatest(newerThan) : nullptr;
+}
+
+void cameraSetBackground(uint16_t fps, FrameSize size) {
+  uint32_t current = background.load(std::memory_order_relaxed);
+  if (fps < (current & 0xFFFF)) fps = current & 0xFFFF;
+  if (size < (FrameSize)(current >> 16)) size = (FrameSize)(current >> 16);
+  background.store(fps | ((uint32_t)size << 16), std::memory_order_relaxed);
+  if (captureTaskHandle) xTaskNotifyGive(captureTaskHandle);
+}
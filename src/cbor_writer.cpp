@@ -0,0 +1,58 @@
+/*
+  cbor_writer.cpp - Запись CBOR (RFC 8949) в буфер фиксированного размера
+*/
+
+#include "cbor_writer.h"
+#include <string.h>
+
+CborWriter& CborWriter::byte(uint8_t b) {
+  if (_len >= _size) {
+    _overflow = true;
+  } else {
+    _buf[_len++] = b;
+  }
+  return *this;
+}
+
+// Заголовок: старший тип и аргумент в кратчайшей форме (0-23 - в том же байте)
+CborWriter& CborWriter::head(uint8_t major, uint64_t v) {
+  uint8_t bytes, info;
+  if (v < 24) {
+    return byte((major << 5) | v);
+  } else if (v <= 0xFF) {
+    bytes = 1; info = 24;
+  } else if (v <= 0xFFFF) {
+    bytes = 2; info = 25;
+  } else if (v <= 0xFFFFFFFFu) {
+    bytes = 4; info = 26;
+  } else {
+    bytes = 8; info = 27;
+  }
+  if (_len + 1 + bytes > _size) {
+    _overflow = true;
+    return *this;
+  }
+  _buf[_len++] = (major << 5) | info;
+  for (int i = bytes - 1; i >= 0; i--) {
+    _buf[_len++] = v >> (i * 8);
+  }
+  return *this;
+}
+
+// Отрицательные числа: тип 1 с аргументом -1 - v
+CborWriter& CborWriter::signedInt(int64_t v) {
+  return v >= 0 ? head(0, v) : head(1, (uint64_t)(-1 - v));
+}
+
+CborWriter& CborWriter::text(const char* s) {
+  size_t n = strlen(s);
+  head(3, n);
+  if (_overflow) return *this;
+  if (_len + n > _size) {
+    _overflow = true;
+    return *this;
+  }
+  memcpy(_buf + _len, s, n);
+  _len += n;
+  return *this;
+}
@@ -0,0 +1,176 @@
+/*
+  clip_recorder.cpp - Ролики кормлений с предзаписью
+*/
+
+#include "clip_recorder.h"
+#include "clip_ring.h"
+#include "camera.h"
+#include "storage.h"
+#include "metrics.h"
+#include "logger.h"
+#include <Preferences.h>
+#include <atomic>
+
+#define CLIP_TMP_PATH "/clip.tmp"
+
+static ClipRing ring;
+static bool ready = false;
+
+// Номер следующего ролика (переживает перезагрузку)
+static uint32_t nextId = 0;
+
+// Ролик, запрошенный кормлением (-1 - нет). Пишет задача ролика,
+// она же сбрасывает после сохранения
+static std::atomic<int32_t> pendingClip(-1);
+
+static Counter clipsSaved("feeder_clips_saved_total", "Feeding clips written to storage");
+static Counter clipsFailed("feeder_clips_failed_total", "Feeding clips lost (storage error)");
+static Counter clipsTruncated("feeder_clips_truncated_total", "Clips cut short by a full ring");
+static Gauge clipRingBytes("feeder_clip_ring_bytes", "Bytes held in the pre-roll ring");
+
+void clipPath(uint32_t id, char* buf, size_t size) {
+  snprintf(buf, size, "/clip_%u.mjpeg", (unsigned)id);
+}
+
+// Кольцо в файл: части multipart с временем кадра от начала кормления
+static bool saveClip(uint32_t id, uint32_t triggerMs) {
+  if (!storageReady()) return false;
+  storageRemove(CLIP_TMP_PATH);
+
+  for (uint16_t i = 0; i < ring.count(); i++) {
+    const uint8_t* data;
+    size_t len;
+    uint32_t timeMs;
+    ring.frame(i, data, len, timeMs);
+
+    char head[128];
+    int n = snprintf(head, sizeof(head),
+                     "%s--frame\r\nContent-Type: image/jpeg\r\n"
+                     "Content-Length: %u\r\nX-Timestamp: %ld\r\n\r\n",
+                     i ? "\r\n" : "", (unsigned)len, (long)(int32_t)(timeMs - triggerMs));
+    if (!storageAppend(CLIP_TMP_PATH, head, n) ||
+        !storageAppend(CLIP_TMP_PATH, data, len)) {
+      storageRemove(CLIP_TMP_PATH);
+      return false;
+    }
+  }
+  if (!storageAppend(CLIP_TMP_PATH, "\r\n--frame--\r\n", 13)) {
+    storageRemove(CLIP_TMP_PATH);
+    return false;
+  }
+
+  char path[32];
+  clipPath(id, path, sizeof(path));
+  storageRemove(path);
+  if (!storageRename(CLIP_TMP_PATH, path)) return false;
+
+  // Старые ролики удаляем: номера идут подряд
+  if (id >= CLIP_KEEP) {
+    clipPath(id - CLIP_KEEP, path, sizeof(path));
+    storageRemove(path);
+  }
+  return true;
+}
+
+// Копирует свежие кадры пула в кольцо; по запросу замораживает его и
+// через CLIP_POSTROLL_MS сохраняет ролик
+static void clipTask(void*) {
+  uint32_t seq = 0;
+  uint32_t triggerMs = 0;
+  uint32_t lastPushMs = 0;
+  bool truncated = false;
+
+  for (;;) {
+    uint32_t now = millis();
+    // Фоновый захват может идти чаще (детектор, зрители) - берём CLIP_FPS
+    FrameSlot* f = now - lastPushMs >= 1000 / CLIP_FPS ? cameraLatestFrame(seq) : nullptr;
+    if (f) {
+      seq = f->info.seq;
+      lastPushMs = now;
+      if (!ring.push(f->data, f->info.len, f->info.timeMs) && ring.frozen()) {
+        truncated = true;
+      }
+      cameraRelease(f);
+    }
+
+    int32_t id = pendingClip.load(std::memory_order_acquire);
+    if (id >= 0 && !ring.frozen()) {
+      ring.freeze();
+      triggerMs = now;
+      truncated = false;
+    }
+
+    if (!ring.frozen()) {
+      ring.dropBefore(now - CLIP_PREROLL_MS);
+    } else if (truncated || now - triggerMs >= CLIP_POSTROLL_MS) {
+      if (truncated) clipsTruncated.inc();
+      uint16_t frames = ring.count();
+      if (saveClip(id, triggerMs)) {
+        clipsSaved.inc();
+        LOGI("CLIP", "Ролик %d сохранён: %u кадров, %u КБ",
+             id, frames, (unsigned)(ring.bytesUsed() / 1024));
+      } else {
+        clipsFailed.inc();
+        LOGW("CLIP", "Не удалось сохранить ролик %d", id);
+      }
+      ring.clear();
+      pendingClip.store(-1, std::memory_order_release);
+    }
+
+    clipRingBytes.set(ring.bytesUsed());
+    bool asleep = cameraAsleep() && !ring.frozen();
+    vTaskDelay(pdMS_TO_TICKS(asleep ? CAMERA_STANDBY_POLL_MS : 1000 / CLIP_FPS / 2));
+  }
+}
+
+void clipSetup() {
+  if (!cameraReady()) return;
+  if (!ring.begin(CLIP_RING_BYTES, CLIP_RING_FRAMES)) {
+    LOGE("CLIP", "Не хватило памяти под кольцо роликов");
+    return;
+  }
+
+  Preferences prefs;
+  prefs.begin("clips", true);
+  nextId = prefs.getUInt("next", 0);
+  prefs.end();
+
+  cameraSetBackground(CLIP_FPS, CLIP_SIZE);
+  xTaskCreatePinnedToCore(clipTask, "clip", 4096, nullptr, 1, nullptr, 0);
+  ready = true;
+  LOGI("CLIP", "Ролики: предзапись %d мс, после кормления %d мс",
+       CLIP_PREROLL_MS, CLIP_POSTROLL_MS);
+}
+
+int clipTrigger(const char* source) {
+  if (!ready) return -1;
+
+  int32_t expected = -1;
+  int32_t id = (int32_t)(nextId & 0x7FFFFFFF);
+  if (!pendingClip.compare_exchange_strong(expected, id, std::memory_order_acq_rel)) {
+    LOGW("CLIP", "Ролик %d ещё пишется, кормление (%s) без ролика", expected, source);
+    return -1;
+  }
+
+  nextId = (uint32_t)id + 1;
+  Preferences prefs;
+  prefs.begin("clips", false);
+  prefs.putUInt("next", nextId);
+  prefs.end();
+  return id;
+}
+
+void clipWriteListJson(Print& out) {
+  out.print('[');
+  bool first = true;
+  uint32_t from = nextId > CLIP_KEEP ? nextId - CLIP_KEEP : 0;
+  for (uint32_t id = from; id < nextId; id++) {
+    char path[32];
+    clipPath(id, path, sizeof(path));
+    long size = storageFileSize(path);
+    if (size < 0) continue;
+    out.printf("%s{\"id\":%u,\"size\":%ld}", first ? "" : ",", (unsigned)id, size);
+    first = false;
+  }
+  out.print(']');
+}
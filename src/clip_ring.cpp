@@ -0,0 +1,114 @@
+/*
+  clip_ring.cpp - Кольцо JPEG кадров для роликов с предзаписью
+*/
+
+#include "clip_ring.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+  #include <esp_heap_caps.h>
+  static void* allocRing(size_t size) {
+    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  }
+#else
+  static void* allocRing(size_t size) {
+    return malloc(size);
+  }
+#endif
+
+bool ClipRing::begin(size_t bytes, uint16_t maxFrames) {
+  if (_buf) return true;
+  _buf = (uint8_t*)allocRing(bytes);
+  _entries = (Entry*)malloc(sizeof(Entry) * maxFrames);
+  if (!_buf || !_entries) {
+    free(_buf);
+    free(_entries);
+    _buf = nullptr;
+    _entries = nullptr;
+    return false;
+  }
+  _size = bytes;
+  _maxFrames = maxFrames;
+  clear();
+  return true;
+}
+
+void ClipRing::clear() {
+  _head = 0;
+  _count = 0;
+  _writePos = 0;
+  _used = 0;
+  _frozen = false;
+}
+
+// Свободное место под len байт без разрыва кадра. Живые кадры занимают
+// по кругу [начало самого старого, _writePos)
+bool ClipRing::findSpace(size_t len, uint32_t& pos) const {
+  if (_count == 0) {
+    pos = 0;
+    return len <= _size;
+  }
+  if (_count >= _maxFrames) return false;
+
+  uint32_t oldest = _entries[_head].off;
+  if (_writePos > oldest) {
+    // Живые кадры без перехода через конец: место после них или в начале
+    if (_writePos + len <= _size) {
+      pos = _writePos;
+      return true;
+    }
+    if (len <= oldest) {
+      pos = 0;
+      return true;
+    }
+    return false;
+  }
+  // Живые кадры переходят через конец: место только между ними
+  if (_writePos + len <= oldest) {
+    pos = _writePos;
+    return true;
+  }
+  return false;
+}
+
+void ClipRing::dropOldest() {
+  _used -= _entries[_head].len;
+  _head = (_head + 1) % _maxFrames;
+  if (--_count == 0) _writePos = 0;
+}
+
+void ClipRing::dropBefore(uint32_t timeMs) {
+  while (!_frozen && _count && (int32_t)(_entries[_head].timeMs - timeMs) < 0) {
+    dropOldest();
+  }
+}
+
+bool ClipRing::push(const uint8_t* data, size_t len, uint32_t timeMs) {
+  if (!_buf || len == 0 || len > _size) return false;
+
+  uint32_t pos;
+  while (!findSpace(len, pos)) {
+    if (_frozen) return false;
+    dropOldest();
+  }
+
+  memcpy(_buf + pos, data, len);
+  Entry& e = _entries[(_head + _count) % _maxFrames];
+  e.off = pos;
+  e.len = len;
+  e.timeMs = timeMs;
+  _count++;
+  _writePos = pos + len;
+  _used += len;
+  return true;
+}
+
+bool ClipRing::frame(uint16_t i, const uint8_t*& data, size_t& len, uint32_t& timeMs) const {
+  if (i >= _count) return false;
+  const Entry& e = _entries[(_head + i) % _maxFrames];
+  data = _buf + e.off;
+  len = e.len;
+  timeMs = e.timeMs;
+  return true;
+}
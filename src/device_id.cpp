@@ -0,0 +1,57 @@
+/*
+  device_id.cpp - Идентификатор устройства для работы нескольких кормушек
+*/
+
+#include "device_id.h"
+#include "checksum.h"
+#include "logger.h"
+
+static char id[DEVICE_ID_LEN];
+static char name[DEVICE_ID_LEN + 16];
+
+#define NAME_HASH_LEN 7   // "_" и 6 hex цифр
+
+void deviceIdFromName(const char* raw, char* out, size_t size) {
+  size_t n = 0;
+  bool changed = false;
+  for (const char* p = raw; *p; p++) {
+    char c = *p;
+    if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+    if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'))) c = '_';
+    if (c != *p) changed = true;
+    if (n < size - 1) {
+      out[n++] = c;
+    } else {
+      changed = true;
+    }
+  }
+  out[n] = '\0';
+  if (!changed) return;
+
+  // Имя изменено (кириллица, пробелы, регистр, длина): разные имена не
+  // должны совпасть после замены, поэтому - хэш исходного имени
+  if (n > size - 1 - NAME_HASH_LEN) n = size - 1 - NAME_HASH_LEN;
+  snprintf(out + n, size - n, "_%06x", (unsigned)(fnv1a(raw, strlen(raw)) & 0xFFFFFF));
+}
+
+void deviceIdSetup() {
+#ifdef DEVICE_NAME
+  deviceIdFromName(DEVICE_NAME, id, sizeof(id));
+  snprintf(name, sizeof(name), "%s", DEVICE_NAME);
+#else
+  // Последние три байта MAC уникальны в пределах производителя
+  uint64_t mac = ESP.getEfuseMac();
+  const uint8_t* b = (const uint8_t*)&mac;
+  snprintf(id, sizeof(id), "feeder_%02x%02x%02x", b[3], b[4], b[5]);
+  snprintf(name, sizeof(name), "Кормушка %02X%02X%02X", b[3], b[4], b[5]);
+#endif
+  LOGI("DEVICE", "Идентификатор: %s", id);
+}
+
+const char* deviceId() {
+  return id;
+}
+
+const char* deviceName() {
+  return name;
+}
@@ -0,0 +1,256 @@
+/*
+  feed_journal.cpp - Журнал кормлений на случай сброса посреди порции
+*/
+
+#include "feed_journal.h"
+#include "checksum.h"
+#include "arena.h"
+#include "time_service.h"
+#include "metrics.h"
+#include "logger.h"
+#include <Preferences.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <stddef.h>
+
+#define RTC_JOURNAL_MAGIC 0x4A524E4Cu
+
+static_assert(FEED_JOURNAL_CHECKPOINT_REVS > 0, "Checkpoint interval must be positive");
+
+// Рабочая копия журнала - сразу в RTC памяти (переживает сброс без потери питания)
+static RTC_NOINIT_ATTR struct {
+  uint32_t magic;
+  JournalRecord rec[NUM_AUGERS];
+} rtcJournal;
+
+static int32_t flashDone[NUM_AUGERS];     // Прогресс на последней записи в NVS
+static uint32_t nextId = 1;
+static uint32_t flashWrites = 0;
+
+// Итог восстановления после загрузки
+static esp_reset_reason_t resetReason = ESP_RST_UNKNOWN;
+static JournalOutcome outcome[NUM_AUGERS];
+static JournalRecord interrupted[NUM_AUGERS];
+static bool resumePending[NUM_AUGERS];
+
+static Counter journalWrites("feeder_journal_writes_total", "Feed journal writes to flash");
+static Histogram journalWriteTime("feeder_journal_write_us", "Feed journal flash write duration",
+                                  nullptr, METRICS_BUCKETS_US, METRICS_BUCKETS_US_COUNT);
+static Counter feedsInterrupted("feeder_feeds_interrupted_total", "Feedings cut short by a reset");
+static Counter feedsResumed("feeder_feeds_resumed_total", "Interrupted feedings completed after boot");
+
+static uint32_t recordCheck(const JournalRecord& r) {
+  return fnv1a(&r, offsetof(JournalRecord, check));
+}
+
+static void seal(JournalRecord& r) {
+  r.check = recordCheck(r);
+}
+
+static void keyFor(uint8_t auger, char* key, size_t size) {
+  snprintf(key, size, "a%u", auger);
+}
+
+// Запись шнека из RTC в NVS
+static void saveFlash(uint8_t auger) {
+  int64_t start = esp_timer_get_time();
+  char key[5];
+  keyFor(auger, key, sizeof(key));
+  Preferences prefs;
+  prefs.begin("journal", false);
+  prefs.putBytes(key, &rtcJournal.rec[auger], sizeof(JournalRecord));
+  prefs.end();
+
+  flashDone[auger] = rtcJournal.rec[auger].done;
+  flashWrites++;
+  journalWrites.inc();
+  journalWriteTime.observe(esp_timer_get_time() - start);
+}
+
+static const char* resetName(esp_reset_reason_t reason) {
+  switch (reason) {
+    case ESP_RST_POWERON:   return "poweron";
+    case ESP_RST_BROWNOUT:  return "brownout";
+    case ESP_RST_PANIC:     return "panic";
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:       return "watchdog";
+    case ESP_RST_SW:        return "software";
+    case ESP_RST_EXT:       return "external";
+    case ESP_RST_DEEPSLEEP: return "deepsleep";
+    default:                return "unknown";
+  }
+}
+
+// Незавершённое кормление: докормить или отметить частичным
+static void recover(uint8_t auger, JournalRecord& r, bool fromRtc) {
+  if (r.state != JOURNAL_ACTIVE) return;
+  if (r.done >= r.target) {
+    // Порция выдана, сброс случился до отметки о завершении
+    r.state = JOURNAL_IDLE;
+    return;
+  }
+
+  feedsInterrupted.inc();
+  interrupted[auger] = r;
+  if (FEED_JOURNAL_RESUME && fromRtc && r.attempts < FEED_JOURNAL_MAX_RESUMES) {
+    outcome[auger] = JOURNAL_RESUMED;
+    resumePending[auger] = true;
+    LOGW("JOURNAL", "Шнек %d: кормление прервано сбросом (%s) на %d из %d оборотов, остаток будет докормлен",
+         auger + 1, resetName(resetReason), (int)r.done, (int)r.target);
+  } else {
+    outcome[auger] = JOURNAL_PARTIAL;
+    r.state = JOURNAL_IDLE;
+    LOGW("JOURNAL", "Шнек %d: кормление прервано сбросом (%s) на %d из %d оборотов%s",
+         auger + 1, resetName(resetReason), (int)r.done, (int)r.target,
+         fromRtc ? ", повторы исчерпаны" : ", питание пропадало - не докармливаем");
+  }
+}
+
+void journalSetup() {
+  resetReason = esp_reset_reason();
+  // Как после сброса (тесты на хосте "перезагружают" журнал повторным вызовом)
+  nextId = 1;
+  memset(outcome, 0, sizeof(outcome));
+  memset(resumePending, 0, sizeof(resumePending));
+  bool rtcValid = rtcJournal.magic == RTC_JOURNAL_MAGIC;
+  JournalRecord flash[NUM_AUGERS];
+
+  Preferences prefs;
+  prefs.begin("journal", true);
+  for (uint8_t i = 0; i < NUM_AUGERS; i++) {
+    char key[5];
+    keyFor(i, key, sizeof(key));
+    if (prefs.getBytes(key, &flash[i], sizeof(JournalRecord)) != sizeof(JournalRecord) ||
+        flash[i].check != recordCheck(flash[i])) {
+      memset(&flash[i], 0, sizeof(JournalRecord));
+    }
+  }
+  prefs.end();
+
+  for (uint8_t i = 0; i < NUM_AUGERS; i++) {
+    JournalRecord rtc = rtcJournal.rec[i];
+    if (!rtcValid || rtc.check != recordCheck(rtc)) memset(&rtc, 0, sizeof(rtc));
+
+    // RTC копия свежее (пишется на каждом обороте), NVS - если питание пропадало
+    bool fromRtc = rtc.id != 0 && (rtc.id > flash[i].id ||
+                                   (rtc.id == flash[i].id && rtc.done >= flash[i].done));
+    JournalRecord r = fromRtc ? rtc : flash[i];
+    if (rtc.id >= nextId) nextId = rtc.id + 1;
+    if (flash[i].id >= nextId) nextId = flash[i].id + 1;
+
+    recover(i, r, fromRtc);
+    seal(r);
+    rtcJournal.rec[i] = r;
+    flashDone[i] = flash[i].done;
+    if (r.id != 0 && memcmp(&r, &flash[i], sizeof(r)) != 0) saveFlash(i);
+  }
+  rtcJournal.magic = RTC_JOURNAL_MAGIC;
+}
+
+void journalBegin(uint8_t auger, int target, const char* source) {
+  if (auger >= NUM_AUGERS) return;
+  // Новое кормление раньше возобновления: остаток прерванного не докармливаем
+  if (resumePending[auger]) {
+    resumePending[auger] = false;
+    outcome[auger] = JOURNAL_PARTIAL;
+  }
+
+  JournalRecord& r = rtcJournal.rec[auger];
+  memset(&r, 0, sizeof(r));
+  r.id = nextId++;
+  r.epoch = timeEpoch();
+  r.target = target;
+  r.state = JOURNAL_ACTIVE;
+  strlcpy(r.source, source, sizeof(r.source));
+  seal(r);
+  saveFlash(auger);
+}
+
+void journalProgress(uint8_t auger, int done) {
+  if (auger >= NUM_AUGERS) return;
+  JournalRecord& r = rtcJournal.rec[auger];
+  if (r.state != JOURNAL_ACTIVE || done == r.done) return;
+  r.done = done;
+  seal(r);
+  if (done - flashDone[auger] >= FEED_JOURNAL_CHECKPOINT_REVS) saveFlash(auger);
+}
+
+void journalEnd(uint8_t auger, int done) {
+  if (auger >= NUM_AUGERS) return;
+  JournalRecord& r = rtcJournal.rec[auger];
+  if (r.state != JOURNAL_ACTIVE) return;
+  r.done = done;
+  r.state = JOURNAL_IDLE;
+  seal(r);
+  saveFlash(auger);
+
+  if (outcome[auger] == JOURNAL_RESUMED && r.id == interrupted[auger].id) {
+    feedsResumed.inc();
+    LOGI("JOURNAL", "Шнек %d: прерванное кормление докормлено", auger + 1);
+  }
+}
+
+bool journalTakeResume(uint8_t auger, JournalRecord& rec) {
+  if (auger >= NUM_AUGERS || !resumePending[auger]) return false;
+  resumePending[auger] = false;
+
+  JournalRecord& r = rtcJournal.rec[auger];
+  r.attempts++;
+  seal(r);
+  saveFlash(auger);
+  rec = r;
+  return true;
+}
+
+bool journalHasRecovery() {
+  for (uint8_t i = 0; i < NUM_AUGERS; i++) {
+    if (outcome[i] != JOURNAL_NONE) return true;
+  }
+  return false;
+}
+
+static void writeRecord(BufWriter& out, uint8_t auger, const JournalRecord& r) {
+  out.printf("{\"auger\":%d,\"id\":%u,\"source\":\"%s\",\"target\":%d,\"done\":%d,"
+             "\"attempts\":%u,\"epoch\":%u",
+             auger + 1, r.id, r.source, (int)r.target, (int)r.done, r.attempts, r.epoch);
+}
+
+static void writeRecovery(BufWriter& out) {
+  out.printf("{\"reset\":\"%s\",\"feeds\":[", resetName(resetReason));
+  bool first = true;
+  for (uint8_t i = 0; i < NUM_AUGERS; i++) {
+    if (outcome[i] == JOURNAL_NONE) continue;
+    if (!first) out.print(",");
+    first = false;
+    writeRecord(out, i, interrupted[i]);
+    out.printf(",\"outcome\":\"%s\"}", outcome[i] == JOURNAL_RESUMED ? "resumed" : "partial");
+  }
+  out.print("]}");
+}
+
+size_t journalRecoveryJson(char* buf, size_t size) {
+  BufWriter out(buf, size);
+  writeRecovery(out);
+  return out.overflow() ? 0 : out.length();
+}
+
+size_t journalStatusJson(char* buf, size_t size) {
+  BufWriter out(buf, size);
+  out.print("{\"recovery\":");
+  if (journalHasRecovery()) {
+    writeRecovery(out);
+  } else {
+    out.print("null");
+  }
+  out.print(",\"feeds\":[");
+  for (uint8_t i = 0; i < NUM_AUGERS; i++) {
+    const JournalRecord& r = rtcJournal.rec[i];
+    if (i) out.print(",");
+    writeRecord(out, i, r);
+    out.printf(",\"state\":\"%s\"}", r.state == JOURNAL_ACTIVE ? "active" : "idle");
+  }
+  out.printf("],\"flashWrites\":%u}", flashWrites);
+  return out.overflow() ? 0 : out.length();
+}
@@ -1,158 +1,197 @@
 /*
-  feeder.cpp - Управление мотором и кормлением
+  feeder.cpp - Кормление шнеками и калибровка порций
 */
 
 #include "feeder.h"
+#include "metrics.h"
+#include "logger.h"
+#include "alloc_track.h"
+#include "led_engine.h"
+#include "schedule.h"
+#include "mqtt_handler.h"
+#include "stepper.h"
+#include "clip_recorder.h"
+#include "presence.h"
+#include "time_service.h"
+#include "feed_journal.h"
 
-// LED массив
-CRGB leds[NUM_LEDS];
+// Базовые порции по шнекам (загружаются в loadSettings)
+int feedAmount[NUM_AUGERS];
 
-// Текущая порция кормления (по умолчанию)
-int feedAmount = DEFAULT_FEED_AMOUNT;
+// Метрики кормления
+static Counter feedsTotal("feeder_feeds_total", "Completed feedings");
+static Counter feedRevolutions("feeder_feed_revolutions_total", "Auger revolutions dispensed");
+static Histogram feedDuration("feeder_feed_duration_ms", "Feeding duration",
+                              nullptr, METRICS_BUCKETS_MS, METRICS_BUCKETS_MS_COUNT);
 
-// Последовательность шагов для двигателя
-static const byte steps[] = {0b1010, 0b0110, 0b0101, 0b1001};
+static_assert(sizeof(AUGER_PINS) / sizeof(AUGER_PINS[0]) >= NUM_AUGERS,
+              "AUGER_PINS must list pins for every auger");
 
-// Инициализация LED и моторных пинов
+// Профиль шагов шнека
+static const StepProfile feedProfile = {STEPS_BKW, STEPS_FRW, FEED_SPEED};
+
+static Stepper augers[NUM_AUGERS];
+
+// Текущее кормление шнека (для публикации по завершении)
+struct FeedJob {
+  const char* source;
+  int clip;             // Номер ролика (-1 - без ролика)
+  int base;             // Выдано до сброса (докармливание), для журнала
+  unsigned long start;
+};
+static FeedJob jobs[NUM_AUGERS];
+
+static FeederStats stats = {};
+
+// Инициализация моторов шнеков
 void feederSetup() {
-  // Настройка адресной ленты
-  FastLED.addLeds<WS2812B, LED_PIN, GRB>(leds, NUM_LEDS);
-  FastLED.setBrightness(LED_BRIGHTNESS);
-  Serial.println("[OK] LED лента инициализирована");
-  
-  // Настройка пинов драйвера мотора
-  for (byte i = 0; i < 4; i++) {
-    pinMode(MOTOR_PINS[i], OUTPUT);
+  for (uint8_t i = 0; i < NUM_AUGERS; i++) {
+    augers[i].begin(AUGER_PINS[i], feedProfile);
   }
-  Serial.println("[OK] Пины драйвера настроены");
+  LOGI("MOTOR", "Пины драйверов настроены (шнеков: %d)", NUM_AUGERS);
+  journalSetup();
+}
+
+// Мотор свободен: стоит, и завершение прошлого прогона уже забрано
+static bool augerFree(uint8_t auger) {
+  StepperStatus s = augers[auger].status();
+  return s.mode == STEPPER_IDLE && s.finishedMode == STEPPER_IDLE;
 }
 
-// Один шаг мотора
-void runMotor(int8_t dir) {
-  static byte step = 0;
-  for (byte i = 0; i < 4; i++) {
-    digitalWrite(MOTOR_PINS[i], bitRead(steps[step & 0b11], i));
+// Запуск мотора (запись в журнале уже сделана)
+static void startJob(uint8_t auger, int amount, const char* source, int base) {
+  augers[auger].start(STEPPER_RUN, amount);
+  jobs[auger].source = source;
+  jobs[auger].base = base;
+  jobs[auger].start = millis();
+  jobs[auger].clip = clipTrigger(source);
+  presenceOnFeed();
+}
+
+bool feed(uint8_t auger, int amount, const char* source) {
+  ALLOC_SCOPE(ALLOC_FEED);
+  if (auger >= NUM_AUGERS) return false;
+  if (amount <= 0) amount = feedAmount[auger];
+
+  if (!augerFree(auger)) {
+    LOGW("FEED", "Шнек %d занят, кормление пропущено", auger + 1);
+    return false;
   }
-  delayMicroseconds(FEED_SPEED);
-  step += dir;
+  // Журнал до первого шага: сброс посреди порции не пройдёт незамеченным
+  journalBegin(auger, amount, source);
+  startJob(auger, amount, source, 0);
+  LOGI("FEED", "Шнек %d: начало кормления, %d оборотов", auger + 1, amount);
+  return true;
 }
 
-// Выключаем ток на мотор
-void disableMotor() {
-  for (byte i = 0; i < 4; i++) {
-    digitalWrite(MOTOR_PINS[i], 0);
+// Докармливание прерванного сбросом кормления (feed_journal.h) - после
+// паузы, чтобы пуск мотора не совпал с подключением WiFi
+static void resumeInterrupted() {
+  if (millis() < FEED_JOURNAL_RESUME_DELAY) return;
+  for (uint8_t i = 0; i < NUM_AUGERS; i++) {
+    if (!augerFree(i)) continue;
+    JournalRecord rec;
+    if (!journalTakeResume(i, rec)) continue;
+    startJob(i, rec.target - rec.done, "resume", rec.done);
+    LOGI("FEED", "Шнек %d: докармливание, %d оборотов", i + 1, rec.target - rec.done);
   }
 }
 
-// Один оборот шнека
-void oneRev() {
-  for (int i = 0; i < STEPS_BKW; i++) runMotor(-1);
-  for (int i = 0; i < STEPS_FRW; i++) runMotor(1);
+bool feederBusy(uint8_t auger) {
+  return auger < NUM_AUGERS && augers[auger].status().mode != STEPPER_IDLE;
 }
 
-// Мигалка синим-красным при старте
-void flashLights() {
-  for (byte i = 0; i < 3; i++) {
-    leds[0] = CRGB::Blue;
-    leds[1] = CRGB::Red;
-    FastLED.show();
-    delay(200);
-    leds[0] = CRGB::Red;
-    leds[1] = CRGB::Blue;
-    FastLED.show();
-    delay(200);
-  }
-  FastLED.clear();
-  FastLED.show();
+const FeederStats& feederGetStats() {
+  return stats;
 }
 
-// Анимация во время кормления
-void feedAnimation(int revCount) {
-  static unsigned long lastUpdate = 0;
-  static byte hue = 0;
-  
-  if (millis() - lastUpdate > 50) {
-    leds[0] = CHSV(hue, 255, 255);
-    leds[1] = CHSV(hue + 128, 255, 255);
-    FastLED.show();
-    hue += 5;
-    lastUpdate = millis();
+bool calibrationStart(uint8_t auger) {
+  if (auger >= NUM_AUGERS) return false;
+  if (!augers[auger].start(STEPPER_CONTINUOUS, 0)) {
+    LOGW("CAL", "Шнек %d занят, калибровка не начата", auger + 1);
+    return false;
   }
+  ledSetCalibrating(true);
+  LOGI("CAL", "Калибровка шнека %d", auger + 1);
+  return true;
 }
 
-// Процесс кормления
-void feed(int amount) {
-  if (amount == 0) amount = feedAmount;
-  
-  Serial.printf("[FEED] Начало кормления: %d оборотов\n", amount);
-  
-  for (int i = 0; i < amount; i++) {
-    oneRev();
-    feedAnimation(i);
-    if (i % 25 == 0 && i > 0) {
-      Serial.printf("[FEED] Прогресс: %d/%d\n", i, amount);
-    }
-  }
-  
-  disableMotor();
-  FastLED.clear();
-  FastLED.show();
-  
-  Serial.println("[FEED] Кормление завершено");
+void calibrationStop(uint8_t auger) {
+  // Только калибровку: кнопку могли отпустить, когда калибровка не началась
+  // из-за идущего кормления, и оно должно выдать порцию целиком
+  if (auger < NUM_AUGERS) augers[auger].requestStop(STEPPER_CONTINUOUS);
 }
 
-// Индикация состояния системы (мигание как маяк - короткая вспышка)
-void updateStatusLed(SystemStatus status) {
-  static unsigned long lastBlink = 0;
-  static bool isBlinking = false;
-  static unsigned long blinkStart = 0;
-  
-  const uint8_t LOW_BRIGHTNESS = 15;  // Низкая яркость для индикации
-  const unsigned long FLASH_DURATION = 50;  // Длительность вспышки (мс)
-  
-  unsigned long blinkInterval;
-  CRGB color;
-  
-  // Определяем цвет и интервал в зависимости от статуса
-  switch (status) {
-    case STATUS_OK:
-      blinkInterval = 30000;  // 30 секунд
-      color = CRGB::Green;
-      break;
-    case STATUS_WIFI_ISSUE:
-      blinkInterval = 10000;  // 10 секунд
-      color = CRGB::Blue;
-      break;
-    case STATUS_ERROR:
-      blinkInterval = 3000;   // 3 секунды
-      color = CRGB::Red;
-      break;
-    default:
-      blinkInterval = 30000;
-      color = CRGB::Green;
+// Завершение кормления: метрики и публикация
+static void finishFeed(uint8_t auger, const StepperStatus& s) {
+  const FeedJob& job = jobs[auger];
+  journalEnd(auger, job.base + s.revs);
+  feedsTotal.inc();
+  feedRevolutions.inc(s.revs);
+  feedDuration.observe(millis() - job.start);
+  stats.feeds++;
+  stats.revolutions += s.revs;
+  stats.lastEpoch = timeEpoch();
+  stats.lastAuger = auger;
+  stats.lastAmount = s.revs;
+  stats.lastSource = job.source;
+
+  // Публикуется выданное мотором, а не заказанное
+  LOGI("FEED", "Шнек %d: кормление завершено, %d оборотов", auger + 1, s.revs);
+  publishLastFeeding(auger, s.revs, job.source, job.clip);
+}
+
+// Завершение калибровки: сохранение новой порции
+static void finishCalibration(uint8_t auger, const StepperStatus& s) {
+  ledSetCalibrating(false);
+  if (s.revs == 0) {
+    LOGW("CAL", "Калибровка прервана, порция не изменена");
+    return;
   }
-  
-  unsigned long now = millis();
-  
-  // Проверяем, нужно ли начать вспышку
-  if (!isBlinking && (now - lastBlink >= blinkInterval)) {
-    isBlinking = true;
-    blinkStart = now;
-    lastBlink = now;
-    
-    // Включаем светодиод с низкой яркостью
-    FastLED.setBrightness(LOW_BRIGHTNESS);
-    leds[0] = color;
-    FastLED.show();
+  feedAmount[auger] = s.revs;
+  saveSettings();
+  LOGI("BTN", "Шнек %d, новая порция: %d", auger + 1, s.revs);
+}
+
+void feederLoop() {
+  static int calReported[NUM_AUGERS];
+  static bool ledFeeding = false;
+  int done = 0;
+  int total = 0;
+
+  resumeInterrupted();
+
+  for (uint8_t i = 0; i < NUM_AUGERS; i++) {
+    StepperStatus s = augers[i].status();
+
+    if (s.mode == STEPPER_RUN) {
+      done += s.revs;
+      total += s.target;
+      journalProgress(i, jobs[i].base + s.revs);
+    } else if (s.mode == STEPPER_CONTINUOUS) {
+      if (s.revs / 20 != calReported[i] / 20) {
+        LOGI("CAL", "%d оборотов", s.revs);
+      }
+      calReported[i] = s.revs;
+    }
+
+    if (s.finishedMode == STEPPER_RUN) {
+      augers[i].clearFinished();
+      finishFeed(i, s);
+    } else if (s.finishedMode == STEPPER_CONTINUOUS) {
+      augers[i].clearFinished();
+      calReported[i] = 0;
+      finishCalibration(i, s);
+    }
   }
-  
-  // Проверяем, нужно ли выключить вспышку
-  if (isBlinking && (now - blinkStart >= FLASH_DURATION)) {
-    isBlinking = false;
-    
-    // Выключаем светодиод и восстанавливаем яркость
-    leds[0] = CRGB::Black;
-    FastLED.show();
-    FastLED.setBrightness(LED_BRIGHTNESS);
+
+  // Общий прогресс всех работающих шнеков
+  if (total > 0) {
+    if (!ledFeeding) ledFeedStart();
+    ledFeeding = true;
+    ledFeedProgress(done, total);
+  } else if (ledFeeding) {
+    ledFeedStop();
+    ledFeeding = false;
   }
 }
@@ -0,0 +1,44 @@
+/*
+  file_frame_source.cpp - Кадры из файлов вместо камеры
+*/
+
+#include "file_frame_source.h"
+#include "storage.h"
+#include <stdio.h>
+
+// Максимум файлов кадров (дальше не ищем)
+#define FILE_FRAMES_MAX 1000
+
+void FileFrameSource::framePath(char* path, size_t size, uint16_t index) const {
+  snprintf(path, size, "%s/%03u.jpg", _dir, index);
+}
+
+bool FileFrameSource::begin(FrameSize size) {
+  _size = size;
+  _next = 0;
+  _count = 0;
+  char path[64];
+  for (;;) {
+    framePath(path, sizeof(path), _count);
+    if (_count >= FILE_FRAMES_MAX || !storageExists(path)) break;
+    _count++;
+  }
+  return _count > 0;
+}
+
+bool FileFrameSource::capture(uint8_t* buf, size_t cap, FrameInfo& info) {
+  if (_count == 0) return false;
+
+  char path[64];
+  framePath(path, sizeof(path), _next);
+  _next = (_next + 1) % _count;
+
+  long len = storageFileSize(path);
+  if (len <= 0 || (size_t)len > cap) return false;
+  if (storageRead(path, 0, buf, len) != (size_t)len) return false;
+
+  info.len = len;
+  info.width = frameWidth(_size);
+  info.height = frameHeight(_size);
+  return true;
+}
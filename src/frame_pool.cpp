@@ -0,0 +1,86 @@
+/*
+  frame_pool.cpp - Пул буферов кадров в PSRAM
+*/
+
+#include "frame_pool.h"
+#include <stdlib.h>
+
+#ifdef ESP_PLATFORM
+  #include <esp_heap_caps.h>
+  static uint8_t* allocFrame(size_t size) {
+    uint8_t* p = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    return p ? p : (uint8_t*)malloc(size);
+  }
+#else
+  static uint8_t* allocFrame(size_t size) {
+    return (uint8_t*)malloc(size);
+  }
+#endif
+
+bool FramePool::begin(uint8_t slots, size_t frameMax) {
+  if (_slots) return true;
+  _slots = new FrameSlot[slots];
+  _count = slots;
+  _frameMax = frameMax;
+  for (uint8_t i = 0; i < slots; i++) {
+    _slots[i].data = allocFrame(frameMax);
+    if (!_slots[i].data) {
+      _count = i;  // Сколько поместилось
+      break;
+    }
+  }
+  // Нужен хотя бы один слот под запись и один под последний кадр
+  return _count >= 2;
+}
+
+bool FramePool::captureFrom(FrameSource& source, uint32_t nowMs) {
+  // Свободный слот: не последний и без читателей. Читатель может на миг
+  // увеличить счётчик не последнего слота (и сразу вернуть) - такой
+  // слот просто пропускаем
+  int8_t latest = _latest.load(std::memory_order_acquire);
+  FrameSlot* slot = nullptr;
+  for (uint8_t i = 0; i < _count; i++) {
+    if (i != latest && _slots[i].refs.load(std::memory_order_acquire) == 0) {
+      slot = &_slots[i];
+      break;
+    }
+  }
+  if (!slot) {
+    _droppedNoSlot.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  FrameInfo info = {};
+  if (!source.capture(slot->data, _frameMax, info)) return false;
+  info.timeMs = nowMs;
+  info.seq = ++_seq;
+  slot->info = info;
+
+  _latest.store(slot - _slots, std::memory_order_release);
+  return true;
+}
+
+FrameSlot* FramePool::acquireLatest(uint32_t newerThan) {
+  for (;;) {
+    int8_t idx = _latest.load(std::memory_order_acquire);
+    if (idx < 0) return nullptr;
+    FrameSlot* slot = &_slots[idx];
+    slot->refs.fetch_add(1, std::memory_order_acq_rel);
+    if (_latest.load(std::memory_order_acquire) == idx) {
+      if (slot->info.seq > newerThan) return slot;
+      release(slot);
+      return nullptr;
+    }
+    // Пока брали ссылку, вышел новый кадр - повторяем
+    release(slot);
+  }
+}
+
+void FramePool::release(FrameSlot* slot) {
+  if (slot) slot->refs.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+uint32_t FramePool::latestSeq() const {
+  int8_t idx = _latest.load(std::memory_order_acquire);
+  return idx < 0 ? 0 : _slots[idx].info.seq;
+}
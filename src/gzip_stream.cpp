@@ -0,0 +1,188 @@
+/*
+  gzip_stream.cpp - Потоковая распаковка gzip
+*/
+
+#include "gzip_stream.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+  #include "esp32/rom/miniz.h"
+  #include "esp_rom_crc.h"
+  static inline uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t len) {
+    return esp_rom_crc32_le(crc, data, len);
+  }
+#else
+  #include "inflate_native.h"
+  static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t len) {
+    crc = ~crc;
+    while (len--) {
+      crc ^= *data++;
+      for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+    return ~crc;
+  }
+#endif
+
+// Флаги заголовка gzip (RFC 1952)
+#define GZ_FHCRC    0x02
+#define GZ_FEXTRA   0x04
+#define GZ_FNAME    0x08
+#define GZ_FCOMMENT 0x10
+
+bool GzipStream::isGzip(const uint8_t* data, size_t len) {
+  return len >= 2 && data[0] == 0x1F && data[1] == 0x8B;
+}
+
+bool GzipStream::begin(Sink sink, void* ctx) {
+  end();
+  _inflator = malloc(sizeof(tinfl_decompressor));
+  _dict = (uint8_t*)malloc(TINFL_LZ_DICT_SIZE);
+  if (!_inflator || !_dict) {
+    end();
+    _stage = STAGE_FAILED;
+    _error = "out of memory";
+    return false;
+  }
+  tinfl_init((tinfl_decompressor*)_inflator);
+
+  _sink = sink;
+  _ctx = ctx;
+  _dictPos = 0;
+  _stage = STAGE_HEADER;
+  _flags = 0;
+  _bufLen = 0;
+  _skip = 0;
+  _crc = 0;
+  _outSize = 0;
+  _error = nullptr;
+  return true;
+}
+
+void GzipStream::end() {
+  free(_inflator);
+  free(_dict);
+  _inflator = nullptr;
+  _dict = nullptr;
+}
+
+bool GzipStream::fail(const char* error) {
+  _stage = STAGE_FAILED;
+  _error = error;
+  return false;
+}
+
+// Переход к следующему необязательному полю заголовка
+void GzipStream::nextHeaderStage() {
+  _bufLen = 0;
+  if (_stage < STAGE_EXTRA_LEN && (_flags & GZ_FEXTRA)) { _stage = STAGE_EXTRA_LEN; return; }
+  if (_stage < STAGE_NAME && (_flags & GZ_FNAME))       { _stage = STAGE_NAME; return; }
+  if (_stage < STAGE_COMMENT && (_flags & GZ_FCOMMENT)) { _stage = STAGE_COMMENT; return; }
+  if (_stage < STAGE_HCRC && (_flags & GZ_FHCRC))       { _stage = STAGE_HCRC; _skip = 2; return; }
+  _stage = STAGE_BODY;
+}
+
+// Распаковка в кольцевой словарь; заполненная часть сразу уходит приёмнику
+bool GzipStream::inflate(const uint8_t*& data, size_t& len) {
+  tinfl_decompressor* r = (tinfl_decompressor*)_inflator;
+
+  for (;;) {
+    size_t inBytes = len;
+    size_t outBytes = TINFL_LZ_DICT_SIZE - _dictPos;
+    tinfl_status st = tinfl_decompress(r, data, &inBytes, _dict, _dict + _dictPos, &outBytes,
+                                       TINFL_FLAG_HAS_MORE_INPUT);
+    data += inBytes;
+    len -= inBytes;
+
+    if (outBytes) {
+      _crc = crc32Update(_crc, _dict + _dictPos, outBytes);
+      _outSize += outBytes;
+      if (!_sink(_dict + _dictPos, outBytes, _ctx)) return fail("write failed");
+      _dictPos = (_dictPos + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+    }
+
+    if (st == TINFL_STATUS_DONE) {
+      // Целые байты, которые inflate успел забрать в битовый буфер,
+      // уже относятся к трейлеру
+      _stage = STAGE_TRAILER;
+      _bufLen = 0;
+      for (uint32_t n = r->m_num_bits / 8; n > 0 && _bufLen < sizeof(_buf); n--) {
+        _buf[_bufLen++] = (uint8_t)r->m_bit_buf;
+        r->m_bit_buf >>= 8;
+      }
+      return true;
+    }
+    if (st < 0) return fail("corrupt deflate stream");
+    if (st == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) return true;
+    if (inBytes == 0 && outBytes == 0) return fail("inflate stalled");
+  }
+}
+
+bool GzipStream::write(const uint8_t* data, size_t len) {
+  while (len > 0) {
+    switch (_stage) {
+      case STAGE_HEADER:
+        _buf[_bufLen++] = *data++;
+        len--;
+        if (_bufLen < 10) break;
+        if (_buf[0] != 0x1F || _buf[1] != 0x8B) return fail("not a gzip stream");
+        if (_buf[2] != 8) return fail("unsupported compression method");
+        _flags = _buf[3];
+        nextHeaderStage();
+        break;
+
+      case STAGE_EXTRA_LEN:
+        _buf[_bufLen++] = *data++;
+        len--;
+        if (_bufLen < 2) break;
+        _skip = _buf[0] | (_buf[1] << 8);
+        _stage = STAGE_EXTRA;
+        if (_skip == 0) nextHeaderStage();
+        break;
+
+      case STAGE_EXTRA:
+      case STAGE_HCRC: {
+        size_t n = len < _skip ? len : _skip;
+        data += n;
+        len -= n;
+        _skip -= n;
+        if (_skip == 0) nextHeaderStage();
+        break;
+      }
+
+      case STAGE_NAME:
+      case STAGE_COMMENT: {
+        uint8_t c = *data++;
+        len--;
+        if (c == 0) nextHeaderStage();
+        break;
+      }
+
+      case STAGE_BODY:
+        if (!inflate(data, len)) return false;
+        break;
+
+      case STAGE_TRAILER:
+        while (len > 0 && _bufLen < 8) {
+          _buf[_bufLen++] = *data++;
+          len--;
+        }
+        if (_bufLen == 8) {
+          uint32_t crc = _buf[0] | (_buf[1] << 8) | (_buf[2] << 16) | ((uint32_t)_buf[3] << 24);
+          uint32_t size = _buf[4] | (_buf[5] << 8) | (_buf[6] << 16) | ((uint32_t)_buf[7] << 24);
+          if (crc != _crc) return fail("CRC mismatch");
+          if (size != _outSize) return fail("size mismatch");
+          _stage = STAGE_DONE;
+        }
+        break;
+
+      case STAGE_DONE:
+        // Данные после конца потока игнорируются
+        return true;
+
+      case STAGE_FAILED:
+        return false;
+    }
+  }
+  return _stage != STAGE_FAILED;
+}
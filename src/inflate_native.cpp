@@ -0,0 +1,341 @@
+/*
+  inflate_native.cpp - Inflate (RFC 1951) для сборки на хосте
+
+  Декодер Хаффмана - канонические коды по числу кодов каждой длины
+  (как в puff из zlib). Состояние целиком в tinfl_decompressor: каждый шаг
+  (заголовок блока, длина с доп. битами, дистанция) выполняется, только
+  когда для него хватает бит, иначе распаковка останавливается
+  и продолжается со следующим куском входа.
+*/
+
+#ifndef ESP_PLATFORM
+
+#include "inflate_native.h"
+#include <string.h>
+
+enum InflateState : uint32_t {
+  ST_BLOCK,         // Заголовок блока: BFINAL, BTYPE
+  ST_STORED_LEN,    // Хранимый блок: LEN, NLEN
+  ST_STORED,        // Хранимый блок: данные
+  ST_DYN_HEADER,    // HLIT, HDIST, HCLEN
+  ST_DYN_CLEN,      // Длины кодов длин
+  ST_DYN_LENS,      // Длины кодов литералов и дистанций
+  ST_LITLEN,        // Литерал, конец блока или длина копии
+  ST_DIST,          // Дистанция копии
+  ST_COPY,          // Копирование из словаря
+  ST_DONE,
+  ST_FAILED
+};
+
+static const uint16_t LEN_BASE[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t LEN_EXTRA[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t DIST_BASE[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+  1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t DIST_EXTRA[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+static const uint8_t CLEN_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+#define DECODE_NEED_BITS -1
+#define DECODE_INVALID -2
+
+// Таблица по длинам кодов: 0 - код полный, >0 - неполный, <0 - переполнен
+static int buildHuff(TinflHuff& h, const uint8_t* lens, int n) {
+  memset(h.count, 0, sizeof(h.count));
+  for (int i = 0; i < n; i++) h.count[lens[i]]++;
+  if (h.count[0] == n) return 0;
+
+  int left = 1;
+  for (int len = 1; len < 16; len++) {
+    left <<= 1;
+    left -= h.count[len];
+    if (left < 0) return left;
+  }
+
+  uint16_t offs[16];
+  offs[1] = 0;
+  for (int len = 1; len < 15; len++) offs[len + 1] = offs[len] + h.count[len];
+  for (int i = 0; i < n; i++) {
+    if (lens[i]) h.symbol[offs[lens[i]]++] = i;
+  }
+  return left;
+}
+
+// Символ по битам buf без их извлечения: used - длина кода
+static int decode(const TinflHuff& h, uint64_t buf, uint32_t avail, uint32_t& used) {
+  int code = 0, first = 0, index = 0;
+  for (uint32_t len = 1; len < 16; len++) {
+    if (len > avail) return DECODE_NEED_BITS;
+    code |= (int)(buf & 1);
+    buf >>= 1;
+    int count = h.count[len];
+    if (code - count < first) {
+      used = len;
+      return h.symbol[index + (code - first)];
+    }
+    index += count;
+    first += count;
+    first <<= 1;
+    code <<= 1;
+  }
+  return DECODE_INVALID;
+}
+
+// Фиксированные коды (BTYPE 01)
+static void fixedTables(tinfl_decompressor* r) {
+  uint8_t* lens = r->m_lens;
+  int i = 0;
+  for (; i < 144; i++) lens[i] = 8;
+  for (; i < 256; i++) lens[i] = 9;
+  for (; i < 280; i++) lens[i] = 7;
+  for (; i < 288; i++) lens[i] = 8;
+  buildHuff(r->m_lit, lens, 288);
+  memset(lens + 288, 5, 30);
+  buildHuff(r->m_distcode, lens + 288, 30);
+}
+
+// Неполный код допустим, только если в нём один символ (RFC 1951, 3.2.7)
+static bool huffValid(int err, int n, const TinflHuff& h) {
+  return err == 0 || (err > 0 && n - h.count[0] == 1);
+}
+
+tinfl_status tinfl_decompress(tinfl_decompressor* r, const uint8_t* pIn_buf_next, size_t* pIn_buf_size,
+                              uint8_t* pOut_buf_start, uint8_t* pOut_buf_next, size_t* pOut_buf_size,
+                              uint32_t decomp_flags) {
+  const uint8_t* in = pIn_buf_next;
+  const uint8_t* inEnd = in + *pIn_buf_size;
+  uint8_t* out = pOut_buf_next;
+  uint8_t* outEnd = out + *pOut_buf_size;
+  const size_t mask = TINFL_LZ_DICT_SIZE - 1;
+  tinfl_status status;
+  uint32_t used, extra;
+  int sym;
+
+  // Вход в битовый буфер с запасом, пока помещаются целые байты
+  auto fill = [&]() {
+    while (r->m_num_bits <= 56 && in < inEnd) {
+      r->m_bit_buf |= (uint64_t)*in++ << r->m_num_bits;
+      r->m_num_bits += 8;
+    }
+  };
+  auto bits = [&](uint32_t n) { return (uint32_t)(r->m_bit_buf & ((1ull << n) - 1)); };
+  auto drop = [&](uint32_t n) {
+    r->m_bit_buf >>= n;
+    r->m_num_bits -= n;
+  };
+  auto put = [&](uint8_t c) {
+    *out++ = c;
+    if (r->m_total < TINFL_LZ_DICT_SIZE) r->m_total++;
+  };
+  auto endBlock = [&]() {
+    if (r->m_final) {
+      // Остаток байта после потока - выравнивание
+      drop(r->m_num_bits & 7);
+      r->m_state = ST_DONE;
+    } else {
+      r->m_state = ST_BLOCK;
+    }
+  };
+
+  for (;;) {
+    switch (r->m_state) {
+      case ST_BLOCK: {
+        fill();
+        if (r->m_num_bits < 3) goto need_input;
+        r->m_final = bits(1);
+        uint32_t type = bits(3) >> 1;
+        drop(3);
+        if (type == 0) {
+          drop(r->m_num_bits & 7);
+          r->m_state = ST_STORED_LEN;
+        } else if (type == 1) {
+          fixedTables(r);
+          r->m_state = ST_LITLEN;
+        } else if (type == 2) {
+          r->m_state = ST_DYN_HEADER;
+        } else {
+          goto fail;
+        }
+        break;
+      }
+
+      case ST_STORED_LEN: {
+        fill();
+        if (r->m_num_bits < 32) goto need_input;
+        uint32_t len = bits(16);
+        uint32_t nlen = (uint32_t)(r->m_bit_buf >> 16) & 0xFFFF;
+        drop(32);
+        if (len != (~nlen & 0xFFFF)) goto fail;
+        r->m_counter = len;
+        r->m_state = ST_STORED;
+        break;
+      }
+
+      case ST_STORED:
+        // Сначала байты, уже забранные в битовый буфер, затем вход напрямую
+        while (r->m_counter) {
+          if (out == outEnd) goto more_output;
+          if (r->m_num_bits >= 8) {
+            put(bits(8));
+            drop(8);
+          } else if (in < inEnd) {
+            put(*in++);
+          } else {
+            goto need_input;
+          }
+          r->m_counter--;
+        }
+        endBlock();
+        break;
+
+      case ST_DYN_HEADER:
+        fill();
+        if (r->m_num_bits < 14) goto need_input;
+        r->m_nlen = bits(5) + 257;
+        drop(5);
+        r->m_ndist = bits(5) + 1;
+        drop(5);
+        r->m_ncode = bits(4) + 4;
+        drop(4);
+        if (r->m_nlen > 286 || r->m_ndist > 30) goto fail;
+        r->m_index = 0;
+        r->m_state = ST_DYN_CLEN;
+        break;
+
+      case ST_DYN_CLEN:
+        for (; r->m_index < 19; r->m_index++) {
+          uint8_t len = 0;
+          if (r->m_index < r->m_ncode) {
+            fill();
+            if (r->m_num_bits < 3) goto need_input;
+            len = bits(3);
+            drop(3);
+          }
+          r->m_lens[CLEN_ORDER[r->m_index]] = len;
+        }
+        if (buildHuff(r->m_clen, r->m_lens, 19) != 0) goto fail;
+        r->m_index = 0;
+        r->m_state = ST_DYN_LENS;
+        break;
+
+      case ST_DYN_LENS: {
+        uint32_t total = r->m_nlen + r->m_ndist;
+        while (r->m_index < total) {
+          fill();
+          sym = decode(r->m_clen, r->m_bit_buf, r->m_num_bits, used);
+          if (sym == DECODE_NEED_BITS) goto need_input;
+          if (sym < 0) goto fail;
+          if (sym < 16) {
+            drop(used);
+            r->m_lens[r->m_index++] = sym;
+            continue;
+          }
+          // Повтор: 16 - предыдущей длины 3..6 раз, 17 - нуля 3..10, 18 - нуля 11..138
+          extra = sym == 16 ? 2 : sym == 17 ? 3 : 7;
+          if (r->m_num_bits < used + extra) goto need_input;
+          drop(used);
+          uint32_t rep = bits(extra) + (sym == 18 ? 11 : 3);
+          drop(extra);
+          uint8_t val = 0;
+          if (sym == 16) {
+            if (r->m_index == 0) goto fail;
+            val = r->m_lens[r->m_index - 1];
+          }
+          if (r->m_index + rep > total) goto fail;
+          while (rep--) r->m_lens[r->m_index++] = val;
+        }
+        if (r->m_lens[256] == 0) goto fail;   // Нет кода конца блока
+        int err = buildHuff(r->m_lit, r->m_lens, r->m_nlen);
+        if (!huffValid(err, r->m_nlen, r->m_lit)) goto fail;
+        err = buildHuff(r->m_distcode, r->m_lens + r->m_nlen, r->m_ndist);
+        if (!huffValid(err, r->m_ndist, r->m_distcode)) goto fail;
+        r->m_state = ST_LITLEN;
+        break;
+      }
+
+      case ST_LITLEN:
+        for (;;) {
+          if (out == outEnd) goto more_output;
+          fill();
+          sym = decode(r->m_lit, r->m_bit_buf, r->m_num_bits, used);
+          if (sym == DECODE_NEED_BITS) goto need_input;
+          if (sym < 0) goto fail;
+          if (sym < 256) {
+            drop(used);
+            put(sym);
+            continue;
+          }
+          if (sym == 256) {
+            drop(used);
+            endBlock();
+            break;
+          }
+          sym -= 257;
+          if (sym >= 29) goto fail;
+          extra = LEN_EXTRA[sym];
+          if (r->m_num_bits < used + extra) goto need_input;
+          drop(used);
+          r->m_counter = LEN_BASE[sym] + bits(extra);
+          drop(extra);
+          r->m_state = ST_DIST;
+          break;
+        }
+        break;
+
+      case ST_DIST:
+        fill();
+        sym = decode(r->m_distcode, r->m_bit_buf, r->m_num_bits, used);
+        if (sym == DECODE_NEED_BITS) goto need_input;
+        if (sym < 0 || sym >= 30) goto fail;
+        extra = DIST_EXTRA[sym];
+        if (r->m_num_bits < used + extra) goto need_input;
+        drop(used);
+        r->m_dist = DIST_BASE[sym] + bits(extra);
+        drop(extra);
+        if (r->m_dist > r->m_total) goto fail;   // Ссылка до начала потока
+        r->m_state = ST_COPY;
+        break;
+
+      case ST_COPY:
+        while (r->m_counter) {
+          if (out == outEnd) goto more_output;
+          size_t pos = out - pOut_buf_start;
+          put(pOut_buf_start[(pos - r->m_dist) & mask]);
+          r->m_counter--;
+        }
+        r->m_state = ST_LITLEN;
+        break;
+
+      case ST_DONE:
+        status = TINFL_STATUS_DONE;
+        goto done;
+
+      default:
+        goto fail;
+    }
+  }
+
+need_input:
+  status = (decomp_flags & TINFL_FLAG_HAS_MORE_INPUT) ? TINFL_STATUS_NEEDS_MORE_INPUT
+                                                     : TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS;
+  goto done;
+more_output:
+  status = TINFL_STATUS_HAS_MORE_OUTPUT;
+  goto done;
+fail:
+  r->m_state = ST_FAILED;
+  status = TINFL_STATUS_FAILED;
+done:
+  *pIn_buf_size = in - pIn_buf_next;
+  *pOut_buf_size = out - pOut_buf_next;
+  return status;
+}
+
+#endif // ESP_PLATFORM
@@ -0,0 +1,276 @@
+/*
+  json_stream.cpp - Потоковый разбор JSON без выделения памяти
+*/
+
+#include "json_stream.h"
+#include <string.h>
+
+void JsonStream::begin(ValueFn fn, void* ctx) {
+  _fn = fn;
+  _ctx = ctx;
+  _state = ST_VALUE;
+  _depth = 0;
+  _tokenLen = 0;
+  _escape = false;
+  _unicode = 0;
+  _offset = 0;
+}
+
+const char* JsonStream::key(uint8_t level) const {
+  return (level >= 1 && level <= _depth) ? _levels[level].key : "";
+}
+
+int JsonStream::index(uint8_t level) const {
+  return (level >= 1 && level <= _depth && _levels[level].array) ? _levels[level].index : -1;
+}
+
+bool JsonStream::feed(const char* data, size_t len) {
+  for (size_t i = 0; i < len && _state != ST_ERROR; i++) {
+    step(data[i]);
+    if (_state != ST_ERROR) _offset++;
+  }
+  return _state != ST_ERROR;
+}
+
+void JsonStream::emit(JsonType type, const char* text) {
+  if (_fn) _fn(_ctx, *this, type, text);
+}
+
+void JsonStream::append(char c) {
+  if (_tokenLen >= JSON_TOKEN_LEN - 1) {
+    fail();
+    return;
+  }
+  _token[_tokenLen++] = c;
+}
+
+// \uXXXX в UTF-8 (суррогатные пары не собираются - хватает для настроек)
+void JsonStream::appendUtf8(uint16_t code) {
+  if (code < 0x80) {
+    append(code);
+  } else if (code < 0x800) {
+    append(0xC0 | (code >> 6));
+    append(0x80 | (code & 0x3F));
+  } else {
+    append(0xE0 | (code >> 12));
+    append(0x80 | ((code >> 6) & 0x3F));
+    append(0x80 | (code & 0x3F));
+  }
+}
+
+bool JsonStream::push(bool array) {
+  if (_depth >= JSON_MAX_DEPTH) {
+    fail();
+    return false;
+  }
+  Level& l = _levels[++_depth];
+  l.array = array;
+  l.index = 0;
+  l.key[0] = '\0';
+  return true;
+}
+
+void JsonStream::pop(bool array) {
+  if (_depth == 0 || _levels[_depth].array != array) {
+    fail();
+    return;
+  }
+  _depth--;
+  afterValue();
+}
+
+void JsonStream::afterValue() {
+  _state = _depth == 0 ? ST_DONE : ST_NEXT;
+}
+
+void JsonStream::startValue(char c) {
+  switch (c) {
+    case '{':
+      emit(JSON_OBJECT, "");
+      if (push(false)) _state = ST_FIRST_KEY;
+      break;
+    case '[':
+      emit(JSON_ARRAY, "");
+      if (push(true)) _state = ST_FIRST_VALUE;
+      break;
+    case '"':
+      _tokenLen = 0;
+      _isKey = false;
+      _state = ST_STRING;
+      break;
+    default:
+      if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+        _tokenLen = 0;
+        append(c);
+        _state = ST_LITERAL;
+      } else {
+        fail();
+      }
+      break;
+  }
+}
+
+void JsonStream::finishString() {
+  _token[_tokenLen] = '\0';
+  if (_isKey) {
+    Level& l = _levels[_depth];
+    strncpy(l.key, _token, JSON_KEY_LEN - 1);
+    l.key[JSON_KEY_LEN - 1] = '\0';
+    _state = ST_COLON;
+  } else {
+    emit(JSON_STRING, _token);
+    afterValue();
+  }
+}
+
+static bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// Символы числа: знаки, точка, экспонента и цифры
+static bool isNumberChar(char c) {
+  return isDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+// Число по грамматике JSON: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+// (strtod принял бы и nan, inf, 0x10, 01 и "1.")
+static bool validNumber(const char* s) {
+  if (*s == '-') s++;
+  if (*s == '0') {
+    s++;
+  } else if (isDigit(*s)) {
+    while (isDigit(*s)) s++;
+  } else {
+    return false;
+  }
+  if (*s == '.') {
+    s++;
+    if (!isDigit(*s)) return false;
+    while (isDigit(*s)) s++;
+  }
+  if (*s == 'e' || *s == 'E') {
+    s++;
+    if (*s == '+' || *s == '-') s++;
+    if (!isDigit(*s)) return false;
+    while (isDigit(*s)) s++;
+  }
+  return *s == '\0';
+}
+
+void JsonStream::finishLiteral() {
+  _token[_tokenLen] = '\0';
+  if (strcmp(_token, "true") == 0) {
+    emit(JSON_TRUE, "");
+  } else if (strcmp(_token, "false") == 0) {
+    emit(JSON_FALSE, "");
+  } else if (strcmp(_token, "null") == 0) {
+    emit(JSON_NULL, "");
+  } else if (validNumber(_token)) {
+    emit(JSON_NUMBER, _token);
+  } else {
+    fail();
+    return;
+  }
+  afterValue();
+}
+
+void JsonStream::step(char c) {
+  if (_state == ST_STRING) {
+    if (_unicode) {
+      uint8_t v;
+      if (c >= '0' && c <= '9') v = c - '0';
+      else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+      else return fail();
+      _code = (_code << 4) | v;
+      if (--_unicode == 0) appendUtf8(_code);
+      return;
+    }
+    if (_escape) {
+      _escape = false;
+      switch (c) {
+        case 'n': append('\n'); break;
+        case 't': append('\t'); break;
+        case 'r': append('\r'); break;
+        case 'b': append('\b'); break;
+        case 'f': append('\f'); break;
+        case 'u': _unicode = 4; _code = 0; break;
+        case '"': case '\\': case '/': append(c); break;
+        default: fail(); break;
+      }
+      return;
+    }
+    if (c == '\\') {
+      _escape = true;
+    } else if (c == '"') {
+      finishString();
+    } else if ((uint8_t)c < 0x20) {
+      fail();
+    } else {
+      append(c);
+    }
+    return;
+  }
+
+  // Литерал кончается на первом чужом символе, который разбирается дальше:
+  // у числа свои символы, у true/false/null - строчные буквы
+  if (_state == ST_LITERAL) {
+    bool word = _token[0] >= 'a' && _token[0] <= 'z';
+    if (word ? (c >= 'a' && c <= 'z') : isNumberChar(c)) {
+      append(c);
+      return;
+    }
+    finishLiteral();
+    if (_state == ST_ERROR) return;
+  }
+
+  if (c == ' ' || c == '\t' || c == '\r' || c == '\n') return;
+
+  switch (_state) {
+    case ST_FIRST_VALUE:
+      if (c == ']') {
+        pop(true);
+        return;
+      }
+      startValue(c);
+      break;
+    case ST_VALUE:
+      startValue(c);
+      break;
+    case ST_FIRST_KEY:
+      if (c == '}') {
+        pop(false);
+        return;
+      }
+      // fallthrough
+    case ST_KEY:
+      if (c != '"') return fail();
+      _tokenLen = 0;
+      _isKey = true;
+      _state = ST_STRING;
+      break;
+    case ST_COLON:
+      if (c != ':') return fail();
+      _state = ST_VALUE;
+      break;
+    case ST_NEXT:
+      if (c == ',') {
+        Level& l = _levels[_depth];
+        if (l.array) {
+          l.index++;
+          _state = ST_VALUE;
+        } else {
+          _state = ST_KEY;
+        }
+      } else if (c == '}' || c == ']') {
+        pop(c == ']');
+      } else {
+        fail();
+      }
+      break;
+    default:
+      // После корневого значения - только пробелы
+      fail();
+      break;
+  }
+}
@@ -0,0 +1,299 @@
+/*
+  led_engine.cpp - Неблокирующая индикация на адресных светодиодах
+
+  Состояние слоёв меняется из loop() и колбэков OTA под ledMux, отрисовка
+  идёт в задаче esp_timer: копия состояния -> сборка кадра -> сравнение
+  с показанным -> FastLED.show() только при изменении. Яркость слоя
+  задаётся масштабированием цвета, глобальная яркость FastLED не меняется.
+
+  Таймер однократный: каждый слой сообщает, когда его картинка сменится,
+  и следующий кадр взводится на ближайшую смену. Анимации идут кадрами
+  LED_FRAME_MS, а в покое (один маяк) таймер срабатывает только на фронтах
+  вспышки маяка. Пока таймер спит дольше кадра, смена состояния слоя
+  будит его сразу.
+*/
+
+#include "led_engine.h"
+#include "metrics.h"
+#include "logger.h"
+#include <FastLED.h>
+#include <esp_timer.h>
+
+// Состояние слоёв
+struct LedState {
+  SystemStatus status;
+  uint32_t statusSince;
+  bool wifiConnecting;
+  bool feeding;
+  bool calibrating;
+  uint32_t feedStart;
+  int feedDone;
+  int feedTotal;
+  bool ota;
+  uint8_t otaPercent;
+  bool flashActive;
+  LedFlash flash;
+  uint32_t flashStart;
+};
+
+static LedState state = {STATUS_OK, 0, false, false, false, 0, 0, 0, false, 0, false, LED_FLASH_OK, 0};
+static portMUX_TYPE ledMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t stateVersion = 0;   // Растёт при каждой смене состояния (под ledMux)
+static bool timerSleeping = false;  // Таймер взведён дольше кадра (под ledMux)
+
+// Кадр не меняется сам по себе
+#define LED_STATIC UINT32_MAX
+
+// Показанный кадр (меняется только задачей отрисовки)
+static CRGB leds[NUM_LEDS];
+static esp_timer_handle_t frameTimer = nullptr;
+
+static Counter ledFrames("feeder_led_frames_total", "LED frames composed");
+static Counter ledShows("feeder_led_shows_total", "LED frames sent to the strip");
+
+// До смены картинки циклического эффекта с периодом period (мс)
+static uint32_t untilNextStep(uint32_t elapsed, uint32_t period) {
+  return period - elapsed % period;
+}
+
+// Смешивание пикселя слоя с кадром
+static inline void blendPixel(CRGB* frame, int i, CRGB color, uint8_t brightness, uint8_t alpha) {
+  color.nscale8_video(brightness);
+  nblend(frame[i], color, alpha);
+}
+
+// Прозрачность затухания к концу эффекта
+static uint8_t fadeAlpha(uint32_t elapsed, uint32_t duration) {
+  if (elapsed + LED_FADE_MS < duration) return 255;
+  uint32_t left = duration > elapsed ? duration - elapsed : 0;
+  return left * 255 / LED_FADE_MS;
+}
+
+// Слои рисуют свою часть кадра и возвращают, через сколько мс она
+// сменится (LED_STATIC - только при смене состояния)
+
+// Маяк: короткая вспышка первого светодиода с низкой яркостью
+static uint32_t renderStatus(const LedState& s, uint32_t now, CRGB* frame) {
+  uint32_t interval;
+  CRGB color;
+  switch (s.status) {
+    case STATUS_WIFI_ISSUE: interval = LED_BEACON_WIFI_PERIOD;  color = CRGB::Blue;  break;
+    case STATUS_ERROR:      interval = LED_BEACON_ERROR_PERIOD; color = CRGB::Red;   break;
+    default:                interval = LED_BEACON_OK_PERIOD;    color = CRGB::Green; break;
+  }
+  uint32_t phase = (now - s.statusSince) % interval;
+  if (phase < LED_BEACON_MS) {
+    blendPixel(frame, 0, color, LED_STATUS_BRIGHTNESS, 255);
+    return LED_BEACON_MS - phase;
+  }
+  return interval - phase;
+}
+
+// Подключение WiFi: жёлтое перемигивание раз в 500 мс
+static uint32_t renderWifi(const LedState& s, uint32_t now, CRGB* frame) {
+  if (!s.wifiConnecting) return LED_STATIC;
+  bool phase = (now / 500) & 1;
+  blendPixel(frame, 0, phase ? CRGB::Black : CRGB::Yellow, LED_BRIGHTNESS, 255);
+  blendPixel(frame, 1, phase ? CRGB::Yellow : CRGB::Black, LED_BRIGHTNESS, 255);
+  return untilNextStep(now, 500);
+}
+
+// Кормление: радуга на первом, прогресс от красного к зелёному на втором
+static uint32_t renderFeed(const LedState& s, uint32_t now, CRGB* frame) {
+  if (s.calibrating) {
+    for (int i = 0; i < NUM_LEDS; i++) blendPixel(frame, i, CRGB::Green, LED_BRIGHTNESS, 255);
+    return LED_STATIC;
+  }
+  if (!s.feeding) return LED_STATIC;
+
+  uint32_t elapsed = now - s.feedStart;
+  uint8_t hue = elapsed / 50 * 5;
+  uint8_t progressHue = s.feedTotal > 0 ? s.feedDone * HUE_GREEN / s.feedTotal : 0;
+  blendPixel(frame, 0, CHSV(hue, 255, 255), LED_BRIGHTNESS, 255);
+  blendPixel(frame, 1, CHSV(progressHue, 255, 255), LED_BRIGHTNESS, 255);
+  return untilNextStep(elapsed, 50);
+}
+
+// OTA: фиолетовый, второй светодиод разгорается по прогрессу
+static uint32_t renderOta(const LedState& s, CRGB* frame) {
+  if (!s.ota) return LED_STATIC;
+  blendPixel(frame, 0, CRGB::Purple, LED_BRIGHTNESS, 255);
+  blendPixel(frame, 1, CRGB::Purple, LED_BRIGHTNESS, 64 + s.otaPercent * 191 / 100);
+  return LED_STATIC;
+}
+
+// Вспышки с затуханием в конце
+static uint32_t renderFlash(const LedState& s, uint32_t now, CRGB* frame) {
+  if (!s.flashActive) return LED_STATIC;
+  uint32_t elapsed = now - s.flashStart;
+
+  switch (s.flash) {
+    case LED_FLASH_BOOT: {
+      if (elapsed >= 1200) return LED_STATIC;
+      bool swap = (elapsed / 200) & 1;
+      blendPixel(frame, 0, swap ? CRGB::Red : CRGB::Blue, LED_BRIGHTNESS, 255);
+      blendPixel(frame, 1, swap ? CRGB::Blue : CRGB::Red, LED_BRIGHTNESS, 255);
+      return untilNextStep(elapsed, 200);
+    }
+    case LED_FLASH_OK:
+    case LED_FLASH_FAIL: {
+      uint32_t duration = s.flash == LED_FLASH_OK ? 1000 : 2000;
+      if (elapsed >= duration) return LED_STATIC;
+      CRGB color = s.flash == LED_FLASH_OK ? CRGB::Green : CRGB::Red;
+      uint8_t alpha = fadeAlpha(elapsed, duration);
+      for (int i = 0; i < NUM_LEDS; i++) blendPixel(frame, i, color, LED_BRIGHTNESS, alpha);
+      // До затухания картинка стоит, затухание - покадрово
+      return elapsed + LED_FADE_MS < duration ? duration - LED_FADE_MS - elapsed : 0;
+    }
+  }
+  return LED_STATIC;
+}
+
+// Взвести таймер через delayMs (под ledMux). Работающий таймер
+// останавливается: esp_timer не перезапускает взведённый
+static void armTimer(uint32_t delayMs) {
+  timerSleeping = delayMs > LED_FRAME_MS;
+  esp_timer_stop(frameTimer);
+  esp_timer_start_once(frameTimer, (uint64_t)delayMs * 1000);
+}
+
+// Отрисовка кадра (задача esp_timer)
+static void renderFrame(void*) {
+  LedState s;
+  uint32_t version;
+  portENTER_CRITICAL(&ledMux);
+  s = state;
+  version = stateVersion;
+  portEXIT_CRITICAL(&ledMux);
+
+  uint32_t now = millis();
+  CRGB frame[NUM_LEDS];
+  for (int i = 0; i < NUM_LEDS; i++) frame[i] = CRGB::Black;
+
+  uint32_t next = renderStatus(s, now, frame);
+  next = min(next, renderWifi(s, now, frame));
+  next = min(next, renderFeed(s, now, frame));
+  next = min(next, renderOta(s, frame));
+  next = min(next, renderFlash(s, now, frame));
+  ledFrames.inc();
+
+  if (memcmp(frame, leds, sizeof(frame)) != 0) {
+    memcpy(leds, frame, sizeof(frame));
+    FastLED.show();
+    ledShows.inc();
+  }
+
+  // Не чаще кадра; состояние сменилось за время отрисовки - следующий кадр сразу
+  if (next < LED_FRAME_MS) next = LED_FRAME_MS;
+  portENTER_CRITICAL(&ledMux);
+  armTimer(stateVersion != version ? LED_FRAME_MS : next);
+  portEXIT_CRITICAL(&ledMux);
+}
+
+// Состояние слоя изменилось (под ledMux): спящий таймер будится
+static void stateChanged() {
+  stateVersion++;
+  if (timerSleeping && frameTimer) armTimer(0);
+}
+
+void ledSetup() {
+  FastLED.addLeds<WS2812B, LED_PIN, GRB>(leds, NUM_LEDS);
+  FastLED.clear(true);
+
+  esp_timer_create_args_t args = {};
+  args.callback = renderFrame;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "led";
+  if (esp_timer_create(&args, &frameTimer) != ESP_OK ||
+      esp_timer_start_once(frameTimer, 0) != ESP_OK) {
+    frameTimer = nullptr;
+    LOGE("LED", "Не удалось запустить таймер отрисовки");
+    return;
+  }
+  LOGI("LED", "Лента инициализирована");
+}
+
+void ledSetStatus(SystemStatus status) {
+  portENTER_CRITICAL(&ledMux);
+  if (state.status != status) {
+    state.status = status;
+    state.statusSince = millis();
+    stateChanged();
+  }
+  portEXIT_CRITICAL(&ledMux);
+}
+
+void ledSetWifiConnecting(bool active) {
+  portENTER_CRITICAL(&ledMux);
+  if (state.wifiConnecting != active) {
+    state.wifiConnecting = active;
+    stateChanged();
+  }
+  portEXIT_CRITICAL(&ledMux);
+}
+
+void ledFeedStart() {
+  portENTER_CRITICAL(&ledMux);
+  state.feeding = true;
+  state.feedStart = millis();
+  state.feedDone = 0;
+  state.feedTotal = 0;
+  stateChanged();
+  portEXIT_CRITICAL(&ledMux);
+}
+
+void ledFeedProgress(int done, int total) {
+  portENTER_CRITICAL(&ledMux);
+  if (state.feedDone != done || state.feedTotal != total) {
+    state.feedDone = done;
+    state.feedTotal = total;
+    stateChanged();
+  }
+  portEXIT_CRITICAL(&ledMux);
+}
+
+void ledFeedStop() {
+  portENTER_CRITICAL(&ledMux);
+  state.feeding = false;
+  stateChanged();
+  portEXIT_CRITICAL(&ledMux);
+}
+
+void ledSetCalibrating(bool active) {
+  portENTER_CRITICAL(&ledMux);
+  state.calibrating = active;
+  stateChanged();
+  portEXIT_CRITICAL(&ledMux);
+}
+
+void ledOtaStart() {
+  portENTER_CRITICAL(&ledMux);
+  state.ota = true;
+  state.otaPercent = 0;
+  stateChanged();
+  portEXIT_CRITICAL(&ledMux);
+}
+
+void ledOtaProgress(uint8_t percent) {
+  portENTER_CRITICAL(&ledMux);
+  state.otaPercent = percent > 100 ? 100 : percent;
+  stateChanged();
+  portEXIT_CRITICAL(&ledMux);
+}
+
+void ledOtaEnd(bool ok) {
+  portENTER_CRITICAL(&ledMux);
+  state.ota = false;
+  stateChanged();
+  portEXIT_CRITICAL(&ledMux);
+  ledFlash(ok ? LED_FLASH_OK : LED_FLASH_FAIL);
+}
+
+void ledFlash(LedFlash flash) {
+  portENTER_CRITICAL(&ledMux);
+  state.flashActive = true;
+  state.flash = flash;
+  state.flashStart = millis();
+  stateChanged();
+  portEXIT_CRITICAL(&ledMux);
+}
@@ -0,0 +1,291 @@
+/*
+  logger.cpp - Асинхронное журналирование с уровнями и тегами
+
+  Очередь - ограниченная MPMC очередь Вьюкова: каждый слот хранит
+  порядковый номер, производители резервируют слот через CAS и пишут
+  в него без блокировок. При переполнении сообщение отбрасывается
+  (вызывающий никогда не ждёт UART).
+*/
+
+#include "logger.h"
+#include "metrics.h"
+#include "storage.h"
+#include <atomic>
+#include <stdarg.h>
+#include <time.h>
+
+static_assert((LOG_QUEUE_SLOTS & (LOG_QUEUE_SLOTS - 1)) == 0, "LOG_QUEUE_SLOTS must be a power of two");
+
+// Слот очереди
+struct LogSlot {
+  std::atomic<uint32_t> seq;
+  uint32_t timeMs;
+  uint8_t level;
+  char text[LOG_LINE_LEN];  // "[TAG] сообщение"
+};
+
+// Строка истории для удалённого просмотра
+struct LogTailLine {
+  uint32_t id;
+  uint32_t timeMs;
+  uint8_t level;
+  char text[LOG_LINE_LEN];
+};
+
+static LogSlot queue[LOG_QUEUE_SLOTS];
+static std::atomic<uint32_t> enqueuePos(0);
+static uint32_t dequeuePos = 0;  // Только задача вывода
+
+static LogTailLine tail[LOG_TAIL_LINES];
+static uint32_t tailNextId = 0;
+static portMUX_TYPE tailMux = portMUX_INITIALIZER_UNLOCKED;
+
+static bool started = false;
+
+// Номера слотов задаются при статической инициализации, чтобы сообщения
+// до logSetup() не терялись (они будут выведены после запуска задачи)
+static struct LogQueueInit {
+  LogQueueInit() {
+    for (uint32_t i = 0; i < LOG_QUEUE_SLOTS; i++) {
+      queue[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+} logQueueInit;
+
+static Counter logLines("feeder_log_lines_total", "Log lines written");
+static Counter logDropped("feeder_log_dropped_total", "Log lines dropped on queue overflow");
+static Counter logFileErrors("feeder_log_file_errors_total", "Log lines not written to flash");
+
+char logLevelChar(uint8_t level) {
+  switch (level) {
+    case LOG_LVL_ERROR: return 'E';
+    case LOG_LVL_WARN:  return 'W';
+    case LOG_LVL_INFO:  return 'I';
+    case LOG_LVL_DEBUG: return 'D';
+    default:            return '?';
+  }
+}
+
+uint8_t logLevelFromName(const char* name) {
+  if (strcasecmp(name, "error") == 0) return LOG_LVL_ERROR;
+  if (strcasecmp(name, "warn") == 0) return LOG_LVL_WARN;
+  if (strcasecmp(name, "info") == 0) return LOG_LVL_INFO;
+  if (strcasecmp(name, "debug") == 0) return LOG_LVL_DEBUG;
+  return LOG_LVL_NONE;
+}
+
+void logWrite(uint8_t level, const char* tag, const char* fmt, ...) {
+  // Резервируем слот
+  uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+  LogSlot* slot;
+  for (;;) {
+    slot = &queue[pos & (LOG_QUEUE_SLOTS - 1)];
+    uint32_t seq = slot->seq.load(std::memory_order_acquire);
+    int32_t diff = (int32_t)(seq - pos);
+    if (diff == 0) {
+      if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (diff < 0) {
+      // Очередь полна
+      logDropped.inc();
+      return;
+    } else {
+      pos = enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+
+  // Форматируем прямо в слот
+  slot->timeMs = millis();
+  slot->level = level;
+  int n = snprintf(slot->text, LOG_LINE_LEN, "[%s] ", tag);
+  if (n < 0 || n >= LOG_LINE_LEN) n = 0;
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(slot->text + n, LOG_LINE_LEN - n, fmt, args);
+  va_end(args);
+
+  // Публикуем слот для задачи вывода
+  slot->seq.store(pos + 1, std::memory_order_release);
+  logLines.inc();
+}
+
+// Обрезка недописанного UTF-8 символа в конце (строка могла не поместиться в слот)
+static size_t trimUtf8(char* s, size_t len) {
+  size_t i = len;
+  while (i > 0 && ((uint8_t)s[i - 1] & 0xC0) == 0x80) i--;
+  if (i == 0) return len;
+  uint8_t lead = (uint8_t)s[i - 1];
+  size_t need = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+  if (len - (i - 1) < need) {
+    s[i - 1] = '\0';
+    return i - 1;
+  }
+  return len;
+}
+
+// Перенос строки в историю
+static void appendTail(uint32_t timeMs, uint8_t level, const char* text) {
+  portENTER_CRITICAL(&tailMux);
+  LogTailLine& line = tail[tailNextId % LOG_TAIL_LINES];
+  line.id = tailNextId++;
+  line.timeMs = timeMs;
+  line.level = level;
+  strncpy(line.text, text, LOG_LINE_LEN - 1);
+  line.text[LOG_LINE_LEN - 1] = '\0';
+  portEXIT_CRITICAL(&tailMux);
+}
+
+// Запись важной строки в файл журнала с ротацией (из задачи вывода).
+// Пока хранилище не смонтировано, строки во flash не попадают
+static void appendFile(uint8_t level, const char* text) {
+  static long fileSize = -1;
+  if (!storageReady()) return;
+  if (fileSize < 0) {
+    fileSize = storageFileSize(LOG_FILE_PATH);
+    if (fileSize < 0) fileSize = 0;
+  }
+
+  // Метка - местное время, если оно уже синхронизировано, иначе аптайм
+  char line[LOG_LINE_LEN + 32];
+  time_t now = time(nullptr);
+  struct tm tmNow;
+  int n;
+  if (now > 1600000000 && localtime_r(&now, &tmNow)) {
+    n = strftime(line, sizeof(line), "%Y-%m-%d %H:%M:%S ", &tmNow);
+  } else {
+    n = snprintf(line, sizeof(line), "+%lu ", millis());
+  }
+  n += snprintf(line + n, sizeof(line) - n, "%c %s\n", logLevelChar(level), text);
+  if (n >= (int)sizeof(line)) n = sizeof(line) - 1;
+
+  if (fileSize + n > LOG_FILE_MAX_SIZE) {
+    storageRemove(LOG_FILE_OLD_PATH);
+    storageRename(LOG_FILE_PATH, LOG_FILE_OLD_PATH);
+    fileSize = 0;
+  }
+  if (storageAppend(LOG_FILE_PATH, line, n)) {
+    fileSize += n;
+  } else {
+    logFileErrors.inc();
+  }
+}
+
+// Задача вывода: забирает сообщения из очереди, пишет в Serial, историю
+// и (от LOG_FILE_LEVEL и важнее) в файл журнала
+static void drainTask(void*) {
+  uint32_t reportedDrops = 0;
+
+  for (;;) {
+    bool idle = true;
+
+    for (;;) {
+      LogSlot& slot = queue[dequeuePos & (LOG_QUEUE_SLOTS - 1)];
+      uint32_t seq = slot.seq.load(std::memory_order_acquire);
+      if ((int32_t)(seq - (dequeuePos + 1)) != 0) break;
+
+      // Убираем завершающие переводы строк
+      size_t len = trimUtf8(slot.text, strnlen(slot.text, LOG_LINE_LEN));
+      while (len > 0 && (slot.text[len - 1] == '\n' || slot.text[len - 1] == '\r')) {
+        slot.text[--len] = '\0';
+      }
+
+      Serial.print(logLevelChar(slot.level));
+      Serial.print(' ');
+      Serial.println(slot.text);
+      appendTail(slot.timeMs, slot.level, slot.text);
+      if (slot.level <= LOG_FILE_LEVEL) appendFile(slot.level, slot.text);
+
+      // Освобождаем слот для следующего круга
+      slot.seq.store(dequeuePos + LOG_QUEUE_SLOTS, std::memory_order_release);
+      dequeuePos++;
+      idle = false;
+    }
+
+    uint32_t dropped = logDropped.value();
+    if (dropped != reportedDrops) {
+      Serial.printf("W [LOG] Потеряно сообщений: %u\n", dropped - reportedDrops);
+      reportedDrops = dropped;
+    }
+
+    if (idle) vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_PERIOD));
+  }
+}
+
+void logSetup() {
+  if (started) return;
+  started = true;
+
+  xTaskCreatePinnedToCore(drainTask, "log", 4096, nullptr, 1, nullptr, 0);
+}
+
+// Вывод строки в JSON с экранированием
+void printJsonString(Print& out, const char* s) {
+  out.print('"');
+  for (; *s; s++) {
+    char c = *s;
+    if (c == '"' || c == '\\') {
+      out.print('\\');
+      out.print(c);
+    } else if ((uint8_t)c < 0x20) {
+      out.printf("\\u%04x", c);
+    } else {
+      out.print(c);
+    }
+  }
+  out.print('"');
+}
+
+// Копия строки истории по номеру (false - строка уже вытеснена или ещё не записана)
+static bool copyTailLine(uint32_t id, LogTailLine& dst) {
+  bool ok = false;
+  portENTER_CRITICAL(&tailMux);
+  const LogTailLine& src = tail[id % LOG_TAIL_LINES];
+  if (id < tailNextId && src.id == id) {
+    dst = src;
+    ok = true;
+  }
+  portEXIT_CRITICAL(&tailMux);
+  return ok;
+}
+
+static uint32_t tailBounds(uint32_t& oldest) {
+  portENTER_CRITICAL(&tailMux);
+  uint32_t next = tailNextId;
+  portEXIT_CRITICAL(&tailMux);
+  oldest = next > LOG_TAIL_LINES ? next - LOG_TAIL_LINES : 0;
+  return next;
+}
+
+uint32_t logWriteTailJson(Print& out, uint32_t since) {
+  uint32_t oldest;
+  uint32_t next = tailBounds(oldest);
+  if (since < oldest) since = oldest;
+
+  out.print("{\"lines\":[");
+  bool first = true;
+  LogTailLine line;
+  for (uint32_t id = since; id < next; id++) {
+    if (!copyTailLine(id, line)) continue;
+    out.printf("%s{\"id\":%u,\"t\":%u,\"l\":\"%c\",\"m\":", first ? "" : ",",
+               line.id, line.timeMs, logLevelChar(line.level));
+    printJsonString(out, line.text);
+    out.print('}');
+    first = false;
+  }
+  out.printf("],\"next\":%u}", next);
+  return next;
+}
+
+bool logNextLine(uint32_t& since, uint8_t maxLevel, char* buf, size_t size) {
+  uint32_t oldest;
+  uint32_t next = tailBounds(oldest);
+  if (since < oldest) since = oldest;
+
+  LogTailLine line;
+  while (since < next) {
+    uint32_t id = since++;
+    if (!copyTailLine(id, line) || line.level > maxLevel) continue;
+    snprintf(buf, size, "%c %s", logLevelChar(line.level), line.text);
+    return true;
+  }
+  return false;
+}
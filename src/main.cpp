@@ -4,10 +4,33 @@
   
   Модульная структура:
   - config.h       : Настройки (WiFi, MQTT, пины)
-  - feeder.h/cpp   : Мотор, LED, кормление
+  - feeder.h/cpp   : Кормление шнеками, калибровка
   - schedule.h/cpp : Расписание
   - mqtt_handler.h/cpp : MQTT
   - web_server.h/cpp   : HTTP API
+  - wifi_manager.h/cpp : WiFi линк и переподключение
+  - metrics.h/cpp      : Метрики (/metrics, MQTT)
+  - trace.h/cpp        : Трассировка и сторож зависаний
+  - logger.h/cpp       : Асинхронный журнал
+  - led_engine.h/cpp   : Слои LED индикации
+  - stepper.h/cpp      : Моторы и планировщик шагов
+  - device_id.h/cpp    : Идентификатор устройства (топики MQTT)
+  - ota_update.h/cpp   : HTTP OTA (gzip, докачка), самопроверки и откат
+  - gzip_stream.h/cpp  : Потоковая распаковка gzip
+  - storage.h/cpp      : Хранилище LittleFS (веб-файлы, журнал)
+  - camera.h/cpp       : Камера, пул кадров, MJPEG поток
+  - clip_recorder.h/cpp: Ролики кормлений с предзаписью
+  - presence.h/cpp     : Кот у миски (детектор на кадрах камеры)
+  - time_service.h/cpp : Местное время: пояс, кэш, NTP
+  - json_stream.h/cpp  : Потоковый разбор JSON
+  - provisioning.h/cpp : Настройки из JSON (файл, HTTP, MQTT) на ходу
+  - cbor_writer.h/cpp  : Запись CBOR
+  - telemetry.h/cpp    : События и метрики в CBOR (схема ключей)
+  - udp_control.h/cpp  : Команды кормления по UDP (HMAC, mDNS)
+  - tls_client.h/cpp   : TLS для MQTT с возобновлением сессий
+  - shadow.h/cpp       : Тень устройства (reported/desired, версии)
+  - power_manager.h/cpp: Экономный режим между событиями
+  - feed_journal.h/cpp : Журнал кормлений на случай сброса
 */
 
 #include <Arduino.h>
@@ -21,105 +44,126 @@
 #include "schedule.h"
 #include "mqtt_handler.h"
 #include "web_server.h"
+#include "wifi_manager.h"
+#include "metrics.h"
+#include "trace.h"
+#include "logger.h"
+#include "alloc_track.h"
+#include "led_engine.h"
+#include "device_id.h"
+#include "ota_update.h"
+#include "storage.h"
+#include "camera.h"
+#include "clip_recorder.h"
+#include "presence.h"
+#include "time_service.h"
+#include "provisioning.h"
+#include "udp_control.h"
+#include "shadow.h"
+#include "power_manager.h"
 
 // ==================== ПЕРЕМЕННЫЕ ====================
 SimpleButton btn(BTN_PIN);
-bool wifiConnected = false;
+bool servicesStarted = false;
 
-// ==================== WiFi ====================
-void wifiSetup() {
-  Serial.println("\n--- Подключение к WiFi ---");
-  Serial.printf("SSID: %s\n", WIFI_SSID);
-  
-  WiFi.mode(WIFI_STA);
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-  
-  // Индикация подключения
-  leds[0] = CRGB::Yellow;
-  leds[1] = CRGB::Yellow;
-  FastLED.show();
-  
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < 40) {
-    delay(500);
-    attempts++;
-    Serial.print(".");
-    leds[0] = (attempts % 2) ? CRGB::Yellow : CRGB::Black;
-    leds[1] = (attempts % 2) ? CRGB::Black : CRGB::Yellow;
-    FastLED.show();
-  }
-  
-  Serial.println();
-  wifiConnected = (WiFi.status() == WL_CONNECTED);
-  
-  if (wifiConnected) {
-    Serial.println("[OK] WiFi подключен!");
-    Serial.printf("     IP: %s\n", WiFi.localIP().toString().c_str());
-    Serial.printf("     MAC: %s\n", WiFi.macAddress().c_str());
-    
-    leds[0] = CRGB::Green;
-    leds[1] = CRGB::Green;
-    FastLED.show();
-    delay(1000);
-  } else {
-    Serial.println("[ОШИБКА] WiFi не подключен!");
-    Serial.println("  Проверьте SSID и пароль в config.h");
-    
-    leds[0] = CRGB::Red;
-    leds[1] = CRGB::Red;
-    FastLED.show();
-    delay(2000);
-  }
-  
-  FastLED.clear();
-  FastLED.show();
-}
+// Метрики цикла
+static Histogram loopDuration("feeder_loop_duration_us", "loop() iteration time (without idle delay)",
+                              nullptr, METRICS_BUCKETS_US, METRICS_BUCKETS_US_COUNT);
+static Gauge loopMax("feeder_loop_max_us", "Longest loop() iteration since boot");
 
-// ==================== NTP ====================
-void ntpSetup() {
-  Serial.println("--- Синхронизация времени ---");
-  configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER);
+// ==================== WiFi ====================
+// Индикация подключения при старте (не дольше WIFI_BOOT_WAIT).
+// Загрузка не ждёт сеть - менеджер WiFi подключится в фоне
+void wifiBootIndication() {
+  static bool done = false;
+  if (done) return;
   
-  delay(2000);
-  struct tm timeinfo;
-  if (getLocalTime(&timeinfo)) {
-    Serial.printf("[OK] Время: %02d.%02d.%04d %02d:%02d:%02d\n",
-      timeinfo.tm_mday, timeinfo.tm_mon + 1, timeinfo.tm_year + 1900,
-      timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
-  } else {
-    Serial.println("[WARN] Время еще не синхронизировано");
+  if (wifiLinkUp()) {
+    ledSetWifiConnecting(false);
+    ledFlash(LED_FLASH_OK);
+    done = true;
+  } else if (millis() > WIFI_BOOT_WAIT) {
+    LOGW("WIFI", "Пока не подключен, продолжаем в фоне (проверьте SSID и пароль в .env)");
+    ledSetWifiConnecting(false);
+    ledFlash(LED_FLASH_FAIL);
+    done = true;
   }
 }
 
 // ==================== OTA ====================
 void otaSetup() {
-  Serial.println("--- Настройка OTA ---");
+  LOGI("OTA", "Настройка...");
   ArduinoOTA.setHostname(OTA_HOSTNAME);
   
   ArduinoOTA.onStart([]() {
-    Serial.println("[OTA] Начало обновления...");
-    leds[0] = CRGB::Purple;
-    leds[1] = CRGB::Purple;
-    FastLED.show();
+    LOGI("OTA", "Начало обновления...");
+    ledOtaStart();
   });
   
   ArduinoOTA.onProgress([](unsigned int progress, unsigned int total) {
-    Serial.printf("[OTA] %u%%\r", (progress / (total / 100)));
+    static unsigned int lastPercent = 0;
+    unsigned int percent = progress / (total / 100);
+    ledOtaProgress(percent);
+    if (percent / 10 != lastPercent / 10) {
+      LOGI("OTA", "%u%%", percent);
+    }
+    lastPercent = percent;
   });
   
   ArduinoOTA.onEnd([]() {
-    Serial.println("\n[OTA] Готово!");
-    leds[0] = CRGB::Green;
-    leds[1] = CRGB::Green;
-    FastLED.show();
+    LOGI("OTA", "Готово!");
+    otaMarkPending();
+    ledOtaEnd(true);
   });
   
   ArduinoOTA.onError([](ota_error_t error) {
-    Serial.printf("[OTA] Ошибка[%u]\n", error);
+    LOGE("OTA", "Ошибка[%u]", error);
+    ledOtaEnd(false);
   });
   
   ArduinoOTA.begin();
-  Serial.println("[OK] OTA готов");
+  LOGI("OTA", "Готов");
+}
+
+// Запуск сетевых сервисов (один раз, при первом подключении к WiFi)
+void startNetworkServices() {
+  if (servicesStarted || !wifiLinkUp()) return;
+  
+  otaSetup();
+  udpControlSetup();
+  webServerSetup();
+  servicesStarted = true;
+  
+  LOGI("MAIN", "СИСТЕМА ГОТОВА! http://%s", WiFi.localIP().toString().c_str());
+}
+
+// ==================== КНОПКА ====================
+// Кнопка управляет первым шнеком: клик - кормление, двойной клик - проверка
+// связи (вспышка и строка в журнале), удержание - калибровка порции
+void handleButton() {
+  ButtonGesture g;
+  while ((g = btn.getGesture()) != BTN_NONE) {
+    powerActivity();
+    switch (g) {
+      case BTN_CLICK:
+        LOGI("BTN", "Клик - кормление");
+        feed(0, 0, "button");
+        break;
+      case BTN_DOUBLE_CLICK:
+        LOGI("BTN", "Двойной клик - WiFi: %s, MQTT: %s",
+             wifiLinkUp() ? "OK" : "FAIL", mqttConnected ? "OK" : "FAIL");
+        ledFlash(wifiLinkUp() && mqttConnected ? LED_FLASH_OK : LED_FLASH_FAIL);
+        break;
+      case BTN_HOLD_START:
+        calibrationStart(0);
+        break;
+      case BTN_HOLD_RELEASE:
+        calibrationStop(0);
+        break;
+      default:
+        break;
+    }
+  }
 }
 
 // ==================== SETUP ====================
@@ -127,116 +171,135 @@ void setup() {
   Serial.begin(115200);
   delay(2000);
   
-  Serial.println("\n\n===========================================");
-  Serial.println("  ESP32-CAM Автокормушка v3.2");
-  Serial.println("===========================================\n");
+  // 0. Журнал (вывод в Serial идёт из отдельной задачи)
+  logSetup();
+  allocTrackSetup();
+  LOGI("MAIN", "ESP32-CAM Автокормушка v" FIRMWARE_VERSION);
+  deviceIdSetup();
   
-  // 1. Инициализация оборудования
+  // Новая прошивка: счётчик загрузок, откат после исчерпания попыток
+  otaUpdateSetup();
+  
+  // Хранилище монтируется в фоне
+  storageSetup();
+  
+  // 1. Инициализация оборудования (мигалка не блокирует загрузку)
+  ledSetup();
+  ledFlash(LED_FLASH_BOOT);
   feederSetup();
-  flashLights();
+  btn.setDebounce(BTN_DEBOUNCE_MS);
+  btn.setHoldTimeout(BTN_HOLD_MS);
+  btn.setDoubleClickTimeout(BTN_DOUBLE_CLICK_MS);
+  btn.setIsrHook(powerWakeFromIsr);
+  btn.begin();
   
-  // 2. Загрузка настроек
+  // 2. Загрузка настроек (сеть и пояс - из NVS, /config.json - после монтирования)
+  provisioningSetup();
   scheduleSetup();
+  shadowSetup();
   
-  // 3. Подключение к WiFi
+  // 3. Подключение к WiFi (дальше переподключение идёт в фоне)
   wifiSetup();
+  ledSetWifiConnecting(true);
+  powerSetup();
   
-  if (wifiConnected) {
-    // 4. NTP
-    ntpSetup();
-    
-    // 5. OTA
-    otaSetup();
-    
-    // 6. MQTT
-    mqttSetup();
-    
-    // 7. Веб-сервер
-    webServerSetup();
-    
-    Serial.println("\n===========================================");
-    Serial.println("  СИСТЕМА ГОТОВА!");
-    Serial.printf("  http://%s\n", WiFi.localIP().toString().c_str());
-    Serial.println("===========================================\n");
-  }
+  // Камера и MJPEG сервер (сокет слушает и до подключения к WiFi)
+  cameraSetup();
+  clipSetup();
+  presenceSetup();
+  
+  // 4. Время: пояс, восстановление после сброса, NTP (как только появится сеть)
+  timeServiceSetup();
+  
+  // 5. MQTT
+  mqttSetup();
+  
+  // OTA и веб-сервер запускаются при первом подключении к WiFi
+  startNetworkServices();
+  
+  // 6. Сторож зависаний loop()
+  traceSetup();
 }
 
 // ==================== LOOP ====================
 void loop() {
-  delay(10);
+  // Пауза цикла по режиму питания; команда по UDP и кнопка прерывают её
+  powerIdle();
+  uint32_t loopStart = micros();
+  traceLoopTick();
+  allocLoopBegin();
   btn.tick();
   
-  // Определяем статус системы для индикации
-  SystemStatus currentStatus;
-  if (WiFi.status() != WL_CONNECTED) {
-    currentStatus = STATUS_WIFI_ISSUE;
-  } else {
-    currentStatus = STATUS_OK;
-  }
+  // Состояние WiFi и переподключение
+  wifiLoop();
+  startNetworkServices();
+  wifiBootIndication();
   
-  // Обновляем индикацию состояния (мигание маяком)
-  updateStatusLed(currentStatus);
+  // Команды по UDP - сразу после пробуждения
+  udpControlLoop();
   
-  // WiFi-зависимые задачи
-  if (wifiConnected) {
-    // MQTT
-    mqttLoop();
-    
-    // Веб-сервер
+  // Статус системы для маяка (отрисовка идёт по таймеру)
+  ledSetStatus(wifiLinkUp() ? STATUS_OK : STATUS_WIFI_ISSUE);
+  
+  // MQTT (сам отслеживает состояние линка)
+  mqttLoop();
+  
+  // Веб-сервер и OTA - только при поднятом линке
+  if (wifiLinkUp() && servicesStarted) {
     webServerLoop();
-    
-    // OTA
     ArduinoOTA.handle();
-    
-    // Проверка расписания (раз в секунду)
-    static unsigned long lastScheduleCheck = 0;
-    if (millis() - lastScheduleCheck >= 1000) {
-      checkSchedule();
-      lastScheduleCheck = millis();
-    }
   }
   
+  // Документ настроек из хранилища, переподключение после смены сети
+  provisioningLoop();
+  
+  // Тень устройства: версия настроек, публикация reported
+  shadowLoop();
+  
+  // Кэш местного времени
+  timeServiceLoop();
+  
+  // Проверка расписания (раз в секунду) - работает и без сети,
+  // если время уже было синхронизировано
+  static unsigned long lastScheduleCheck = 0;
+  if (millis() - lastScheduleCheck >= SCHEDULE_CHECK_INTERVAL) {
+    checkSchedule();
+    lastScheduleCheck = millis();
+  }
+  
+  // Самопроверки новой прошивки и приём OTA
+  otaUpdateLoop();
+  
+  // Системные метрики
+  metricsLoop();
+  
   // Heartbeat (раз в 30 секунд)
   static unsigned long lastHeartbeat = 0;
   if (millis() - lastHeartbeat > 30000) {
-    Serial.printf("[INFO] Uptime: %lu сек, WiFi: %s, MQTT: %s\n", 
+    const WifiStats& ws = wifiGetStats();
+    LOGI("INFO", "Uptime: %lu сек, WiFi: %s, MQTT: %s, обрывов: %u, реконнект: %u мс", 
                   millis() / 1000, 
-                  wifiConnected ? "OK" : "FAIL",
-                  mqttConnected ? "OK" : "FAIL");
+                  wifiLinkUp() ? "OK" : "FAIL",
+                  mqttConnected ? "OK" : "FAIL",
+                  ws.outages, ws.lastReconnectMs);
     lastHeartbeat = millis();
   }
   
-  // Кнопка: клик - кормление
-  if (btn.click()) {
-    Serial.println("[BTN] Клик - кормление");
-    feed();
-    publishLastFeeding(feedAmount, "button");
-  }
+  // Кнопка: жесты из очереди
+  handleButton();
   
-  // Кнопка: удержание - калибровка
-  if (btn.hold()) {
-    Serial.println("[BTN] Калибровка");
-    int newAmount = 0;
-    
-    leds[0] = CRGB::Green;
-    leds[1] = CRGB::Green;
-    FastLED.show();
-    
-    while (btn.isHold()) {
-      btn.tick();
-      oneRev();
-      newAmount++;
-      if (newAmount % 20 == 0) {
-        Serial.printf("[CAL] %d оборотов\n", newAmount);
-      }
-    }
-    
-    disableMotor();
-    FastLED.clear();
-    FastLED.show();
-    
-    feedAmount = newAmount;
-    saveSettings();
-    Serial.printf("[BTN] Новая порция: %d\n", feedAmount);
-  }
-}
\ No newline at end of file
+  // Моторы шагают в фоне, здесь - завершение кормлений и калибровки
+  feederLoop();
+  
+  // Кот у миски: время еды и публикация состояния
+  presenceLoop();
+  
+  // Режим питания по занятости (частота, WiFi, пауза следующего цикла)
+  powerLoop();
+  
+  allocLoopEnd();
+  
+  uint32_t elapsed = micros() - loopStart;
+  loopDuration.observe(elapsed);
+  loopMax.setMax(elapsed);
+}
@@ -0,0 +1,143 @@
+/*
+  metrics.cpp - Реестр метрик и экспорт в формате Prometheus
+*/
+
+#include "metrics.h"
+#include "wifi_manager.h"
+
+// Голова реестра (нулевая инициализация до конструкторов метрик)
+Metric* Metric::_head = nullptr;
+
+const uint32_t METRICS_BUCKETS_US[] = {
+  100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000
+};
+const uint8_t METRICS_BUCKETS_US_COUNT = sizeof(METRICS_BUCKETS_US) / sizeof(METRICS_BUCKETS_US[0]);
+
+const uint32_t METRICS_BUCKETS_MS[] = {
+  100, 500, 1000, 2000, 5000, 10000, 30000, 60000, 120000
+};
+const uint8_t METRICS_BUCKETS_MS_COUNT = sizeof(METRICS_BUCKETS_MS) / sizeof(METRICS_BUCKETS_MS[0]);
+
+// Системные метрики
+static Gauge heapFree("feeder_heap_free_bytes", "Free heap");
+static Gauge heapMinFree("feeder_heap_min_free_bytes", "Minimum free heap since boot");
+static Gauge heapLargest("feeder_heap_largest_free_block_bytes", "Largest allocatable heap block");
+static Gauge uptime("feeder_uptime_seconds", "Uptime");
+static Counter wifiOutages("feeder_wifi_outages_total", "WiFi link losses");
+static Counter wifiDowntime("feeder_wifi_downtime_ms_total", "Total time without WiFi link");
+static Counter wifiFastConnects("feeder_wifi_fast_connects_total", "Reconnects using the RTC cache");
+static Gauge wifiReconnectTime("feeder_wifi_last_reconnect_ms", "Duration of the last WiFi reconnect");
+static Gauge wifiUp("feeder_wifi_link_up", "WiFi link state (1 = up)");
+
+Metric::Metric(const char* name, const char* help, const char* labels, MetricType type)
+  : _name(name), _help(help), _labels(labels), _type(type), _next(_head) {
+  // Регистрация выполняется при статической инициализации (один поток)
+  _head = this;
+}
+
+Histogram::Histogram(const char* name, const char* help, const char* labels,
+                     const uint32_t* bounds, uint8_t numBounds)
+  : Metric(name, help, labels, METRIC_HISTOGRAM),
+    _bounds(bounds),
+    _numBounds(numBounds > METRICS_MAX_BUCKETS ? METRICS_MAX_BUCKETS : numBounds),
+    _count(0), _sum(0) {
+  for (uint8_t i = 0; i <= METRICS_MAX_BUCKETS; i++) {
+    _buckets[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void Histogram::observe(uint32_t v) {
+  uint8_t i = 0;
+  while (i < _numBounds && v > _bounds[i]) i++;
+  _buckets[i].fetch_add(1, std::memory_order_relaxed);
+  _count.fetch_add(1, std::memory_order_relaxed);
+  _sum.fetch_add(v, std::memory_order_relaxed);
+}
+
+// Периодическое обновление системных метрик
+void metricsLoop() {
+  static unsigned long lastSample = 0;
+  if (millis() - lastSample < METRICS_SAMPLE_INTERVAL) return;
+  lastSample = millis();
+
+  heapFree.set(ESP.getFreeHeap());
+  heapMinFree.set(ESP.getMinFreeHeap());
+  heapLargest.set(ESP.getMaxAllocHeap());
+  uptime.set(millis() / 1000);
+
+  const WifiStats& ws = wifiGetStats();
+  wifiOutages.set(ws.outages);
+  wifiDowntime.set(ws.totalDowntimeMs);
+  wifiFastConnects.set(ws.fastConnects);
+  wifiReconnectTime.set(ws.lastReconnectMs);
+  wifiUp.set(wifiLinkUp() ? 1 : 0);
+}
+
+// Заголовок семейства выводится один раз на имя
+static bool firstOfFamily(const Metric* m) {
+  for (const Metric* p = Metric::first(); p != m; p = p->next()) {
+    if (strcmp(p->name(), m->name()) == 0) return false;
+  }
+  return true;
+}
+
+static void writeLabels(Print& out, const char* labels, const char* extra) {
+  bool hasLabels = labels && *labels;
+  if (!hasLabels && !extra) return;
+  out.print('{');
+  if (hasLabels) out.print(labels);
+  if (hasLabels && extra) out.print(',');
+  if (extra) out.print(extra);
+  out.print('}');
+}
+
+// Экспорт всех метрик
+void metricsWritePrometheus(Print& out) {
+  static const char* TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+  char le[24];
+
+  for (const Metric* m = Metric::first(); m; m = m->next()) {
+    if (firstOfFamily(m)) {
+      out.printf("# HELP %s %s\n", m->name(), m->help());
+      out.printf("# TYPE %s %s\n", m->name(), TYPE_NAMES[m->type()]);
+    }
+
+    switch (m->type()) {
+      case METRIC_COUNTER:
+        out.print(m->name());
+        writeLabels(out, m->labels(), nullptr);
+        out.printf(" %u\n", ((const Counter*)m)->value());
+        break;
+
+      case METRIC_GAUGE:
+        out.print(m->name());
+        writeLabels(out, m->labels(), nullptr);
+        out.printf(" %d\n", ((const Gauge*)m)->value());
+        break;
+
+      case METRIC_HISTOGRAM: {
+        const Histogram* h = (const Histogram*)m;
+        // Корзины в Prometheus кумулятивные
+        uint32_t cumulative = 0;
+        for (uint8_t i = 0; i <= h->numBounds(); i++) {
+          cumulative += h->bucket(i);
+          if (i < h->numBounds()) {
+            snprintf(le, sizeof(le), "le=\"%u\"", h->bound(i));
+          } else {
+            strcpy(le, "le=\"+Inf\"");
+          }
+          out.printf("%s_bucket", m->name());
+          writeLabels(out, m->labels(), le);
+          out.printf(" %u\n", cumulative);
+        }
+        out.printf("%s_sum", m->name());
+        writeLabels(out, m->labels(), nullptr);
+        out.printf(" %llu\n", (unsigned long long)h->sum());
+        out.printf("%s_count", m->name());
+        writeLabels(out, m->labels(), nullptr);
+        out.printf(" %u\n", h->count());
+        break;
+      }
+    }
+  }
+}
@@ -0,0 +1,300 @@
+/*
+  mjpeg_stream.cpp - MJPEG поток для нескольких зрителей
+*/
+
+#include "mjpeg_stream.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#ifndef MSG_NOSIGNAL
+  #define MSG_NOSIGNAL 0
+#endif
+
+#define STREAM_BOUNDARY "frame"
+
+static const char STREAM_RESPONSE[] =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Type: multipart/x-mixed-replace;boundary=" STREAM_BOUNDARY "\r\n"
+  "Cache-Control: no-cache\r\n"
+  "Access-Control-Allow-Origin: *\r\n"
+  "Connection: close\r\n\r\n";
+
+static const char NOT_FOUND_RESPONSE[] =
+  "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+static const char BUSY_RESPONSE[] =
+  "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+static inline uint32_t packDemand(uint8_t clients, uint16_t fps, FrameSize size) {
+  return clients | ((uint32_t)fps << 8) | ((uint32_t)size << 24);
+}
+
+static bool wouldBlock() {
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+static void setNonBlocking(int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+bool MjpegStreamer::begin(uint16_t port, FramePool* pool) {
+  _pool = pool;
+  for (Client& c : _clients) c.state = CLIENT_FREE;
+
+  _listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  if (_listenFd < 0) return false;
+  int yes = 1;
+  setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(_listenFd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+      listen(_listenFd, CAMERA_STREAM_MAX_CLIENTS) != 0) {
+    close(_listenFd);
+    _listenFd = -1;
+    return false;
+  }
+  setNonBlocking(_listenFd);
+
+  _fps = CAMERA_MAX_FPS;
+  _demand.store(packDemand(0, _fps, _size), std::memory_order_relaxed);
+  return true;
+}
+
+void MjpegStreamer::end() {
+  for (Client& c : _clients) {
+    if (c.state != CLIENT_FREE) closeClient(c);
+  }
+  if (_listenFd >= 0) close(_listenFd);
+  _listenFd = -1;
+}
+
+void MjpegStreamer::closeClient(Client& c) {
+  _pool->release(c.frame);
+  c.frame = nullptr;
+  close(c.fd);
+  c.state = CLIENT_FREE;
+}
+
+void MjpegStreamer::acceptClients(uint32_t nowMs) {
+  for (;;) {
+    int fd = accept(_listenFd, nullptr, nullptr);
+    if (fd < 0) return;
+
+    Client* c = nullptr;
+    for (Client& slot : _clients) {
+      if (slot.state == CLIENT_FREE) {
+        c = &slot;
+        break;
+      }
+    }
+    if (!c) {
+      send(fd, BUSY_RESPONSE, sizeof(BUSY_RESPONSE) - 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+      close(fd);
+      continue;
+    }
+
+    setNonBlocking(fd);
+    c->fd = fd;
+    c->state = CLIENT_REQUEST;
+    c->requestLen = 0;
+    c->frame = nullptr;
+    c->outPos = c->outLen = 0;
+    c->headLen = 0;
+    c->lastSeq = 0;
+    c->avgSendMs = 0;
+    c->lastProgressMs = nowMs;
+  }
+}
+
+// Чтение запроса до пустой строки; поток отдаётся только на /api/stream
+bool MjpegStreamer::readRequest(Client& c, uint32_t nowMs) {
+  ssize_t n = recv(c.fd, c.request + c.requestLen, sizeof(c.request) - 1 - c.requestLen, MSG_DONTWAIT);
+  if (n == 0 || (n < 0 && !wouldBlock())) {
+    closeClient(c);
+    return true;
+  }
+  if (n < 0) return false;
+
+  c.requestLen += n;
+  c.request[c.requestLen] = '\0';
+  c.lastProgressMs = nowMs;
+  if (!strstr(c.request, "\r\n\r\n")) {
+    if (c.requestLen >= sizeof(c.request) - 1) closeClient(c);
+    return true;
+  }
+
+  if (strncmp(c.request, "GET /api/stream", 15) != 0) {
+    send(c.fd, NOT_FOUND_RESPONSE, sizeof(NOT_FOUND_RESPONSE) - 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+    closeClient(c);
+    return true;
+  }
+
+  // Заголовок ответа уходит как первая "часть" без тела
+  static_assert(sizeof(STREAM_RESPONSE) <= sizeof(c.head), "head buffer too small");
+  memcpy(c.head, STREAM_RESPONSE, sizeof(STREAM_RESPONSE) - 1);
+  c.headLen = sizeof(STREAM_RESPONSE) - 1;
+  c.outPos = 0;
+  c.outLen = c.headLen;
+  c.state = CLIENT_STREAM;
+  return true;
+}
+
+void MjpegStreamer::startFrame(Client& c, uint32_t nowMs) {
+  FrameSlot* f = _pool->acquireLatest(c.lastSeq);
+  if (!f) return;
+
+  if (c.lastSeq && f->info.seq > c.lastSeq + 1) {
+    _framesSkipped.fetch_add(f->info.seq - c.lastSeq - 1, std::memory_order_relaxed);
+  }
+  c.lastSeq = f->info.seq;
+  c.frame = f;
+  c.headLen = snprintf(c.head, sizeof(c.head),
+                       "--" STREAM_BOUNDARY "\r\nContent-Type: image/jpeg\r\n"
+                       "Content-Length: %u\r\nX-Timestamp: %u\r\n\r\n",
+                       (unsigned)f->info.len, (unsigned)f->info.timeMs);
+  c.outPos = 0;
+  c.outLen = c.headLen + f->info.len + 2;
+  c.frameStartMs = nowMs;
+  c.lastProgressMs = nowMs;
+}
+
+// Досылка текущей части прямо из слота пула
+bool MjpegStreamer::sendPending(Client& c, uint32_t nowMs) {
+  bool progress = false;
+  uint32_t bodyLen = c.frame ? c.frame->info.len : 0;
+
+  while (c.outPos < c.outLen) {
+    const uint8_t* ptr;
+    size_t rem;
+    if (c.outPos < c.headLen) {
+      ptr = (const uint8_t*)c.head + c.outPos;
+      rem = c.headLen - c.outPos;
+    } else if (c.outPos < c.headLen + bodyLen) {
+      uint32_t off = c.outPos - c.headLen;
+      ptr = c.frame->data + off;
+      rem = bodyLen - off;
+    } else {
+      uint32_t off = c.outPos - c.headLen - bodyLen;
+      ptr = (const uint8_t*)"\r\n" + off;
+      rem = 2 - off;
+    }
+
+    ssize_t n = send(c.fd, ptr, rem, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (n < 0 && wouldBlock()) return progress;
+    if (n <= 0) {
+      closeClient(c);
+      return true;
+    }
+    c.outPos += n;
+    c.lastProgressMs = nowMs;
+    _bytesSent.fetch_add(n, std::memory_order_relaxed);
+    progress = true;
+  }
+
+  // Кадр ушёл целиком
+  if (c.frame) {
+    uint32_t sendMs = nowMs - c.frameStartMs;
+    if (sendMs == 0) sendMs = 1;
+    c.avgSendMs = c.avgSendMs ? (c.avgSendMs * 3 + sendMs) / 4 : sendMs;
+    _pool->release(c.frame);
+    c.frame = nullptr;
+    _framesSent.fetch_add(1, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+// Частота - по самому быстрому зрителю, разрешение - с гистерезисом
+void MjpegStreamer::adapt(uint32_t nowMs) {
+  if (nowMs - _lastAdaptMs < CAMERA_ADAPT_INTERVAL) return;
+  _lastAdaptMs = nowMs;
+
+  uint32_t best = 0;
+  for (const Client& c : _clients) {
+    if (c.state == CLIENT_STREAM && c.avgSendMs && (best == 0 || c.avgSendMs < best)) {
+      best = c.avgSendMs;
+    }
+  }
+  if (best == 0) return;
+
+  uint32_t capacity = 1000 / best;  // Кадров в секунду при текущем разрешении
+  _fps = capacity < CAMERA_MAX_FPS ? (capacity ? capacity : 1) : CAMERA_MAX_FPS;
+
+  FrameSize next = _size;
+  if (capacity < CAMERA_MIN_FPS && _size > FRAME_QQVGA) {
+    next = (FrameSize)(_size - 1);
+  } else if (_size < CAMERA_MAX_SIZE) {
+    FrameSize up = (FrameSize)(_size + 1);
+    uint64_t areaNow = (uint32_t)frameWidth(_size) * frameHeight(_size);
+    uint64_t areaUp = (uint32_t)frameWidth(up) * frameHeight(up);
+    // Прогноз при большем разрешении должен оставлять двойной запас
+    if (capacity * areaNow / areaUp >= 2 * CAMERA_MIN_FPS) next = up;
+  }
+
+  if (next != _size) {
+    _size = next;
+    // Замеры прошлого разрешения больше не годятся
+    for (Client& c : _clients) c.avgSendMs = 0;
+  }
+}
+
+bool MjpegStreamer::service(uint32_t nowMs) {
+  if (_listenFd < 0) return false;
+  bool busy = false;
+
+  acceptClients(nowMs);
+
+  uint8_t count = 0;
+  for (Client& c : _clients) {
+    if (c.state == CLIENT_REQUEST) {
+      busy |= readRequest(c, nowMs);
+      if (c.state == CLIENT_REQUEST && nowMs - c.lastProgressMs > CAMERA_STREAM_STALL_MS) {
+        closeClient(c);
+      }
+    } else if (c.state == CLIENT_STREAM) {
+      if (c.outPos == c.outLen) startFrame(c, nowMs);
+      if (c.outPos < c.outLen) {
+        busy |= sendPending(c, nowMs);
+        // Клиент не забирает данные - отключаем, чтобы не держал слот пула
+        if (c.state == CLIENT_STREAM && c.outPos < c.outLen &&
+            nowMs - c.lastProgressMs > CAMERA_STREAM_STALL_MS) {
+          closeClient(c);
+        }
+      } else {
+        // Ждём кадр: заодно замечаем закрытое соединение
+        char scratch[32];
+        ssize_t n = recv(c.fd, scratch, sizeof(scratch), MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && !wouldBlock())) closeClient(c);
+      }
+    }
+    if (c.state == CLIENT_STREAM) count++;
+  }
+
+  adapt(nowMs);
+  _clientCount.store(count, std::memory_order_relaxed);
+  _demand.store(packDemand(count, _fps, _size), std::memory_order_relaxed);
+  return busy;
+}
+
+StreamDemand MjpegStreamer::demand() const {
+  uint32_t d = _demand.load(std::memory_order_relaxed);
+  StreamDemand s = {(uint8_t)(d & 0xFF), (uint16_t)((d >> 8) & 0xFFFF), (FrameSize)(d >> 24)};
+  return s;
+}
+
+StreamStats MjpegStreamer::stats() const {
+  StreamStats s = {
+    _clientCount.load(std::memory_order_relaxed),
+    _framesSent.load(std::memory_order_relaxed),
+    _framesSkipped.load(std::memory_order_relaxed),
+    _bytesSent.load(std::memory_order_relaxed)
+  };
+  return s;
+}
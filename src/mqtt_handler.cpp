@@ -3,81 +3,310 @@
 */
 
 #include "mqtt_handler.h"
+#include "feeder.h"
+#include "feed_journal.h"
+#include "device_id.h"
+#include "time_service.h"
+#include "wifi_manager.h"
+#include "provisioning.h"
+#include "shadow.h"
+#include "power_manager.h"
+#include "telemetry.h"
+#include "metrics.h"
+#include "trace.h"
+#include "logger.h"
+#include "alloc_track.h"
+#include "arena.h"
+#include "storage.h"
+#if MQTT_TLS
+#include "tls_client.h"
+#endif
 #include <time.h>
 
 // Глобальные переменные
-WiFiClient espClient;
-PubSubClient mqttClient(espClient);
+#if MQTT_TLS
+static TlsClient netClient;
+#else
+static WiFiClient netClient;
+#endif
+PubSubClient mqttClient(netClient);
 bool mqttConnected = false;
 bool bootTimePublished = false;
 unsigned long lastMqttReconnect = 0;
+// Discovery - retained, брокер хранит его сам: раз за загрузку.
+// Конфигурации уходят по одной за проход loop, не чаще MQTT_DISCOVERY_INTERVAL
+static bool discoveryPublished = false;
+static int discoveryStep = -1;          // Следующая конфигурация (-1 - не отправляются)
+static unsigned long discoveryLast = 0;
+static char discoveryDevice[256];       // Блок "device" для всех конфигураций
+static bool publishDiscoveryStep(int step);
+// Кормления, прерванные сбросом: итог один раз за загрузку
+static bool recoveryPublished = false;
+
+// Метрики MQTT
+static Counter mqttPublishOk("feeder_mqtt_publish_total", "MQTT messages published");
+static Counter mqttPublishFailed("feeder_mqtt_publish_failed_total", "MQTT publish failures");
+static Counter mqttConnects("feeder_mqtt_connects_total", "Successful MQTT connections");
+static Counter mqttConnectFailed("feeder_mqtt_connect_failed_total", "Failed MQTT connection attempts");
+static Counter mqttReceived("feeder_mqtt_received_total", "MQTT messages received");
+static Histogram mqttConnectTime("feeder_mqtt_connect_ms", "MQTT connect duration (TCP, TLS, CONNECT)",
+                                 nullptr, METRICS_BUCKETS_MS, METRICS_BUCKETS_MS_COUNT);
+#if MQTT_TLS
+static Histogram tlsHandshakeTime("feeder_tls_handshake_ms", "TLS handshake duration",
+                                  nullptr, METRICS_BUCKETS_MS, METRICS_BUCKETS_MS_COUNT);
+static Counter tlsResumed("feeder_tls_resumed_total", "TLS handshakes resumed from a cached session");
+static Counter tlsFailures("feeder_tls_failures_total", "Failed TLS handshakes");
+#endif
+
+// Топики устройства (собираются в mqttSetup из идентификатора)
+static struct {
+  char availability[MQTT_TOPIC_LEN];
+  char bootTime[MQTT_TOPIC_LEN];
+  char lastFeeding[MQTT_TOPIC_LEN];
+  char metrics[MQTT_TOPIC_LEN];
+  char petPresent[MQTT_TOPIC_LEN];
+  char eating[MQTT_TOPIC_LEN];
+  char events[MQTT_TOPIC_LEN];
+  char telemetry[MQTT_TOPIC_LEN];
+  char feedCmd[NUM_AUGERS][MQTT_TOPIC_LEN];
+  char log[MQTT_TOPIC_LEN];
+  char logLevel[MQTT_TOPIC_LEN];
+  char config[MQTT_TOPIC_LEN];
+  char configResult[MQTT_TOPIC_LEN];
+  char shadowReported[MQTT_TOPIC_LEN];
+  char shadowDesired[MQTT_TOPIC_LEN];
+  char shadowResult[MQTT_TOPIC_LEN];
+  char feedRecovery[MQTT_TOPIC_LEN];
+} topics;
+
+// Пересылка журнала в MQTT
+static uint8_t logMqttLevel = logLevelFromName(LOG_MQTT_DEFAULT_LEVEL);
+static uint32_t logMqttNext = 0;
+
+// Публикация с учётом в метриках
+static bool mqttPublish(const char* topic, const char* payload, bool retained) {
+  bool ok = mqttClient.publish(topic, payload, retained);
+  if (ok) {
+    mqttPublishOk.inc();
+  } else {
+    mqttPublishFailed.inc();
+  }
+  return ok;
+}
+
+// Двоичная публикация (CBOR из telemetry.h); len == 0 - кодирование не удалось
+static void mqttPublishCbor(const char* topic, const uint8_t* data, size_t len) {
+#if MQTT_CBOR_ENABLED
+  if (len == 0) {
+    mqttPublishFailed.inc();
+    return;
+  }
+  if (mqttClient.publish(topic, data, len, false)) {
+    mqttPublishOk.inc();
+  } else {
+    mqttPublishFailed.inc();
+  }
+#endif
+}
 
 // Callback для входящих MQTT сообщений
 void mqttCallback(char* topic, byte* payload, unsigned int length) {
-  String message = "";
-  for (unsigned int i = 0; i < length; i++) {
-    message += (char)payload[i];
+  mqttReceived.inc();
+  powerActivity();
+  
+  // Настройки: разбор прямо из буфера и без записи в журнал (там пароли).
+  // Общий топик не меняет сеть: один документ отрезал бы все кормушки
+  bool fleet = strcmp(topic, MQTT_TOPIC_CONFIG_FLEET) == 0;
+  if (fleet || strcmp(topic, topics.config) == 0) {
+    provisionBegin(fleet ? "fleet" : "mqtt", fleet ? PROV_ALLOW_LOCAL : PROV_ALLOW_ALL);
+    provisionFeed((const char*)payload, length);
+    ProvisionResult r = provisionEnd();
+    char result[128];
+    provisionResultJson(r, result, sizeof(result));
+    mqttPublish(topics.configResult, result, false);
+    return;
+  }
+  
+  // Дельта желаемого состояния (пустое сообщение - сброс retained)
+  if (strcmp(topic, topics.shadowDesired) == 0) {
+    if (length == 0) return;
+    ShadowResult r = shadowApplyDesired((const char*)payload, length, "mqtt");
+    char result[128];
+    shadowResultJson(r, result, sizeof(result));
+    mqttPublish(topics.shadowResult, result, false);
+    return;
   }
   
-  Serial.print("[MQTT] Получено: ");
-  Serial.print(topic);
-  Serial.print(" -> ");
-  Serial.println(message);
+  // Копия полезной нагрузки со строковым терминатором (без String)
+  char message[MQTT_MESSAGE_MAX_LEN];
+  unsigned int n = length < sizeof(message) - 1 ? length : sizeof(message) - 1;
+  memcpy(message, payload, n);
+  message[n] = '\0';
+  
+  LOGI("MQTT", "Получено: %s -> %s", topic, message);
+  
+  // Уровень пересылки журнала
+  if (strcmp(topic, topics.logLevel) == 0) {
+    logMqttLevel = logLevelFromName(message);
+    LOGI("MQTT", "Уровень журнала в MQTT: %c", logLevelChar(logMqttLevel));
+    return;
+  }
   
-  // Команда кормления
-  if (strcmp(topic, MQTT_TOPIC_FEED_CMD) == 0) {
-    int amount = message.toInt();
+  // Команда кормления (топик шнека 1 или feed_N для остальных)
+  for (int auger = 0; auger < NUM_AUGERS; auger++) {
+    if (strcmp(topic, topics.feedCmd[auger]) != 0) continue;
+    
+    int amount = atoi(message);
     if (amount <= 0) amount = DEFAULT_FEED_AMOUNT;
     
-    Serial.printf("[MQTT] Команда кормления: %d оборотов\n", amount);
-    feed(amount);
-    publishLastFeeding(amount, "mqtt");
+    LOGI("MQTT", "Команда кормления: шнек %d, %d оборотов", auger + 1, amount);
+    feed(auger, amount, "mqtt");
+    return;
   }
 }
 
-// Инициализация MQTT
+// Инициализация MQTT (после deviceIdSetup)
 void mqttSetup() {
-  mqttClient.setServer(MQTT_SERVER, MQTT_PORT);
+  const char* id = deviceId();
+  snprintf(topics.availability, MQTT_TOPIC_LEN, MQTT_TOPIC_AVAILABILITY, id);
+  snprintf(topics.bootTime, MQTT_TOPIC_LEN, MQTT_TOPIC_BOOT_TIME, id);
+  snprintf(topics.lastFeeding, MQTT_TOPIC_LEN, MQTT_TOPIC_LAST_FEEDING, id);
+  snprintf(topics.metrics, MQTT_TOPIC_LEN, MQTT_TOPIC_METRICS, id);
+  snprintf(topics.petPresent, MQTT_TOPIC_LEN, MQTT_TOPIC_PET_PRESENT, id);
+  snprintf(topics.eating, MQTT_TOPIC_LEN, MQTT_TOPIC_EATING, id);
+  snprintf(topics.events, MQTT_TOPIC_LEN, MQTT_TOPIC_EVENTS, id);
+  snprintf(topics.telemetry, MQTT_TOPIC_LEN, MQTT_TOPIC_TELEMETRY, id);
+  snprintf(topics.feedCmd[0], MQTT_TOPIC_LEN, MQTT_TOPIC_FEED_CMD, id);
+  for (int i = 1; i < NUM_AUGERS; i++) {
+    snprintf(topics.feedCmd[i], MQTT_TOPIC_LEN, MQTT_TOPIC_FEED_CMD_AUGER, id, i + 1);
+  }
+  snprintf(topics.log, MQTT_TOPIC_LEN, MQTT_TOPIC_LOG, id);
+  snprintf(topics.logLevel, MQTT_TOPIC_LEN, MQTT_TOPIC_LOG_LEVEL, id);
+  snprintf(topics.config, MQTT_TOPIC_LEN, MQTT_TOPIC_CONFIG, id);
+  snprintf(topics.configResult, MQTT_TOPIC_LEN, MQTT_TOPIC_CONFIG_RESULT, id);
+  snprintf(topics.shadowReported, MQTT_TOPIC_LEN, MQTT_TOPIC_SHADOW_REPORTED, id);
+  snprintf(topics.shadowDesired, MQTT_TOPIC_LEN, MQTT_TOPIC_SHADOW_DESIRED, id);
+  snprintf(topics.shadowResult, MQTT_TOPIC_LEN, MQTT_TOPIC_SHADOW_RESULT, id);
+  snprintf(topics.feedRecovery, MQTT_TOPIC_LEN, MQTT_TOPIC_FEED_RECOVERY, id);
+  
+  mqttClient.setServer(provMqttServer(), provMqttPort());
   mqttClient.setCallback(mqttCallback);
   mqttClient.setBufferSize(1024);
   
-  Serial.println("[MQTT] Настроен");
-  Serial.printf("  Сервер: %s:%d\n", MQTT_SERVER, MQTT_PORT);
-  Serial.printf("  Client ID: %s\n", MQTT_CLIENT_ID);
+  LOGI("MQTT", "Настроен: %s:%u, Client ID: %s", provMqttServer(), provMqttPort(), id);
 }
 
+// Новые адрес или учётные данные брокера: переподключение с ними
+void mqttReconfigure() {
+  mqttClient.disconnect();
+  mqttClient.setServer(provMqttServer(), provMqttPort());
+  mqttConnected = false;
+  discoveryPublished = false;
+  discoveryStep = -1;
+#if MQTT_TLS
+  TlsClient::forgetSession();
+#endif
+  lastMqttReconnect = millis() - MQTT_RECONNECT_INTERVAL;
+  LOGI("MQTT", "Новый брокер: %s:%u", provMqttServer(), provMqttPort());
+}
+
+#if MQTT_TLS
+// Корневой сертификат брокера из хранилища (один раз)
+static bool loadCaCert() {
+  static bool warned = false;
+  if (netClient.hasCaCert()) return true;
+  if (!storageReady()) return false;
+  long size = storageFileSize(MQTT_TLS_CA_FILE);
+  if (size <= 0 || size > 8192) {
+    if (!warned) LOGE("MQTT", "Нет сертификата брокера %s, TLS подключение невозможно", MQTT_TLS_CA_FILE);
+    warned = true;
+    return false;
+  }
+  char* pem = (char*)malloc(size + 1);
+  if (!pem) return false;
+  size_t got = storageRead(MQTT_TLS_CA_FILE, 0, pem, size);
+  pem[got] = '\0';
+  bool ok = netClient.setCaCert(pem);
+  free(pem);
+  return ok;
+}
+#endif
+
 // Подключение к MQTT брокеру
 void mqttConnect() {
-  if (WiFi.status() != WL_CONNECTED) return;
+  if (!wifiLinkUp()) return;
   if (millis() - lastMqttReconnect < MQTT_RECONNECT_INTERVAL) return;
   
   lastMqttReconnect = millis();
   
-  Serial.print("[MQTT] Подключение...");
+#if MQTT_TLS
+  if (!loadCaCert()) return;
+  uint32_t handshakes = netClient.stats().handshakes;
+  uint32_t failures = netClient.stats().failures;
+#endif
+  LOGI("MQTT", "Подключение...");
+  uint32_t start = millis();
   
-  // Last Will: при отключении брокер опубликует "offline"
-  if (mqttClient.connect(MQTT_CLIENT_ID, MQTT_USER, MQTT_PASSWORD, 
-                          MQTT_TOPIC_AVAILABILITY, 0, true, "offline")) {
+  // Last Will: при отключении брокер опубликует "offline".
+  // cleanSession=false: брокер хранит подписки и сообщения QoS 1,
+  // пока устройство переподключается
+  bool ok = mqttClient.connect(deviceId(), provMqttUser(), provMqttPassword(),
+                               topics.availability, 0, true, "offline", false);
+#if MQTT_TLS
+  const TlsStats& tls = netClient.stats();
+  if (tls.handshakes != handshakes) {
+    tlsHandshakeTime.observe(tls.lastHandshakeMs);
+    if (tls.lastResumed) tlsResumed.inc();
+  }
+  if (tls.failures != failures) tlsFailures.inc();
+#endif
+  if (ok) {
     mqttConnected = true;
-    Serial.println(" OK!");
+    mqttConnects.inc();
+    mqttConnectTime.observe(millis() - start);
+    LOGI("MQTT", "Подключено за %lu мс", millis() - start);
     
     // Публикуем "online"
-    mqttClient.publish(MQTT_TOPIC_AVAILABILITY, "online", true);
+    mqttPublish(topics.availability, "online", true);
     
-    // Подписываемся на команды
-    mqttClient.subscribe(MQTT_TOPIC_FEED_CMD);
+    // Подписки повторяем всегда: PubSubClient не сообщает, сохранил ли
+    // брокер сессию. Команды кормления - QoS 0, чтобы брокер не копил
+    // их за время обрыва и не выдал пачкой; настройка - QoS 1
+    for (int i = 0; i < NUM_AUGERS; i++) {
+      mqttClient.subscribe(topics.feedCmd[i], 0);
+    }
+    mqttClient.subscribe(topics.logLevel, 0);
+    mqttClient.subscribe(topics.config, 1);
+    mqttClient.subscribe(MQTT_TOPIC_CONFIG_FLEET, 1);
+    mqttClient.subscribe(topics.shadowDesired, 1);
+    shadowRequestReport();
     
-    // Отправляем Discovery для Home Assistant
-    publishHomeAssistantDiscovery();
+    // Discovery для Home Assistant (с начала, если прошлое подключение
+    // оборвалось посреди отправки)
+    if (!discoveryPublished) {
+      publishHomeAssistantDiscovery();
+    }
     
   } else {
     mqttConnected = false;
-    Serial.printf(" ОШИБКА (код: %d)\n", mqttClient.state());
+    mqttConnectFailed.inc();
+    LOGW("MQTT", "Ошибка подключения (код: %d)", mqttClient.state());
   }
 }
 
 // Обработка MQTT в loop
 void mqttLoop() {
+  TRACE_SCOPE("mqttLoop");
+  ALLOC_SCOPE(ALLOC_MQTT);
+  // Без линка не трогаем сокет - закрываем его и ждём восстановления WiFi
+  if (!wifiLinkUp()) {
+    if (mqttConnected) {
+      netClient.stop();
+      mqttConnected = false;
+    }
+    return;
+  }
+  
   if (!mqttClient.connected()) {
     mqttConnected = false;
     mqttConnect();
@@ -90,119 +319,390 @@ void mqttLoop() {
   if (mqttConnected && !bootTimePublished) {
     publishBootTime();
   }
+  
+  // Discovery: следующая конфигурация
+  if (mqttConnected && discoveryStep >= 0 && millis() - discoveryLast >= MQTT_DISCOVERY_INTERVAL) {
+    discoveryLast = millis();
+    if (!publishDiscoveryStep(discoveryStep++)) {
+      discoveryStep = -1;
+      discoveryPublished = true;
+      LOGI("DISCOVERY", "Готово!");
+    }
+  }
+  
+  // Кормления, прерванные сбросом перед этой загрузкой
+  if (mqttConnected && !recoveryPublished && journalHasRecovery()) {
+    publishFeedRecovery();
+  }
+  
+  // Пересылка новых строк журнала
+  if (mqttConnected && logMqttLevel != LOG_LVL_NONE) {
+    char line[LOG_LINE_LEN + 2];
+    for (int i = 0; i < LOG_MQTT_MAX_PER_LOOP; i++) {
+      if (!logNextLine(logMqttNext, logMqttLevel, line, sizeof(line))) break;
+      mqttPublish(topics.log, line, false);
+    }
+  }
+  
+#if METRICS_MQTT_ENABLED || MQTT_CBOR_ENABLED
+  // Периодическая публикация метрик (JSON для Home Assistant, CBOR для сборщиков)
+  static unsigned long lastMetricsPublish = 0;
+  if (mqttConnected && millis() - lastMetricsPublish >= METRICS_MQTT_INTERVAL) {
+#if METRICS_MQTT_ENABLED
+    publishMetrics();
+#endif
+#if MQTT_CBOR_ENABLED
+    publishTelemetry();
+#endif
+    lastMetricsPublish = millis();
+  }
+#endif
 }
 
 // Публикация времени загрузки
 void publishBootTime() {
   if (!mqttConnected || bootTimePublished) return;
   
-  struct tm timeinfo;
-  if (getLocalTime(&timeinfo)) {
+  // Момент загрузки - текущее время минус аптайм
+  if (timeValid()) {
     char isoTime[40];
-    strftime(isoTime, sizeof(isoTime), "%Y-%m-%dT%H:%M:%S+03:00", &timeinfo);
-    mqttClient.publish(MQTT_TOPIC_BOOT_TIME, isoTime, true);
+    timeIsoAt(timeEpoch() - millis() / 1000, isoTime, sizeof(isoTime));
+    mqttPublish(topics.bootTime, isoTime, true);
     bootTimePublished = true;
-    Serial.printf("[MQTT] Boot time: %s\n", isoTime);
+    LOGI("MQTT", "Boot time: %s", isoTime);
+  }
+}
+
+// Итог восстановления кормлений после сброса (feed_journal.h)
+void publishFeedRecovery() {
+  if (!mqttConnected) return;
+  char json[JOURNAL_JSON_MAX];
+  if (journalRecoveryJson(json, sizeof(json)) == 0) return;
+  if (mqttPublish(topics.feedRecovery, json, true)) {
+    recoveryPublished = true;
+    LOGI("MQTT", "Прерванные кормления: %s", json);
   }
 }
 
 // Публикация последнего кормления
-void publishLastFeeding(int amount, const char* source) {
+void publishLastFeeding(uint8_t auger, int amount, const char* source, int clip) {
   if (!mqttConnected) return;
   
-  struct tm timeinfo;
-  char isoTime[40] = "1970-01-01T00:00:00+00:00";
+  char isoTime[40];
+  timeIso(isoTime, sizeof(isoTime));
   
-  if (getLocalTime(&timeinfo)) {
-    strftime(isoTime, sizeof(isoTime), "%Y-%m-%dT%H:%M:%S+03:00", &timeinfo);
+  // Ссылка на ролик кормления, если он пишется
+  char clipUrl[40] = "";
+  if (clip >= 0) {
+    snprintf(clipUrl, sizeof(clipUrl), ",\"clip\":\"/api/clip?id=%d\"", clip);
   }
   
-  String json = "{";
-  json += "\"timestamp\":\"" + String(isoTime) + "\",";
-  json += "\"amount\":" + String(amount) + ",";
-  json += "\"source\":\"" + String(source) + "\"";
-  json += "}";
+  char json[192];
+  snprintf(json, sizeof(json),
+    "{\"timestamp\":\"%s\",\"amount\":%d,\"auger\":%d,\"source\":\"%s\"%s}",
+    isoTime, amount, auger + 1, source, clipUrl);
+  
+  mqttPublish(topics.lastFeeding, json, true);
+  LOGI("MQTT", "Кормление: %s", json);
   
-  mqttClient.publish(MQTT_TOPIC_LAST_FEEDING, json.c_str(), true);
-  Serial.printf("[MQTT] Кормление: %s\n", json.c_str());
+  uint8_t cbor[TELEMETRY_MAX_LEN];
+  size_t len = telemetryFeeding(cbor, sizeof(cbor), timeEpoch(), millis() / 1000,
+                                auger, amount, source, clip);
+  mqttPublishCbor(topics.events, cbor, len);
 }
 
-// MQTT Auto Discovery для Home Assistant
-void publishHomeAssistantDiscovery() {
+// Кот у миски (детектор на камере)
+void publishPetPresence(bool present) {
   if (!mqttConnected) return;
+  mqttPublish(topics.petPresent, present ? "ON" : "OFF", true);
   
-  Serial.println("[DISCOVERY] Отправка конфигурации...");
+  uint8_t cbor[TELEMETRY_MAX_LEN];
+  size_t len = telemetryPresence(cbor, sizeof(cbor), timeEpoch(), millis() / 1000, present);
+  mqttPublishCbor(topics.events, cbor, len);
+}
+
+// Время у миски после последнего кормления (секунды)
+void publishEatingDuration(uint32_t seconds) {
+  if (!mqttConnected) return;
+  char payload[12];
+  snprintf(payload, sizeof(payload), "%u", (unsigned)seconds);
+  mqttPublish(topics.eating, payload, true);
   
-  // Информация об устройстве
-  const char* device_config = 
+  uint8_t cbor[TELEMETRY_MAX_LEN];
+  size_t len = telemetryEating(cbor, sizeof(cbor), timeEpoch(), millis() / 1000, seconds);
+  mqttPublishCbor(topics.events, cbor, len);
+}
+
+// Публикация метрик (сенсоры Home Assistant)
+void publishMetrics() {
+  if (!mqttConnected) return;
+  
+  const WifiStats& ws = wifiGetStats();
+  char payload[200];
+  snprintf(payload, sizeof(payload),
+    "{"
+      "\"heap_free\":%u,"
+      "\"heap_min\":%u,"
+      "\"heap_largest\":%u,"
+      "\"uptime\":%lu,"
+      "\"wifi_outages\":%u,"
+      "\"wifi_reconnect_ms\":%u,"
+      "\"rssi\":%d"
+    "}",
+    ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getMaxAllocHeap(),
+    millis() / 1000, ws.outages, ws.lastReconnectMs, WiFi.RSSI());
+  mqttPublish(topics.metrics, payload, false);
+}
+
+// Сообщаемое состояние (shadow.h)
+bool publishShadowReported() {
+  if (!mqttConnected) return false;
+  static char doc[SHADOW_DOC_MAX];
+  size_t len = shadowReportedJson(doc, sizeof(doc));
+  if (len == 0) {
+    LOGW("SHADOW", "Документ reported не помещается в SHADOW_DOC_MAX");
+    return false;
+  }
+  return mqttPublish(topics.shadowReported, doc, true);
+}
+
+// Метрики в CBOR для сборщиков на стороне брокера
+void publishTelemetry() {
+  if (!mqttConnected) return;
+  
+  const WifiStats& ws = wifiGetStats();
+  TelemetryMetrics m;
+  m.heapFree = ESP.getFreeHeap();
+  m.heapMin = ESP.getMinFreeHeap();
+  m.heapLargest = ESP.getMaxAllocHeap();
+  m.wifiOutages = ws.outages;
+  m.wifiReconnectMs = ws.lastReconnectMs;
+  m.rssi = WiFi.RSSI();
+  
+  uint8_t cbor[TELEMETRY_MAX_LEN];
+  size_t len = telemetryMetrics(cbor, sizeof(cbor), timeEpoch(), millis() / 1000, m);
+  mqttPublishCbor(topics.telemetry, cbor, len);
+}
+
+// Строка внутри JSON: кавычки, обратная косая черта и управляющие символы
+// экранируются; false - не поместилась
+static bool jsonEscape(const char* s, char* out, size_t size) {
+  BufWriter w(out, size);
+  for (; *s; s++) {
+    unsigned char c = *s;
+    if (c == '"' || c == '\\') {
+      const char e[3] = {'\\', (char)c, '\0'};
+      w.print(e);
+    } else if (c < 0x20) {
+      w.printf("\\u%04x", c);
+    } else {
+      w.write(s, 1);
+    }
+  }
+  return !w.overflow();
+}
+
+// Конфигурация Discovery (len - результат snprintf): обрезанный JSON
+// Home Assistant не разберёт, такой не публикуем
+static bool publishDiscovery(const char* topic, const char* payload, int len, size_t size) {
+  if (len < 0 || (size_t)len >= size) {
+    LOGE("DISCOVERY", "Конфигурация %s не помещается в буфер", topic);
+    return false;
+  }
+  return mqttPublish(topic, payload, true);
+}
+
+#if METRICS_MQTT_ENABLED
+// Сенсоры диагностики (из топика метрик)
+static const struct {
+  const char* key;
+  const char* name;
+  const char* unit;
+  const char* icon;
+} diagSensors[] = {
+  {"heap_free", "Свободная память", "B", "mdi:memory"},
+  {"heap_min", "Минимум свободной памяти", "B", "mdi:memory"},
+  {"heap_largest", "Наибольший свободный блок", "B", "mdi:memory"},
+  {"uptime", "Время работы", "s", "mdi:timer-outline"},
+  {"wifi_outages", "Обрывы WiFi", nullptr, "mdi:wifi-off"},
+  {"wifi_reconnect_ms", "Переподключение WiFi", "ms", "mdi:wifi-sync"},
+  {"rssi", "Уровень сигнала WiFi", "dBm", "mdi:wifi"},
+};
+#endif
+
+// Порядок конфигураций Discovery
+enum {
+  DISCOVERY_AVAILABILITY,
+  DISCOVERY_BOOT_TIME,
+  DISCOVERY_LAST_FEEDING,
+  DISCOVERY_PET_PRESENT,
+  DISCOVERY_EATING,
+  DISCOVERY_FEED              // Кнопки шнеков, затем сенсоры диагностики
+};
+
+// Одна конфигурация Discovery; false - отправлены все
+static bool publishDiscoveryStep(int step) {
+  TRACE_SCOPE("haDiscovery");
+  const char* id = deviceId();
+  const char* device_config = discoveryDevice;
+  char topic[150];
+  char payload[600];
+  int n;
+  
+  switch (step) {
+    case DISCOVERY_AVAILABILITY:
+      snprintf(topic, sizeof(topic), "homeassistant/binary_sensor/%s/availability/config", id);
+      n = snprintf(payload, sizeof(payload),
+        "{"
+          "\"name\":\"Кормушка Онлайн\","
+          "\"unique_id\":\"%s_availability\","
+          "\"state_topic\":\"%s\","
+          "\"payload_on\":\"online\","
+          "\"payload_off\":\"offline\","
+          "\"device_class\":\"connectivity\","
+          "%s"
+        "}", id, topics.availability, device_config);
+      break;
+    
+    case DISCOVERY_BOOT_TIME:
+      snprintf(topic, sizeof(topic), "homeassistant/sensor/%s/boot_time/config", id);
+      n = snprintf(payload, sizeof(payload),
+        "{"
+          "\"name\":\"Время загрузки\","
+          "\"unique_id\":\"%s_boot_time\","
+          "\"state_topic\":\"%s\","
+          "\"device_class\":\"timestamp\","
+          "\"icon\":\"mdi:clock-start\","
+          "%s"
+        "}", id, topics.bootTime, device_config);
+      break;
+    
+    case DISCOVERY_LAST_FEEDING:
+      snprintf(topic, sizeof(topic), "homeassistant/sensor/%s/last_feeding/config", id);
+      n = snprintf(payload, sizeof(payload),
+        "{"
+          "\"name\":\"Последнее кормление\","
+          "\"unique_id\":\"%s_last_feeding\","
+          "\"state_topic\":\"%s\","
+          "\"device_class\":\"timestamp\","
+          "\"icon\":\"mdi:food-drumstick\","
+          "\"value_template\":\"{{ value_json.timestamp }}\","
+          "\"json_attributes_topic\":\"%s\","
+          "%s"
+        "}", id, topics.lastFeeding, topics.lastFeeding, device_config);
+      break;
+    
+    // Камера: кот у миски и время еды после кормления
+    case DISCOVERY_PET_PRESENT:
+      snprintf(topic, sizeof(topic), "homeassistant/binary_sensor/%s/pet_present/config", id);
+      n = snprintf(payload, sizeof(payload),
+        "{"
+          "\"name\":\"Кот у миски\","
+          "\"unique_id\":\"%s_pet_present\","
+          "\"state_topic\":\"%s\","
+          "\"device_class\":\"occupancy\","
+          "\"icon\":\"mdi:cat\","
+          "%s"
+        "}", id, topics.petPresent, device_config);
+      break;
+    
+    case DISCOVERY_EATING:
+      snprintf(topic, sizeof(topic), "homeassistant/sensor/%s/eating_duration/config", id);
+      n = snprintf(payload, sizeof(payload),
+        "{"
+          "\"name\":\"Ел после кормления\","
+          "\"unique_id\":\"%s_eating_duration\","
+          "\"state_topic\":\"%s\","
+          "\"device_class\":\"duration\","
+          "\"unit_of_measurement\":\"s\","
+          "\"icon\":\"mdi:timer-sand\","
+          "%s"
+        "}", id, topics.eating, device_config);
+      break;
+    
+    default:
+      step -= DISCOVERY_FEED;
+      if (step == 0) {
+        // Кнопка шнека 1
+        snprintf(topic, sizeof(topic), "homeassistant/button/%s/feed/config", id);
+        n = snprintf(payload, sizeof(payload),
+          "{"
+            "\"name\":\"Покормить кота\","
+            "\"unique_id\":\"%s_feed_button\","
+            "\"command_topic\":\"%s\","
+            "\"icon\":\"mdi:cat\","
+            "\"payload_press\":\"\","
+            "%s"
+          "}", id, topics.feedCmd[0], device_config);
+        break;
+      }
+      if (step < NUM_AUGERS) {
+        snprintf(topic, sizeof(topic), "homeassistant/button/%s/feed_%d/config", id, step + 1);
+        n = snprintf(payload, sizeof(payload),
+          "{"
+            "\"name\":\"Покормить (миска %d)\","
+            "\"unique_id\":\"%s_feed_button_%d\","
+            "\"command_topic\":\"%s\","
+            "\"icon\":\"mdi:cat\","
+            "\"payload_press\":\"\","
+            "%s"
+          "}", step + 1, id, step + 1, topics.feedCmd[step], device_config);
+        break;
+      }
+#if METRICS_MQTT_ENABLED
+      step -= NUM_AUGERS;
+      if (step < (int)(sizeof(diagSensors) / sizeof(diagSensors[0]))) {
+        const auto& d = diagSensors[step];
+        char unit[40] = "";
+        if (d.unit) snprintf(unit, sizeof(unit), "\"unit_of_measurement\":\"%s\",", d.unit);
+        snprintf(topic, sizeof(topic), "homeassistant/sensor/%s/%s/config", id, d.key);
+        n = snprintf(payload, sizeof(payload),
+          "{"
+            "\"name\":\"%s\","
+            "\"unique_id\":\"%s_%s\","
+            "\"state_topic\":\"%s\","
+            "\"value_template\":\"{{ value_json.%s }}\","
+            "%s"
+            "\"state_class\":\"measurement\","
+            "\"entity_category\":\"diagnostic\","
+            "\"icon\":\"%s\","
+            "%s"
+          "}", d.name, id, d.key, topics.metrics, d.key, unit, d.icon, device_config);
+        break;
+      }
+#endif
+      return false;
+  }
+  
+  publishDiscovery(topic, payload, n, sizeof(payload));
+  return true;
+}
+
+// MQTT Auto Discovery для Home Assistant: запуск отправки конфигураций
+// (сами они уходят из mqttLoop, по одной за проход)
+void publishHomeAssistantDiscovery() {
+  if (!mqttConnected) return;
+  
+  // Информация об устройстве (идентификаторы - из deviceId, у каждой кормушки свои)
+  char name[96];
+  if (!jsonEscape(deviceName(), name, sizeof(name))) {
+    LOGE("DISCOVERY", "Имя устройства слишком длинное для конфигурации");
+    return;
+  }
+  int n = snprintf(discoveryDevice, sizeof(discoveryDevice),
     "\"device\":{"
-      "\"identifiers\":[\"esp32_feeder\"],"
-      "\"name\":\"Кормушка для кота\","
+      "\"identifiers\":[\"%s\"],"
+      "\"name\":\"%s\","
       "\"model\":\"" FIRMWARE_MODEL "\","
       "\"manufacturer\":\"DIY\","
       "\"sw_version\":\"" FIRMWARE_VERSION "\""
-    "}";
-  
-  char topic[150];
-  char payload[600];
+    "}", deviceId(), name);
+  if (n < 0 || (size_t)n >= sizeof(discoveryDevice)) {
+    LOGE("DISCOVERY", "Имя устройства слишком длинное для конфигурации");
+    return;
+  }
   
-  // 1. Binary Sensor: Availability
-  strcpy(topic, "homeassistant/binary_sensor/feeder/availability/config");
-  sprintf(payload,
-    "{"
-      "\"name\":\"Кормушка Онлайн\","
-      "\"unique_id\":\"feeder_availability\","
-      "\"state_topic\":\"%s\","
-      "\"payload_on\":\"online\","
-      "\"payload_off\":\"offline\","
-      "\"device_class\":\"connectivity\","
-      "%s"
-    "}", MQTT_TOPIC_AVAILABILITY, device_config);
-  mqttClient.publish(topic, payload, true);
-  delay(100);
-  
-  // 2. Sensor: Boot Time
-  strcpy(topic, "homeassistant/sensor/feeder/boot_time/config");
-  sprintf(payload,
-    "{"
-      "\"name\":\"Время загрузки\","
-      "\"unique_id\":\"feeder_boot_time\","
-      "\"state_topic\":\"%s\","
-      "\"device_class\":\"timestamp\","
-      "\"icon\":\"mdi:clock-start\","
-      "%s"
-    "}", MQTT_TOPIC_BOOT_TIME, device_config);
-  mqttClient.publish(topic, payload, true);
-  delay(100);
-  
-  // 3. Sensor: Last Feeding
-  strcpy(topic, "homeassistant/sensor/feeder/last_feeding/config");
-  sprintf(payload,
-    "{"
-      "\"name\":\"Последнее кормление\","
-      "\"unique_id\":\"feeder_last_feeding\","
-      "\"state_topic\":\"%s\","
-      "\"device_class\":\"timestamp\","
-      "\"icon\":\"mdi:food-drumstick\","
-      "\"value_template\":\"{{ value_json.timestamp }}\","
-      "\"json_attributes_topic\":\"%s\","
-      "%s"
-    "}", MQTT_TOPIC_LAST_FEEDING, MQTT_TOPIC_LAST_FEEDING, device_config);
-  mqttClient.publish(topic, payload, true);
-  delay(100);
-  
-  // 4. Button: Feed
-  strcpy(topic, "homeassistant/button/feeder/feed/config");
-  sprintf(payload,
-    "{"
-      "\"name\":\"Покормить кота\","
-      "\"unique_id\":\"feeder_feed_button\","
-      "\"command_topic\":\"%s\","
-      "\"icon\":\"mdi:cat\","
-      "\"payload_press\":\"\","
-      "%s"
-    "}", MQTT_TOPIC_FEED_CMD, device_config);
-  mqttClient.publish(topic, payload, true);
-  
-  Serial.println("[DISCOVERY] Готово!");
+  LOGI("DISCOVERY", "Отправка конфигурации...");
+  discoveryStep = 0;
+  discoveryLast = millis() - MQTT_DISCOVERY_INTERVAL;
 }
@@ -0,0 +1,249 @@
+/*
+  ota_update.cpp - Обновление прошивки через HTTP с докачкой и откатом
+*/
+
+#include "ota_update.h"
+#include "ota_validate.h"
+#include "gzip_stream.h"
+#include "wifi_manager.h"
+#include "mqtt_handler.h"
+#include "led_engine.h"
+#include "logger.h"
+#include "time_service.h"
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <esp_app_format.h>
+#include <time.h>
+
+// Сессия приёма образа
+static OtaState state = OTA_IDLE;
+static uint32_t received = 0;
+static uint32_t total = 0;
+static uint32_t written = 0;
+static bool compressed = false;
+static bool formatKnown = false;
+static const char* lastError = nullptr;
+static GzipStream gzip;
+static esp_ota_handle_t handle = 0;
+static const esp_partition_t* target = nullptr;
+static uint32_t lastChunkAt = 0;
+static uint32_t rebootRequestedAt = 0;
+
+// Проверка новой прошивки
+static bool validating = false;
+static uint32_t validateStart = 0;
+
+// Закрытие сессии (error == nullptr - без ошибки)
+static void sessionClose(const char* error) {
+  if (handle) {
+    esp_ota_abort(handle);
+    handle = 0;
+  }
+  gzip.end();
+  if (error) {
+    LOGE("OTA", "Ошибка: %s (принято %u из %u байт)", error, received, total);
+    lastError = error;
+    state = OTA_FAILED;
+    ledOtaEnd(false);
+  } else {
+    state = OTA_IDLE;
+  }
+}
+
+static bool fail(const char* error) {
+  sessionClose(error);
+  return false;
+}
+
+// Приёмник распакованных данных - сразу во flash
+static bool flashSink(const uint8_t* data, size_t len, void*) {
+  if (esp_ota_write(handle, data, len) != ESP_OK) return false;
+  written += len;
+  return true;
+}
+
+// Переключение загрузчика на прошлый раздел и перезагрузка
+static void rollback(const char* reason) {
+  Preferences prefs;
+  char prev[sizeof(((esp_partition_t*)0)->label)] = "";
+  prefs.begin("ota", false);
+  prefs.getString("prev", prev, sizeof(prev));
+  prefs.putBool("pending", false);
+  prefs.end();
+  validating = false;
+
+  const esp_partition_t* part =
+    esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, prev);
+  if (!part || esp_ota_set_boot_partition(part) != ESP_OK) {
+    LOGE("OTA", "%s, но раздел '%s' недоступен - остаёмся на текущей прошивке", reason, prev);
+    return;
+  }
+
+  LOGE("OTA", "%s - откат на раздел %s", reason, prev);
+  delay(LOG_DRAIN_PERIOD * 5);  // Журнал выводится асинхронно
+  ESP.restart();
+}
+
+void otaMarkPending() {
+  const esp_partition_t* running = esp_ota_get_running_partition();
+  Preferences prefs;
+  prefs.begin("ota", false);
+  prefs.putBool("pending", true);
+  prefs.putUChar("boots", 0);
+  prefs.putString("prev", running->label);
+  prefs.end();
+}
+
+void otaUpdateSetup() {
+  const esp_partition_t* running = esp_ota_get_running_partition();
+  Preferences prefs;
+  prefs.begin("ota", false);
+  validating = prefs.getBool("pending", false);
+  uint8_t boots = 0;
+  if (validating) {
+    boots = prefs.getUChar("boots", 0) + 1;
+    prefs.putUChar("boots", boots);
+  }
+  prefs.end();
+
+  if (!validating) {
+    LOGI("OTA", "Раздел %s", running->label);
+    return;
+  }
+
+  LOGW("OTA", "Прошивка в разделе %s не подтверждена, загрузка %u из %d",
+       running->label, boots, OTA_MAX_BOOT_ATTEMPTS);
+  if (otaBootsExhausted(boots, OTA_MAX_BOOT_ATTEMPTS)) {
+    rollback("Попытки загрузки исчерпаны");
+    return;
+  }
+  validateStart = millis();
+}
+
+// Самопроверки и решение по новой прошивке
+static void validateLoop() {
+  // Время - именно синхронизация NTP, восстановленное после сброса не в счёт
+  OtaSelfTest tests = {wifiLinkUp(), mqttConnected, timeStatus().synced};
+
+  switch (otaValidate(tests, millis() - validateStart, OTA_VALIDATE_TIMEOUT)) {
+    case OTA_VERDICT_VALID: {
+      Preferences prefs;
+      prefs.begin("ota", false);
+      prefs.putBool("pending", false);
+      prefs.end();
+#ifdef CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+      esp_ota_mark_app_valid_cancel_rollback();
+#endif
+      validating = false;
+      LOGI("OTA", "Самопроверки пройдены за %lu мс, прошивка подтверждена",
+           millis() - validateStart);
+      break;
+    }
+    case OTA_VERDICT_ROLLBACK: {
+      LOGE("OTA", "Самопроверки: WiFi %s, MQTT %s, расписание %s",
+           tests.wifi ? "OK" : "FAIL", tests.mqtt ? "OK" : "FAIL",
+           tests.schedule ? "OK" : "FAIL");
+      rollback("Самопроверки не пройдены");
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void otaUpdateLoop() {
+  if (validating) validateLoop();
+
+  if (state == OTA_RECEIVING && millis() - lastChunkAt > OTA_SESSION_TIMEOUT) {
+    sessionClose("session timeout");
+  }
+
+  if (state == OTA_REBOOTING && millis() - rebootRequestedAt > OTA_REBOOT_DELAY) {
+    ESP.restart();
+  }
+}
+
+bool otaChunkBegin(uint32_t offset, uint32_t size) {
+  if (state == OTA_REBOOTING) return false;
+
+  if (offset == 0) {
+    // Новая сессия (прошлая, если была, отменяется)
+    if (state == OTA_RECEIVING) sessionClose(nullptr);
+    received = 0;
+    written = 0;
+    total = size;
+    formatKnown = false;
+    lastError = nullptr;
+    if (size == 0) return fail("image size required");
+
+    target = esp_ota_get_next_update_partition(nullptr);
+    if (!target) return fail("no OTA partition");
+    if (esp_ota_begin(target, OTA_WITH_SEQUENTIAL_WRITES, &handle) != ESP_OK) {
+      handle = 0;
+      return fail("esp_ota_begin failed");
+    }
+    state = OTA_RECEIVING;
+    LOGI("OTA", "Приём образа: %u байт в раздел %s", size, target->label);
+    ledOtaStart();
+  } else if (state != OTA_RECEIVING || offset != received) {
+    LOGW("OTA", "Кусок со смещения %u отклонён (принято %u)", offset, received);
+    return false;
+  }
+
+  lastChunkAt = millis();
+  return true;
+}
+
+bool otaChunkWrite(const uint8_t* data, size_t len) {
+  if (state != OTA_RECEIVING) return false;
+  if (received + len > total) return fail("more data than announced");
+
+  // Формат определяется по первым байтам: gzip или образ ESP32
+  if (!formatKnown) {
+    if (len < 2) return fail("first chunk too short");
+    compressed = GzipStream::isGzip(data, len);
+    if (!compressed && data[0] != ESP_IMAGE_HEADER_MAGIC) return fail("unknown image format");
+    if (compressed && !gzip.begin(flashSink, nullptr)) return fail(gzip.error());
+    formatKnown = true;
+  }
+
+  bool ok = compressed ? gzip.write(data, len) : flashSink(data, len, nullptr);
+  if (!ok) return fail(compressed ? gzip.error() : "flash write failed");
+
+  uint8_t before = (uint64_t)received * 100 / total;
+  received += len;
+  uint8_t percent = (uint64_t)received * 100 / total;
+  ledOtaProgress(percent);
+  if (percent / 10 != before / 10) {
+    LOGI("OTA", "%u%%", percent);
+  }
+  lastChunkAt = millis();
+  return true;
+}
+
+bool otaChunkEnd() {
+  if (state != OTA_RECEIVING) return false;
+  if (received < total) return true;  // Ждём следующий кусок
+
+  if (compressed && !gzip.finished()) return fail("truncated gzip stream");
+  gzip.end();
+
+  // esp_ota_end проверяет образ (контрольная сумма, SHA-256) и освобождает handle
+  esp_err_t err = esp_ota_end(handle);
+  handle = 0;
+  if (err != ESP_OK) return fail("image verification failed");
+  if (esp_ota_set_boot_partition(target) != ESP_OK) return fail("set boot partition failed");
+
+  otaMarkPending();
+  LOGI("OTA", "Образ записан: %u байт (%s %u), перезагрузка",
+       written, compressed ? "сжато" : "передано", received);
+  ledOtaEnd(true);
+  state = OTA_REBOOTING;
+  rebootRequestedAt = millis();
+  return true;
+}
+
+OtaStatus otaUpdateStatus() {
+  OtaStatus s = {state, received, total, written, compressed, validating, lastError};
+  return s;
+}
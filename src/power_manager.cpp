@@ -0,0 +1,170 @@
+/*
+  power_manager.cpp - Экономный режим между событиями
+*/
+
+#include "power_manager.h"
+#include "feeder.h"
+#include "camera.h"
+#include "ota_update.h"
+#include "wifi_manager.h"
+#include "metrics.h"
+#include "logger.h"
+#include <esp_wifi.h>
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+
+static_assert(POWER_IDLE_CPU_MHZ >= 80, "Below 80 MHz the APB clock drops and breaks timers and UART");
+static_assert(POWER_IDLE_LOOP_MS * 2 < TRACE_STALL_MS, "Idle pause must stay well below the loop stall threshold");
+
+static TaskHandle_t loopTask = nullptr;
+static PowerStats stats = {POWER_ACTIVE, 0, 0, 0, 0, false};
+static uint32_t lastActivity = 0;
+static uint32_t lastAccount = 0;
+static uint32_t modeMs[2] = {0, 0};   // Неучтённые миллисекунды по режимам
+static bool linkWasUp = false;
+
+#if CONFIG_PM_ENABLE
+// Частоту и сон выбирает esp_pm: в активном режиме блокировки захвачены
+static esp_pm_lock_handle_t cpuLock = nullptr;
+static esp_pm_lock_handle_t sleepLock = nullptr;
+#endif
+
+static Gauge powerModeGauge("feeder_power_mode", "Power mode (0 - active, 1 - idle)");
+static Gauge cpuMhz("feeder_cpu_mhz", "CPU frequency in the current power mode");
+static Counter powerTransitions("feeder_power_transitions_total", "Power mode changes");
+static Counter powerActiveSec("feeder_power_active_seconds_total", "Time in active power mode");
+static Counter powerIdleSec("feeder_power_idle_seconds_total", "Time in idle power mode");
+static Counter loopWakeups("feeder_loop_wakeups_total", "loop() wakeups");
+
+static void applyWifiSleep() {
+  esp_wifi_set_ps(stats.mode == POWER_IDLE ? WIFI_PS_MAX_MODEM : WIFI_PS_NONE);
+}
+
+static void applyMode() {
+  bool active = stats.mode == POWER_ACTIVE;
+#if CONFIG_PM_ENABLE
+  if (cpuLock) {
+    if (active) {
+      esp_pm_lock_acquire(cpuLock);
+      esp_pm_lock_acquire(sleepLock);
+    } else {
+      esp_pm_lock_release(sleepLock);
+      esp_pm_lock_release(cpuLock);
+    }
+  } else
+#endif
+  {
+    setCpuFrequencyMhz(active ? POWER_ACTIVE_CPU_MHZ : POWER_IDLE_CPU_MHZ);
+  }
+  cpuMhz.set(active ? POWER_ACTIVE_CPU_MHZ : POWER_IDLE_CPU_MHZ);
+  powerModeGauge.set(stats.mode);
+  if (wifiLinkUp()) applyWifiSleep();
+}
+
+static void setMode(PowerMode mode) {
+  if (mode == stats.mode) return;
+  stats.mode = mode;
+  stats.transitions++;
+  powerTransitions.inc();
+  applyMode();
+  LOGD("POWER", "%s", mode == POWER_IDLE ? "Простой" : "Активный режим");
+}
+
+// Время по режимам (целыми секундами в метрики)
+static void account(uint32_t now) {
+  uint32_t& ms = modeMs[stats.mode];
+  ms += now - lastAccount;
+  lastAccount = now;
+  uint32_t sec = ms / 1000;
+  if (sec == 0) return;
+  ms -= sec * 1000;
+  if (stats.mode == POWER_ACTIVE) {
+    stats.activeSec += sec;
+    powerActiveSec.inc(sec);
+  } else {
+    stats.idleSec += sec;
+    powerIdleSec.inc(sec);
+  }
+}
+
+// Работа, которой нужна полная частота и быстрый WiFi
+static bool busy() {
+  for (uint8_t i = 0; i < NUM_AUGERS; i++) {
+    if (feederBusy(i)) return true;
+  }
+  return cameraStreamClients() > 0 || otaUpdateStatus().state == OTA_RECEIVING;
+}
+
+void powerSetup() {
+  loopTask = xTaskGetCurrentTaskHandle();
+  lastActivity = lastAccount = millis();
+
+#if POWER_MANAGEMENT && CONFIG_PM_ENABLE
+  esp_pm_config_esp32_t pm = {};
+  pm.max_freq_mhz = POWER_ACTIVE_CPU_MHZ;
+  pm.min_freq_mhz = POWER_IDLE_CPU_MHZ;
+  pm.light_sleep_enable = POWER_LIGHT_SLEEP;
+  if (esp_pm_configure(&pm) == ESP_OK &&
+      esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "power", &cpuLock) == ESP_OK &&
+      esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "power", &sleepLock) == ESP_OK) {
+    esp_pm_lock_acquire(cpuLock);
+    esp_pm_lock_acquire(sleepLock);
+    stats.lightSleep = POWER_LIGHT_SLEEP;
+  } else {
+    cpuLock = nullptr;
+    LOGW("POWER", "esp_pm недоступен, только частота и modem sleep");
+  }
+#endif
+
+  applyMode();
+  LOGI("POWER", "Управление питанием: %s, простой - %d МГц%s",
+       POWER_MANAGEMENT ? "вкл" : "выкл", POWER_IDLE_CPU_MHZ,
+       stats.lightSleep ? " и light sleep" : ", modem sleep");
+}
+
+void powerLoop() {
+  uint32_t now = millis();
+  account(now);
+  if (busy()) lastActivity = now;
+
+  // Режим энергосбережения WiFi сбрасывается при запуске станции
+  bool up = wifiLinkUp();
+  if (up && !linkWasUp) applyWifiSleep();
+  linkWasUp = up;
+
+#if POWER_MANAGEMENT
+  setMode(now - lastActivity < POWER_IDLE_DELAY ? POWER_ACTIVE : POWER_IDLE);
+#endif
+}
+
+void powerActivity() {
+  lastActivity = millis();
+  setMode(POWER_ACTIVE);
+}
+
+void powerIdle() {
+  uint32_t ms = stats.mode == POWER_IDLE ? POWER_IDLE_LOOP_MS : POWER_ACTIVE_LOOP_MS;
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+  stats.wakeups++;
+  loopWakeups.inc();
+}
+
+void powerWake() {
+  if (loopTask) xTaskNotifyGive(loopTask);
+}
+
+void IRAM_ATTR powerWakeFromIsr() {
+  if (!loopTask) return;
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(loopTask, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+PowerMode powerMode() {
+  return stats.mode;
+}
+
+const PowerStats& powerGetStats() {
+  return stats;
+}
@@ -0,0 +1,177 @@
+/*
+  presence.cpp - Кот у миски: детектор на кадрах камеры и сенсоры Home Assistant
+*/
+
+#include "presence.h"
+#include "presence_detect.h"
+#include "camera.h"
+#include "mqtt_handler.h"
+#include "metrics.h"
+#include "logger.h"
+#include <esp_jpg_decode.h>
+#include <esp_timer.h>
+#include <atomic>
+
+static PresenceDetector detector;
+static uint8_t gray[PRESENCE_W * PRESENCE_H];
+static bool ready = false;
+static std::atomic<bool> present(false);
+
+// Окно учёта еды после кормления (только loop)
+static bool eatWindow = false;
+static uint32_t eatStartMs = 0;
+static uint32_t eatMs = 0;
+static uint32_t eatLastMs = 0;
+
+static Gauge presenceGauge("feeder_presence", "Pet at the bowl (0/1)");
+static Gauge presenceBlocks("feeder_presence_active_blocks", "Blocks differing from the background");
+static Counter presenceRelearns("feeder_presence_relearns_total", "Background re-learned (light change, scene change)");
+static Counter presenceDecodeErrors("feeder_presence_decode_errors_total", "Frames the detector failed to decode");
+static Histogram presenceFrameUs("feeder_presence_frame_us", "Decode + detector time per frame",
+                                 nullptr, METRICS_BUCKETS_US, METRICS_BUCKETS_US_COUNT);
+
+// ==================== ДЕКОДИРОВАНИЕ ====================
+struct GrayDecode {
+  const uint8_t* jpeg;
+  size_t len;
+  uint16_t width;   // Размер после масштабирования декодером
+  uint16_t height;
+};
+
+static size_t jpegRead(void* arg, size_t index, uint8_t* buf, size_t len) {
+  GrayDecode* d = (GrayDecode*)arg;
+  if (index + len > d->len) len = d->len - index;
+  if (buf) memcpy(buf, d->jpeg + index, len);
+  return len;
+}
+
+// Блоки RGB888 от декодера - в серый кадр PRESENCE_W x PRESENCE_H
+// (ближайший пиксель, если масштаб декодера не дал ровно этот размер)
+static bool grayWrite(void* arg, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t* data) {
+  if (!data) return true;  // Начало и конец кадра
+  GrayDecode* d = (GrayDecode*)arg;
+  for (uint16_t iy = 0; iy < h; iy++) {
+    uint16_t gy = (uint32_t)(y + iy) * PRESENCE_H / d->height;
+    if (gy >= PRESENCE_H) break;
+    const uint8_t* p = data + (size_t)iy * w * 3;
+    for (uint16_t ix = 0; ix < w; ix++, p += 3) {
+      uint16_t gx = (uint32_t)(x + ix) * PRESENCE_W / d->width;
+      if (gx >= PRESENCE_W) break;
+      gray[gy * PRESENCE_W + gx] = (p[0] * 77 + p[1] * 150 + p[2] * 29) >> 8;
+    }
+  }
+  return true;
+}
+
+// Наименьший масштаб декодера, который не меньше целевого кадра
+static bool decodeGray(const FrameSlot* f) {
+  static const jpg_scale_t scales[] = {JPG_SCALE_8X, JPG_SCALE_4X, JPG_SCALE_2X, JPG_SCALE_NONE};
+  static const uint8_t divs[] = {8, 4, 2, 1};
+  uint8_t s = 0;
+  while (s < 3 && (f->info.width / divs[s] < PRESENCE_W || f->info.height / divs[s] < PRESENCE_H)) s++;
+
+  GrayDecode d = {f->data, f->info.len,
+                  (uint16_t)(f->info.width / divs[s]), (uint16_t)(f->info.height / divs[s])};
+  return esp_jpg_decode(f->info.len, scales[s], jpegRead, grayWrite, &d) == ESP_OK;
+}
+
+// ==================== ЗАДАЧА ====================
+static void presenceTask(void*) {
+  uint32_t seq = 0;
+  uint32_t relearns = 0;
+
+  for (;;) {
+    int64_t start = esp_timer_get_time();
+    FrameSlot* f = cameraLatestFrame(seq);
+    uint32_t spentUs = 0;
+
+    if (f) {
+      seq = f->info.seq;
+      bool ok = decodeGray(f);
+      cameraRelease(f);
+
+      if (ok) {
+        bool now = detector.update(gray, millis());
+        if (now != present.load(std::memory_order_relaxed)) {
+          present.store(now, std::memory_order_release);
+          LOGI("PRESENCE", now ? "Кот у миски" : "Кот ушёл");
+        }
+        presenceGauge.set(now);
+        presenceBlocks.set(detector.activeBlocks());
+        if (detector.relearns() != relearns) {
+          relearns = detector.relearns();
+          presenceRelearns.set(relearns);
+        }
+      } else {
+        presenceDecodeErrors.inc();
+      }
+      spentUs = esp_timer_get_time() - start;
+      presenceFrameUs.observe(spentUs);
+    }
+
+    // Пауза - до следующего кадра, но не меньше, чем требует бюджет ядра
+    uint32_t periodMs = 1000 / PRESENCE_FPS;
+    uint32_t spentMs = spentUs / 1000;
+    uint32_t waitMs = periodMs > spentMs ? periodMs - spentMs : 0;
+    uint32_t budgetMs = spentMs * (100 - PRESENCE_CPU_PERCENT) / PRESENCE_CPU_PERCENT;
+    if (waitMs < budgetMs) waitMs = budgetMs;
+    // Без кадров: сенсор в standby - ждать дольше, иначе кадр скоро будет
+    vTaskDelay(pdMS_TO_TICKS(f ? waitMs : cameraAsleep() ? CAMERA_STANDBY_POLL_MS : 20) + 1);
+  }
+}
+
+void presenceSetup() {
+  if (!cameraReady()) return;
+  if (!detector.begin(PRESENCE_W, PRESENCE_H)) {
+    LOGE("PRESENCE", "Не хватило памяти под фон детектора");
+    return;
+  }
+  // Детектору хватает самого малого разрешения, большее он уменьшит сам
+  cameraSetBackground(PRESENCE_FPS, FRAME_QQVGA);
+  xTaskCreatePinnedToCore(presenceTask, "presence", 6144, nullptr, 1, nullptr, 0);
+  ready = true;
+  LOGI("PRESENCE", "Детектор: %dx%d, %d кадр/с, бюджет %d%%",
+       PRESENCE_W, PRESENCE_H, PRESENCE_FPS, PRESENCE_CPU_PERCENT);
+}
+
+bool presenceDetected() {
+  return present.load(std::memory_order_acquire);
+}
+
+void presenceOnFeed() {
+  if (!ready) return;
+  eatWindow = true;
+  eatStartMs = millis();
+  eatLastMs = eatStartMs;
+  eatMs = 0;
+  publishEatingDuration(0);
+}
+
+void presenceLoop() {
+  if (!ready) return;
+  static bool lastPresent = false;
+  static bool wasConnected = false;
+  uint32_t now = millis();
+  bool isPresent = presenceDetected();
+
+  // Время у миски в окне после кормления; публикуется, когда кот уходит,
+  // и по закрытии окна
+  if (eatWindow) {
+    if (isPresent) eatMs += now - eatLastMs;
+    eatLastMs = now;
+    if (now - eatStartMs >= PRESENCE_EAT_WINDOW_MS) {
+      eatWindow = false;
+      publishEatingDuration(eatMs / 1000);
+      LOGI("PRESENCE", "Ел после кормления %u с", (unsigned)(eatMs / 1000));
+    } else if (!isPresent && lastPresent) {
+      publishEatingDuration(eatMs / 1000);
+    }
+  }
+
+  // Состояние - при изменении и после каждого подключения к брокеру
+  if (mqttConnected && (!wasConnected || isPresent != lastPresent)) {
+    publishPetPresence(isPresent);
+  }
+  lastPresent = isPresent;
+  wasConnected = mqttConnected;
+}
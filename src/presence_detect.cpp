@@ -0,0 +1,172 @@
+/*
+  presence_detect.cpp - Детектор кота у миски по уменьшенным серым кадрам
+*/
+
+#include "presence_detect.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define LANES 0x00FF00FFu  // Младшие байты двух 16-битных полос
+#define LANE1 0x00010001u
+
+static inline uint32_t load32(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+// ==================== SAD ====================
+void presenceSadRef(const uint8_t* cur, const uint8_t* bg, uint16_t w, uint16_t h, uint16_t* sad) {
+  uint16_t bw = w / PRESENCE_BLOCK;
+  uint16_t bh = h / PRESENCE_BLOCK;
+  for (uint16_t by = 0; by < bh; by++) {
+    for (uint16_t bx = 0; bx < bw; bx++) {
+      uint32_t sum = 0;
+      for (uint16_t y = 0; y < PRESENCE_BLOCK; y++) {
+        size_t row = (size_t)(by * PRESENCE_BLOCK + y) * w + bx * PRESENCE_BLOCK;
+        for (uint16_t x = 0; x < PRESENCE_BLOCK; x++) {
+          int d = cur[row + x] - bg[row + x];
+          sum += d < 0 ? -d : d;
+        }
+      }
+      sad[by * bw + bx] = sum;
+    }
+  }
+}
+
+// |a - b| в каждой полосе (a, b - байты в младших половинах полос).
+// В полосе 256 + a - b: бит 8 сброшен, если a < b, и тогда модуль -
+// дополнение младшего байта
+static inline uint32_t absDiffLanes(uint32_t a, uint32_t b) {
+  uint32_t d = (a + 0x01000100u) - b;
+  uint32_t neg = (~d >> 8) & LANE1;
+  return ((d & LANES) ^ (neg * 0xFF)) + neg;
+}
+
+// Строка блока - два слова по четыре пикселя; сумма в полосах копится по
+// всем блокам строки блоков сразу (не больше 8 * 2 * 2 * 255 на полосу)
+void presenceSad(const uint8_t* cur, const uint8_t* bg, uint16_t w, uint16_t h, uint16_t* sad) {
+  uint16_t bw = w / PRESENCE_BLOCK;
+  uint16_t bh = h / PRESENCE_BLOCK;
+  uint32_t acc[PRESENCE_W / PRESENCE_BLOCK];
+
+  for (uint16_t by = 0; by < bh; by++) {
+    memset(acc, 0, sizeof(acc));
+    for (uint16_t y = 0; y < PRESENCE_BLOCK; y++) {
+      size_t row = (size_t)(by * PRESENCE_BLOCK + y) * w;
+      const uint8_t* c = cur + row;
+      const uint8_t* g = bg + row;
+      for (uint16_t bx = 0; bx < bw; bx++, c += 8, g += 8) {
+        uint32_t c0 = load32(c), c1 = load32(c + 4);
+        uint32_t g0 = load32(g), g1 = load32(g + 4);
+        acc[bx] += absDiffLanes(c0 & LANES, g0 & LANES) +
+                   absDiffLanes((c0 >> 8) & LANES, (g0 >> 8) & LANES) +
+                   absDiffLanes(c1 & LANES, g1 & LANES) +
+                   absDiffLanes((c1 >> 8) & LANES, (g1 >> 8) & LANES);
+      }
+    }
+    for (uint16_t bx = 0; bx < bw; bx++) {
+      sad[by * bw + bx] = (acc[bx] & 0xFFFF) + (acc[bx] >> 16);
+    }
+  }
+}
+
+// ==================== ФОН ====================
+// Сдвиг на 256 делает разность неотрицательной: округление одинаковое
+// в скалярной и упакованной версиях
+void presenceBlendRef(uint8_t* bg, const uint8_t* cur, size_t n, uint8_t shift) {
+  int half = (1 << shift) >> 1;
+  for (size_t i = 0; i < n; i++) {
+    bg[i] += ((256 + cur[i] - bg[i] + half) >> shift) - (256 >> shift);
+  }
+}
+
+// Полосы до сдвига меньше 1024, поэтому маска (0x3FF >> shift) отрезает
+// биты, сдвинутые из соседней полосы; результат в полосе 0..255
+static inline uint32_t blendLanes(uint32_t b, uint32_t c, uint8_t shift,
+                                  uint32_t half, uint32_t mask, uint32_t bias) {
+  uint32_t d = (c + 0x01000100u) - b + half;
+  return b + ((d >> shift) & mask) - bias;
+}
+
+void presenceBlend(uint8_t* bg, const uint8_t* cur, size_t n, uint8_t shift) {
+  uint32_t half = ((1u << shift) >> 1) * LANE1;
+  uint32_t mask = (0x3FFu >> shift) * LANE1;
+  uint32_t bias = (256u >> shift) * LANE1;
+
+  for (size_t i = 0; i < n; i += 4) {
+    uint32_t b = load32(bg + i);
+    uint32_t c = load32(cur + i);
+    uint32_t lo = blendLanes(b & LANES, c & LANES, shift, half, mask, bias);
+    uint32_t hi = blendLanes((b >> 8) & LANES, (c >> 8) & LANES, shift, half, mask, bias);
+    uint32_t v = lo | (hi << 8);
+    memcpy(bg + i, &v, 4);
+  }
+}
+
+// ==================== ДЕТЕКТОР ====================
+bool PresenceDetector::begin(uint16_t w, uint16_t h) {
+  if (_bg) return true;
+  _w = w;
+  _h = h;
+  _blocks = (w / PRESENCE_BLOCK) * (h / PRESENCE_BLOCK);
+  _bg = (uint8_t*)malloc((size_t)w * h);
+  _sad = (uint16_t*)malloc(sizeof(uint16_t) * _blocks);
+  if (!_bg || !_sad) {
+    free(_bg);
+    free(_sad);
+    _bg = nullptr;
+    _sad = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void PresenceDetector::relearn(const uint8_t* gray) {
+  memcpy(_bg, gray, (size_t)_w * _h);
+  _hasBg = true;
+  _hits = 0;
+  _relearns++;
+}
+
+bool PresenceDetector::update(const uint8_t* gray, uint32_t nowMs) {
+  if (!_hasBg) {
+    relearn(gray);
+    return _present;
+  }
+
+  presenceSad(gray, _bg, _w, _h, _sad);
+  uint16_t active = 0;
+  for (uint16_t i = 0; i < _blocks; i++) {
+    if (_sad[i] > PRESENCE_PIXEL_DIFF * PRESENCE_BLOCK * PRESENCE_BLOCK) active++;
+  }
+  _active = active;
+
+  // Изменился почти весь кадр разом - свет или экспозиция, а не кот
+  if ((uint32_t)active * 100 >= (uint32_t)_blocks * PRESENCE_GLOBAL_PERCENT) {
+    relearn(gray);
+    return _present;
+  }
+
+  bool foreground = active >= PRESENCE_MIN_BLOCKS;
+  if (foreground) {
+    _lastForegroundMs = nowMs;
+    if (!_present && ++_hits >= PRESENCE_ON_FRAMES) {
+      _present = true;
+      _presentSinceMs = nowMs;
+    }
+  } else {
+    _hits = 0;
+    if (_present && nowMs - _lastForegroundMs >= PRESENCE_OFF_MS) _present = false;
+  }
+
+  // Фон учится только на кадрах без отличий. Отличие дольше
+  // PRESENCE_RELEARN_MS - скорее новая сцена (сдвинули миску), чем кот
+  if (!foreground) {
+    presenceBlend(_bg, gray, (size_t)_w * _h, PRESENCE_BG_SHIFT);
+  } else if (_present && nowMs - _presentSinceMs >= PRESENCE_RELEARN_MS) {
+    relearn(gray);
+    _present = false;
+  }
+  return _present;
+}
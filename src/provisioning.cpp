@@ -0,0 +1,395 @@
+/*
+  provisioning.cpp - Настройки устройства из JSON документа без перепрошивки
+*/
+
+#include "provisioning.h"
+#include "json_stream.h"
+#include "settings_json.h"
+#include "schedule.h"
+#include "feeder.h"
+#include "storage.h"
+#include "wifi_manager.h"
+#include "mqtt_handler.h"
+#include "time_service.h"
+#include "checksum.h"
+#include "metrics.h"
+#include "logger.h"
+#include <Preferences.h>
+
+#define PROV_FILE "/config.json"
+#define PROV_READ_CHUNK 128
+
+// Сетевые параметры и пояс (хранятся в NVS)
+struct NetConfig {
+  char wifiSsid[33];
+  char wifiPassword[65];
+  char mqttServer[64];
+  uint16_t mqttPort;
+  char mqttUser[33];
+  char mqttPassword[65];
+  char timeZone[48];
+};
+
+// Действующие значения; PubSubClient держит указатель на mqttServer
+static NetConfig live;
+// Сохранённые в NVS: последние WiFi и MQTT, с которыми связь поднималась
+static NetConfig stored;
+
+// Пробные группы (PROV_WIFI | PROV_MQTT) и начало пробы
+static uint8_t trial = 0;
+static unsigned long trialStart = 0;
+
+// Черновик разбираемого документа (один на все источники - все они в loop)
+static struct {
+  JsonStream json;
+  NetConfig net;
+  int feedAmount[NUM_AUGERS];
+  Schedule schedules[MAX_SCHEDULES];
+  int scheduleCount;      // Элементов в schedules (-1 - ключа нет)
+  char error[SETTINGS_ERROR_LEN];
+  const char* source;
+  uint8_t allowed;        // Биты ProvisionChange
+} draft;
+
+// Переподключения после ответа (PROV_WIFI | PROV_MQTT)
+static uint8_t pendingReconnect = 0;
+
+static Counter provApplied("feeder_provision_applied_total", "Config documents applied");
+static Counter provRejected("feeder_provision_rejected_total", "Config documents rejected (parse or validation error)");
+static Counter provReverted("feeder_provision_reverted_total", "WiFi or MQTT settings reverted after failing to connect");
+
+// ==================== NVS ====================
+static void loadString(Preferences& prefs, const char* key, char* dst, size_t size, const char* def) {
+  if (prefs.isKey(key)) {
+    prefs.getString(key, dst, size);
+  } else {
+    snprintf(dst, size, "%s", def);
+  }
+}
+
+static void loadNet() {
+  Preferences prefs;
+  prefs.begin("prov", true);
+  loadString(prefs, "ssid", stored.wifiSsid, sizeof(stored.wifiSsid), WIFI_SSID);
+  loadString(prefs, "pass", stored.wifiPassword, sizeof(stored.wifiPassword), WIFI_PASSWORD);
+  loadString(prefs, "mqtt_host", stored.mqttServer, sizeof(stored.mqttServer), MQTT_SERVER);
+  stored.mqttPort = prefs.getUShort("mqtt_port", MQTT_PORT);
+  loadString(prefs, "mqtt_user", stored.mqttUser, sizeof(stored.mqttUser), MQTT_USER);
+  loadString(prefs, "mqtt_pass", stored.mqttPassword, sizeof(stored.mqttPassword), MQTT_PASSWORD);
+  loadString(prefs, "tz", stored.timeZone, sizeof(stored.timeZone), TIME_ZONE);
+  prefs.end();
+  live = stored;
+}
+
+static void saveNet() {
+  Preferences prefs;
+  prefs.begin("prov", false);
+  prefs.putString("ssid", stored.wifiSsid);
+  prefs.putString("pass", stored.wifiPassword);
+  prefs.putString("mqtt_host", stored.mqttServer);
+  prefs.putUShort("mqtt_port", stored.mqttPort);
+  prefs.putString("mqtt_user", stored.mqttUser);
+  prefs.putString("mqtt_pass", stored.mqttPassword);
+  prefs.putString("tz", stored.timeZone);
+  prefs.end();
+}
+
+// Перенос группы параметров (PROV_WIFI, PROV_MQTT) между копиями
+static void copyGroup(NetConfig& dst, const NetConfig& src, uint8_t group) {
+  if (group & PROV_WIFI) {
+    strcpy(dst.wifiSsid, src.wifiSsid);
+    strcpy(dst.wifiPassword, src.wifiPassword);
+  }
+  if (group & PROV_MQTT) {
+    strcpy(dst.mqttServer, src.mqttServer);
+    dst.mqttPort = src.mqttPort;
+    strcpy(dst.mqttUser, src.mqttUser);
+    strcpy(dst.mqttPassword, src.mqttPassword);
+  }
+}
+
+// ==================== РАЗБОР ====================
+static void setError(const char* key, const char* what) {
+  settingsError(draft.error, key, what);
+}
+
+// Ключ группы, которую источник менять не может
+static bool denied(const char* key, uint8_t group) {
+  if (draft.allowed & group) return false;
+  setError(key, "not accepted from this source");
+  return true;
+}
+
+static void setString(char* dst, size_t size, const char* key, JsonType type, const char* text) {
+  if (type != JSON_STRING) return setError(key, "expected string");
+  if (strlen(text) >= size) return setError(key, "too long");
+  strcpy(dst, text);
+}
+
+// Значения документа в черновик; неизвестные ключи пропускаются
+static void onValue(void*, const JsonStream& json, JsonType type, const char* text) {
+  if (draft.error[0]) return;
+  uint8_t depth = json.depth();
+  const char* top = json.key(1);
+  long v;
+
+  if (depth == 1) {
+    if (type == JSON_NULL) return;  // null - оставить как есть
+    NetConfig& n = draft.net;
+    if (strncmp(top, "wifi_", 5) == 0 && denied(top, PROV_WIFI)) return;
+    if (strncmp(top, "mqtt_", 5) == 0 && denied(top, PROV_MQTT)) return;
+    if (strcmp(top, "wifi_ssid") == 0) {
+      setString(n.wifiSsid, sizeof(n.wifiSsid), top, type, text);
+    } else if (strcmp(top, "wifi_password") == 0) {
+      setString(n.wifiPassword, sizeof(n.wifiPassword), top, type, text);
+    } else if (strcmp(top, "mqtt_server") == 0) {
+      setString(n.mqttServer, sizeof(n.mqttServer), top, type, text);
+    } else if (strcmp(top, "mqtt_port") == 0) {
+      if (settingsInt(draft.error, v, top, type, text, 1, 65535)) n.mqttPort = v;
+    } else if (strcmp(top, "mqtt_user") == 0) {
+      setString(n.mqttUser, sizeof(n.mqttUser), top, type, text);
+    } else if (strcmp(top, "mqtt_password") == 0) {
+      setString(n.mqttPassword, sizeof(n.mqttPassword), top, type, text);
+    } else if (strcmp(top, "time_zone") == 0) {
+      setString(n.timeZone, sizeof(n.timeZone), top, type, text);
+    } else if (strcmp(top, "feedAmount") == 0) {
+      if (type == JSON_ARRAY) return;
+      settingsAmount(draft.error, draft.feedAmount[0], top, type, text);
+    } else if (strcmp(top, "schedules") == 0) {
+      if (type != JSON_ARRAY) return setError(top, "expected array");
+      draft.scheduleCount = 0;
+    }
+    return;
+  }
+
+  if (strcmp(top, "feedAmount") == 0 && depth == 2) {
+    int i = json.index(2);
+    if (i < 0 || i >= NUM_AUGERS) return setError(top, "more entries than augers");
+    settingsAmount(draft.error, draft.feedAmount[i], top, type, text);
+  } else if (strcmp(top, "schedules") == 0) {
+    int i = json.index(2);
+    if (i < 0) return;
+    if (i >= MAX_SCHEDULES) return setError(top, "too many entries");
+    if (depth == 2) {
+      if (type != JSON_OBJECT) return setError(top, "expected objects");
+      // Указанное расписание включено, если не сказано иначе
+      draft.scheduleCount = i + 1;
+      draft.schedules[i].enabled = true;
+    } else if (depth == 3) {
+      // Неизвестные поля пропускаются, как и ключи верхнего уровня
+      settingsScheduleField(draft.error, draft.schedules[i], json.key(3), type, text);
+    }
+  }
+}
+
+void provisionBegin(const char* source, uint8_t allowed) {
+  draft.net = live;
+  memcpy(draft.feedAmount, feedAmount, sizeof(draft.feedAmount));
+  memcpy(draft.schedules, schedules, sizeof(draft.schedules));
+  draft.scheduleCount = -1;
+  draft.error[0] = '\0';
+  draft.source = source;
+  draft.allowed = allowed;
+  draft.json.begin(onValue, nullptr);
+}
+
+bool provisionFeed(const char* data, size_t len) {
+  if (draft.error[0]) return false;
+  if (!draft.json.feed(data, len)) {
+    snprintf(draft.error, sizeof(draft.error), "malformed JSON at offset %u",
+             (unsigned)draft.json.offset());
+    return false;
+  }
+  return true;
+}
+
+// ==================== ПРИМЕНЕНИЕ ====================
+static bool sameSchedule(const Schedule& a, const Schedule& b) {
+  return a.hour == b.hour && a.minute == b.minute && a.amount == b.amount &&
+         a.auger == b.auger && a.enabled == b.enabled;
+}
+
+ProvisionResult provisionEnd() {
+  ProvisionResult r = {false, 0, nullptr};
+  if (!draft.error[0] && !draft.json.done()) {
+    snprintf(draft.error, sizeof(draft.error), "incomplete JSON");
+  }
+  const NetConfig& n = draft.net;
+  if (!draft.error[0] && !n.wifiSsid[0]) setError("wifi_ssid", "empty");
+  if (!draft.error[0] && !n.timeZone[0]) setError("time_zone", "empty");
+  if (draft.error[0]) {
+    provRejected.inc();
+    LOGW("PROV", "Настройки (%s) отклонены: %s", draft.source, draft.error);
+    r.error = draft.error;
+    return r;
+  }
+
+  // Массив расписаний заменяет список целиком
+  if (draft.scheduleCount >= 0) {
+    for (int i = draft.scheduleCount; i < MAX_SCHEDULES; i++) draft.schedules[i].enabled = false;
+  }
+
+  if (strcmp(n.wifiSsid, live.wifiSsid) || strcmp(n.wifiPassword, live.wifiPassword)) {
+    r.changed |= PROV_WIFI;
+  }
+  if (strcmp(n.mqttServer, live.mqttServer) || n.mqttPort != live.mqttPort ||
+      strcmp(n.mqttUser, live.mqttUser) || strcmp(n.mqttPassword, live.mqttPassword)) {
+    r.changed |= PROV_MQTT;
+  }
+  if (strcmp(n.timeZone, live.timeZone)) r.changed |= PROV_TIME;
+  if (memcmp(draft.feedAmount, feedAmount, sizeof(feedAmount))) r.changed |= PROV_FEED;
+  for (int i = 0; i < MAX_SCHEDULES; i++) {
+    if (!sameSchedule(draft.schedules[i], schedules[i])) r.changed |= PROV_FEED;
+  }
+
+  // Пояс сохраняется сразу, WiFi и MQTT - после подключения с ними
+  if (r.changed & (PROV_WIFI | PROV_MQTT | PROV_TIME)) live = n;
+  if (r.changed & PROV_TIME) {
+    strcpy(stored.timeZone, live.timeZone);
+    saveNet();
+  }
+  if (r.changed & (PROV_WIFI | PROV_MQTT)) {
+    trial |= r.changed & (PROV_WIFI | PROV_MQTT);
+    trialStart = millis();
+  }
+  if (r.changed & PROV_FEED) {
+    memcpy(feedAmount, draft.feedAmount, sizeof(feedAmount));
+    for (int i = 0; i < MAX_SCHEDULES; i++) {
+      bool fed = schedules[i].fed;
+      schedules[i] = draft.schedules[i];
+      schedules[i].fed = fed;
+    }
+    saveSettings();
+  }
+  if (r.changed & PROV_TIME) timeSetZone(live.timeZone);
+  pendingReconnect |= r.changed & (PROV_WIFI | PROV_MQTT);
+
+  provApplied.inc();
+  r.ok = true;
+  LOGI("PROV", "Настройки (%s) применены:%s%s%s%s%s", draft.source,
+       r.changed & PROV_WIFI ? " wifi" : "", r.changed & PROV_MQTT ? " mqtt" : "",
+       r.changed & PROV_FEED ? " кормление" : "", r.changed & PROV_TIME ? " пояс" : "",
+       r.changed ? "" : " без изменений");
+  return r;
+}
+
+size_t provisionResultJson(const ProvisionResult& r, char* buf, size_t size) {
+  if (!r.ok) {
+    return snprintf(buf, size, "{\"ok\":false,\"error\":\"%s\"}", r.error);
+  }
+  return snprintf(buf, size, "{\"ok\":true,\"changed\":{\"wifi\":%s,\"mqtt\":%s,\"feed\":%s,\"time\":%s}}",
+                  r.changed & PROV_WIFI ? "true" : "false", r.changed & PROV_MQTT ? "true" : "false",
+                  r.changed & PROV_FEED ? "true" : "false", r.changed & PROV_TIME ? "true" : "false");
+}
+
+// ==================== ФАЙЛ ====================
+// Применяется, только если содержимое изменилось с прошлого раза
+static void applyFile() {
+  long size = storageFileSize(PROV_FILE);
+  if (size <= 0) return;
+
+  char buf[PROV_READ_CHUNK];
+  uint32_t crc = fnv1a(nullptr, 0);
+  for (long off = 0; off < size; ) {
+    size_t n = storageRead(PROV_FILE, off, buf, sizeof(buf));
+    if (n == 0) return;
+    crc = fnv1a(buf, n, crc);
+    off += n;
+  }
+
+  Preferences prefs;
+  prefs.begin("prov", false);
+  if (prefs.getUInt("crc", 0) == crc) {
+    prefs.end();
+    LOGD("PROV", "%s не изменился", PROV_FILE);
+    return;
+  }
+
+  provisionBegin("file", PROV_ALLOW_ALL);
+  for (long off = 0; off < size; ) {
+    size_t n = storageRead(PROV_FILE, off, buf, sizeof(buf));
+    if (n == 0 || !provisionFeed(buf, n)) break;
+    off += n;
+  }
+  // Ошибочный файл не запоминаем: он будет проверен и при следующей загрузке
+  if (provisionEnd().ok) prefs.putUInt("crc", crc);
+  prefs.end();
+}
+
+// ==================== ПРОБА WIFI И MQTT ====================
+// Связь поднялась - группа сохраняется; не поднялась за PROV_TRIAL_TIMEOUT -
+// возвращаются сохранённые значения
+static void checkTrial() {
+  if (!trial) return;
+  uint8_t ok = 0;
+  if ((trial & PROV_WIFI) && wifiLinkUp()) ok |= PROV_WIFI;
+  if ((trial & PROV_MQTT) && mqttConnected) ok |= PROV_MQTT;
+  if (ok) {
+    copyGroup(stored, live, ok);
+    saveNet();
+    trial &= ~ok;
+    LOGI("PROV", "Подключение удалось, сохранено:%s%s",
+         ok & PROV_WIFI ? " wifi" : "", ok & PROV_MQTT ? " mqtt" : "");
+  }
+
+  if (trial && millis() - trialStart >= PROV_TRIAL_TIMEOUT) {
+    copyGroup(live, stored, trial);
+    pendingReconnect |= trial;
+    provReverted.inc();
+    LOGW("PROV", "Нет подключения за %u с, возврат прежних настроек:%s%s",
+         PROV_TRIAL_TIMEOUT / 1000, trial & PROV_WIFI ? " wifi" : "", trial & PROV_MQTT ? " mqtt" : "");
+    trial = 0;
+  }
+}
+
+// ==================== API ====================
+void provisioningSetup() {
+  loadNet();
+  LOGI("PROV", "WiFi: %s, MQTT: %s:%u, пояс: %s",
+       live.wifiSsid, live.mqttServer, live.mqttPort, live.timeZone);
+}
+
+void provisioningLoop() {
+  static bool fileChecked = false;
+  if (!fileChecked && storageReady()) {
+    fileChecked = true;
+    applyFile();
+  }
+
+  // Проверка - после переподключения: до него линк ещё старый
+  if (pendingReconnect & PROV_WIFI) wifiReconnect();
+  if (pendingReconnect & PROV_MQTT) mqttReconfigure();
+  pendingReconnect = 0;
+  checkTrial();
+}
+
+void provisionWriteJson(Print& out) {
+  out.print("{\"wifi_ssid\":");
+  printJsonString(out, live.wifiSsid);
+  out.print(",\"mqtt_server\":");
+  printJsonString(out, live.mqttServer);
+  out.printf(",\"mqtt_port\":%u,\"mqtt_user\":", live.mqttPort);
+  printJsonString(out, live.mqttUser);
+  out.print(",\"time_zone\":");
+  printJsonString(out, live.timeZone);
+
+  out.print(",\"feedAmount\":[");
+  for (int i = 0; i < NUM_AUGERS; i++) {
+    out.printf("%s%d", i ? "," : "", feedAmount[i]);
+  }
+  out.print("],\"schedules\":[");
+  for (int i = 0; i < MAX_SCHEDULES; i++) {
+    const Schedule& s = schedules[i];
+    out.printf("%s{\"hour\":%u,\"minute\":%u,\"amount\":%d,\"auger\":%u,\"enabled\":%s}",
+               i ? "," : "", s.hour, s.minute, s.amount, s.auger + 1, s.enabled ? "true" : "false");
+  }
+  out.print("]}");
+}
+
+const char* provWifiSsid() { return live.wifiSsid; }
+const char* provWifiPassword() { return live.wifiPassword; }
+const char* provMqttServer() { return live.mqttServer; }
+uint16_t provMqttPort() { return live.mqttPort; }
+const char* provMqttUser() { return live.mqttUser; }
+const char* provMqttPassword() { return live.mqttPassword; }
+const char* provTimeZone() { return live.timeZone; }
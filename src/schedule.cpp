@@ -4,7 +4,10 @@
 
 #include "schedule.h"
 #include "feeder.h"
-#include "mqtt_handler.h"
+#include "trace.h"
+#include "logger.h"
+#include "time_service.h"
+#include "alloc_track.h"
 #include <time.h>
 
 // Массив расписаний
@@ -16,78 +19,107 @@ Preferences preferences;
 // Инициализация расписания
 void scheduleSetup() {
   loadSettings();
-  Serial.println("[OK] Расписание инициализировано");
+  LOGI("SCHEDULE", "Расписание инициализировано");
+}
+
+// Ключ базовой порции шнека (у первого - прежний ключ)
+static void feedAmountKey(char* key, int auger) {
+  if (auger == 0) {
+    strcpy(key, "feedAmount");
+  } else {
+    sprintf(key, "feedAmount%d", auger);
+  }
 }
 
 // Сохранение настроек
 void saveSettings() {
+  TRACE_SCOPE("saveSettings");
   preferences.begin("feeder", false);
-  preferences.putInt("feedAmount", feedAmount);
+  for (int i = 0; i < NUM_AUGERS; i++) {
+    char key[16];
+    feedAmountKey(key, i);
+    preferences.putInt(key, feedAmount[i]);
+  }
   
   for (int i = 0; i < MAX_SCHEDULES; i++) {
-    char key_h[16], key_m[16], key_a[16], key_e[16];
+    char key_h[16], key_m[16], key_a[16], key_g[16], key_e[16];
     sprintf(key_h, "sched%d_h", i);
     sprintf(key_m, "sched%d_m", i);
     sprintf(key_a, "sched%d_a", i);
+    sprintf(key_g, "sched%d_g", i);
     sprintf(key_e, "sched%d_e", i);
     
     preferences.putUChar(key_h, schedules[i].hour);
     preferences.putUChar(key_m, schedules[i].minute);
     preferences.putInt(key_a, schedules[i].amount);
+    preferences.putUChar(key_g, schedules[i].auger);
     preferences.putBool(key_e, schedules[i].enabled);
   }
   
   preferences.end();
-  Serial.println("[PREF] Настройки сохранены");
+  LOGI("PREF", "Настройки сохранены");
 }
 
 // Загрузка настроек
 void loadSettings() {
   preferences.begin("feeder", true);
-  feedAmount = preferences.getInt("feedAmount", DEFAULT_FEED_AMOUNT);
+  for (int i = 0; i < NUM_AUGERS; i++) {
+    char key[16];
+    feedAmountKey(key, i);
+    feedAmount[i] = preferences.getInt(key, DEFAULT_FEED_AMOUNT);
+  }
   
   // Инициализация расписаний значениями по умолчанию
   for (int i = 0; i < MAX_SCHEDULES; i++) {
     schedules[i].hour = (i * 4) % 24;  // 0, 4, 8, 12, 16
     schedules[i].minute = 0;
     schedules[i].amount = DEFAULT_FEED_AMOUNT;
+    schedules[i].auger = 0;
     schedules[i].enabled = (i < 3);  // Первые 3 включены
     schedules[i].fed = false;
   }
   
   // Пытаемся загрузить из памяти (если есть)
   for (int i = 0; i < MAX_SCHEDULES; i++) {
-    char key_h[16], key_m[16], key_a[16], key_e[16];
+    char key_h[16], key_m[16], key_a[16], key_g[16], key_e[16];
     sprintf(key_h, "sched%d_h", i);
     sprintf(key_m, "sched%d_m", i);
     sprintf(key_a, "sched%d_a", i);
+    sprintf(key_g, "sched%d_g", i);
     sprintf(key_e, "sched%d_e", i);
     
     if (preferences.isKey(key_h)) {
       schedules[i].hour = preferences.getUChar(key_h, schedules[i].hour);
       schedules[i].minute = preferences.getUChar(key_m, schedules[i].minute);
       schedules[i].amount = preferences.getInt(key_a, schedules[i].amount);
+      schedules[i].auger = preferences.getUChar(key_g, 0);
       schedules[i].enabled = preferences.getBool(key_e, schedules[i].enabled);
     }
+    // Шнек мог исчезнуть при сборке с меньшим NUM_AUGERS
+    if (schedules[i].auger >= NUM_AUGERS) schedules[i].auger = 0;
   }
   
   preferences.end();
   
   // Показываем загруженные расписания
-  Serial.println("[PREF] Расписания загружены:");
+  LOGI("PREF", "Расписания загружены:");
   for (int i = 0; i < MAX_SCHEDULES; i++) {
     if (schedules[i].enabled) {
-      Serial.printf("  #%d: %02d:%02d - %d оборотов\n", 
-                    i + 1, schedules[i].hour, schedules[i].minute, schedules[i].amount);
+      LOGI("PREF", "  #%d: %02d:%02d - %d оборотов, шнек %d", 
+                    i + 1, schedules[i].hour, schedules[i].minute, schedules[i].amount,
+                    schedules[i].auger + 1);
     }
   }
-  Serial.printf("[PREF] Базовая порция: %d оборотов\n", feedAmount);
+  for (int i = 0; i < NUM_AUGERS; i++) {
+    LOGI("PREF", "Базовая порция шнека %d: %d оборотов", i + 1, feedAmount[i]);
+  }
 }
 
 // Проверка расписания
 void checkSchedule() {
+  ALLOC_SCOPE(ALLOC_SCHEDULE);
   struct tm timeinfo;
-  if (!getLocalTime(&timeinfo)) return;
+  if (!timeNow(timeinfo)) return;
   
   for (int i = 0; i < MAX_SCHEDULES; i++) {
     if (!schedules[i].enabled) continue;
@@ -99,12 +131,14 @@ void checkSchedule() {
     if (timeMatch) {
       // Время совпало! Проверяем первые 10 секунд для надежности
       if (timeinfo.tm_sec < 10 && !schedules[i].fed) {
-        Serial.printf("[SCHEDULE] Расписание #%d (%02d:%02d): %d оборотов\n", 
-                i + 1, schedules[i].hour, schedules[i].minute, schedules[i].amount);
+        LOGI("SCHEDULE", "Расписание #%d (%02d:%02d): шнек %d, %d оборотов", 
+                i + 1, schedules[i].hour, schedules[i].minute,
+                schedules[i].auger + 1, schedules[i].amount);
         
-        feed(schedules[i].amount);
-        publishLastFeeding(schedules[i].amount, "schedule");
-        schedules[i].fed = true;
+        // Занятый шнек (калибровка) - повторим на следующей проверке
+        if (feed(schedules[i].auger, schedules[i].amount, "schedule")) {
+          schedules[i].fed = true;
+        }
       }
     } else {
       // Время НЕ совпадает - сбрасываем флаг
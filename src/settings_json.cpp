@@ -0,0 +1,54 @@
+/*
+  settings_json.cpp - Общие проверки полей настроек в JSON документах
+*/
+
+#include "settings_json.h"
+
+void settingsError(char* error, const char* key, const char* what) {
+  if (error[0]) return;
+  snprintf(error, SETTINGS_ERROR_LEN, "%s: %s", key, what);
+}
+
+bool settingsInt(char* error, long& v, const char* key, JsonType type, const char* text,
+                 long min, long max) {
+  char* end;
+  if (type == JSON_NUMBER) v = strtol(text, &end, 10);
+  if (type != JSON_NUMBER || *end != '\0') {
+    settingsError(error, key, "expected integer");
+    return false;
+  }
+  if (v < min || v > max) {
+    settingsError(error, key, "out of range");
+    return false;
+  }
+  return true;
+}
+
+bool settingsAmount(char* error, int& amount, const char* key, JsonType type, const char* text) {
+  long v;
+  if (!settingsInt(error, v, key, type, text, 1, PROV_MAX_AMOUNT)) return false;
+  amount = v;
+  return true;
+}
+
+bool settingsScheduleField(char* error, Schedule& s, const char* key, JsonType type, const char* text) {
+  long v;
+  if (strcmp(key, "hour") == 0) {
+    if (settingsInt(error, v, key, type, text, 0, 23)) s.hour = v;
+  } else if (strcmp(key, "minute") == 0) {
+    if (settingsInt(error, v, key, type, text, 0, 59)) s.minute = v;
+  } else if (strcmp(key, "amount") == 0) {
+    settingsAmount(error, s.amount, key, type, text);
+  } else if (strcmp(key, "auger") == 0) {
+    if (settingsInt(error, v, key, type, text, 1, NUM_AUGERS)) s.auger = v - 1;
+  } else if (strcmp(key, "enabled") == 0) {
+    if (type != JSON_TRUE && type != JSON_FALSE) {
+      settingsError(error, key, "expected boolean");
+    } else {
+      s.enabled = type == JSON_TRUE;
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
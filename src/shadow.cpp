@@ -0,0 +1,289 @@
+/*
+  shadow.cpp - Тень устройства: сообщаемое и желаемое состояние
+*/
+
+#include "shadow.h"
+#include "json_stream.h"
+#include "settings_json.h"
+#include "schedule.h"
+#include "feeder.h"
+#include "wifi_manager.h"
+#include "mqtt_handler.h"
+#include "time_service.h"
+#include "checksum.h"
+#include "arena.h"
+#include "metrics.h"
+#include "logger.h"
+#include <Preferences.h>
+
+// Текущая версия и отпечаток настроек, которым она соответствует
+static uint32_t version = 0;
+static uint32_t settingsHash = 0;
+static bool reportPending = true;
+
+// Черновик разбираемой дельты
+static struct {
+  JsonStream json;
+  int feedAmount[NUM_AUGERS];
+  Schedule schedules[MAX_SCHEDULES];
+  bool hasVersion;
+  uint32_t version;
+  char error[SETTINGS_ERROR_LEN];
+} draft;
+
+static Counter shadowApplied("feeder_shadow_applied_total", "Desired-state deltas applied");
+static Counter shadowRejected("feeder_shadow_rejected_total", "Desired-state deltas rejected (parse, validation or stale version)");
+static Counter shadowStale("feeder_shadow_stale_total", "Desired-state deltas based on an outdated version");
+static Gauge shadowVersionGauge("feeder_shadow_version", "Version of the reported state");
+
+// Отпечаток порций и расписаний (без флага fed)
+static uint32_t hashSettings(const int* amounts, const Schedule* list) {
+  uint32_t h = fnv1a(amounts, sizeof(int) * NUM_AUGERS);
+  for (int i = 0; i < MAX_SCHEDULES; i++) {
+    const Schedule& s = list[i];
+    uint8_t fields[4] = {s.hour, s.minute, s.auger, s.enabled};
+    h = fnv1a(fields, sizeof(fields), h);
+    h = fnv1a(&s.amount, sizeof(s.amount), h);
+  }
+  return h;
+}
+
+static void bumpVersion(uint32_t hash) {
+  version++;
+  settingsHash = hash;
+  shadowVersionGauge.set(version);
+  reportPending = true;
+
+  Preferences prefs;
+  prefs.begin("shadow", false);
+  prefs.putUInt("version", version);
+  prefs.putUInt("hash", hash);
+  prefs.end();
+}
+
+// ==================== РАЗБОР ====================
+static void setError(const char* key, const char* what) {
+  settingsError(draft.error, key, what);
+}
+
+// Дельта в черновик. В state неизвестные поля - ошибка (опечатка не
+// должна тихо пропасть), на верхнем уровне - пропускаются
+static void onValue(void*, const JsonStream& json, JsonType type, const char* text) {
+  if (draft.error[0] || type == JSON_NULL) return;
+  uint8_t depth = json.depth();
+  const char* top = json.key(1);
+
+  if (depth == 1) {
+    if (strcmp(top, "version") == 0) {
+      char* end;
+      unsigned long v = type == JSON_NUMBER ? strtoul(text, &end, 10) : 0;
+      if (type != JSON_NUMBER || *end != '\0' || text[0] == '-') return setError(top, "expected integer");
+      draft.version = v;
+      draft.hasVersion = true;
+    } else if (strcmp(top, "state") == 0 && type != JSON_OBJECT) {
+      setError(top, "expected object");
+    }
+    return;
+  }
+  if (strcmp(top, "state") != 0) return;
+
+  const char* field = json.key(2);
+  if (strcmp(field, "feedAmount") == 0) {
+    if (depth == 2) {
+      if (type == JSON_ARRAY) return;
+      settingsAmount(draft.error, draft.feedAmount[0], field, type, text);
+    } else if (depth == 3) {
+      int i = json.index(3);
+      if (i < 0 || i >= NUM_AUGERS) return setError(field, "more entries than augers");
+      settingsAmount(draft.error, draft.feedAmount[i], field, type, text);
+    }
+  } else if (strcmp(field, "schedules") == 0) {
+    if (depth == 2) {
+      if (type != JSON_ARRAY) setError(field, "expected array");
+      return;
+    }
+    int i = json.index(3);
+    if (i < 0) return;
+    if (i >= MAX_SCHEDULES) return setError(field, "too many entries");
+    if (depth == 3) {
+      if (type != JSON_OBJECT) setError(field, "expected objects or null");
+    } else if (depth == 4) {
+      const char* key = json.key(4);
+      if (!settingsScheduleField(draft.error, draft.schedules[i], key, type, text)) {
+        setError(key, "unknown field");
+      }
+    }
+  } else if (depth == 2) {
+    setError(field, "unknown field");
+  }
+}
+
+// Число полей, которыми черновик отличается от текущих настроек
+static uint8_t countChanges() {
+  uint8_t n = 0;
+  for (int i = 0; i < NUM_AUGERS; i++) n += draft.feedAmount[i] != feedAmount[i];
+  for (int i = 0; i < MAX_SCHEDULES; i++) {
+    const Schedule& a = draft.schedules[i];
+    const Schedule& b = schedules[i];
+    n += (a.hour != b.hour) + (a.minute != b.minute) + (a.amount != b.amount) +
+         (a.auger != b.auger) + (a.enabled != b.enabled);
+  }
+  return n;
+}
+
+// ==================== API ====================
+void shadowSetup() {
+  Preferences prefs;
+  prefs.begin("shadow", true);
+  version = prefs.getUInt("version", 0);
+  settingsHash = prefs.getUInt("hash", 0);
+  prefs.end();
+
+  // Настройки могли измениться без тени (новая NVS, прошлая прошивка)
+  uint32_t hash = hashSettings(feedAmount, schedules);
+  if (hash != settingsHash || version == 0) bumpVersion(hash);
+  shadowVersionGauge.set(version);
+  LOGI("SHADOW", "Версия состояния: %u", version);
+}
+
+void shadowLoop() {
+  static uint32_t lastCheck = 0;
+  static uint32_t lastReport = 0;
+  if (millis() - lastCheck < SHADOW_CHECK_INTERVAL) return;
+  lastCheck = millis();
+
+  // Изменения через HTTP, кнопку или документ настроек
+  uint32_t hash = hashSettings(feedAmount, schedules);
+  if (hash != settingsHash) {
+    bumpVersion(hash);
+    LOGI("SHADOW", "Настройки изменены, версия %u", version);
+  }
+
+  if (!mqttConnected) return;
+  if (reportPending || millis() - lastReport >= SHADOW_REPORT_INTERVAL) {
+    if (publishShadowReported()) {
+      reportPending = false;
+      lastReport = millis();
+    }
+  }
+}
+
+void shadowRequestReport() {
+  reportPending = true;
+}
+
+ShadowResult shadowApplyDesired(const char* data, size_t len, const char* source) {
+  ShadowResult r = {false, false, 0, version, nullptr};
+
+  memcpy(draft.feedAmount, feedAmount, sizeof(draft.feedAmount));
+  memcpy(draft.schedules, schedules, sizeof(draft.schedules));
+  draft.hasVersion = false;
+  draft.error[0] = '\0';
+  draft.json.begin(onValue, nullptr);
+  if (!draft.json.feed(data, len)) {
+    snprintf(draft.error, sizeof(draft.error), "malformed JSON at offset %u",
+             (unsigned)draft.json.offset());
+  } else if (!draft.json.done()) {
+    snprintf(draft.error, sizeof(draft.error), "incomplete JSON");
+  }
+  if (!draft.error[0] && !draft.hasVersion) setError("version", "required");
+
+  uint8_t changed = draft.error[0] ? 0 : countChanges();
+  // Уже применённая дельта (повторная доставка) - не ошибка
+  if (!draft.error[0] && changed > 0 && draft.version != version) {
+    snprintf(draft.error, sizeof(draft.error), "stale version %u, current %u",
+             draft.version, version);
+    r.stale = true;
+    shadowStale.inc();
+  }
+  if (draft.error[0]) {
+    shadowRejected.inc();
+    LOGW("SHADOW", "Дельта (%s) отклонена: %s", source, draft.error);
+    r.error = draft.error;
+    return r;
+  }
+
+  r.ok = true;
+  r.changed = changed;
+  if (changed == 0) {
+    LOGD("SHADOW", "Дельта (%s) без изменений", source);
+    return r;
+  }
+
+  memcpy(feedAmount, draft.feedAmount, sizeof(feedAmount));
+  for (int i = 0; i < MAX_SCHEDULES; i++) {
+    bool fed = schedules[i].fed;
+    schedules[i] = draft.schedules[i];
+    schedules[i].fed = fed;
+  }
+  saveSettings();
+  bumpVersion(hashSettings(feedAmount, schedules));
+  r.version = version;
+  shadowApplied.inc();
+  LOGI("SHADOW", "Дельта (%s) применена: полей %u, версия %u", source, changed, version);
+  return r;
+}
+
+size_t shadowResultJson(const ShadowResult& r, char* buf, size_t size) {
+  if (!r.ok) {
+    return snprintf(buf, size, "{\"ok\":false,\"version\":%u,\"stale\":%s,\"error\":\"%s\"}",
+                    r.version, r.stale ? "true" : "false", r.error);
+  }
+  return snprintf(buf, size, "{\"ok\":true,\"version\":%u,\"changed\":%u}", r.version, r.changed);
+}
+
+size_t shadowReportedJson(char* buf, size_t size) {
+  BufWriter json(buf, size);
+  char iso[40];
+
+  json.printf("{\"version\":%u,\"timestamp\":", version);
+  if (timeValid()) {
+    timeIso(iso, sizeof(iso));
+    json.printf("\"%s\"", iso);
+  } else {
+    json.print("null");
+  }
+
+  json.print(",\"state\":{\"feedAmount\":[");
+  for (int i = 0; i < NUM_AUGERS; i++) {
+    json.printf("%s%d", i ? "," : "", feedAmount[i]);
+  }
+  json.print("],\"schedules\":[");
+  for (int i = 0; i < MAX_SCHEDULES; i++) {
+    const Schedule& s = schedules[i];
+    json.printf("%s{\"hour\":%u,\"minute\":%u,\"amount\":%d,\"auger\":%u,\"enabled\":%s}",
+                i ? "," : "", s.hour, s.minute, s.amount, s.auger + 1, s.enabled ? "true" : "false");
+  }
+
+  // IP по октетам: IPAddress::toString() выделяет String в куче
+  const WifiStats& ws = wifiGetStats();
+  IPAddress ip = WiFi.localIP();
+  json.printf("]},\"link\":{\"ip\":\"%u.%u.%u.%u\",\"rssi\":%d,\"wifi_outages\":%u,"
+              "\"wifi_reconnect_ms\":%u,\"wifi_downtime_ms\":%u}",
+              ip[0], ip[1], ip[2], ip[3], WiFi.RSSI(), ws.outages,
+              ws.lastReconnectMs, ws.totalDowntimeMs);
+
+  const FeederStats& fs = feederGetStats();
+  json.printf(",\"stats\":{\"uptime\":%lu,\"heap_free\":%u,\"feeds\":%u,\"revolutions\":%u,"
+              "\"last_feeding\":",
+              millis() / 1000, ESP.getFreeHeap(), fs.feeds, fs.revolutions);
+  if (fs.lastSource) {
+    json.print("{\"time\":");
+    if (fs.lastEpoch) {
+      timeIsoAt(fs.lastEpoch, iso, sizeof(iso));
+      json.printf("\"%s\"", iso);
+    } else {
+      json.print("null");
+    }
+    json.printf(",\"auger\":%u,\"amount\":%d,\"source\":\"%s\"}",
+                fs.lastAuger + 1, fs.lastAmount, fs.lastSource);
+  } else {
+    json.print("null");
+  }
+  json.print("}}");
+  return json.overflow() ? 0 : json.length();
+}
+
+uint32_t shadowVersion() {
+  return version;
+}
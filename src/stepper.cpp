@@ -0,0 +1,162 @@
+/*
+  stepper.cpp - Шаговые моторы шнеков и общий планировщик шагов
+*/
+
+#include "stepper.h"
+#include "logger.h"
+#include <esp_timer.h>
+
+// Последовательность шагов для двигателя
+static const byte steps[] = {0b1010, 0b0110, 0b0101, 0b1001};
+
+// Минимальная задержка перевзвода таймера (мкс)
+#define STEPPER_MIN_DELAY_US 50
+
+static Stepper* registry[NUM_AUGERS];
+static uint8_t registered = 0;
+static portMUX_TYPE stepperMux = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t stepTimer = nullptr;
+
+// Колбэк планировщика (задача esp_timer): шаги всех моторов, которым пора,
+// и перевзвод на ближайший следующий шаг. Таймер однократный, поэтому
+// когда все моторы стоят, он не взведён
+static void schedulerTick(void*) {
+  int64_t now = esp_timer_get_time();
+  int64_t next = 0;
+  for (uint8_t i = 0; i < registered; i++) {
+    int64_t due = registry[i]->service(now);
+    if (due && (next == 0 || due < next)) next = due;
+  }
+  if (next == 0) return;
+
+  int64_t delay = next - esp_timer_get_time();
+  esp_timer_start_once(stepTimer, delay > STEPPER_MIN_DELAY_US ? delay : STEPPER_MIN_DELAY_US);
+}
+
+// Разбудить планировщик после запуска мотора
+static void schedulerKick() {
+  esp_timer_stop(stepTimer);
+  esp_timer_start_once(stepTimer, STEPPER_MIN_DELAY_US);
+}
+
+void Stepper::begin(const uint8_t* pins, const StepProfile& profile) {
+  _pins = pins;
+  _profile = profile;
+  for (byte i = 0; i < 4; i++) {
+    pinMode(_pins[i], OUTPUT);
+    digitalWrite(_pins[i], 0);
+  }
+
+  if (!stepTimer) {
+    esp_timer_create_args_t args = {};
+    args.callback = schedulerTick;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "stepper";
+    if (esp_timer_create(&args, &stepTimer) != ESP_OK) {
+      LOGE("MOTOR", "Не удалось создать таймер шагов");
+      return;
+    }
+  }
+
+  if (registered >= NUM_AUGERS) {
+    LOGE("MOTOR", "Слишком много моторов (максимум %d)", NUM_AUGERS);
+    return;
+  }
+  portENTER_CRITICAL(&stepperMux);
+  _index = registered;
+  registry[registered++] = this;
+  portEXIT_CRITICAL(&stepperMux);
+}
+
+bool Stepper::start(StepperMode mode, int target) {
+  // Сдвиг фазы: моторы шагают в разные моменты внутри интервала
+  int64_t offset = (int64_t)_profile.stepIntervalUs * _index / NUM_AUGERS;
+
+  // Пока завершение прошлого прогона не забрано (clearFinished), мотор занят
+  portENTER_CRITICAL(&stepperMux);
+  bool busy = _mode != STEPPER_IDLE || _finishedMode != STEPPER_IDLE;
+  if (!busy) {
+    _mode = mode;
+    _stopRequested = false;
+    _revStep = 0;
+    _revs = 0;
+    _target = target;
+    _due = esp_timer_get_time() + offset;
+  }
+  portEXIT_CRITICAL(&stepperMux);
+
+  if (busy) return false;
+  schedulerKick();
+  return true;
+}
+
+void Stepper::requestStop(StepperMode mode) {
+  portENTER_CRITICAL(&stepperMux);
+  if (mode != STEPPER_IDLE && _mode == mode) _stopRequested = true;
+  portEXIT_CRITICAL(&stepperMux);
+}
+
+StepperStatus Stepper::status() {
+  portENTER_CRITICAL(&stepperMux);
+  StepperStatus s = {_mode, _finishedMode, _revs, _target};
+  portEXIT_CRITICAL(&stepperMux);
+  return s;
+}
+
+void Stepper::clearFinished() {
+  portENTER_CRITICAL(&stepperMux);
+  _finishedMode = STEPPER_IDLE;
+  portEXIT_CRITICAL(&stepperMux);
+}
+
+// Оборот шнека: stepsBackward шагов назад, затем stepsForward вперёд;
+// остановка только на границе оборота
+int64_t Stepper::service(int64_t nowUs) {
+  int8_t dir = 0;
+  int64_t next = 0;
+  bool finished = false;
+
+  portENTER_CRITICAL(&stepperMux);
+  if (_mode != STEPPER_IDLE) {
+    if (nowUs < _due) {
+      next = _due;
+    } else if (_revStep == 0 &&
+               (_stopRequested || (_mode == STEPPER_RUN && _revs >= _target))) {
+      _finishedMode = _mode;
+      _mode = STEPPER_IDLE;
+      finished = true;
+    } else {
+      dir = _revStep < _profile.stepsBackward ? -1 : 1;
+      if (++_revStep >= _profile.stepsBackward + _profile.stepsForward) {
+        _revStep = 0;
+        _revs++;
+      }
+      // Опоздавший шаг не догоняем пачкой - держим интервал
+      _due += _profile.stepIntervalUs;
+      if (_due <= nowUs) _due = nowUs + _profile.stepIntervalUs;
+      next = _due;
+    }
+  }
+  portEXIT_CRITICAL(&stepperMux);
+
+  if (dir != 0) {
+    writePhase(dir);
+  } else if (finished) {
+    release();
+  }
+  return next;
+}
+
+void Stepper::writePhase(int8_t dir) {
+  for (byte i = 0; i < 4; i++) {
+    digitalWrite(_pins[i], bitRead(steps[_phase & 0b11], i));
+  }
+  _phase += dir;
+}
+
+// Выключаем ток на мотор
+void Stepper::release() {
+  for (byte i = 0; i < 4; i++) {
+    digitalWrite(_pins[i], 0);
+  }
+}
@@ -0,0 +1,116 @@
+/*
+  storage.cpp - Файловое хранилище на LittleFS
+*/
+
+#ifdef ARDUINO
+
+#include "storage.h"
+#include "config.h"
+#include "logger.h"
+#include "metrics.h"
+#include <LittleFS.h>
+#include <atomic>
+
+static std::atomic<bool> ready(false);
+static bool started = false;
+
+static Gauge mountTime("feeder_storage_mount_ms", "Filesystem mount time (including format)");
+static Gauge usedBytes("feeder_storage_used_bytes", "Filesystem bytes in use");
+
+// Фоновое монтирование; повреждённый раздел форматируется здесь же,
+// поэтому loop() и веб-сервер не ждут форматирования
+static void mountTask(void*) {
+  uint32_t start = millis();
+  bool ok = LittleFS.begin(false, STORAGE_BASE_PATH, STORAGE_MAX_OPEN_FILES, STORAGE_PARTITION);
+  if (!ok) {
+    LOGW("FS", "Раздел '%s' не смонтирован, форматирование...", STORAGE_PARTITION);
+    ok = LittleFS.begin(true, STORAGE_BASE_PATH, STORAGE_MAX_OPEN_FILES, STORAGE_PARTITION);
+  }
+  uint32_t elapsed = millis() - start;
+  mountTime.set(elapsed);
+
+  if (ok) {
+    usedBytes.set(LittleFS.usedBytes());
+    ready.store(true, std::memory_order_release);
+    LOGI("FS", "LittleFS смонтирована за %u мс, занято %u из %u КБ", elapsed,
+         (unsigned)(LittleFS.usedBytes() / 1024), (unsigned)(LittleFS.totalBytes() / 1024));
+    if (!LittleFS.exists("/index.html")) {
+      LOGW("FS", "index.html не найден (загрузите образ: pio run -t uploadfs)");
+    }
+  } else {
+    LOGE("FS", "Ошибка монтирования LittleFS (раздел '%s')", STORAGE_PARTITION);
+  }
+  vTaskDelete(nullptr);
+}
+
+void storageSetup() {
+  if (started) return;
+  started = true;
+  xTaskCreatePinnedToCore(mountTask, "fs_mount", 4096, nullptr, 1, nullptr, 0);
+}
+
+bool storageReady() {
+  return ready.load(std::memory_order_acquire);
+}
+
+bool storageExists(const char* path) {
+  return storageReady() && LittleFS.exists(path);
+}
+
+long storageFileSize(const char* path) {
+  if (!storageReady()) return -1;
+  File f = LittleFS.open(path, "r");
+  if (!f) return -1;
+  long size = f.size();
+  f.close();
+  return size;
+}
+
+size_t storageRead(const char* path, size_t offset, void* buf, size_t size) {
+  if (!storageReady()) return 0;
+  File f = LittleFS.open(path, "r");
+  if (!f) return 0;
+  size_t n = f.seek(offset) ? f.read((uint8_t*)buf, size) : 0;
+  f.close();
+  return n;
+}
+
+static bool writeMode(const char* path, const char* mode, const void* data, size_t len) {
+  if (!storageReady()) return false;
+  File f = LittleFS.open(path, mode, true);
+  if (!f) return false;
+  size_t n = f.write((const uint8_t*)data, len);
+  f.close();
+  usedBytes.set(LittleFS.usedBytes());
+  return n == len;
+}
+
+bool storageWrite(const char* path, const void* data, size_t len) {
+  return writeMode(path, "w", data, len);
+}
+
+bool storageAppend(const char* path, const void* data, size_t len) {
+  return writeMode(path, "a", data, len);
+}
+
+bool storageRename(const char* from, const char* to) {
+  return storageReady() && LittleFS.rename(from, to);
+}
+
+bool storageRemove(const char* path) {
+  return storageReady() && LittleFS.remove(path);
+}
+
+size_t storageUsedBytes() {
+  return storageReady() ? LittleFS.usedBytes() : 0;
+}
+
+size_t storageTotalBytes() {
+  return storageReady() ? LittleFS.totalBytes() : 0;
+}
+
+fs::FS& storageFs() {
+  return LittleFS;
+}
+
+#endif // ARDUINO
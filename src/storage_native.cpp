@@ -0,0 +1,107 @@
+/*
+  storage_native.cpp - Файловое хранилище на каталоге хоста (для тестов)
+
+  Пути хранилища отображаются в корневой каталог (storageSetRoot),
+  монтирование мгновенное. Запись, как и LittleFS на устройстве,
+  создаёт недостающие каталоги.
+*/
+
+#ifndef ARDUINO
+
+#include "storage.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+
+static std::string root = "storage";
+static bool ready = false;
+
+static std::string fullPath(const char* path) {
+  return root + (path[0] == '/' ? "" : "/") + path;
+}
+
+// Создание каталогов на пути к файлу
+static void makeParents(const std::string& file) {
+  for (size_t i = root.size() + 1; (i = file.find('/', i)) != std::string::npos; i++) {
+    mkdir(file.substr(0, i).c_str(), 0755);
+  }
+}
+
+void storageSetRoot(const char* dir) {
+  root = dir;
+  while (root.size() > 1 && root.back() == '/') root.pop_back();
+  ready = false;
+}
+
+void storageSetup() {
+  mkdir(root.c_str(), 0755);
+  struct stat st;
+  ready = stat(root.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool storageReady() {
+  return ready;
+}
+
+bool storageExists(const char* path) {
+  struct stat st;
+  return ready && stat(fullPath(path).c_str(), &st) == 0;
+}
+
+long storageFileSize(const char* path) {
+  struct stat st;
+  if (!ready || stat(fullPath(path).c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return -1;
+  return st.st_size;
+}
+
+size_t storageRead(const char* path, size_t offset, void* buf, size_t size) {
+  if (!ready) return 0;
+  FILE* f = fopen(fullPath(path).c_str(), "rb");
+  if (!f) return 0;
+  size_t n = fseek(f, offset, SEEK_SET) == 0 ? fread(buf, 1, size, f) : 0;
+  fclose(f);
+  return n;
+}
+
+static bool writeMode(const char* path, const char* mode, const void* data, size_t len) {
+  if (!ready) return false;
+  std::string file = fullPath(path);
+  makeParents(file);
+  FILE* f = fopen(file.c_str(), mode);
+  if (!f) return false;
+  size_t n = fwrite(data, 1, len, f);
+  fclose(f);
+  return n == len;
+}
+
+bool storageWrite(const char* path, const void* data, size_t len) {
+  return writeMode(path, "wb", data, len);
+}
+
+bool storageAppend(const char* path, const void* data, size_t len) {
+  return writeMode(path, "ab", data, len);
+}
+
+bool storageRename(const char* from, const char* to) {
+  return ready && rename(fullPath(from).c_str(), fullPath(to).c_str()) == 0;
+}
+
+bool storageRemove(const char* path) {
+  return ready && remove(fullPath(path).c_str()) == 0;
+}
+
+size_t storageUsedBytes() {
+  struct statvfs vfs;
+  if (!ready || statvfs(root.c_str(), &vfs) != 0) return 0;
+  return (size_t)(vfs.f_blocks - vfs.f_bfree) * vfs.f_frsize;
+}
+
+size_t storageTotalBytes() {
+  struct statvfs vfs;
+  if (!ready || statvfs(root.c_str(), &vfs) != 0) return 0;
+  return (size_t)vfs.f_blocks * vfs.f_frsize;
+}
+
+#endif // ARDUINO
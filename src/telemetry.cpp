@@ -0,0 +1,56 @@
+/*
+  telemetry.cpp - Схема и кодирование событий и телеметрии в CBOR
+*/
+
+#include "telemetry.h"
+#include "cbor_writer.h"
+
+// Общее начало карты: вид, время (если известно), аптайм
+static void header(CborWriter& w, uint32_t pairs, TelemetryType type, time_t epoch, uint32_t uptime) {
+  w.map(pairs + (epoch ? 3 : 2));
+  w.unsignedInt(TLM_KEY_TYPE).unsignedInt(type);
+  if (epoch) w.unsignedInt(TLM_KEY_TIME).epochTag().unsignedInt(epoch);
+  w.unsignedInt(TLM_KEY_UPTIME).unsignedInt(uptime);
+}
+
+static size_t finish(const CborWriter& w) {
+  return w.overflow() ? 0 : w.length();
+}
+
+size_t telemetryFeeding(uint8_t* buf, size_t size, time_t epoch, uint32_t uptime,
+                        uint8_t auger, int amount, const char* source, int clip) {
+  CborWriter w(buf, size);
+  header(w, clip >= 0 ? 4 : 3, TLM_FEEDING, epoch, uptime);
+  w.unsignedInt(TLM_KEY_AMOUNT).signedInt(amount);
+  w.unsignedInt(TLM_KEY_AUGER).unsignedInt(auger + 1);
+  w.unsignedInt(TLM_KEY_SOURCE).text(source);
+  if (clip >= 0) w.unsignedInt(TLM_KEY_CLIP).unsignedInt(clip);
+  return finish(w);
+}
+
+size_t telemetryPresence(uint8_t* buf, size_t size, time_t epoch, uint32_t uptime, bool present) {
+  CborWriter w(buf, size);
+  header(w, 1, TLM_PRESENCE, epoch, uptime);
+  w.unsignedInt(TLM_KEY_PRESENT).boolean(present);
+  return finish(w);
+}
+
+size_t telemetryEating(uint8_t* buf, size_t size, time_t epoch, uint32_t uptime, uint32_t seconds) {
+  CborWriter w(buf, size);
+  header(w, 1, TLM_EATING, epoch, uptime);
+  w.unsignedInt(TLM_KEY_SECONDS).unsignedInt(seconds);
+  return finish(w);
+}
+
+size_t telemetryMetrics(uint8_t* buf, size_t size, time_t epoch, uint32_t uptime,
+                        const TelemetryMetrics& m) {
+  CborWriter w(buf, size);
+  header(w, 6, TLM_METRICS, epoch, uptime);
+  w.unsignedInt(TLM_KEY_HEAP_FREE).unsignedInt(m.heapFree);
+  w.unsignedInt(TLM_KEY_HEAP_MIN).unsignedInt(m.heapMin);
+  w.unsignedInt(TLM_KEY_HEAP_LARGEST).unsignedInt(m.heapLargest);
+  w.unsignedInt(TLM_KEY_WIFI_OUTAGES).unsignedInt(m.wifiOutages);
+  w.unsignedInt(TLM_KEY_WIFI_RECONNECT_MS).unsignedInt(m.wifiReconnectMs);
+  w.unsignedInt(TLM_KEY_RSSI).signedInt(m.rssi);
+  return finish(w);
+}
@@ -0,0 +1,214 @@
+/*
+  time_service.cpp - Местное время: часовой пояс, кэш, синхронизация NTP
+*/
+
+#include "time_service.h"
+#include "provisioning.h"
+#include "metrics.h"
+#include "logger.h"
+#include <esp_sntp.h>
+#include <esp_timer.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <sys/time.h>
+
+#define TIME_VALID_EPOCH 1600000000   // Раньше - часы не выставлены
+#define RTC_TIME_MAGIC 0x54494D45u
+
+// Последнее известное время (RTC память переживает программный сброс)
+static RTC_NOINIT_ATTR struct {
+  uint32_t magic;
+  uint32_t check;
+  int64_t epochUs;
+} rtcTime;
+
+// Опорная точка: время эпохи refEpochUs в момент монотонного refMonoUs.
+// Меняется при синхронизации SNTP (его задача) и при восстановлении
+static portMUX_TYPE refMux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t refEpochUs = 0;
+static int64_t refMonoUs = 0;
+static bool refValid = false;
+static bool synced = false;
+static uint32_t syncs = 0;
+static int32_t driftMs = 0;
+
+// Кэш разложенного местного времени (только loop)
+static struct tm cached;
+static time_t cachedEpoch = 0;
+static bool cacheValid = false;
+
+static Counter timeSyncs("feeder_time_syncs_total", "NTP synchronisations");
+static Gauge timeSyncAge("feeder_time_sync_age_seconds", "Seconds since the last NTP sync");
+static Gauge timeDrift("feeder_time_drift_ms", "Clock offset corrected by the last NTP sync");
+
+static void setReference(int64_t epochUs, int64_t monoUs) {
+  refEpochUs = epochUs;
+  refMonoUs = monoUs;
+  refValid = true;
+}
+
+// Задача SNTP: новое время уже выставлено, сверяем с монотонным прогнозом
+static void onTimeSync(struct timeval* tv) {
+  int64_t mono = esp_timer_get_time();
+  int64_t ntpUs = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+
+  portENTER_CRITICAL(&refMux);
+  if (synced) driftMs = (ntpUs - (refEpochUs + (mono - refMonoUs))) / 1000;
+  setReference(ntpUs, mono);
+  synced = true;
+  syncs++;
+  portEXIT_CRITICAL(&refMux);
+}
+
+static bool epochUs(int64_t& out) {
+  portENTER_CRITICAL(&refMux);
+  bool ok = refValid;
+  out = refEpochUs + (esp_timer_get_time() - refMonoUs);
+  portEXIT_CRITICAL(&refMux);
+  return ok;
+}
+
+// Внутри минуты - только секунды, иначе полный пересчёт с правилами пояса
+static void updateCache(time_t now) {
+  if (cacheValid && now >= cachedEpoch && cached.tm_sec + (now - cachedEpoch) < 60) {
+    cached.tm_sec += now - cachedEpoch;
+  } else {
+    localtime_r(&now, &cached);
+    cacheValid = true;
+  }
+  cachedEpoch = now;
+}
+
+// Время до синхронизации: системные часы, если пережили сброс, иначе
+// копия из RTC памяти плюс время с начала загрузки
+static void restoreTime() {
+  esp_reset_reason_t reason = esp_reset_reason();
+  bool warm = reason != ESP_RST_POWERON && reason != ESP_RST_BROWNOUT && reason != ESP_RST_UNKNOWN;
+  int64_t mono = esp_timer_get_time();
+
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  if (tv.tv_sec > TIME_VALID_EPOCH) {
+    setReference((int64_t)tv.tv_sec * 1000000 + tv.tv_usec, mono);
+  } else if (warm && rtcTime.magic == RTC_TIME_MAGIC &&
+             rtcTime.check == (uint32_t)(rtcTime.epochUs ^ (rtcTime.epochUs >> 32))) {
+    int64_t us = rtcTime.epochUs + mono;
+    tv.tv_sec = us / 1000000;
+    tv.tv_usec = us % 1000000;
+    settimeofday(&tv, nullptr);
+    setReference(us, mono);
+  } else {
+    return;
+  }
+
+  time_t now = refEpochUs / 1000000;
+  struct tm t;
+  localtime_r(&now, &t);
+  LOGI("NTP", "Время восстановлено до синхронизации: %02d.%02d.%04d %02d:%02d:%02d",
+       t.tm_mday, t.tm_mon + 1, t.tm_year + 1900, t.tm_hour, t.tm_min, t.tm_sec);
+}
+
+void timeServiceSetup() {
+  LOGI("NTP", "Синхронизация времени (пояс %s)...", provTimeZone());
+  sntp_set_time_sync_notification_cb(onTimeSync);
+  configTzTime(provTimeZone(), NTP_SERVER);
+  restoreTime();
+}
+
+void timeServiceLoop() {
+  static uint32_t seenSyncs = 0;
+  static time_t savedEpoch = 0;
+
+  int64_t us;
+  if (!epochUs(us)) return;
+
+  time_t now = us / 1000000;
+  if (now != savedEpoch) {
+    savedEpoch = now;
+    updateCache(now);
+    rtcTime.magic = RTC_TIME_MAGIC;
+    rtcTime.epochUs = us;
+    rtcTime.check = (uint32_t)(us ^ (us >> 32));
+  }
+
+  TimeStatus st = timeStatus();
+  if (st.syncs != seenSyncs) {
+    if (seenSyncs == 0) {
+      LOGI("NTP", "Время: %02d.%02d.%04d %02d:%02d:%02d",
+           cached.tm_mday, cached.tm_mon + 1, cached.tm_year + 1900,
+           cached.tm_hour, cached.tm_min, cached.tm_sec);
+    } else {
+      LOGI("NTP", "Синхронизация: расхождение %d мс", st.driftMs);
+    }
+    timeSyncs.inc(st.syncs - seenSyncs);
+    seenSyncs = st.syncs;
+    // Пересчёт: пояс и переход на летнее время могли измениться
+    cacheValid = false;
+    updateCache(now);
+  }
+  timeSyncAge.set(st.syncAgeS);
+  timeDrift.set(st.driftMs);
+}
+
+void timeSetZone(const char* tz) {
+  setenv("TZ", tz, 1);
+  tzset();
+  cacheValid = false;
+  LOGI("NTP", "Часовой пояс: %s", tz);
+}
+
+bool timeValid() {
+  portENTER_CRITICAL(&refMux);
+  bool ok = refValid;
+  portEXIT_CRITICAL(&refMux);
+  return ok;
+}
+
+bool timeNow(struct tm& out) {
+  int64_t us;
+  if (!epochUs(us)) return false;
+  updateCache(us / 1000000);
+  out = cached;
+  return true;
+}
+
+time_t timeEpoch() {
+  int64_t us;
+  return epochUs(us) ? us / 1000000 : 0;
+}
+
+// %z даёт "+0300", в ISO 8601 нужно "+03:00"
+static size_t formatIso(const struct tm& t, char* buf, size_t size) {
+  size_t n = strftime(buf, size, "%Y-%m-%dT%H:%M:%S%z", &t);
+  if (n >= 5 && n + 1 < size) {
+    memmove(buf + n - 1, buf + n - 2, 3);
+    buf[n - 2] = ':';
+    n++;
+  }
+  return n;
+}
+
+size_t timeIso(char* buf, size_t size) {
+  struct tm t;
+  if (!timeNow(t)) return snprintf(buf, size, "1970-01-01T00:00:00+00:00");
+  return formatIso(t, buf, size);
+}
+
+size_t timeIsoAt(time_t epoch, char* buf, size_t size) {
+  struct tm t;
+  localtime_r(&epoch, &t);
+  return formatIso(t, buf, size);
+}
+
+TimeStatus timeStatus() {
+  TimeStatus st;
+  int64_t mono = esp_timer_get_time();
+  portENTER_CRITICAL(&refMux);
+  st.valid = refValid;
+  st.synced = synced;
+  st.syncs = syncs;
+  st.syncAgeS = synced ? (mono - refMonoUs) / 1000000 : 0;
+  st.driftMs = driftMs;
+  portEXIT_CRITICAL(&refMux);
+  return st;
+}
@@ -0,0 +1,302 @@
+/*
+  tls_client.cpp - TLS поверх lwip сокета с возобновлением сессий
+*/
+
+#include "tls_client.h"
+#include "tls_session.h"
+#include "logger.h"
+#include <WiFi.h>
+#include <lwip/sockets.h>
+#include <lwip/netdb.h>
+#include <unistd.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/ssl_internal.h>
+#include <mbedtls/error.h>
+
+void TlsClient::forgetSession() {
+  tlsSessionForget();
+}
+
+// Ввод-вывод mbedtls через неблокирующий сокет
+static int bioSend(void* ctx, const unsigned char* buf, size_t len) {
+  int n = send(*(int*)ctx, buf, len, 0);
+  if (n >= 0) return n;
+  return (errno == EAGAIN || errno == EWOULDBLOCK) ? MBEDTLS_ERR_SSL_WANT_WRITE : MBEDTLS_ERR_NET_SEND_FAILED;
+}
+
+static int bioRecv(void* ctx, unsigned char* buf, size_t len) {
+  int n = recv(*(int*)ctx, buf, len, 0);
+  if (n > 0) return n;
+  if (n == 0) return MBEDTLS_ERR_NET_CONN_RESET;
+  return (errno == EAGAIN || errno == EWOULDBLOCK) ? MBEDTLS_ERR_SSL_WANT_READ : MBEDTLS_ERR_NET_RECV_FAILED;
+}
+
+static void logError(const char* what, int ret) {
+  char text[80];
+  mbedtls_strerror(ret, text, sizeof(text));
+  LOGW("TLS", "%s: %s (-0x%04x)", what, text, -ret);
+}
+
+TlsClient::TlsClient() {
+  mbedtls_ssl_init(&_ssl);
+  mbedtls_ssl_config_init(&_conf);
+  mbedtls_x509_crt_init(&_ca);
+  mbedtls_entropy_init(&_entropy);
+  mbedtls_ctr_drbg_init(&_drbg);
+}
+
+TlsClient::~TlsClient() {
+  stop();
+  mbedtls_ssl_free(&_ssl);
+  mbedtls_ssl_config_free(&_conf);
+  mbedtls_x509_crt_free(&_ca);
+  mbedtls_ctr_drbg_free(&_drbg);
+  mbedtls_entropy_free(&_entropy);
+}
+
+bool TlsClient::setCaCert(const char* pem) {
+  int ret = mbedtls_x509_crt_parse(&_ca, (const unsigned char*)pem, strlen(pem) + 1);
+  if (ret != 0) {
+    logError("Корневой сертификат не разобран", ret);
+    return false;
+  }
+  _caLoaded = true;
+  return true;
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port) {
+  char host[16];
+  snprintf(host, sizeof(host), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  return connectTo(host, (uint32_t)ip, port);
+}
+
+int TlsClient::connect(const char* host, uint16_t port) {
+  IPAddress ip;
+  if (!WiFi.hostByName(host, ip)) {
+    LOGW("TLS", "Не найден адрес %s", host);
+    return 0;
+  }
+  return connectTo(host, (uint32_t)ip, port);
+}
+
+// TCP с таймаутом, затем рукопожатие
+int TlsClient::connectTo(const char* host, uint32_t ip, uint16_t port) {
+  stop();
+  if (!_caLoaded) {
+    LOGE("TLS", "Нет корневого сертификата брокера");
+    return 0;
+  }
+
+  _sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (_sock < 0) return 0;
+  fcntl(_sock, F_SETFL, fcntl(_sock, F_GETFL, 0) | O_NONBLOCK);
+  int one = 1;
+  setsockopt(_sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = ip;
+  if (::connect(_sock, (sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+    stop();
+    return 0;
+  }
+
+  fd_set wfds;
+  FD_ZERO(&wfds);
+  FD_SET(_sock, &wfds);
+  timeval tv = {TLS_CONNECT_TIMEOUT / 1000, (TLS_CONNECT_TIMEOUT % 1000) * 1000};
+  int err = 0;
+  socklen_t len = sizeof(err);
+  if (select(_sock + 1, nullptr, &wfds, nullptr, &tv) <= 0 ||
+      getsockopt(_sock, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+    LOGW("TLS", "Нет TCP подключения к %s:%u", host, port);
+    stop();
+    return 0;
+  }
+
+  if (!handshake(host, port)) {
+    stop();
+    return 0;
+  }
+  _connected = true;
+  return 1;
+}
+
+bool TlsClient::handshake(const char* host, uint16_t port) {
+  int ret;
+  if (!_configured) {
+    ret = mbedtls_ctr_drbg_seed(&_drbg, mbedtls_entropy_func, &_entropy, nullptr, 0);
+    if (ret == 0) {
+      ret = mbedtls_ssl_config_defaults(&_conf, MBEDTLS_SSL_IS_CLIENT,
+                                        MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+    }
+    if (ret != 0) {
+      logError("Настройка TLS", ret);
+      return false;
+    }
+    mbedtls_ssl_conf_authmode(&_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    mbedtls_ssl_conf_ca_chain(&_conf, &_ca, nullptr);
+    mbedtls_ssl_conf_rng(&_conf, mbedtls_ctr_drbg_random, &_drbg);
+    mbedtls_ssl_conf_session_tickets(&_conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+    _configured = true;
+  }
+
+  mbedtls_ssl_free(&_ssl);
+  mbedtls_ssl_init(&_ssl);
+  if ((ret = mbedtls_ssl_setup(&_ssl, &_conf)) != 0 ||
+      (ret = mbedtls_ssl_set_hostname(&_ssl, host)) != 0) {
+    logError("Настройка TLS", ret);
+    return false;
+  }
+  mbedtls_ssl_set_bio(&_ssl, &_sock, bioSend, bioRecv, nullptr);
+
+  // Предлагаем серверу сохранённую сессию
+  bool offered = false;
+  size_t savedLen = 0;
+  const uint8_t* saved = tlsSessionFind(host, port, &savedLen);
+  if (saved) {
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+    offered = mbedtls_ssl_session_load(&session, saved, savedLen) == 0 &&
+              mbedtls_ssl_set_session(&_ssl, &session) == 0;
+    mbedtls_ssl_session_free(&session);
+  }
+
+  // По шагам: принял ли сервер сессию, видно только внутри рукопожатия.
+  // mbedtls_ssl_set_session ставит resume заранее, разбор ServerHello
+  // сбрасывает его, если сервер начал новую сессию, - поэтому флаг
+  // читается только после ServerHello (и до освобождения handshake)
+  uint32_t start = millis();
+  bool resumed = false;
+  ret = 0;
+  while (_ssl.state != MBEDTLS_SSL_HANDSHAKE_OVER) {
+    ret = mbedtls_ssl_handshake_step(&_ssl);
+    if (offered && _ssl.handshake && _ssl.state > MBEDTLS_SSL_SERVER_HELLO) {
+      resumed = _ssl.handshake->resume != 0;
+    }
+    if (ret == 0) continue;
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) break;
+    if (millis() - start > TLS_HANDSHAKE_TIMEOUT) {
+      ret = MBEDTLS_ERR_SSL_TIMEOUT;
+      break;
+    }
+    vTaskDelay(1);
+  }
+
+  if (_ssl.state != MBEDTLS_SSL_HANDSHAKE_OVER) {
+    _stats.failures++;
+    _stats.lastError = ret;
+    logError("Рукопожатие", ret);
+    uint32_t flags = mbedtls_ssl_get_verify_result(&_ssl);
+    if (flags != 0 && flags != (uint32_t)-1) {
+      char text[128];
+      mbedtls_x509_crt_verify_info(text, sizeof(text), "", flags);
+      LOGW("TLS", "Сертификат брокера не принят: %s", text);
+    }
+    // Сессия могла стать причиной - следующая попытка полная
+    if (offered) forgetSession();
+    return false;
+  }
+
+  _stats.handshakes++;
+  _stats.lastHandshakeMs = millis() - start;
+  _stats.lastResumed = resumed;
+  _stats.lastError = 0;
+  if (resumed) _stats.resumed++;
+  LOGI("TLS", "%s:%u, %s, %s, %u мс", host, port, mbedtls_ssl_get_version(&_ssl),
+       resumed ? "сессия возобновлена" : "полное рукопожатие", _stats.lastHandshakeMs);
+
+  saveSession(host, port);
+  return true;
+}
+
+// Сессия (с новым билетом, если сервер его выдал) - для следующего подключения
+void TlsClient::saveSession(const char* host, uint16_t port) {
+  mbedtls_ssl_session session;
+  mbedtls_ssl_session_init(&session);
+  size_t len = 0;
+  if (mbedtls_ssl_get_session(&_ssl, &session) != 0 ||
+      mbedtls_ssl_session_save(&session, tlsSessionBuffer(), TLS_SESSION_MAX, &len) != 0 ||
+      !tlsSessionStore(host, port, len)) {
+    forgetSession();
+    LOGW("TLS", "Сессия не сохранена (больше TLS_SESSION_MAX?)");
+  }
+  mbedtls_ssl_session_free(&session);
+}
+
+size_t TlsClient::write(const uint8_t* buf, size_t size) {
+  if (!_connected) return 0;
+  size_t done = 0;
+  uint32_t start = millis();
+  while (done < size) {
+    int n = mbedtls_ssl_write(&_ssl, buf + done, size - done);
+    if (n > 0) {
+      done += n;
+      continue;
+    }
+    if ((n != MBEDTLS_ERR_SSL_WANT_WRITE && n != MBEDTLS_ERR_SSL_WANT_READ) ||
+        millis() - start > TLS_CONNECT_TIMEOUT) {
+      _connected = false;
+      break;
+    }
+    vTaskDelay(1);
+  }
+  return done;
+}
+
+int TlsClient::available() {
+  if (!_connected) return 0;
+  // Чтение нуля байт разбирает пришедшие записи
+  int ret = mbedtls_ssl_read(&_ssl, nullptr, 0);
+  if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+    _connected = false;
+    return _peeked >= 0 ? 1 : 0;
+  }
+  return mbedtls_ssl_get_bytes_avail(&_ssl) + (_peeked >= 0 ? 1 : 0);
+}
+
+int TlsClient::read(uint8_t* buf, size_t size) {
+  if (size == 0) return 0;
+  size_t got = 0;
+  if (_peeked >= 0) {
+    buf[got++] = _peeked;
+    _peeked = -1;
+  }
+  if (_connected && got < size) {
+    int n = mbedtls_ssl_read(&_ssl, buf + got, size - got);
+    if (n > 0) {
+      got += n;
+    } else if (n != MBEDTLS_ERR_SSL_WANT_READ && n != MBEDTLS_ERR_SSL_WANT_WRITE) {
+      _connected = false;
+    }
+  }
+  return got > 0 ? (int)got : -1;
+}
+
+int TlsClient::read() {
+  uint8_t b;
+  return read(&b, 1) == 1 ? b : -1;
+}
+
+int TlsClient::peek() {
+  if (_peeked < 0) {
+    uint8_t b;
+    if (read(&b, 1) == 1) _peeked = b;
+  }
+  return _peeked;
+}
+
+void TlsClient::stop() {
+  if (_sock >= 0) {
+    if (_connected) mbedtls_ssl_close_notify(&_ssl);
+    close(_sock);
+    _sock = -1;
+  }
+  _connected = false;
+  _peeked = -1;
+}
+
+uint8_t TlsClient::connected() {
+  return _connected || _peeked >= 0;
+}
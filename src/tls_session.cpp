@@ -0,0 +1,54 @@
+/*
+  tls_session.cpp - Сохранённая TLS сессия в RTC памяти
+*/
+
+#include "tls_session.h"
+#include "checksum.h"
+#include <esp_attr.h>
+#include <string.h>
+
+#define TLS_SESSION_MAGIC 0x544C5353u  // "TLSS"
+
+// Последняя сессия (переживает программный сброс)
+static RTC_NOINIT_ATTR struct {
+  uint32_t magic;
+  uint32_t key;          // host:port, для которых она получена
+  uint32_t len;
+  uint32_t check;
+  uint8_t data[TLS_SESSION_MAX];
+} rtcSession;
+
+static uint32_t sessionKey(const char* host, uint16_t port) {
+  return fnv1a(&port, sizeof(port), fnv1a(host, strlen(host)));
+}
+
+const uint8_t* tlsSessionFind(const char* host, uint16_t port, size_t* len) {
+  if (rtcSession.magic != TLS_SESSION_MAGIC || rtcSession.key != sessionKey(host, port) ||
+      rtcSession.len > sizeof(rtcSession.data) ||
+      rtcSession.check != fnv1a(rtcSession.data, rtcSession.len)) {
+    return nullptr;
+  }
+  *len = rtcSession.len;
+  return rtcSession.data;
+}
+
+uint8_t* tlsSessionBuffer() {
+  rtcSession.magic = 0;
+  return rtcSession.data;
+}
+
+bool tlsSessionStore(const char* host, uint16_t port, size_t len) {
+  if (len > sizeof(rtcSession.data)) {
+    rtcSession.magic = 0;
+    return false;
+  }
+  rtcSession.key = sessionKey(host, port);
+  rtcSession.len = len;
+  rtcSession.check = fnv1a(rtcSession.data, len);
+  rtcSession.magic = TLS_SESSION_MAGIC;
+  return true;
+}
+
+void tlsSessionForget() {
+  rtcSession.magic = 0;
+}
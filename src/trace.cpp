@@ -0,0 +1,208 @@
+/*
+  trace.cpp - Трассировка блокирующих участков и сторож зависаний loop()
+*/
+
+#include "trace.h"
+#include "checksum.h"
+#include "metrics.h"
+#include "logger.h"
+
+// Событие трассировки (имя копируется, чтобы снимок пережил перезагрузку)
+struct TraceEvent {
+  char name[TRACE_NAME_LEN];
+  uint32_t startUs;
+  uint32_t durUs;
+  uint8_t depth;
+  uint8_t open;  // Участок не завершился к моменту снимка
+};
+
+// Снимок зависания в RTC памяти
+struct TraceSnapshot {
+  uint32_t magic;
+  uint32_t stallMs;
+  uint32_t takenAtUs;
+  uint32_t uptimeSec;
+  uint16_t count;
+  TraceEvent events[TRACE_RING_SIZE + TRACE_MAX_DEPTH];
+  uint32_t checksum;
+};
+
+// Открытый участок
+struct OpenScope {
+  const char* name;
+  uint32_t startUs;
+};
+
+static const uint32_t TRACE_SNAPSHOT_MAGIC = 0x54524143;  // "TRAC"
+
+RTC_NOINIT_ATTR static TraceSnapshot snapshot;
+
+// Кольцо завершённых событий и стек открытых участков
+static TraceEvent ring[TRACE_RING_SIZE];
+static uint16_t ringHead = 0;   // Куда писать следующее событие
+static uint16_t ringCount = 0;
+static OpenScope stack[TRACE_MAX_DEPTH];
+static uint8_t depth = 0;
+
+// Пишет loop, читает сторож
+static portMUX_TYPE traceMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint32_t lastTickMs = 0;
+static volatile bool armed = false;
+
+static Counter loopStalls("feeder_loop_stalls_total", "loop() iterations longer than TRACE_STALL_MS");
+static Gauge lastStall("feeder_loop_last_stall_ms", "Duration of the last loop() stall");
+
+static uint32_t snapshotChecksum() {
+  return fnv1a(&snapshot, offsetof(TraceSnapshot, checksum));
+}
+
+static void copyName(char* dst, const char* src) {
+  strncpy(dst, src, TRACE_NAME_LEN - 1);
+  dst[TRACE_NAME_LEN - 1] = '\0';
+}
+
+void traceBegin(const char* name) {
+  portENTER_CRITICAL(&traceMux);
+  if (depth < TRACE_MAX_DEPTH) {
+    stack[depth].name = name;
+    stack[depth].startUs = micros();
+  }
+  depth++;
+  portEXIT_CRITICAL(&traceMux);
+}
+
+void traceEnd() {
+  uint32_t now = micros();
+
+  portENTER_CRITICAL(&traceMux);
+  if (depth > 0) depth--;
+  if (depth < TRACE_MAX_DEPTH) {
+    uint32_t dur = now - stack[depth].startUs;
+    // Короткие участки не интересны и только вытесняют длинные
+    if (dur >= TRACE_MIN_DURATION_US) {
+      TraceEvent& e = ring[ringHead];
+      copyName(e.name, stack[depth].name);
+      e.startUs = stack[depth].startUs;
+      e.durUs = dur;
+      e.depth = depth;
+      e.open = 0;
+      ringHead = (ringHead + 1) % TRACE_RING_SIZE;
+      if (ringCount < TRACE_RING_SIZE) ringCount++;
+    }
+  }
+  portEXIT_CRITICAL(&traceMux);
+}
+
+// Копия кольца и открытых участков в RTC память (из задачи сторожа)
+static void takeSnapshot(uint32_t stallMs) {
+  uint32_t now = micros();
+
+  portENTER_CRITICAL(&traceMux);
+  uint16_t n = 0;
+  uint16_t start = (ringHead + TRACE_RING_SIZE - ringCount) % TRACE_RING_SIZE;
+  for (uint16_t i = 0; i < ringCount; i++) {
+    snapshot.events[n++] = ring[(start + i) % TRACE_RING_SIZE];
+  }
+  uint8_t open = depth < TRACE_MAX_DEPTH ? depth : TRACE_MAX_DEPTH;
+  for (uint8_t i = 0; i < open; i++) {
+    TraceEvent& e = snapshot.events[n++];
+    copyName(e.name, stack[i].name);
+    e.startUs = stack[i].startUs;
+    e.durUs = now - stack[i].startUs;
+    e.depth = i;
+    e.open = 1;
+  }
+  portEXIT_CRITICAL(&traceMux);
+
+  snapshot.count = n;
+  snapshot.stallMs = stallMs;
+  snapshot.takenAtUs = now;
+  snapshot.uptimeSec = millis() / 1000;
+  snapshot.magic = TRACE_SNAPSHOT_MAGIC;
+  snapshot.checksum = snapshotChecksum();
+}
+
+// Сторож: пока loop() стоит, снимок обновляется (в итоге - самое полное состояние)
+static void watchdogTask(void*) {
+  bool inStall = false;
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(TRACE_WATCHDOG_PERIOD));
+    if (!armed) continue;
+
+    uint32_t since = millis() - lastTickMs;
+    if (since >= TRACE_STALL_MS) {
+      takeSnapshot(since);
+      lastStall.set(since);
+      if (!inStall) {
+        loopStalls.inc();
+        inStall = true;
+      }
+    } else {
+      inStall = false;
+    }
+  }
+}
+
+void traceSetup() {
+  if (traceHasSnapshot()) {
+    // Самый глубокий открытый участок - наиболее вероятный виновник
+    const char* culprit = "?";
+    for (uint16_t i = 0; i < snapshot.count; i++) {
+      if (snapshot.events[i].open) culprit = snapshot.events[i].name;
+    }
+    LOGW("TRACE", "Есть снимок зависания: %u мс в \"%s\" (uptime %u сек)",
+                  snapshot.stallMs, culprit, snapshot.uptimeSec);
+  }
+
+  xTaskCreatePinnedToCore(watchdogTask, "trace_wd", 3072, nullptr, 2, nullptr, 0);
+  LOGI("TRACE", "Сторож loop() запущен");
+}
+
+void traceLoopTick() {
+  lastTickMs = millis();
+  armed = true;
+}
+
+bool traceHasSnapshot() {
+  return snapshot.magic == TRACE_SNAPSHOT_MAGIC &&
+         snapshot.count <= TRACE_RING_SIZE + TRACE_MAX_DEPTH &&
+         snapshot.checksum == snapshotChecksum();
+}
+
+// Выгрузка событий (events - кольцо ёмкостью size, начиная с first):
+// ts отсчитывается от самого раннего события
+static void writeEvents(Print& out, const TraceEvent* events, uint16_t size,
+                        uint16_t first, uint16_t count, uint32_t refUs) {
+  uint32_t maxAge = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    uint32_t age = refUs - events[(first + i) % size].startUs;
+    if (age > maxAge) maxAge = age;
+  }
+
+  for (uint16_t i = 0; i < count; i++) {
+    const TraceEvent& e = events[(first + i) % size];
+    out.printf("%s{\"name\":\"%s\",\"cat\":\"loop\",\"ph\":\"X\",\"ts\":%u,\"dur\":%u,"
+               "\"pid\":1,\"tid\":1,\"args\":{\"depth\":%u,\"open\":%s}}",
+               i ? ",\n" : "\n", e.name, maxAge - (refUs - e.startUs), e.durUs,
+               e.depth, e.open ? "true" : "false");
+  }
+}
+
+void traceWriteChromeJson(Print& out, bool fromSnapshot) {
+  out.print("{\"traceEvents\":[");
+
+  if (fromSnapshot) {
+    writeEvents(out, snapshot.events, snapshot.count, 0, snapshot.count, snapshot.takenAtUs);
+    out.printf("],\"otherData\":{\"kind\":\"stall\",\"stall_ms\":%u,\"uptime_s\":%u,"
+               "\"firmware\":\"" FIRMWARE_VERSION "\"}}\n",
+               snapshot.stallMs, snapshot.uptimeSec);
+    return;
+  }
+
+  // Кольцо пишет только loop - тот же поток, что и обработчик запроса,
+  // поэтому читаем его без копирования
+  uint16_t first = (ringHead + TRACE_RING_SIZE - ringCount) % TRACE_RING_SIZE;
+  writeEvents(out, ring, TRACE_RING_SIZE, first, ringCount, micros());
+  out.printf("],\"otherData\":{\"kind\":\"live\",\"uptime_s\":%lu,"
+             "\"firmware\":\"" FIRMWARE_VERSION "\"}}\n", millis() / 1000);
+}
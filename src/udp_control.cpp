@@ -0,0 +1,186 @@
+/*
+  udp_control.cpp - Команды кормления по UDP в локальной сети
+*/
+
+#include "udp_control.h"
+#include "feeder.h"
+#include "presence.h"
+#include "power_manager.h"
+#include "time_service.h"
+#include "device_id.h"
+#include "metrics.h"
+#include "logger.h"
+#include <ESPmDNS.h>
+#include <Preferences.h>
+#include <lwip/sockets.h>
+#include <mbedtls/md.h>
+#include <atomic>
+
+// Проверенная команда для loop
+struct UdpCommand {
+  UdpRequest req;
+  sockaddr_in from;
+  uint8_t result;            // UDP_OK или UDP_REPLAY
+  uint32_t receivedUs;
+};
+
+static int sock = -1;
+static QueueHandle_t commands = nullptr;
+
+// Последний принятый counter кормления. Пишет только задача приёма
+// (проверка и сдвиг - одним шагом, повтор не пройдёт даже в той же очереди),
+// loop сохраняет его в NVS
+static std::atomic<uint32_t> lastCounter(0);
+static uint32_t savedCounter = 0;
+
+static Counter udpCommands("feeder_udp_commands_total", "Authenticated UDP commands");
+static Counter udpRejected("feeder_udp_rejected_total", "UDP packets dropped (format or signature)");
+static Counter udpReplays("feeder_udp_replays_total", "UDP feed commands with a stale counter");
+static Histogram udpLatency("feeder_udp_latency_us", "UDP command: receive to reply",
+                            nullptr, METRICS_BUCKETS_US, METRICS_BUCKETS_US_COUNT);
+
+// HMAC-SHA256 от len байт, усечённый до UDP_MAC_LEN
+static void sign(const void* data, size_t len, uint8_t* mac) {
+  uint8_t full[32];
+  mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+                  (const uint8_t*)UDP_CONTROL_KEY, strlen(UDP_CONTROL_KEY),
+                  (const uint8_t*)data, len, full);
+  memcpy(mac, full, UDP_MAC_LEN);
+}
+
+// Сравнение за постоянное время (не выдаёт совпавший префикс)
+static bool macValid(const UdpRequest& req) {
+  uint8_t mac[UDP_MAC_LEN];
+  sign(&req, offsetof(UdpRequest, mac), mac);
+  uint8_t diff = 0;
+  for (int i = 0; i < UDP_MAC_LEN; i++) diff |= mac[i] ^ req.mac[i];
+  return diff == 0;
+}
+
+// Приём одной датаграммы: формат, подпись, повтор; остальное - в loop.
+// false - датаграммы нет (или ошибка сокета)
+static bool receiveOne(int flags) {
+  uint8_t buf[sizeof(UdpRequest) + 1];
+  UdpCommand cmd;
+  socklen_t alen = sizeof(cmd.from);
+  int n = recvfrom(sock, buf, sizeof(buf), flags, (sockaddr*)&cmd.from, &alen);
+  if (n < 0) return false;
+  cmd.receivedUs = micros();
+  memcpy(&cmd.req, buf, sizeof(cmd.req));
+  if (n != sizeof(UdpRequest) || cmd.req.magic != UDP_MAGIC ||
+      cmd.req.version != UDP_VERSION || !macValid(cmd.req)) {
+    udpRejected.inc();
+    return true;
+  }
+
+  cmd.result = UDP_OK;
+  if (cmd.req.cmd == UDP_CMD_FEED) {
+    if (cmd.req.counter <= lastCounter.load()) {
+      udpReplays.inc();
+      cmd.result = UDP_REPLAY;
+    } else {
+      lastCounter.store(cmd.req.counter);
+    }
+  }
+  udpCommands.inc();
+  if (xQueueSend(commands, &cmd, 0) == pdTRUE) powerWake();
+  return true;
+}
+
+// Задача приёма на ядре 0
+static void udpTask(void*) {
+  for (;;) {
+    if (!receiveOne(0)) vTaskDelay(pdMS_TO_TICKS(100));
+  }
+}
+
+#ifndef ARDUINO
+bool udpControlPoll() {
+  return sock >= 0 && receiveOne(MSG_DONTWAIT);
+}
+#endif
+
+static void sendReply(const UdpCommand& cmd, uint8_t result) {
+  UdpReply r = {};
+  r.magic = UDP_MAGIC;
+  r.version = UDP_VERSION;
+  r.cmd = cmd.req.cmd | UDP_REPLY_FLAG;
+  r.result = result;
+  r.counter = cmd.req.counter;
+  r.lastCounter = lastCounter.load();
+  r.uptime = millis() / 1000;
+  r.epoch = timeEpoch();
+  for (uint8_t i = 0; i < NUM_AUGERS && i < 8; i++) {
+    if (feederBusy(i)) r.busyMask |= 1 << i;
+  }
+  r.petPresent = presenceDetected();
+  sign(&r, offsetof(UdpReply, mac), r.mac);
+  sendto(sock, &r, sizeof(r), 0, (const sockaddr*)&cmd.from, sizeof(cmd.from));
+}
+
+void udpControlSetup() {
+  if (strlen(UDP_CONTROL_KEY) == 0) {
+    LOGI("UDP", "Ключ UDP_CONTROL_KEY не задан, UDP управление выключено");
+    return;
+  }
+  Preferences prefs;
+  prefs.begin("udp", true);
+  savedCounter = prefs.getUInt("counter", 0);
+  prefs.end();
+  lastCounter.store(savedCounter);
+
+  sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(UDP_CONTROL_PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (sock < 0 || bind(sock, (sockaddr*)&addr, sizeof(addr)) < 0) {
+    LOGE("UDP", "Не удалось открыть порт %d", UDP_CONTROL_PORT);
+    if (sock >= 0) close(sock);
+    sock = -1;
+    return;
+  }
+
+  commands = xQueueCreate(UDP_CONTROL_QUEUE, sizeof(UdpCommand));
+  xTaskCreatePinnedToCore(udpTask, "udp", 3072, nullptr, 2, nullptr, 0);
+
+  // mDNS уже запущен ArduinoOTA
+  MDNS.addService("feeder", "udp", UDP_CONTROL_PORT);
+  MDNS.addServiceTxt("feeder", "udp", "id", deviceId());
+  MDNS.addServiceTxt("feeder", "udp", "v", String(UDP_VERSION));
+  LOGI("UDP", "Команды на порту %d (counter %u)", UDP_CONTROL_PORT, savedCounter);
+}
+
+void udpControlLoop() {
+  if (!commands) return;
+
+  UdpCommand cmd;
+  while (xQueueReceive(commands, &cmd, 0) == pdTRUE) {
+    uint8_t result = cmd.result;
+    powerActivity();
+    if (result == UDP_OK) {
+      if (cmd.req.cmd == UDP_CMD_FEED) {
+        uint8_t auger = cmd.req.auger ? cmd.req.auger - 1 : 0;
+        if (auger >= NUM_AUGERS) {
+          result = UDP_BAD_AUGER;
+        } else if (!feed(auger, cmd.req.amount, "udp")) {
+          result = UDP_BUSY;
+        }
+      } else if (cmd.req.cmd != UDP_CMD_STATUS) {
+        result = UDP_BAD_REQUEST;
+      }
+    }
+    sendReply(cmd, result);
+    udpLatency.observe(micros() - cmd.receivedUs);
+  }
+
+  // Запись во flash - после ответа, чтобы не задерживать его
+  uint32_t counter = lastCounter.load();
+  if (counter != savedCounter) {
+    Preferences prefs;
+    prefs.begin("udp", false);
+    prefs.putUInt("counter", counter);
+    prefs.end();
+    savedCounter = counter;
+  }
+}
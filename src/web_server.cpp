@@ -4,52 +4,140 @@
 
 #include "web_server.h"
 #include "feeder.h"
+#include "feed_journal.h"
 #include "schedule.h"
 #include "mqtt_handler.h"
+#include "metrics.h"
+#include "trace.h"
+#include "logger.h"
+#include "alloc_track.h"
+#include "arena.h"
+#include "ota_update.h"
+#include "storage.h"
+#include "camera.h"
+#include "clip_recorder.h"
+#include "time_service.h"
+#include "provisioning.h"
+#include "shadow.h"
+#include "power_manager.h"
+#include <WiFi.h>
 #include <time.h>
 
 // Глобальный объект веб-сервера
 WebServer server(80);
 
-// Инициализация веб-сервера
-void webServerSetup() {
-  // Инициализация SPIFFS
-  if (!SPIFFS.begin(true)) {
-    Serial.println("[WEB] Ошибка монтирования SPIFFS!");
-    return;
+// Время обработки запросов по маршрутам
+#define HTTP_HIST(var, route) \
+  static Histogram var("feeder_http_request_duration_us", "HTTP handler latency", \
+                       "route=\"" route "\"", METRICS_BUCKETS_US, METRICS_BUCKETS_US_COUNT)
+HTTP_HIST(httpRoot, "/");
+HTTP_HIST(httpTime, "/api/time");
+HTTP_HIST(httpGetSchedules, "GET /api/schedules");
+HTTP_HIST(httpSaveSchedules, "POST /api/schedules");
+HTTP_HIST(httpFeed, "/api/feed");
+HTTP_HIST(httpToggle, "/api/toggle");
+HTTP_HIST(httpSetBase, "/api/setbase");
+HTTP_HIST(httpMetrics, "/metrics");
+HTTP_HIST(httpTrace, "/api/trace");
+HTTP_HIST(httpLog, "/api/log");
+HTTP_HIST(httpCapture, "/api/capture");
+HTTP_HIST(httpStream, "/api/stream");
+HTTP_HIST(httpClip, "/api/clip");
+HTTP_HIST(httpClips, "/api/clips");
+HTTP_HIST(httpGetConfig, "GET /api/config");
+HTTP_HIST(httpSaveConfig, "POST /api/config");
+HTTP_HIST(httpGetShadow, "GET /api/shadow");
+HTTP_HIST(httpSaveShadow, "POST /api/shadow");
+HTTP_HIST(httpJournal, "/api/journal");
+HTTP_HIST(httpOta, "POST /api/ota");
+HTTP_HIST(httpOtaStatus, "GET /api/ota");
+HTTP_HIST(httpNotFound, "404");
+
+// Временные буферы обработчиков (освобождаются перед каждым запросом)
+static StaticArena<WEB_ARENA_SIZE> webArena;
+
+// Обёртка обработчика с замером времени. Запрос - событие для режима
+// питания, кроме периодического опроса (wake = false)
+static std::function<void()> timed(Histogram& hist, void (*handler)(), bool wake = true) {
+  return [&hist, handler, wake]() {
+    uint32_t start = micros();
+    if (wake) powerActivity();
+    allocWebRequest();
+    webArena.reset();
+    handler();
+    hist.observe(micros() - start);
+  };
+}
+
+// Буферизованный вывод в ответ с chunked-кодированием
+class ChunkedResponse : public Print {
+public:
+  size_t write(uint8_t c) override {
+    _buf[_len++] = c;
+    if (_len == sizeof(_buf)) flush();
+    return 1;
   }
-  Serial.println("[OK] SPIFFS смонтирован");
-  
-  // Проверка наличия index.html
-  File file = SPIFFS.open("/index.html", "r");
-  if (file) {
-    Serial.printf("[OK] index.html найден (%d байт)\n", file.size());
-    file.close();
-  } else {
-    Serial.println("[WARN] index.html не найден!");
+  size_t write(const uint8_t* data, size_t size) override {
+    for (size_t i = 0; i < size; i++) write(data[i]);
+    return size;
   }
-  
+  void flush() {
+    if (_len == 0) return;
+    server.sendContent((const char*)_buf, _len);
+    _len = 0;
+  }
+private:
+  uint8_t _buf[512];
+  size_t _len = 0;
+};
+
+// Инициализация веб-сервера
+void webServerSetup() {
+  // Хранилище монтируется в фоне (storageSetup), веб-файлы отдаются,
+  // когда оно готово
   // Регистрация обработчиков
-  server.on("/", handleRoot);
-  server.on("/api/time", handleTime);
-  server.on("/api/schedules", HTTP_GET, handleGetSchedules);
-  server.on("/api/schedules", HTTP_POST, handleSaveSchedules);
-  server.on("/api/feed", handleFeed);
-  server.on("/api/toggle", handleToggle);
-  server.on("/api/setbase", handleSetBase);
+  server.on("/", timed(httpRoot, handleRoot));
+  server.on("/api/time", timed(httpTime, handleTime));
+  server.on("/api/schedules", HTTP_GET, timed(httpGetSchedules, handleGetSchedules));
+  server.on("/api/schedules", HTTP_POST, timed(httpSaveSchedules, handleSaveSchedules));
+  server.on("/api/feed", timed(httpFeed, handleFeed));
+  server.on("/api/toggle", timed(httpToggle, handleToggle));
+  server.on("/api/setbase", timed(httpSetBase, handleSetBase));
+  server.on("/api/capture", timed(httpCapture, handleCapture));
+  server.on("/api/stream", timed(httpStream, handleStream));
+  server.on("/api/clip", timed(httpClip, handleClip));
+  server.on("/api/clips", timed(httpClips, handleClips));
+  server.on("/metrics", timed(httpMetrics, handleMetrics, false));
+  server.on("/api/trace", timed(httpTrace, handleTrace));
+  server.on("/api/log", timed(httpLog, handleLog));
+  server.on("/api/config", HTTP_GET, timed(httpGetConfig, handleGetConfig));
+  server.on("/api/config", HTTP_POST, timed(httpSaveConfig, handleConfigDone), handleConfigUpload);
+  server.on("/api/shadow", HTTP_GET, timed(httpGetShadow, handleGetShadow));
+  server.on("/api/shadow", HTTP_POST, timed(httpSaveShadow, handleSaveShadow));
+  server.on("/api/journal", timed(httpJournal, handleJournal));
+  server.on("/api/ota", HTTP_GET, timed(httpOtaStatus, handleOtaStatus));
+  server.on("/api/ota", HTTP_POST, timed(httpOta, handleOtaDone), handleOtaUpload);
+  // Неизвестные адреса - тоже через обёртку (сканеры сети не будят кормушку)
+  server.onNotFound(timed(httpNotFound, handleNotFound, false));
   
   server.begin();
-  Serial.println("[OK] Web-сервер запущен на порту 80");
+  LOGI("WEB", "Сервер запущен на порту 80");
 }
 
 // Обработка клиентов
 void webServerLoop() {
+  TRACE_SCOPE("handleClient");
+  ALLOC_SCOPE(ALLOC_WEB);
   server.handleClient();
 }
 
 // Главная страница
 void handleRoot() {
-  File file = SPIFFS.open("/index.html", "r");
+  if (!storageReady()) {
+    server.send(503, "text/plain", "Storage is not mounted yet");
+    return;
+  }
+  File file = storageFs().open("/index.html", "r");
   if (!file) {
     server.send(500, "text/plain", "Error: index.html not found");
     return;
@@ -61,94 +149,125 @@ void handleRoot() {
 // Текущее время
 void handleTime() {
   struct tm timeinfo;
-  if (!getLocalTime(&timeinfo)) {
+  if (!timeNow(timeinfo)) {
     server.send(200, "application/json", "{\"time\":\"Не синхронизировано\"}");
     return;
   }
   
-  char timeStr[64];
-  strftime(timeStr, sizeof(timeStr), "%d.%m.%Y %H:%M:%S", &timeinfo);
-  String json = "{\"time\":\"" + String(timeStr) + "\"}";
+  // Время и состояние синхронизации (synced=false - восстановлено после сброса)
+  TimeStatus st = timeStatus();
+  char iso[32];
+  timeIso(iso, sizeof(iso));
+  char json[192];
+  size_t n = strftime(json, sizeof(json), "{\"time\":\"%d.%m.%Y %H:%M:%S\"", &timeinfo);
+  snprintf(json + n, sizeof(json) - n,
+           ",\"iso\":\"%s\",\"synced\":%s,\"sync_age\":%u,\"drift_ms\":%d}",
+           iso, st.synced ? "true" : "false", st.syncAgeS, st.driftMs);
   server.send(200, "application/json", json);
 }
 
+// Номер шнека из аргумента ?auger= (с единицы); -1 - неверный номер
+static int augerArg() {
+  if (!server.hasArg("auger")) return 0;
+  int auger = server.arg("auger").toInt() - 1;
+  return (auger >= 0 && auger < NUM_AUGERS) ? auger : -1;
+}
+
 // Получение расписаний
 void handleGetSchedules() {
-  String json = "{\"feedAmount\":" + String(feedAmount) + ",\"schedules\":[";
+  const size_t size = 96 + NUM_AUGERS * 8 + MAX_SCHEDULES * 80;
+  char* buf = (char*)webArena.alloc(size);
+  if (!buf) {
+    server.send(500, "text/plain", "Out of memory");
+    return;
+  }
+  
+  BufWriter json(buf, size);
+  json.printf("{\"feedAmount\":%d,\"augers\":%d,\"feedAmounts\":[", feedAmount[0], NUM_AUGERS);
+  for (int i = 0; i < NUM_AUGERS; i++) {
+    json.printf("%s%d", i > 0 ? "," : "", feedAmount[i]);
+  }
+  json.print("],\"schedules\":[");
   for (int i = 0; i < MAX_SCHEDULES; i++) {
-    if (i > 0) json += ",";
-    json += "{\"hour\":" + String(schedules[i].hour) + 
-            ",\"minute\":" + String(schedules[i].minute) +
-            ",\"amount\":" + String(schedules[i].amount) +
-            ",\"enabled\":" + String(schedules[i].enabled ? "true" : "false") + "}";
+    json.printf("%s{\"hour\":%u,\"minute\":%u,\"amount\":%d,\"auger\":%d,\"enabled\":%s}",
+                i > 0 ? "," : "", schedules[i].hour, schedules[i].minute,
+                schedules[i].amount, schedules[i].auger + 1,
+                schedules[i].enabled ? "true" : "false");
   }
-  json += "]}";
-  server.send(200, "application/json", json);
+  json.print("]}");
+  server.send_P(200, "application/json", json.c_str(), json.length());
 }
 
 // Сохранение расписаний
 void handleSaveSchedules() {
-  Serial.println("[WEB] Сохранение расписания");
+  LOGI("WEB", "Сохранение расписания");
   
   if (!server.hasArg("plain")) {
     server.send(400, "text/plain", "No data");
     return;
   }
   
-  String body = server.arg("plain");
-  
-  // Парсинг JSON
-  int pos = body.indexOf("\"schedules\"");
-  if (pos < 0) {
+  // Разбор прямо по тексту запроса, без промежуточных String
+  const String& body = server.arg("plain");
+  const char* pos = strstr(body.c_str(), "\"schedules\"");
+  if (!pos) {
     server.send(400, "text/plain", "Bad format");
     return;
   }
   
   for (int i = 0; i < MAX_SCHEDULES; i++) {
-    int hourPos = body.indexOf("\"hour\":", pos);
-    if (hourPos < 0) break;
+    const char* hourPos = strstr(pos, "\"hour\":");
+    if (!hourPos) break;
     
-    int minPos = body.indexOf("\"minute\":", hourPos);
-    int amtPos = body.indexOf("\"amount\":", minPos);
-    int enPos = body.indexOf("\"enabled\":", amtPos);
+    const char* minPos = strstr(hourPos, "\"minute\":");
+    const char* amtPos = minPos ? strstr(minPos, "\"amount\":") : nullptr;
+    if (!amtPos) break;
+    const char* enPos = strstr(amtPos, "\"enabled\":");
     
-    if (minPos > 0 && amtPos > 0) {
-      int commaH = body.indexOf(',', hourPos);
-      int commaM = body.indexOf(',', minPos);
-      int commaA = body.indexOf(',', amtPos);
-      
-      if (commaH > 0 && commaM > 0) {
-        schedules[i].hour = body.substring(hourPos + 7, commaH).toInt();
-        schedules[i].minute = body.substring(minPos + 9, commaM).toInt();
-        schedules[i].amount = body.substring(amtPos + 9, commaA > 0 ? commaA : body.indexOf('}', amtPos)).toInt();
-        
-        if (enPos > 0) {
-          int boolEnd = body.indexOf('}', enPos);
-          String enabledStr = body.substring(enPos + 10, boolEnd);
-          schedules[i].enabled = (enabledStr.indexOf("true") >= 0);
-        }
-        
-        Serial.printf("  #%d: %02d:%02d - %d об. %s\n", 
-          i+1, schedules[i].hour, schedules[i].minute, schedules[i].amount,
-          schedules[i].enabled ? "ВКЛ" : "ВЫКЛ");
-      }
-      
-      pos = amtPos;
+    schedules[i].hour = atoi(hourPos + 7);
+    schedules[i].minute = atoi(minPos + 9);
+    schedules[i].amount = atoi(amtPos + 9);
+    
+    // Шнек - необязательное поле, ищем только внутри этого объекта
+    const char* objStart = hourPos;
+    while (objStart > pos && *objStart != '{') objStart--;
+    const char* objEnd = strchr(amtPos, '}');
+    const char* augPos = strstr(objStart, "\"auger\":");
+    int auger = (augPos && (!objEnd || augPos < objEnd)) ? atoi(augPos + 8) - 1 : 0;
+    schedules[i].auger = (auger >= 0 && auger < NUM_AUGERS) ? auger : 0;
+    
+    if (enPos) {
+      const char* value = enPos + 10;
+      while (*value == ' ') value++;
+      schedules[i].enabled = (strncmp(value, "true", 4) == 0);
     }
+    
+    LOGI("WEB", "  #%d: %02d:%02d - %d об., шнек %d %s", 
+      i+1, schedules[i].hour, schedules[i].minute, schedules[i].amount,
+      schedules[i].auger + 1, schedules[i].enabled ? "ВКЛ" : "ВЫКЛ");
+    
+    pos = amtPos;
   }
   
   saveSettings();
   server.send(200, "text/plain", "OK");
 }
 
-// Кормление
+// Кормление (?auger=N - номер шнека, ?amount= - порция)
 void handleFeed() {
-  int amount = feedAmount;
+  int auger = augerArg();
+  if (auger < 0) {
+    server.send(400, "text/plain", "Bad auger");
+    return;
+  }
+  int amount = feedAmount[auger];
   if (server.hasArg("amount")) {
     amount = server.arg("amount").toInt();
   }
-  feed(amount);
-  publishLastFeeding(amount, "web");
+  if (!feed(auger, amount, "web")) {
+    server.send(409, "text/plain", "Busy");
+    return;
+  }
   server.send(200, "text/plain", "OK");
 }
 
@@ -158,19 +277,281 @@ void handleToggle() {
     int id = server.arg("id").toInt() - 1;
     if (id >= 0 && id < MAX_SCHEDULES) {
       schedules[id].enabled = !schedules[id].enabled;
-      Serial.printf("[WEB] Расписание %d -> %s\n", id + 1, schedules[id].enabled ? "ВКЛ" : "ВЫКЛ");
+      LOGI("WEB", "Расписание %d -> %s", id + 1, schedules[id].enabled ? "ВКЛ" : "ВЫКЛ");
       saveSettings();
     }
   }
   server.send(200, "text/plain", "OK");
 }
 
-// Установка базовой порции
+// Установка базовой порции (?auger=N - номер шнека)
 void handleSetBase() {
+  int auger = augerArg();
+  if (auger < 0) {
+    server.send(400, "text/plain", "Bad auger");
+    return;
+  }
   if (server.hasArg("amount")) {
-    feedAmount = server.arg("amount").toInt();
-    Serial.printf("[WEB] Базовая порция: %d\n", feedAmount);
+    feedAmount[auger] = server.arg("amount").toInt();
+    LOGI("WEB", "Базовая порция шнека %d: %d", auger + 1, feedAmount[auger]);
     saveSettings();
   }
   server.send(200, "text/plain", "OK");
 }
+
+// Снимок камеры (JPEG отдаётся прямо из слота пула кадров)
+void handleCapture() {
+  FrameSlot* frame = cameraAcquireFrame(CAMERA_CAPTURE_TIMEOUT);
+  if (!frame) {
+    server.send(503, "text/plain", "Camera not available");
+    return;
+  }
+  
+  server.sendHeader("Content-Disposition", "inline; filename=capture.jpg");
+  server.sendHeader("Cache-Control", "no-cache");
+  server.setContentLength(frame->info.len);
+  server.send(200, "image/jpeg", "");
+  server.client().write(frame->data, frame->info.len);
+  cameraRelease(frame);
+}
+
+// MJPEG поток идёт с отдельного сервера, чтобы не занимать этот
+void handleStream() {
+  IPAddress ip = WiFi.localIP();
+  char url[64];
+  snprintf(url, sizeof(url), "http://%u.%u.%u.%u:%d/api/stream",
+           ip[0], ip[1], ip[2], ip[3], CAMERA_STREAM_PORT);
+  server.sendHeader("Location", url);
+  server.send(302, "text/plain", "");
+}
+
+// Ролик кормления: multipart кадры в том же виде, что и MJPEG поток
+void handleClip() {
+  if (!server.hasArg("id") || !storageReady()) {
+    server.send(404, "text/plain", "Clip not found");
+    return;
+  }
+  char path[32];
+  clipPath(strtoul(server.arg("id").c_str(), nullptr, 10), path, sizeof(path));
+  File file = storageFs().open(path, "r");
+  if (!file) {
+    server.send(404, "text/plain", "Clip not found");
+    return;
+  }
+  server.streamFile(file, "multipart/x-mixed-replace; boundary=frame");
+  file.close();
+}
+
+// Список сохранённых роликов
+void handleClips() {
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  
+  ChunkedResponse out;
+  clipWriteListJson(out);
+  out.flush();
+  server.sendContent("");
+}
+
+// Метрики в формате Prometheus
+void handleMetrics() {
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/plain; version=0.0.4", "");
+  
+  ChunkedResponse out;
+  metricsWritePrometheus(out);
+  out.flush();
+  server.sendContent("");
+}
+
+// Трасса в формате Chrome trace (?snapshot=1 - снимок последнего зависания)
+void handleTrace() {
+  bool snapshot = server.hasArg("snapshot");
+  if (snapshot && !traceHasSnapshot()) {
+    server.send(404, "text/plain", "No stall snapshot");
+    return;
+  }
+  
+  server.sendHeader("Content-Disposition",
+                    snapshot ? "attachment; filename=stall_trace.json" : "attachment; filename=trace.json");
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  
+  ChunkedResponse out;
+  traceWriteChromeJson(out, snapshot);
+  out.flush();
+  server.sendContent("");
+}
+
+// Последние строки журнала (?since=N - только строки с номером >= N)
+void handleLog() {
+  uint32_t since = server.hasArg("since") ? strtoul(server.arg("since").c_str(), nullptr, 10) : 0;
+  
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  
+  ChunkedResponse out;
+  logWriteTailJson(out, since);
+  out.flush();
+  server.sendContent("");
+}
+
+// Текущие настройки (без паролей; годятся как документ для POST)
+void handleGetConfig() {
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/json", "");
+  
+  ChunkedResponse out;
+  provisionWriteJson(out);
+  out.flush();
+  server.sendContent("");
+}
+
+// Тело пришло через raw() (иначе - целиком в arg("plain"))
+static bool configReceived = false;
+
+// Сеть и учётные данные по HTTP - только с паролем WEB_ADMIN_PASSWORD
+static uint8_t configAllowed() {
+  bool admin = strlen(WEB_ADMIN_PASSWORD) > 0 && server.authenticate(WEB_ADMIN_USER, WEB_ADMIN_PASSWORD);
+  return admin ? PROV_ALLOW_ALL : PROV_ALLOW_LOCAL;
+}
+
+// Тело POST /api/config - документ настроек, разбирается по мере приёма
+void handleConfigUpload() {
+  HTTPRaw& raw = server.raw();
+  switch (raw.status) {
+    case RAW_START:
+      provisionBegin("web", configAllowed());
+      configReceived = true;
+      break;
+    case RAW_WRITE:
+      provisionFeed((const char*)raw.buf, raw.currentSize);
+      break;
+    default:
+      break;
+  }
+}
+
+// Итог применения: 200 или 400 с текстом ошибки
+void handleConfigDone() {
+  if (!configReceived) {
+    provisionBegin("web", configAllowed());
+    const String& body = server.arg("plain");
+    provisionFeed(body.c_str(), body.length());
+  }
+  configReceived = false;
+  
+  ProvisionResult r = provisionEnd();
+  char json[128];
+  provisionResultJson(r, json, sizeof(json));
+  server.send(r.ok ? 200 : 400, "application/json", json);
+}
+
+// Сообщаемое состояние (shadow.h)
+void handleGetShadow() {
+  char* buf = (char*)webArena.alloc(SHADOW_DOC_MAX);
+  size_t len = buf ? shadowReportedJson(buf, SHADOW_DOC_MAX) : 0;
+  if (len == 0) {
+    server.send(500, "text/plain", "Out of memory");
+    return;
+  }
+  server.send_P(200, "application/json", buf, len);
+}
+
+// Дельта желаемого состояния: 200, 409 (устаревшая версия) или 400
+void handleSaveShadow() {
+  const String& body = server.arg("plain");
+  ShadowResult r = shadowApplyDesired(body.c_str(), body.length(), "web");
+  char json[128];
+  shadowResultJson(r, json, sizeof(json));
+  server.send(r.ok ? 200 : (r.stale ? 409 : 400), "application/json", json);
+}
+
+// Журнал кормлений и прерванные сбросом кормления (feed_journal.h)
+void handleJournal() {
+  char* buf = (char*)webArena.alloc(JOURNAL_JSON_MAX);
+  size_t len = buf ? journalStatusJson(buf, JOURNAL_JSON_MAX) : 0;
+  if (len == 0) {
+    server.send(500, "text/plain", "Out of memory");
+    return;
+  }
+  server.send_P(200, "application/json", buf, len);
+}
+
+// Принят ли текущий кусок прошивки (между handleOtaUpload и handleOtaDone)
+static bool otaChunkAccepted = false;
+
+// Прошивка по HTTP - только с паролем OTA_PASSWORD (пусто - WEB_ADMIN_PASSWORD,
+// пользователь WEB_ADMIN_USER). Без обоих паролей HTTP OTA выключено
+static bool otaAllowed() {
+  const char* password = strlen(OTA_PASSWORD) > 0 ? OTA_PASSWORD : WEB_ADMIN_PASSWORD;
+  return strlen(password) > 0 && server.authenticate(WEB_ADMIN_USER, password);
+}
+
+// Состояние OTA в JSON (received - смещение для продолжения передачи)
+static void sendOtaStatus(int code) {
+  OtaStatus st = otaUpdateStatus();
+  static const char* const stateNames[] = {"idle", "receiving", "rebooting", "failed"};
+  
+  char json[256];
+  snprintf(json, sizeof(json),
+           "{\"state\":\"%s\",\"received\":%u,\"size\":%u,\"written\":%u,"
+           "\"compressed\":%s,\"validating\":%s,\"error\":\"%s\"}",
+           stateNames[st.state], st.received, st.total, st.written,
+           st.compressed ? "true" : "false", st.validating ? "true" : "false",
+           st.error ? st.error : "");
+  server.send(code, "application/json", json);
+}
+
+// Тело POST /api/ota?offset=N&size=M - кусок образа (application/octet-stream)
+void handleOtaUpload() {
+  HTTPRaw& raw = server.raw();
+  switch (raw.status) {
+    case RAW_START:
+      // Без пароля кусок не трогает сессию: чужой offset=0 её не сбросит
+      if (!otaAllowed()) {
+        LOGW("WEB", "Кусок прошивки без авторизации отклонён");
+        otaChunkAccepted = false;
+        break;
+      }
+      otaChunkAccepted = otaChunkBegin(strtoul(server.arg("offset").c_str(), nullptr, 10),
+                                       strtoul(server.arg("size").c_str(), nullptr, 10));
+      break;
+    case RAW_WRITE:
+      if (otaChunkAccepted) otaChunkAccepted = otaChunkWrite(raw.buf, raw.currentSize);
+      break;
+    case RAW_END:
+      if (otaChunkAccepted) otaChunkAccepted = otaChunkEnd();
+      break;
+    default:
+      // Обрыв: принятые байты уже учтены, клиент продолжит с received
+      otaChunkAccepted = false;
+      break;
+  }
+}
+
+// Ответ на кусок: 401 - нет пароля, 409 - смещение не совпало (продолжать
+// с received), 500 - ошибка
+void handleOtaDone() {
+  if (!otaAllowed()) {
+    otaChunkAccepted = false;
+    server.requestAuthentication();
+    return;
+  }
+  if (otaChunkAccepted) {
+    sendOtaStatus(200);
+  } else {
+    sendOtaStatus(otaUpdateStatus().state == OTA_FAILED ? 500 : 409);
+  }
+  otaChunkAccepted = false;
+}
+
+// Состояние OTA
+void handleOtaStatus() {
+  sendOtaStatus(200);
+}
+
+// Неизвестный адрес
+void handleNotFound() {
+  server.send(404, "text/plain", "Not found");
+}
@@ -0,0 +1,240 @@
+/*
+  wifi_manager.cpp - Управление WiFi подключением
+*/
+
+#include "wifi_manager.h"
+#include "provisioning.h"
+#include "checksum.h"
+#include "logger.h"
+#include "alloc_track.h"
+
+// Точка доступа последнего подключения (переживает мягкую перезагрузку)
+struct WifiRtcCache {
+  uint32_t magic;
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint32_t checksum;
+};
+
+static const uint32_t WIFI_CACHE_MAGIC = 0x57494649;  // "WIFI"
+
+RTC_NOINIT_ATTR static WifiRtcCache rtcCache;
+
+// Состояние
+static WifiLinkState linkState = LINK_DOWN;
+static WifiStats stats = {};
+static bool fastAttempt = false;     // Текущая попытка - по кэшу
+static unsigned long attemptStart = 0;
+static unsigned long attemptTimeout = 0;
+static unsigned long nextAttempt = 0;
+static unsigned long backoff = WIFI_BACKOFF_MIN;
+static unsigned long linkLostAt = 0;
+static bool wasEverUp = false;
+
+// События из задачи WiFi (обрабатываются в wifiLoop)
+static portMUX_TYPE eventMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool evtGotIp = false;
+static volatile bool evtDisconnected = false;
+static volatile uint8_t evtReason = 0;
+static uint8_t evtBssid[6];
+static volatile uint8_t evtChannel = 0;
+
+// Контрольная сумма кэша (FNV-1a, с учётом SSID - смена сети сбрасывает кэш)
+static uint32_t cacheChecksum(const WifiRtcCache& c) {
+  uint32_t h = fnv1a(&c, offsetof(WifiRtcCache, checksum));
+  return fnv1a(provWifiSsid(), strlen(provWifiSsid()), h);
+}
+
+static bool cacheValid() {
+  return rtcCache.magic == WIFI_CACHE_MAGIC &&
+         rtcCache.checksum == cacheChecksum(rtcCache) &&
+         rtcCache.channel > 0;
+}
+
+static void cacheInvalidate() {
+  rtcCache.magic = 0;
+}
+
+// Обработчик событий WiFi (выполняется в задаче WiFi, не в loop)
+static void onWifiEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
+  switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+      portENTER_CRITICAL(&eventMux);
+      memcpy(evtBssid, info.wifi_sta_connected.bssid, 6);
+      evtChannel = info.wifi_sta_connected.channel;
+      portEXIT_CRITICAL(&eventMux);
+      break;
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      evtGotIp = true;
+      break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      evtReason = info.wifi_sta_disconnected.reason;
+      evtDisconnected = true;
+      break;
+    default:
+      break;
+  }
+}
+
+// Начало попытки подключения
+static void startAttempt() {
+  stats.connectAttempts++;
+  attemptStart = millis();
+  linkState = LINK_CONNECTING;
+
+  // Адрес всегда по DHCP: назначенный самим себе IP без аренды может
+  // занять другое устройство
+  WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+  fastAttempt = cacheValid();
+  if (fastAttempt) {
+    // Быстрый путь: известная точка доступа и канал, без сканирования
+    LOGI("WIFI", "Быстрое подключение (канал %d)", rtcCache.channel);
+    WiFi.begin(provWifiSsid(), provWifiPassword(), rtcCache.channel, rtcCache.bssid);
+    attemptTimeout = WIFI_FAST_CONNECT_TIMEOUT;
+  } else {
+    // Полный путь: сканирование
+    LOGI("WIFI", "Подключение к %s...", provWifiSsid());
+    WiFi.begin(provWifiSsid(), provWifiPassword());
+    attemptTimeout = WIFI_CONNECT_TIMEOUT;
+  }
+}
+
+// Неудачная попытка - планируем следующую с увеличением задержки
+static void attemptFailed() {
+  if (fastAttempt) {
+    // Кэш не сработал (точка доступа сменила канал и т.п.) - сразу полный путь
+    cacheInvalidate();
+    WiFi.disconnect();
+    nextAttempt = millis();
+    linkState = LINK_DOWN;
+    return;
+  }
+
+  WiFi.disconnect();
+  linkState = LINK_DOWN;
+  nextAttempt = millis() + backoff;
+  LOGW("WIFI", "Нет подключения, повтор через %lu мс", backoff);
+  backoff = min(backoff * 2, (unsigned long)WIFI_BACKOFF_MAX);
+}
+
+// Линк поднялся
+static void linkUp() {
+  unsigned long now = millis();
+  linkState = LINK_UP;
+  backoff = WIFI_BACKOFF_MIN;
+
+  if (fastAttempt) stats.fastConnects++;
+
+  // Время восстановления: от потери связи (или старта) до получения IP
+  unsigned long since = wasEverUp ? linkLostAt : attemptStart;
+  stats.lastReconnectMs = now - since;
+  if (wasEverUp) stats.totalDowntimeMs += now - linkLostAt;
+  wasEverUp = true;
+
+  // Обновляем кэш для следующего быстрого подключения
+  portENTER_CRITICAL(&eventMux);
+  memcpy(rtcCache.bssid, evtBssid, 6);
+  rtcCache.channel = evtChannel;
+  portEXIT_CRITICAL(&eventMux);
+  rtcCache.magic = WIFI_CACHE_MAGIC;
+  rtcCache.checksum = cacheChecksum(rtcCache);
+
+  // IP и MAC по байтам: toString() и macAddress() выделяют String в куче
+  IPAddress ip = WiFi.localIP();
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  LOGI("WIFI", "Подключен за %u мс, IP: %u.%u.%u.%u, MAC: %02X:%02X:%02X:%02X:%02X:%02X",
+       stats.lastReconnectMs, ip[0], ip[1], ip[2], ip[3],
+       mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
+
+// Линк потерян
+static void linkDown(uint8_t reason) {
+  stats.lastDisconnectReason = reason;
+  if (linkState == LINK_UP) {
+    stats.outages++;
+    linkLostAt = millis();
+    LOGW("WIFI", "Связь потеряна (причина: %d)", reason);
+    // Первая попытка - сразу, по кэшу точки доступа
+    linkState = LINK_DOWN;
+    nextAttempt = millis();
+  } else if (linkState == LINK_CONNECTING) {
+    // Событие от нашего же WiFi.disconnect() может прийти уже после
+    // старта новой попытки - такие игнорируем
+    if (millis() - attemptStart >= WIFI_STALE_EVENT_MS) {
+      attemptFailed();
+    }
+  }
+}
+
+// Запуск подключения
+void wifiSetup() {
+  // Переподключением управляем сами
+  WiFi.persistent(false);
+  WiFi.setAutoReconnect(false);
+  WiFi.onEvent(onWifiEvent);
+  WiFi.mode(WIFI_STA);
+
+  startAttempt();
+}
+
+// Обработка событий и переподключение
+void wifiLoop() {
+  ALLOC_SCOPE(ALLOC_WIFI);
+  bool gotIp, disconnected;
+  uint8_t reason;
+
+  portENTER_CRITICAL(&eventMux);
+  gotIp = evtGotIp;
+  disconnected = evtDisconnected;
+  reason = evtReason;
+  evtGotIp = false;
+  evtDisconnected = false;
+  portEXIT_CRITICAL(&eventMux);
+
+  if (disconnected) linkDown(reason);
+  if (gotIp && WiFi.status() == WL_CONNECTED) linkUp();
+
+  unsigned long now = millis();
+
+  switch (linkState) {
+    case LINK_CONNECTING:
+      if (now - attemptStart >= attemptTimeout) {
+        attemptFailed();
+      }
+      break;
+    case LINK_DOWN:
+      if ((long)(now - nextAttempt) >= 0) {
+        startAttempt();
+      }
+      break;
+    case LINK_UP:
+      break;
+  }
+}
+
+// Сменились SSID или пароль: полное подключение к новой сети
+void wifiReconnect() {
+  cacheInvalidate();
+  if (linkState == LINK_UP) {
+    stats.outages++;
+    linkLostAt = millis();
+  }
+  WiFi.disconnect();
+  linkState = LINK_DOWN;
+  backoff = WIFI_BACKOFF_MIN;
+  nextAttempt = millis();
+  LOGI("WIFI", "Переподключение к %s", provWifiSsid());
+}
+
+WifiLinkState wifiLinkState() {
+  return linkState;
+}
+
+bool wifiLinkUp() {
+  return linkState == LINK_UP;
+}
+
+const WifiStats& wifiGetStats() {
+  return stats;
+}
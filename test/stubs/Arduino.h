@@ -0,0 +1,284 @@
+/*
+  Arduino.h - Заглушка ядра Arduino для тестов на хосте (окружение native)
+
+  Только то, чем пользуется прошивка. String, как в arduino-esp32,
+  хранит короткие строки внутри объекта, а длинные - в куче, чтобы проверка
+  выделений видела те же выделения, что и на устройстве.
+*/
+
+#ifndef ARDUINO_STUB_H
+#define ARDUINO_STUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <algorithm>
+#include <functional>
+
+#include "host.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_attr.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define PROGMEM
+#define F(s) (s)
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+
+using std::min;
+using std::max;
+
+// strlcpy есть в newlib, но не в glibc до 2.38
+#if defined(__GLIBC__) && (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t len = strlen(src);
+  if (size) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+#endif
+
+// ==================== ВРЕМЯ ====================
+inline unsigned long millis() { return (unsigned long)(hostNowUs / 1000); }
+inline unsigned long micros() { return (unsigned long)hostNowUs; }
+inline void delay(uint32_t ms) { hostAdvance(ms); }
+inline void delayMicroseconds(uint32_t us) { hostAdvanceUs(us); }
+inline void yield() {}
+
+// ==================== ПИНЫ ====================
+inline void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin < HOST_PINS && mode == INPUT_PULLUP) hostPinLevel[pin] = HIGH;
+}
+inline void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin < HOST_PINS) hostPinLevel[pin] = val ? HIGH : LOW;
+}
+inline int digitalRead(uint8_t pin) { return pin < HOST_PINS ? hostPinLevel[pin] : LOW; }
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterruptArg(uint8_t pin, void (*fn)(void*), void* arg, int mode) {
+  (void)mode;
+  if (pin < HOST_PINS) hostPinIsr[pin] = {fn, arg};
+}
+inline void detachInterrupt(uint8_t pin) {
+  if (pin < HOST_PINS) hostPinIsr[pin] = {nullptr, nullptr};
+}
+
+typedef int gpio_num_t;
+inline int gpio_get_level(gpio_num_t pin) { return digitalRead(pin); }
+
+// ==================== СИСТЕМА ====================
+inline uint32_t hostCpuMhz = 240;
+inline bool setCpuFrequencyMhz(uint32_t mhz) { hostCpuMhz = mhz; return true; }
+inline uint32_t getCpuFrequencyMhz() { return hostCpuMhz; }
+inline bool psramFound() { return true; }
+
+// ==================== String ====================
+class String {
+public:
+  String(const char* s = "") { copy(s ? s : "", s ? strlen(s) : 0); }
+  String(const String& s) { copy(s.c_str(), s._len); }
+  String(char c) { char b[2] = {c, 0}; copy(b, 1); }
+  String(int v) { char b[12]; copy(b, snprintf(b, sizeof(b), "%d", v)); }
+  String(unsigned v) { char b[12]; copy(b, snprintf(b, sizeof(b), "%u", v)); }
+  String(long v) { char b[24]; copy(b, snprintf(b, sizeof(b), "%ld", v)); }
+  String(unsigned long v) { char b[24]; copy(b, snprintf(b, sizeof(b), "%lu", v)); }
+  ~String() { free(_heap); }
+
+  String& operator=(const String& s) {
+    if (this != &s) copy(s.c_str(), s._len);
+    return *this;
+  }
+  String& operator=(const char* s) { copy(s, strlen(s)); return *this; }
+
+  String& operator+=(const String& s) { return append(s.c_str(), s._len); }
+  String& operator+=(const char* s) { return append(s, strlen(s)); }
+  String& operator+=(char c) { return append(&c, 1); }
+  bool concat(const char* s) { append(s, strlen(s)); return true; }
+
+  bool operator==(const String& s) const { return _len == s._len && strcmp(c_str(), s.c_str()) == 0; }
+  bool operator==(const char* s) const { return strcmp(c_str(), s) == 0; }
+  bool operator!=(const char* s) const { return !(*this == s); }
+  bool equals(const char* s) const { return *this == s; }
+  char operator[](unsigned i) const { return i < _len ? c_str()[i] : 0; }
+
+  const char* c_str() const { return _heap ? _heap : _sso; }
+  unsigned length() const { return _len; }
+  bool isEmpty() const { return _len == 0; }
+  long toInt() const { return strtol(c_str(), nullptr, 10); }
+  float toFloat() const { return strtof(c_str(), nullptr); }
+  bool startsWith(const char* s) const { return strncmp(c_str(), s, strlen(s)) == 0; }
+  int indexOf(char c) const {
+    const char* p = strchr(c_str(), c);
+    return p ? (int)(p - c_str()) : -1;
+  }
+
+  bool reserve(unsigned size) {
+    if (size <= capacity()) return true;
+    char* p = (char*)malloc(size + 1);
+    if (!p) return false;
+    memcpy(p, c_str(), _len + 1);
+    free(_heap);
+    _heap = p;
+    _cap = size;
+    return true;
+  }
+
+private:
+  static const unsigned SSO_SIZE = 11;   // Как в arduino-esp32 (32-битная сборка)
+
+  unsigned capacity() const { return _heap ? _cap : SSO_SIZE; }
+
+  void copy(const char* s, size_t n) {
+    _len = 0;
+    _sso[0] = '\0';
+    if (_heap) _heap[0] = '\0';
+    append(s, n);
+  }
+
+  String& append(const char* s, size_t n) {
+    if (!reserve(_len + n)) return *this;
+    char* dst = _heap ? _heap : _sso;
+    memmove(dst + _len, s, n);
+    _len += n;
+    dst[_len] = '\0';
+    return *this;
+  }
+
+  char _sso[SSO_SIZE + 1] = {0};
+  char* _heap = nullptr;
+  unsigned _cap = 0;
+  unsigned _len = 0;
+};
+
+inline String operator+(const String& a, const char* b) { String s(a); s += b; return s; }
+inline String operator+(const String& a, const String& b) { String s(a); s += b; return s; }
+
+// ==================== Print ====================
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buf++);
+    return n;
+  }
+  size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+  size_t write(const char* buf, size_t size) { return write((const uint8_t*)buf, size); }
+  virtual void flush() {}
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str(), s.length()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return printf("%d", v); }
+  size_t print(unsigned v) { return printf("%u", v); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n < 0) return 0;
+    return write((const uint8_t*)buf, std::min((size_t)n, sizeof(buf) - 1));
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long ms) { _timeout = ms; }
+protected:
+  unsigned long _timeout = 1000;
+};
+
+// Последовательный порт: вывод в stdout только с HOST_SERIAL=1 в окружении
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) { (void)baud; const char* e = getenv("HOST_SERIAL"); _echo = e && *e == '1'; }
+  size_t write(uint8_t c) override { if (_echo) fputc(c, stdout); return 1; }
+  size_t write(const uint8_t* buf, size_t size) override { if (_echo) fwrite(buf, 1, size, stdout); return size; }
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+private:
+  bool _echo = false;
+};
+
+inline HardwareSerial Serial;
+
+// ==================== IPAddress ====================
+class IPAddress {
+public:
+  IPAddress() : _addr(0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    : _addr(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+  IPAddress(uint32_t addr) : _addr(addr) {}
+  operator uint32_t() const { return _addr; }
+  uint8_t operator[](int i) const { return (_addr >> (8 * i)) & 0xFF; }
+  bool operator==(const IPAddress& o) const { return _addr == o._addr; }
+  bool fromString(const char* s) {
+    unsigned a, b, c, d;
+    if (sscanf(s, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255) return false;
+    *this = IPAddress(a, b, c, d);
+    return true;
+  }
+  String toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buf);
+  }
+private:
+  uint32_t _addr;
+};
+
+#define INADDR_NONE IPAddress(0, 0, 0, 0)
+
+// ==================== ESP ====================
+class EspClass {
+public:
+  uint32_t getFreeHeap() { return freeHeap; }
+  uint32_t getMinFreeHeap() { return freeHeap; }
+  uint32_t getMaxAllocHeap() { return freeHeap / 2; }
+  uint64_t getEfuseMac() { return efuseMac; }
+  void restart() { hostRestarts++; }
+
+  uint32_t freeHeap = 160000;
+  uint64_t efuseMac = 0x0000C3B2A1FECA24ull;  // Байты 3..5: a1 b2 c3
+};
+
+inline EspClass ESP;
+
+#endif // ARDUINO_STUB_H
@@ -0,0 +1,31 @@
+/*
+  ArduinoOTA.h - Заглушка espota (тесты на хосте)
+*/
+
+#ifndef ARDUINO_OTA_STUB_H
+#define ARDUINO_OTA_STUB_H
+
+#include <Arduino.h>
+
+typedef enum {
+  OTA_AUTH_ERROR,
+  OTA_BEGIN_ERROR,
+  OTA_CONNECT_ERROR,
+  OTA_RECEIVE_ERROR,
+  OTA_END_ERROR
+} ota_error_t;
+
+class ArduinoOTAClass {
+public:
+  ArduinoOTAClass& setHostname(const char* name) { (void)name; return *this; }
+  ArduinoOTAClass& onStart(std::function<void()> fn) { (void)fn; return *this; }
+  ArduinoOTAClass& onEnd(std::function<void()> fn) { (void)fn; return *this; }
+  ArduinoOTAClass& onProgress(std::function<void(unsigned int, unsigned int)> fn) { (void)fn; return *this; }
+  ArduinoOTAClass& onError(std::function<void(ota_error_t)> fn) { (void)fn; return *this; }
+  void begin() {}
+  void handle() {}
+};
+
+inline ArduinoOTAClass ArduinoOTA;
+
+#endif // ARDUINO_OTA_STUB_H
@@ -0,0 +1,28 @@
+/*
+  ESPmDNS.h - Заглушка mDNS (тесты на хосте)
+*/
+
+#ifndef ESPMDNS_STUB_H
+#define ESPMDNS_STUB_H
+
+#include <Arduino.h>
+
+class MDNSResponder {
+public:
+  bool begin(const char* hostName) { (void)hostName; return true; }
+  bool addService(const char* service, const char* proto, uint16_t port) {
+    (void)service; (void)proto; (void)port;
+    return true;
+  }
+  bool addServiceTxt(const char* service, const char* proto, const char* key, const char* value) {
+    (void)service; (void)proto; (void)key; (void)value;
+    return true;
+  }
+  bool addServiceTxt(const char* service, const char* proto, const char* key, const String& value) {
+    return addServiceTxt(service, proto, key, value.c_str());
+  }
+};
+
+inline MDNSResponder MDNS;
+
+#endif // ESPMDNS_STUB_H
@@ -0,0 +1,71 @@
+/*
+  FS.h - Файлы Arduino поверх хранилища хоста (тесты на хосте)
+
+  На устройстве веб-сервер отдаёт файлы LittleFS через storageFs()
+  (storage.cpp). На хосте тот же интерфейс читает через storage.h из
+  каталога storage_native.cpp.
+*/
+
+#ifndef FS_STUB_H
+#define FS_STUB_H
+
+#include <Arduino.h>
+#include "storage.h"
+
+namespace fs {
+
+class File : public Stream {
+public:
+  File() {}
+  File(const char* path, long size) : _size(size) {
+    strncpy(_path, path, sizeof(_path) - 1);
+  }
+
+  explicit operator bool() const { return _size >= 0; }
+  size_t size() const { return _size < 0 ? 0 : _size; }
+  const char* path() const { return _path; }
+  void close() { _size = -1; }
+
+  size_t read(uint8_t* buf, size_t len) {
+    if (_size < 0) return 0;
+    size_t n = storageRead(_path, _pos, buf, len);
+    _pos += n;
+    return n;
+  }
+  int read() override {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+  }
+  int available() override { return _size < 0 ? 0 : (int)(_size - _pos); }
+  int peek() override {
+    uint8_t b;
+    return _size >= 0 && storageRead(_path, _pos, &b, 1) == 1 ? b : -1;
+  }
+  size_t write(uint8_t c) override { (void)c; return 0; }
+  using Print::write;
+
+private:
+  char _path[64] = "";
+  long _size = -1;
+  size_t _pos = 0;
+};
+
+class FS {
+public:
+  File open(const char* path, const char* mode = "r") {
+    (void)mode;
+    return File(path, storageFileSize(path));
+  }
+  bool exists(const char* path) { return storageExists(path); }
+};
+
+}  // namespace fs
+
+using fs::File;
+
+inline fs::FS& storageFs() {
+  static fs::FS hostFs;
+  return hostFs;
+}
+
+#endif // FS_STUB_H
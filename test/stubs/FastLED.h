@@ -0,0 +1,104 @@
+/*
+  FastLED.h - Заглушка FastLED (тесты на хосте)
+
+  Цвета и смешивание - по формулам FastLED, show() только считается.
+*/
+
+#ifndef FASTLED_STUB_H
+#define FASTLED_STUB_H
+
+#include <Arduino.h>
+
+typedef uint8_t fract8;
+
+enum HSVHue { HUE_RED = 0, HUE_ORANGE = 32, HUE_YELLOW = 64, HUE_GREEN = 96, HUE_AQUA = 128, HUE_BLUE = 160 };
+
+inline uint8_t scale8_video(uint8_t i, uint8_t scale) {
+  return (((int)i * (int)scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+struct CRGB {
+  uint8_t r, g, b;
+
+  enum HTMLColorCode : uint32_t {
+    Black = 0x000000,
+    Blue = 0x0000FF,
+    Green = 0x008000,
+    Purple = 0x800080,
+    Red = 0xFF0000,
+    White = 0xFFFFFF,
+    Yellow = 0xFFFF00,
+  };
+
+  CRGB() : r(0), g(0), b(0) {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(HTMLColorCode code) : r((code >> 16) & 0xFF), g((code >> 8) & 0xFF), b(code & 0xFF) {}
+
+  CRGB& nscale8_video(uint8_t scale) {
+    r = scale8_video(r, scale);
+    g = scale8_video(g, scale);
+    b = scale8_video(b, scale);
+    return *this;
+  }
+
+  bool operator==(const CRGB& o) const { return r == o.r && g == o.g && b == o.b; }
+};
+
+// Радуга по кругу оттенков (упрощённо, как hsv2rgb_spectrum)
+struct CHSV {
+  uint8_t h, s, v;
+  CHSV(uint8_t ih, uint8_t is, uint8_t iv) : h(ih), s(is), v(iv) {}
+  operator CRGB() const {
+    uint8_t region = h / 43;
+    uint8_t rem = (h - region * 43) * 6;
+    uint8_t p = (v * (255 - s)) >> 8;
+    uint8_t q = (v * (255 - ((s * rem) >> 8))) >> 8;
+    uint8_t t = (v * (255 - ((s * (255 - rem)) >> 8))) >> 8;
+    switch (region) {
+      case 0: return CRGB(v, t, p);
+      case 1: return CRGB(q, v, p);
+      case 2: return CRGB(p, v, t);
+      case 3: return CRGB(p, q, v);
+      case 4: return CRGB(t, p, v);
+      default: return CRGB(v, p, q);
+    }
+  }
+};
+
+inline CRGB& nblend(CRGB& existing, const CRGB& overlay, fract8 amount) {
+  if (amount == 0) return existing;
+  if (amount == 255) return existing = overlay;
+  auto mix = [amount](uint8_t a, uint8_t b) {
+    return (uint8_t)((a * (255 - amount) + b * amount + 128) >> 8);
+  };
+  existing = CRGB(mix(existing.r, overlay.r), mix(existing.g, overlay.g), mix(existing.b, overlay.b));
+  return existing;
+}
+
+enum EOrder { RGB, GRB };
+enum ELedChipset { WS2812B };
+
+class CFastLED {
+public:
+  template <ELedChipset CHIP, uint8_t PIN, EOrder ORDER>
+  CFastLED& addLeds(CRGB* leds, int count) {
+    _leds = leds;
+    _count = count;
+    return *this;
+  }
+  void clear(bool write = false) {
+    for (int i = 0; i < _count; i++) _leds[i] = CRGB();
+    if (write) show();
+  }
+  void show() { shows++; }
+
+  uint32_t shows = 0;
+
+private:
+  CRGB* _leds = nullptr;
+  int _count = 0;
+};
+
+inline CFastLED FastLED;
+
+#endif // FASTLED_STUB_H
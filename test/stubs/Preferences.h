@@ -0,0 +1,130 @@
+/*
+  Preferences.h - Заглушка NVS в памяти (тесты на хосте)
+
+  Записи живут в статическом массиве и переживают "перезагрузку" внутри
+  теста, как NVS на устройстве; hostNvsErase() - чистая флеш-память.
+*/
+
+#ifndef PREFERENCES_STUB_H
+#define PREFERENCES_STUB_H
+
+#include <Arduino.h>
+
+#define HOST_NVS_ENTRIES 96
+#define HOST_NVS_VALUE 512
+
+struct HostNvsEntry {
+  bool used;
+  char ns[16];
+  char key[16];
+  size_t len;
+  uint8_t data[HOST_NVS_VALUE];
+};
+
+inline HostNvsEntry hostNvs[HOST_NVS_ENTRIES];
+inline uint32_t hostNvsWrites = 0;
+
+inline void hostNvsErase() {
+  for (HostNvsEntry& e : hostNvs) e.used = false;
+  hostNvsWrites = 0;
+}
+
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false) {
+    strncpy(_ns, name, sizeof(_ns) - 1);
+    _ns[sizeof(_ns) - 1] = '\0';
+    _readOnly = readOnly;
+    _open = true;
+    return true;
+  }
+  void end() { _open = false; }
+
+  bool clear() {
+    if (!writable()) return false;
+    for (HostNvsEntry& e : hostNvs) {
+      if (e.used && strcmp(e.ns, _ns) == 0) e.used = false;
+    }
+    return true;
+  }
+  bool remove(const char* key) {
+    HostNvsEntry* e = find(key);
+    if (!e || !writable()) return false;
+    e->used = false;
+    return true;
+  }
+  bool isKey(const char* key) { return find(key) != nullptr; }
+
+  size_t putBytes(const char* key, const void* value, size_t len) { return put(key, value, len); }
+  size_t getBytes(const char* key, void* buf, size_t maxLen) {
+    HostNvsEntry* e = find(key);
+    if (!e || e->len > maxLen) return 0;
+    memcpy(buf, e->data, e->len);
+    return e->len;
+  }
+  size_t getBytesLength(const char* key) {
+    HostNvsEntry* e = find(key);
+    return e ? e->len : 0;
+  }
+
+  size_t putString(const char* key, const char* value) { return put(key, value, strlen(value) + 1); }
+  size_t getString(const char* key, char* value, size_t maxLen) {
+    HostNvsEntry* e = find(key);
+    if (!e || e->len > maxLen) return 0;
+    memcpy(value, e->data, e->len);
+    return e->len;
+  }
+
+  size_t putBool(const char* key, bool v) { return putValue(key, v); }
+  size_t putUChar(const char* key, uint8_t v) { return putValue(key, v); }
+  size_t putUShort(const char* key, uint16_t v) { return putValue(key, v); }
+  size_t putInt(const char* key, int32_t v) { return putValue(key, v); }
+  size_t putUInt(const char* key, uint32_t v) { return putValue(key, v); }
+  bool getBool(const char* key, bool def = false) { return getValue(key, def); }
+  uint8_t getUChar(const char* key, uint8_t def = 0) { return getValue(key, def); }
+  uint16_t getUShort(const char* key, uint16_t def = 0) { return getValue(key, def); }
+  int32_t getInt(const char* key, int32_t def = 0) { return getValue(key, def); }
+  uint32_t getUInt(const char* key, uint32_t def = 0) { return getValue(key, def); }
+
+private:
+  bool writable() const { return _open && !_readOnly; }
+
+  HostNvsEntry* find(const char* key) {
+    if (!_open) return nullptr;
+    for (HostNvsEntry& e : hostNvs) {
+      if (e.used && strcmp(e.ns, _ns) == 0 && strcmp(e.key, key) == 0) return &e;
+    }
+    return nullptr;
+  }
+
+  size_t put(const char* key, const void* value, size_t len) {
+    if (!writable() || len > HOST_NVS_VALUE || strlen(key) >= sizeof(HostNvsEntry::key)) return 0;
+    HostNvsEntry* e = find(key);
+    for (size_t i = 0; !e && i < HOST_NVS_ENTRIES; i++) {
+      if (!hostNvs[i].used) e = &hostNvs[i];
+    }
+    if (!e) return 0;
+    e->used = true;
+    strcpy(e->ns, _ns);
+    strcpy(e->key, key);
+    e->len = len;
+    memcpy(e->data, value, len);
+    hostNvsWrites++;
+    return len;
+  }
+
+  template <typename T> size_t putValue(const char* key, T v) { return put(key, &v, sizeof(v)); }
+  template <typename T> T getValue(const char* key, T def) {
+    HostNvsEntry* e = find(key);
+    if (!e || e->len != sizeof(T)) return def;
+    T v;
+    memcpy(&v, e->data, sizeof(v));
+    return v;
+  }
+
+  char _ns[16] = "";
+  bool _readOnly = false;
+  bool _open = false;
+};
+
+#endif // PREFERENCES_STUB_H
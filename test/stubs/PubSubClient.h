@@ -0,0 +1,204 @@
+/*
+  PubSubClient.h - Заглушка MQTT клиента с брокером в памяти (тесты на хосте)
+
+  hostBroker записывает публикации и подписки каждого Client ID и доставляет
+  сообщения по подпискам (с шаблонами + и #), как настоящий брокер.
+  Несколько устройств в одном тесте - это переподключения с разными
+  Client ID: подписки прежних клиентов остаются у брокера.
+  Хранилище статическое: клиент не выделяет память в куче.
+*/
+
+#ifndef PUBSUBCLIENT_STUB_H
+#define PUBSUBCLIENT_STUB_H
+
+#include <Arduino.h>
+#include <Client.h>
+
+#define MQTT_CALLBACK_SIGNATURE void (*callback)(char*, uint8_t*, unsigned int)
+
+#define MQTT_CONNECTED 0
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+
+#define HOST_MQTT_ID 40
+#define HOST_MQTT_TOPIC 128
+#define HOST_MQTT_PAYLOAD 1024
+#define HOST_MQTT_MESSAGES 256
+#define HOST_MQTT_SUBS 1024
+
+struct HostMqttMessage {
+  char client[HOST_MQTT_ID];
+  char topic[HOST_MQTT_TOPIC];
+  uint8_t payload[HOST_MQTT_PAYLOAD];
+  size_t len;
+  bool retained;
+};
+
+struct HostMqttSub {
+  char client[HOST_MQTT_ID];
+  char filter[HOST_MQTT_TOPIC];
+  uint8_t qos;
+};
+
+// Совпадение топика с фильтром подписки (+ - один уровень, # - остаток)
+inline bool hostTopicMatch(const char* filter, const char* topic) {
+  while (*filter) {
+    if (*filter == '#') return true;
+    if (*filter == '+') {
+      while (*topic && *topic != '/') topic++;
+      filter++;
+      continue;
+    }
+    if (*filter != *topic) return false;
+    filter++;
+    topic++;
+  }
+  return *topic == '\0';
+}
+
+struct HostBroker {
+  HostMqttMessage messages[HOST_MQTT_MESSAGES];
+  size_t messageCount = 0;
+  uint32_t dropped = 0;             // Не поместились в журнал
+  HostMqttSub subs[HOST_MQTT_SUBS];
+  size_t subCount = 0;
+  bool accept = true;               // Брокер принимает подключения
+
+  void reset() {
+    messageCount = 0;
+    dropped = 0;
+    subCount = 0;
+    accept = true;
+  }
+
+  void record(const char* client, const char* topic, const uint8_t* payload, size_t len, bool retained) {
+    if (messageCount == HOST_MQTT_MESSAGES) {
+      dropped++;
+      return;
+    }
+    HostMqttMessage& m = messages[messageCount++];
+    strncpy(m.client, client, sizeof(m.client) - 1);
+    m.client[sizeof(m.client) - 1] = '\0';
+    strncpy(m.topic, topic, sizeof(m.topic) - 1);
+    m.topic[sizeof(m.topic) - 1] = '\0';
+    m.len = len < sizeof(m.payload) ? len : sizeof(m.payload);
+    memcpy(m.payload, payload, m.len);
+    m.retained = retained;
+  }
+
+  void subscribe(const char* client, const char* filter, uint8_t qos) {
+    for (size_t i = 0; i < subCount; i++) {
+      if (strcmp(subs[i].client, client) == 0 && strcmp(subs[i].filter, filter) == 0) return;
+    }
+    if (subCount == HOST_MQTT_SUBS) return;
+    HostMqttSub& s = subs[subCount++];
+    strncpy(s.client, client, sizeof(s.client) - 1);
+    s.client[sizeof(s.client) - 1] = '\0';
+    strncpy(s.filter, filter, sizeof(s.filter) - 1);
+    s.filter[sizeof(s.filter) - 1] = '\0';
+    s.qos = qos;
+  }
+
+  bool subscribed(const char* client, const char* topic) const {
+    for (size_t i = 0; i < subCount; i++) {
+      if (strcmp(subs[i].client, client) == 0 && hostTopicMatch(subs[i].filter, topic)) return true;
+    }
+    return false;
+  }
+
+  // Последнее сообщение в топик (nullptr - не было)
+  const HostMqttMessage* last(const char* topic) const {
+    for (size_t i = messageCount; i-- > 0;) {
+      if (strcmp(messages[i].topic, topic) == 0) return &messages[i];
+    }
+    return nullptr;
+  }
+
+  size_t count(const char* topic) const {
+    size_t n = 0;
+    for (size_t i = 0; i < messageCount; i++) {
+      if (strcmp(messages[i].topic, topic) == 0) n++;
+    }
+    return n;
+  }
+};
+
+inline HostBroker hostBroker;
+
+class PubSubClient {
+public:
+  explicit PubSubClient(Client& client) : _client(&client) {}
+
+  PubSubClient& setServer(const char* host, uint16_t port) { _host = host; _port = port; return *this; }
+  PubSubClient& setServer(IPAddress ip, uint16_t port) { (void)ip; _host = nullptr; _port = port; return *this; }
+  PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE) { _callback = callback; return *this; }
+  bool setBufferSize(uint16_t size) { _bufferSize = size; return true; }
+  uint16_t getBufferSize() { return _bufferSize; }
+
+  bool connect(const char* id, const char* user, const char* pass, const char* willTopic,
+               uint8_t willQos, bool willRetain, const char* willMessage, bool cleanSession = true) {
+    (void)user; (void)pass; (void)willTopic; (void)willQos; (void)willRetain; (void)willMessage;
+    (void)cleanSession;
+    connects++;
+    if (!hostBroker.accept) {
+      _state = MQTT_CONNECT_FAILED;
+      return false;
+    }
+    strncpy(_id, id, sizeof(_id) - 1);
+    _id[sizeof(_id) - 1] = '\0';
+    _state = MQTT_CONNECTED;
+    return true;
+  }
+  bool connect(const char* id) { return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr); }
+
+  void disconnect() { _state = MQTT_DISCONNECTED; }
+  bool connected() { return _state == MQTT_CONNECTED; }
+  int state() { return _state; }
+  bool loop() { return connected(); }
+
+  bool publish(const char* topic, const char* payload, bool retained = false) {
+    return publish(topic, (const uint8_t*)payload, strlen(payload), retained);
+  }
+  bool publish(const char* topic, const uint8_t* payload, unsigned int len, bool retained = false) {
+    if (!connected() || strlen(topic) + len + 7 > _bufferSize) return false;
+    hostBroker.record(_id, topic, payload, len, retained);
+    return true;
+  }
+
+  bool subscribe(const char* topic, uint8_t qos = 0) {
+    if (!connected()) return false;
+    hostBroker.subscribe(_id, topic, qos);
+    return true;
+  }
+
+  // Сообщение от брокера этому клиенту (если он подписан на топик)
+  bool hostDeliver(const char* topic, const void* payload, size_t len) {
+    if (!connected() || !_callback || !hostBroker.subscribed(_id, topic)) return false;
+    char t[HOST_MQTT_TOPIC];
+    strncpy(t, topic, sizeof(t) - 1);
+    t[sizeof(t) - 1] = '\0';
+    uint8_t buf[HOST_MQTT_PAYLOAD];
+    if (len > sizeof(buf)) return false;
+    memcpy(buf, payload, len);
+    _callback(t, buf, len);
+    return true;
+  }
+  bool hostDeliver(const char* topic, const char* payload) { return hostDeliver(topic, payload, strlen(payload)); }
+
+  // Брокер закрыл соединение
+  void hostDrop() { _state = MQTT_DISCONNECTED; }
+
+  const char* clientId() const { return _id; }
+  uint32_t connects = 0;
+
+private:
+  Client* _client;
+  const char* _host = nullptr;
+  uint16_t _port = 0;
+  void (*_callback)(char*, uint8_t*, unsigned int) = nullptr;
+  uint16_t _bufferSize = 256;
+  char _id[HOST_MQTT_ID] = "";
+  int _state = MQTT_DISCONNECTED;
+};
+
+#endif // PUBSUBCLIENT_STUB_H
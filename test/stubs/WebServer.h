@@ -0,0 +1,242 @@
+/*
+  WebServer.h - Заглушка HTTP сервера (тесты на хосте)
+
+  Маршруты регистрируются как в библиотеке. Тест ставит запрос в очередь
+  (hostRequest), handleClient() обслуживает его, ответ сохраняется
+  в hostResponse. Аргументы, тело и ответ - в статических буферах:
+  выделения в куче, которые видит проверка, - только из обработчиков
+  прошивки (и из arg(), как у библиотеки: String по значению).
+*/
+
+#ifndef WEBSERVER_STUB_H
+#define WEBSERVER_STUB_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <WiFi.h>
+
+typedef enum { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS } HTTPMethod;
+typedef enum { RAW_START, RAW_WRITE, RAW_END, RAW_ABORTED } HTTPRawStatus;
+typedef enum { BASIC_AUTH, DIGEST_AUTH } HTTPAuthMethod;
+
+#define HTTP_RAW_BUFLEN 1436
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+struct HTTPRaw {
+  HTTPRawStatus status;
+  size_t totalSize;
+  size_t currentSize;
+  uint8_t buf[HTTP_RAW_BUFLEN];
+};
+
+#define HOST_WEB_ROUTES 32
+#define HOST_WEB_ARGS 8
+#define HOST_WEB_BODY 4096
+#define HOST_WEB_RESPONSE 16384
+
+struct HostWebResponse {
+  int code;
+  char type[64];
+  char body[HOST_WEB_RESPONSE];
+  size_t len;
+  bool truncated;
+};
+
+inline HostWebResponse hostResponse;
+
+// Сокет ответа: байты после заголовков (например, JPEG снимка)
+class HostWebClient : public WiFiClient {
+public:
+  size_t write(const uint8_t* buf, size_t size) override;
+  size_t write(uint8_t b) override { return write(&b, 1); }
+};
+
+inline void hostResponseAppend(const char* data, size_t len) {
+  size_t room = sizeof(hostResponse.body) - 1 - hostResponse.len;
+  if (len > room) {
+    len = room;
+    hostResponse.truncated = true;
+  }
+  memcpy(hostResponse.body + hostResponse.len, data, len);
+  hostResponse.len += len;
+  hostResponse.body[hostResponse.len] = '\0';
+}
+
+inline size_t HostWebClient::write(const uint8_t* buf, size_t size) {
+  hostResponseAppend((const char*)buf, size);
+  return size;
+}
+
+class WebServer {
+public:
+  typedef std::function<void()> THandlerFunction;
+
+  explicit WebServer(int port = 80) : _port(port) {}
+
+  void begin() { _started = true; }
+  void onNotFound(THandlerFunction fn) { _notFound = fn; }
+  void on(const char* uri, THandlerFunction fn) { on(uri, HTTP_ANY, fn); }
+  void on(const char* uri, HTTPMethod method, THandlerFunction fn) { on(uri, method, fn, nullptr); }
+  void on(const char* uri, HTTPMethod method, THandlerFunction fn, THandlerFunction upload) {
+    if (_routeCount == HOST_WEB_ROUTES) return;
+    _routes[_routeCount++] = {uri, method, fn, upload};
+  }
+
+  // Запрос в очередь: args - "имя=значение&...", body - тело POST
+  bool hostRequest(HTTPMethod method, const char* uri, const char* args = "", const char* body = nullptr,
+                   const char* user = nullptr, const char* pass = nullptr) {
+    if (_pending) return false;
+    _pending = true;
+    _method = method;
+    strncpy(_uri, uri, sizeof(_uri) - 1);
+    _uri[sizeof(_uri) - 1] = '\0';
+    _argCount = 0;
+    parseArgs(args);
+    _bodyLen = body ? std::min(strlen(body), sizeof(_body) - 1) : 0;
+    if (body) memcpy(_body, body, _bodyLen);
+    _body[_bodyLen] = '\0';
+    _hasBody = body != nullptr;
+    _user = user;
+    _pass = pass;
+    return true;
+  }
+  bool hostPending() const { return _pending; }
+
+  void handleClient() {
+    if (!_started || !_pending) return;
+    _pending = false;
+    hostResponse.code = 0;
+    hostResponse.type[0] = '\0';
+    hostResponse.len = 0;
+    hostResponse.body[0] = '\0';
+    hostResponse.truncated = false;
+    _contentLength = CONTENT_LENGTH_NOT_SET;
+
+    for (size_t i = 0; i < _routeCount; i++) {
+      Route& r = _routes[i];
+      if (strcmp(r.uri, _uri) != 0 || (r.method != HTTP_ANY && r.method != _method)) continue;
+      if (r.upload && _hasBody) {
+        // Тело по кускам, как приходит из сокета
+        _raw.totalSize = _bodyLen;
+        _raw.status = RAW_START;
+        _raw.currentSize = 0;
+        r.upload();
+        for (size_t pos = 0; pos < _bodyLen; pos += HTTP_RAW_BUFLEN) {
+          _raw.status = RAW_WRITE;
+          _raw.currentSize = std::min((size_t)HTTP_RAW_BUFLEN, _bodyLen - pos);
+          memcpy(_raw.buf, _body + pos, _raw.currentSize);
+          r.upload();
+        }
+        _raw.status = RAW_END;
+        _raw.currentSize = 0;
+        r.upload();
+      }
+      r.fn();
+      return;
+    }
+    if (_notFound) {
+      _notFound();
+    } else {
+      send(404, "text/plain", "Not found");
+    }
+  }
+
+  bool hasArg(const char* name) const { return findArg(name) != nullptr || (strcmp(name, "plain") == 0 && _hasBody); }
+  String arg(const char* name) const {
+    if (strcmp(name, "plain") == 0 && _hasBody) return String(_body);
+    const char* v = findArg(name);
+    return String(v ? v : "");
+  }
+  HTTPRaw& raw() { return _raw; }
+  HostWebClient& client() { return _client; }
+  HTTPMethod method() const { return _method; }
+
+  bool authenticate(const char* user, const char* pass) {
+    return _user && _pass && strcmp(_user, user) == 0 && strcmp(_pass, pass) == 0;
+  }
+  void requestAuthentication(HTTPAuthMethod mode = BASIC_AUTH, const char* realm = nullptr,
+                             const char* failMsg = "") {
+    (void)mode; (void)realm;
+    send(401, "text/html", failMsg);
+  }
+
+  void setContentLength(size_t len) { _contentLength = len; }
+  void sendHeader(const char* name, const char* value, bool first = false) { (void)name; (void)value; (void)first; }
+  void send(int code, const char* type, const char* content) { send_P(code, type, content, strlen(content)); }
+  void send(int code, const char* type, const String& content) { send_P(code, type, content.c_str(), content.length()); }
+  void send_P(int code, const char* type, const char* content) { send_P(code, type, content, strlen(content)); }
+  void send_P(int code, const char* type, const char* content, size_t len) {
+    hostResponse.code = code;
+    strncpy(hostResponse.type, type, sizeof(hostResponse.type) - 1);
+    hostResponse.type[sizeof(hostResponse.type) - 1] = '\0';
+    hostResponseAppend(content, len);
+  }
+  void sendContent(const char* content, size_t len) { hostResponseAppend(content, len); }
+  void sendContent(const char* content) { sendContent(content, strlen(content)); }
+
+  template <typename T>
+  size_t streamFile(T& file, const char* type, int code = 200) {
+    send(code, type, "");
+    uint8_t buf[512];
+    size_t total = 0, n;
+    while ((n = file.read(buf, sizeof(buf))) > 0) {
+      hostResponseAppend((const char*)buf, n);
+      total += n;
+    }
+    return total;
+  }
+
+private:
+  struct Route {
+    const char* uri;
+    HTTPMethod method;
+    THandlerFunction fn;
+    THandlerFunction upload;
+  };
+
+  void parseArgs(const char* args) {
+    while (args && *args && _argCount < HOST_WEB_ARGS) {
+      const char* end = strchr(args, '&');
+      size_t len = end ? (size_t)(end - args) : strlen(args);
+      const char* eq = (const char*)memchr(args, '=', len);
+      char* name = _args[_argCount][0];
+      char* value = _args[_argCount][1];
+      size_t nameLen = eq ? (size_t)(eq - args) : len;
+      size_t valueLen = eq ? len - nameLen - 1 : 0;
+      snprintf(name, sizeof(_args[0][0]), "%.*s", (int)nameLen, args);
+      snprintf(value, sizeof(_args[0][1]), "%.*s", (int)valueLen, eq ? eq + 1 : "");
+      _argCount++;
+      args = end ? end + 1 : nullptr;
+    }
+  }
+
+  const char* findArg(const char* name) const {
+    for (size_t i = 0; i < _argCount; i++) {
+      if (strcmp(_args[i][0], name) == 0) return _args[i][1];
+    }
+    return nullptr;
+  }
+
+  int _port;
+  bool _started = false;
+  Route _routes[HOST_WEB_ROUTES];
+  size_t _routeCount = 0;
+  THandlerFunction _notFound;
+
+  bool _pending = false;
+  HTTPMethod _method = HTTP_GET;
+  char _uri[64] = "";
+  char _args[HOST_WEB_ARGS][2][64];
+  size_t _argCount = 0;
+  char _body[HOST_WEB_BODY];
+  size_t _bodyLen = 0;
+  bool _hasBody = false;
+  const char* _user = nullptr;
+  const char* _pass = nullptr;
+  HTTPRaw _raw;
+  HostWebClient _client;
+  size_t _contentLength = CONTENT_LENGTH_NOT_SET;
+};
+
+#endif // WEBSERVER_STUB_H
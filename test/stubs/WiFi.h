@@ -0,0 +1,167 @@
+/*
+  WiFi.h - Заглушка WiFi (тесты на хосте)
+
+  Точка доступа управляется тестом: hostConnect() и hostDrop() присылают
+  те же события, что драйвер на устройстве. С autoConnect подключение
+  удаётся сразу при WiFi.begin().
+*/
+
+#ifndef WIFI_STUB_H
+#define WIFI_STUB_H
+
+#include <Arduino.h>
+#include <Client.h>
+
+typedef enum {
+  ARDUINO_EVENT_WIFI_STA_START,
+  ARDUINO_EVENT_WIFI_STA_CONNECTED,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP,
+  ARDUINO_EVENT_WIFI_STA_LOST_IP,
+} arduino_event_id_t;
+
+typedef union {
+  struct {
+    uint8_t ssid[33];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t authmode;
+  } wifi_sta_connected;
+  struct {
+    uint8_t ssid[33];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t reason;
+  } wifi_sta_disconnected;
+} arduino_event_info_t;
+
+typedef arduino_event_id_t WiFiEvent_t;
+typedef arduino_event_info_t WiFiEventInfo_t;
+typedef void (*WiFiEventSysCb)(WiFiEvent_t event, WiFiEventInfo_t info);
+
+typedef enum { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+typedef enum { WL_IDLE_STATUS = 0, WL_CONNECTED = 3, WL_CONNECT_FAILED = 4, WL_DISCONNECTED = 6 } wl_status_t;
+
+class WiFiClass {
+public:
+  void persistent(bool on) { (void)on; }
+  bool setAutoReconnect(bool on) { (void)on; return true; }
+  bool mode(wifi_mode_t m) { (void)m; return true; }
+  void onEvent(WiFiEventSysCb cb) {
+    for (WiFiEventSysCb& slot : _handlers) {
+      if (!slot) { slot = cb; break; }
+    }
+  }
+
+  bool config(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns = INADDR_NONE) {
+    _staticIp = ip;
+    if ((uint32_t)ip) {
+      _gateway = gateway;
+      _subnet = subnet;
+      _dns = dns;
+    }
+    return true;
+  }
+
+  wl_status_t begin(const char* ssid, const char* pass = nullptr, int32_t channel = 0,
+                    const uint8_t* bssid = nullptr) {
+    (void)pass;
+    strncpy(lastSsid, ssid, sizeof(lastSsid) - 1);
+    lastChannel = channel;
+    lastFast = bssid != nullptr;
+    begins++;
+    if (autoConnect) hostConnect();
+    return _status;
+  }
+
+  bool disconnect(bool wifiOff = false, bool eraseAp = false) {
+    (void)wifiOff; (void)eraseAp;
+    if (_status == WL_CONNECTED) hostDrop(8);
+    return true;
+  }
+
+  wl_status_t status() { return _status; }
+  IPAddress localIP() { return _status == WL_CONNECTED ? (_staticIp ? _staticIp : dhcpIp) : IPAddress(); }
+  IPAddress gatewayIP() { return _gateway; }
+  IPAddress subnetMask() { return _subnet; }
+  IPAddress dnsIP() { return _dns; }
+  int8_t RSSI() { return _status == WL_CONNECTED ? rssi : 0; }
+  uint8_t* macAddress(uint8_t* mac) { memcpy(mac, _mac, 6); return mac; }
+  String macAddress() {
+    char buf[18];
+    snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X",
+             _mac[0], _mac[1], _mac[2], _mac[3], _mac[4], _mac[5]);
+    return String(buf);
+  }
+  int hostByName(const char* host, IPAddress& ip) {
+    if (ip.fromString(host)) return 1;
+    ip = brokerIp;
+    return _status == WL_CONNECTED;
+  }
+
+  // Точка доступа приняла подключение и выдала адрес
+  void hostConnect() {
+    _status = WL_CONNECTED;
+    WiFiEventInfo_t info = {};
+    memcpy(info.wifi_sta_connected.bssid, apBssid, 6);
+    info.wifi_sta_connected.channel = apChannel;
+    emit(ARDUINO_EVENT_WIFI_STA_CONNECTED, info);
+    emit(ARDUINO_EVENT_WIFI_STA_GOT_IP, {});
+  }
+
+  // Связь оборвалась
+  void hostDrop(uint8_t reason) {
+    _status = WL_DISCONNECTED;
+    WiFiEventInfo_t info = {};
+    info.wifi_sta_disconnected.reason = reason;
+    emit(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, info);
+  }
+
+  bool autoConnect = true;
+  char lastSsid[33] = "";
+  int32_t lastChannel = 0;
+  bool lastFast = false;
+  uint32_t begins = 0;
+  int8_t rssi = -55;
+  IPAddress dhcpIp = IPAddress(192, 168, 1, 50);
+  IPAddress brokerIp = IPAddress(192, 168, 1, 2);
+  uint8_t apBssid[6] = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60};
+  uint8_t apChannel = 6;
+
+private:
+  void emit(WiFiEvent_t event, WiFiEventInfo_t info) {
+    for (WiFiEventSysCb cb : _handlers) {
+      if (cb) cb(event, info);
+    }
+  }
+
+  WiFiEventSysCb _handlers[4] = {};
+  wl_status_t _status = WL_DISCONNECTED;
+  IPAddress _staticIp;
+  IPAddress _gateway = IPAddress(192, 168, 1, 1);
+  IPAddress _subnet = IPAddress(255, 255, 255, 0);
+  IPAddress _dns = IPAddress(192, 168, 1, 1);
+  uint8_t _mac[6] = {0x24, 0xCA, 0xFE, 0xA1, 0xB2, 0xC3};
+};
+
+inline WiFiClass WiFi;
+
+// TCP клиент для PubSubClient: соединения нет, брокер - заглушка PubSubClient
+class WiFiClient : public Client {
+public:
+  int connect(IPAddress ip, uint16_t port) override { (void)ip; (void)port; return 1; }
+  int connect(const char* host, uint16_t port) override { (void)host; (void)port; return 1; }
+  size_t write(uint8_t b) override { (void)b; return 1; }
+  size_t write(const uint8_t* buf, size_t size) override { (void)buf; return size; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int read(uint8_t* buf, size_t size) override { (void)buf; (void)size; return -1; }
+  int peek() override { return -1; }
+  void flush() override {}
+  void stop() override {}
+  uint8_t connected() override { return 0; }
+  operator bool() override { return true; }
+};
+
+#endif // WIFI_STUB_H
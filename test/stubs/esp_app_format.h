@@ -0,0 +1,10 @@
+/*
+  esp_app_format.h - Формат образа приложения (тесты на хосте)
+*/
+
+#ifndef ESP_APP_FORMAT_STUB_H
+#define ESP_APP_FORMAT_STUB_H
+
+#define ESP_IMAGE_HEADER_MAGIC 0xE9
+
+#endif // ESP_APP_FORMAT_STUB_H
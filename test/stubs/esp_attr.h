@@ -0,0 +1,21 @@
+/*
+  esp_attr.h - Атрибуты размещения ESP-IDF (тесты на хосте)
+
+  RTC_NOINIT_ATTR собирает переменные в одну секцию, чтобы тест мог
+  подменить её содержимое, как после сброса или отключения питания
+  (__start_rtcnoinit .. __stop_rtcnoinit, только ELF).
+*/
+
+#ifndef ESP_ATTR_STUB_H
+#define ESP_ATTR_STUB_H
+
+#ifdef __APPLE__
+  #define RTC_NOINIT_ATTR
+#else
+  #define RTC_NOINIT_ATTR __attribute__((section("rtcnoinit")))
+#endif
+#define RTC_DATA_ATTR
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif // ESP_ATTR_STUB_H
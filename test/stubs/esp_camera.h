@@ -0,0 +1,60 @@
+/*
+  esp_camera.h - Заглушка драйвера камеры (тесты на хосте)
+
+  Сенсора нет: esp_camera_init() возвращает ошибку, и прошивка работает
+  без камеры, как плата с неподключённым шлейфом. Кадры для тестов
+  конвейера - FileFrameSource (file_frame_source.h).
+*/
+
+#ifndef ESP_CAMERA_STUB_H
+#define ESP_CAMERA_STUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum { PIXFORMAT_RGB565, PIXFORMAT_YUV422, PIXFORMAT_GRAYSCALE, PIXFORMAT_JPEG } pixformat_t;
+typedef enum {
+  FRAMESIZE_96X96, FRAMESIZE_QQVGA, FRAMESIZE_QCIF, FRAMESIZE_HQVGA, FRAMESIZE_240X240,
+  FRAMESIZE_QVGA, FRAMESIZE_CIF, FRAMESIZE_HVGA, FRAMESIZE_VGA, FRAMESIZE_SVGA
+} framesize_t;
+typedef enum { LEDC_TIMER_0 } ledc_timer_t;
+typedef enum { LEDC_CHANNEL_0 } ledc_channel_t;
+typedef enum { CAMERA_FB_IN_PSRAM, CAMERA_FB_IN_DRAM } camera_fb_location_t;
+typedef enum { CAMERA_GRAB_WHEN_EMPTY, CAMERA_GRAB_LATEST } camera_grab_mode_t;
+
+typedef struct {
+  int pin_pwdn, pin_reset, pin_xclk, pin_sscb_sda, pin_sscb_scl;
+  int pin_d7, pin_d6, pin_d5, pin_d4, pin_d3, pin_d2, pin_d1, pin_d0;
+  int pin_vsync, pin_href, pin_pclk;
+  int xclk_freq_hz;
+  ledc_timer_t ledc_timer;
+  ledc_channel_t ledc_channel;
+  pixformat_t pixel_format;
+  framesize_t frame_size;
+  int jpeg_quality;
+  size_t fb_count;
+  camera_fb_location_t fb_location;
+  camera_grab_mode_t grab_mode;
+} camera_config_t;
+
+typedef struct {
+  uint8_t* buf;
+  size_t len;
+  size_t width;
+  size_t height;
+  pixformat_t format;
+} camera_fb_t;
+
+typedef struct _sensor sensor_t;
+struct _sensor {
+  int (*set_framesize)(sensor_t* sensor, framesize_t framesize);
+  int (*set_reg)(sensor_t* sensor, int reg, int mask, int value);
+};
+
+inline esp_err_t esp_camera_init(const camera_config_t* config) { (void)config; return ESP_FAIL; }
+inline sensor_t* esp_camera_sensor_get() { return nullptr; }
+inline camera_fb_t* esp_camera_fb_get() { return nullptr; }
+inline void esp_camera_fb_return(camera_fb_t* fb) { (void)fb; }
+
+#endif // ESP_CAMERA_STUB_H
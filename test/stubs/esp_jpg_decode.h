@@ -0,0 +1,25 @@
+/*
+  esp_jpg_decode.h - Заглушка декодера JPEG (тесты на хосте)
+
+  Декодера на хосте нет: кадр не декодируется. Детектор проверяется
+  на готовых серых кадрах (presence_detect.h).
+*/
+
+#ifndef ESP_JPG_DECODE_STUB_H
+#define ESP_JPG_DECODE_STUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum { JPG_SCALE_NONE, JPG_SCALE_2X, JPG_SCALE_4X, JPG_SCALE_8X } jpg_scale_t;
+typedef size_t (*jpg_reader_cb)(void* arg, size_t index, uint8_t* buf, size_t len);
+typedef bool (*jpg_writer_cb)(void* arg, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t* data);
+
+inline esp_err_t esp_jpg_decode(size_t len, jpg_scale_t scale, jpg_reader_cb reader,
+                                jpg_writer_cb writer, void* arg) {
+  (void)len; (void)scale; (void)reader; (void)writer; (void)arg;
+  return ESP_FAIL;
+}
+
+#endif // ESP_JPG_DECODE_STUB_H
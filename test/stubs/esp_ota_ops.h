@@ -0,0 +1,68 @@
+/*
+  esp_ota_ops.h - Заглушка разделов и записи OTA (тесты на хосте)
+
+  Два раздела приложения; запись образа только считает байты.
+*/
+
+#ifndef ESP_OTA_OPS_STUB_H
+#define ESP_OTA_OPS_STUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "esp_err.h"
+
+typedef enum { ESP_PARTITION_TYPE_APP, ESP_PARTITION_TYPE_DATA } esp_partition_type_t;
+typedef enum { ESP_PARTITION_SUBTYPE_ANY = 0xff } esp_partition_subtype_t;
+
+typedef struct {
+  esp_partition_type_t type;
+  uint32_t address;
+  uint32_t size;
+  char label[17];
+} esp_partition_t;
+
+typedef uint32_t esp_ota_handle_t;
+
+#define OTA_SIZE_UNKNOWN 0xffffffff
+#define OTA_WITH_SEQUENTIAL_WRITES 0xfffffffe
+
+inline const esp_partition_t hostAppPartitions[2] = {
+  {ESP_PARTITION_TYPE_APP, 0x10000, 0x180000, "app0"},
+  {ESP_PARTITION_TYPE_APP, 0x190000, 0x180000, "app1"},
+};
+inline const esp_partition_t* hostRunning = &hostAppPartitions[0];
+inline const esp_partition_t* hostBoot = &hostAppPartitions[0];
+inline size_t hostOtaWritten = 0;
+
+inline const esp_partition_t* esp_ota_get_running_partition() { return hostRunning; }
+inline const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start) {
+  (void)start;
+  return hostRunning == &hostAppPartitions[0] ? &hostAppPartitions[1] : &hostAppPartitions[0];
+}
+inline const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t sub,
+                                                       const char* label) {
+  (void)sub;
+  if (type != ESP_PARTITION_TYPE_APP || !label) return nullptr;
+  for (const esp_partition_t& p : hostAppPartitions) {
+    if (strcmp(p.label, label) == 0) return &p;
+  }
+  return nullptr;
+}
+inline esp_err_t esp_ota_begin(const esp_partition_t* p, size_t size, esp_ota_handle_t* handle) {
+  (void)p; (void)size;
+  hostOtaWritten = 0;
+  *handle = 1;
+  return ESP_OK;
+}
+inline esp_err_t esp_ota_write(esp_ota_handle_t handle, const void* data, size_t len) {
+  (void)handle; (void)data;
+  hostOtaWritten += len;
+  return ESP_OK;
+}
+inline esp_err_t esp_ota_end(esp_ota_handle_t handle) { (void)handle; return ESP_OK; }
+inline esp_err_t esp_ota_abort(esp_ota_handle_t handle) { (void)handle; return ESP_OK; }
+inline esp_err_t esp_ota_set_boot_partition(const esp_partition_t* p) { hostBoot = p; return ESP_OK; }
+inline esp_err_t esp_ota_mark_app_valid_cancel_rollback() { return ESP_OK; }
+
+#endif // ESP_OTA_OPS_STUB_H
@@ -0,0 +1,54 @@
+/*
+  esp_sntp.h - Заглушка SNTP (тесты на хосте)
+
+  Системные часы прошивки - виртуальные: gettimeofday и settimeofday
+  в коде прошивки не трогают часы хоста. hostNtpSync() - ответ сервера NTP.
+*/
+
+#ifndef ESP_SNTP_STUB_H
+#define ESP_SNTP_STUB_H
+
+#include <stdlib.h>
+#include <sys/time.h>
+#include <time.h>
+#include "host.h"
+
+typedef void (*sntp_sync_time_cb_t)(struct timeval* tv);
+
+inline sntp_sync_time_cb_t hostSntpCallback = nullptr;
+inline int64_t hostEpochOffsetUs = 0;   // Время эпохи минус монотонное
+
+inline int hostGettimeofday(struct timeval* tv, void* tz) {
+  (void)tz;
+  int64_t us = hostEpochOffsetUs + hostNowUs;
+  tv->tv_sec = us / 1000000;
+  tv->tv_usec = us % 1000000;
+  return 0;
+}
+
+inline int hostSettimeofday(const struct timeval* tv, const void* tz) {
+  (void)tz;
+  hostEpochOffsetUs = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec - hostNowUs;
+  return 0;
+}
+
+#define gettimeofday hostGettimeofday
+#define settimeofday hostSettimeofday
+
+inline void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t cb) { hostSntpCallback = cb; }
+
+inline void configTzTime(const char* tz, const char* server1, const char* server2 = nullptr,
+                         const char* server3 = nullptr) {
+  (void)server1; (void)server2; (void)server3;
+  setenv("TZ", tz, 1);
+  tzset();
+}
+
+// Ответ NTP: часы выставлены, затем уведомление (как задача SNTP)
+inline void hostNtpSync(time_t epoch) {
+  struct timeval tv = {epoch, 0};
+  hostSettimeofday(&tv, nullptr);
+  if (hostSntpCallback) hostSntpCallback(&tv);
+}
+
+#endif // ESP_SNTP_STUB_H
@@ -0,0 +1,27 @@
+/*
+  esp_system.h - Причина сброса (тесты на хосте: hostResetReason)
+*/
+
+#ifndef ESP_SYSTEM_STUB_H
+#define ESP_SYSTEM_STUB_H
+
+#include "host.h"
+#include "esp_err.h"
+
+typedef enum {
+  ESP_RST_UNKNOWN,
+  ESP_RST_POWERON,
+  ESP_RST_EXT,
+  ESP_RST_SW,
+  ESP_RST_PANIC,
+  ESP_RST_INT_WDT,
+  ESP_RST_TASK_WDT,
+  ESP_RST_WDT,
+  ESP_RST_DEEPSLEEP,
+  ESP_RST_BROWNOUT,
+  ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+inline esp_reset_reason_t esp_reset_reason() { return (esp_reset_reason_t)hostResetReason; }
+
+#endif // ESP_SYSTEM_STUB_H
@@ -0,0 +1,68 @@
+/*
+  esp_timer.h - Заглушка esp_timer на виртуальных часах (тесты на хосте)
+
+  Колбэки вызываются из hostAdvance() по наступлении срока.
+*/
+
+#ifndef ESP_TIMER_STUB_H
+#define ESP_TIMER_STUB_H
+
+#include "host.h"
+#include "esp_err.h"
+
+typedef HostTimer* esp_timer_handle_t;
+
+typedef enum { ESP_TIMER_TASK } esp_timer_dispatch_t;
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void* arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char* name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+inline int64_t esp_timer_get_time() { return hostNowUs; }
+
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+  for (HostTimer& t : hostTimers) {
+    if (t.used) continue;
+    t = {true, false, args->callback, args->arg, 0, 0};
+    *out = &t;
+    return ESP_OK;
+  }
+  return ESP_ERR_NO_MEM;
+}
+
+// Как в ESP-IDF: взведённый таймер не перезапускается
+inline esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t us) {
+  if (t->armed) return ESP_ERR_INVALID_STATE;
+  t->armed = true;
+  t->due = hostNowUs + (int64_t)us;
+  t->period = 0;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_timer_start_periodic(esp_timer_handle_t t, uint64_t us) {
+  if (t->armed) return ESP_ERR_INVALID_STATE;
+  t->armed = true;
+  t->due = hostNowUs + (int64_t)us;
+  t->period = us ? us : 1;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_timer_stop(esp_timer_handle_t t) {
+  if (!t->armed) return ESP_ERR_INVALID_STATE;
+  t->armed = false;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_timer_delete(esp_timer_handle_t t) {
+  t->used = false;
+  t->armed = false;
+  return ESP_OK;
+}
+
+inline bool esp_timer_is_active(esp_timer_handle_t t) { return t->armed; }
+
+#endif // ESP_TIMER_STUB_H
@@ -0,0 +1,19 @@
+/*
+  esp_wifi.h - Энергосбережение WiFi (тесты на хосте)
+*/
+
+#ifndef ESP_WIFI_STUB_H
+#define ESP_WIFI_STUB_H
+
+#include "esp_err.h"
+
+typedef enum { WIFI_PS_NONE, WIFI_PS_MIN_MODEM, WIFI_PS_MAX_MODEM } wifi_ps_type_t;
+
+inline wifi_ps_type_t hostWifiPs = WIFI_PS_NONE;
+
+inline esp_err_t esp_wifi_set_ps(wifi_ps_type_t type) {
+  hostWifiPs = type;
+  return ESP_OK;
+}
+
+#endif // ESP_WIFI_STUB_H
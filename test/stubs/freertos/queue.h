@@ -0,0 +1,49 @@
+/*
+  queue.h - Заглушка очередей FreeRTOS (тесты на хосте)
+*/
+
+#ifndef FREERTOS_QUEUE_STUB_H
+#define FREERTOS_QUEUE_STUB_H
+
+#include "FreeRTOS.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct HostQueue {
+  uint8_t* items;
+  UBaseType_t length;
+  UBaseType_t itemSize;
+  UBaseType_t head;
+  UBaseType_t count;
+};
+
+typedef HostQueue* QueueHandle_t;
+
+// Очередь выделяется при создании (как xQueueCreate), дальше - без выделений
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  HostQueue* q = (HostQueue*)calloc(1, sizeof(HostQueue));
+  if (!q) return nullptr;
+  q->items = (uint8_t*)calloc(length, itemSize);
+  q->length = length;
+  q->itemSize = itemSize;
+  return q;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks) {
+  (void)ticks;
+  if (q->count == q->length) return pdFALSE;
+  memcpy(q->items + ((q->head + q->count) % q->length) * q->itemSize, item, q->itemSize);
+  q->count++;
+  return pdTRUE;
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks) {
+  (void)ticks;
+  if (q->count == 0) return pdFALSE;
+  memcpy(item, q->items + q->head * q->itemSize, q->itemSize);
+  q->head = (q->head + 1) % q->length;
+  q->count--;
+  return pdTRUE;
+}
+
+#endif // FREERTOS_QUEUE_STUB_H
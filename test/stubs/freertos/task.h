@@ -0,0 +1,58 @@
+/*
+  task.h - Заглушка задач FreeRTOS (тесты на хосте)
+
+  Задачи регистрируются, но не запускаются. Ожидание уведомления сдвигает
+  виртуальные часы, пока уведомление не придёт (от таймера или прерывания)
+  или не выйдет таймаут.
+*/
+
+#ifndef FREERTOS_TASK_STUB_H
+#define FREERTOS_TASK_STUB_H
+
+#include "FreeRTOS.h"
+
+typedef HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack,
+                                          void* param, UBaseType_t priority,
+                                          TaskHandle_t* handle, BaseType_t core) {
+  (void)fn; (void)stack; (void)param; (void)priority; (void)core;
+  for (HostTask& t : hostTasks) {
+    if (t.used) continue;
+    t = {true, name, 0};
+    if (handle) *handle = &t;
+    return pdPASS;
+  }
+  return pdFAIL;
+}
+
+inline void vTaskDelete(TaskHandle_t task) {
+  if (task && task != &hostLoopTask) task->used = false;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return hostCurrentTask; }
+
+inline void vTaskDelay(TickType_t ticks) { hostAdvance(ticks); }
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  if (task) task->notify++;
+  return pdPASS;
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+  xTaskNotifyGive(task);
+  if (woken) *woken = pdTRUE;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+  HostTask* self = hostCurrentTask;
+  if (ticks != portMAX_DELAY) {
+    for (TickType_t i = 0; i < ticks && self->notify == 0; i++) hostAdvance(1);
+  }
+  uint32_t value = self->notify;
+  if (value) self->notify = clear ? 0 : value - 1;
+  return value;
+}
+
+#endif // FREERTOS_TASK_STUB_H
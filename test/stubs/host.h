@@ -0,0 +1,102 @@
+/*
+  host.h - Окружение прошивки на хосте (часы, таймеры, задачи, пины)
+
+  Общая часть заглушек Arduino и ESP-IDF для окружения native:
+    - часы виртуальные: стоят, пока тест или код прошивки их не сдвинет
+      (hostAdvance, delay, vTaskDelay, ожидание уведомления задачи);
+      при сдвиге срабатывают наступившие таймеры esp_timer;
+    - задачи FreeRTOS не запускаются: их тела проверяются отдельно,
+      а loop() тест вызывает сам;
+    - пины - массив уровней, прерывания пинов вызывает hostSetPin.
+  Всё хранится в статических массивах, чтобы сами заглушки не выделяли
+  память в куче и не мешали проверке выделений.
+*/
+
+#ifndef HOST_H
+#define HOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ==================== ЧАСЫ И ТАЙМЕРЫ ====================
+typedef void (*esp_timer_cb_t)(void* arg);
+
+struct HostTimer {
+  bool used;
+  bool armed;
+  esp_timer_cb_t callback;
+  void* arg;
+  int64_t due;
+  uint64_t period;          // 0 - однократный
+};
+
+#define HOST_TIMERS 16
+
+inline int64_t hostNowUs = 0;
+inline HostTimer hostTimers[HOST_TIMERS];
+
+// Сдвиг часов с вызовом наступивших таймеров по порядку
+inline void hostAdvanceUs(int64_t us) {
+  int64_t target = hostNowUs + us;
+  for (;;) {
+    HostTimer* next = nullptr;
+    for (HostTimer& t : hostTimers) {
+      if (t.used && t.armed && t.due <= target && (!next || t.due < next->due)) next = &t;
+    }
+    if (!next) break;
+    if (next->due > hostNowUs) hostNowUs = next->due;
+    if (next->period) {
+      next->due += next->period;
+    } else {
+      next->armed = false;
+    }
+    next->callback(next->arg);
+  }
+  hostNowUs = target;
+}
+
+inline void hostAdvance(uint32_t ms) { hostAdvanceUs((int64_t)ms * 1000); }
+
+// ==================== ЗАДАЧИ ====================
+struct HostTask {
+  bool used;
+  const char* name;
+  uint32_t notify;
+};
+
+#define HOST_TASKS 16
+
+inline HostTask hostTasks[HOST_TASKS];
+inline HostTask hostLoopTask = {true, "loopTask", 0};
+inline HostTask* hostCurrentTask = &hostLoopTask;
+
+inline HostTask* hostFindTask(const char* name) {
+  for (HostTask& t : hostTasks) {
+    if (t.used && strcmp(t.name, name) == 0) return &t;
+  }
+  return nullptr;
+}
+
+// ==================== ПИНЫ ====================
+#define HOST_PINS 40
+
+struct HostPinIsr {
+  void (*fn)(void*);
+  void* arg;
+};
+
+inline uint8_t hostPinLevel[HOST_PINS];
+inline HostPinIsr hostPinIsr[HOST_PINS];
+
+inline void hostSetPin(uint8_t pin, uint8_t level) {
+  if (pin >= HOST_PINS || hostPinLevel[pin] == level) return;
+  hostPinLevel[pin] = level;
+  if (hostPinIsr[pin].fn) hostPinIsr[pin].fn(hostPinIsr[pin].arg);
+}
+
+// ==================== СИСТЕМА ====================
+inline uint32_t hostRestarts = 0;     // Вызовы ESP.restart()
+inline int hostResetReason = 1;       // esp_reset_reason() (ESP_RST_POWERON)
+
+#endif // HOST_H
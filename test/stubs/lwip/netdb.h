@@ -0,0 +1,10 @@
+/*
+  lwip/netdb.h - Разрешение имён lwIP на хосте
+*/
+
+#ifndef LWIP_NETDB_STUB_H
+#define LWIP_NETDB_STUB_H
+
+#include <netdb.h>
+
+#endif // LWIP_NETDB_STUB_H
@@ -0,0 +1,17 @@
+/*
+  lwip/sockets.h - Сокеты lwIP на хосте - сокеты BSD
+*/
+
+#ifndef LWIP_SOCKETS_STUB_H
+#define LWIP_SOCKETS_STUB_H
+
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+
+#endif // LWIP_SOCKETS_STUB_H
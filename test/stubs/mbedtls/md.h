@@ -0,0 +1,132 @@
+/*
+  mbedtls/md.h - HMAC-SHA256 для тестов на хосте
+
+  Только mbedtls_md_hmac с SHA-256 (FIPS 180-4, RFC 2104): этим прошивка
+  подписывает UDP пакеты. Проверено векторами RFC 4231 (test_udp_control).
+*/
+
+#ifndef MBEDTLS_MD_STUB_H
+#define MBEDTLS_MD_STUB_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef enum { MBEDTLS_MD_NONE = 0, MBEDTLS_MD_SHA256 = 6 } mbedtls_md_type_t;
+
+typedef struct {
+  mbedtls_md_type_t type;
+  unsigned char size;
+  unsigned char block_size;
+} mbedtls_md_info_t;
+
+#define MBEDTLS_ERR_MD_BAD_INPUT_DATA -0x5100
+
+struct HostSha256 {
+  uint32_t h[8];
+  uint8_t block[64];
+  size_t used;
+  uint64_t total;
+};
+
+inline void hostSha256Block(HostSha256& c, const uint8_t* p) {
+  static const uint32_t k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+  };
+  auto rotr = [](uint32_t x, int n) { return (x >> n) | (x << (32 - n)); };
+  uint32_t w[64];
+  for (int i = 0; i < 16; i++) {
+    w[i] = (uint32_t)p[4 * i] << 24 | (uint32_t)p[4 * i + 1] << 16 | (uint32_t)p[4 * i + 2] << 8 | p[4 * i + 3];
+  }
+  for (int i = 16; i < 64; i++) {
+    uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+  uint32_t a = c.h[0], b = c.h[1], cc = c.h[2], d = c.h[3], e = c.h[4], f = c.h[5], g = c.h[6], h = c.h[7];
+  for (int i = 0; i < 64; i++) {
+    uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+    uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & cc) ^ (b & cc));
+    h = g; g = f; f = e; e = d + t1; d = cc; cc = b; b = a; a = t1 + t2;
+  }
+  c.h[0] += a; c.h[1] += b; c.h[2] += cc; c.h[3] += d;
+  c.h[4] += e; c.h[5] += f; c.h[6] += g; c.h[7] += h;
+}
+
+inline void hostSha256Init(HostSha256& c) {
+  static const uint32_t init[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                   0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  memcpy(c.h, init, sizeof(init));
+  c.used = 0;
+  c.total = 0;
+}
+
+inline void hostSha256Update(HostSha256& c, const uint8_t* data, size_t len) {
+  c.total += len;
+  while (len--) {
+    c.block[c.used++] = *data++;
+    if (c.used == 64) {
+      hostSha256Block(c, c.block);
+      c.used = 0;
+    }
+  }
+}
+
+inline void hostSha256Final(HostSha256& c, uint8_t out[32]) {
+  uint64_t bits = c.total * 8;
+  uint8_t pad = 0x80;
+  hostSha256Update(c, &pad, 1);
+  pad = 0;
+  while (c.used != 56) hostSha256Update(c, &pad, 1);
+  for (int i = 7; i >= 0; i--) {
+    uint8_t b = bits >> (8 * i);
+    hostSha256Update(c, &b, 1);
+  }
+  for (int i = 0; i < 8; i++) {
+    out[4 * i] = c.h[i] >> 24;
+    out[4 * i + 1] = c.h[i] >> 16;
+    out[4 * i + 2] = c.h[i] >> 8;
+    out[4 * i + 3] = c.h[i];
+  }
+}
+
+inline const mbedtls_md_info_t* mbedtls_md_info_from_type(mbedtls_md_type_t type) {
+  static const mbedtls_md_info_t sha256 = {MBEDTLS_MD_SHA256, 32, 64};
+  return type == MBEDTLS_MD_SHA256 ? &sha256 : nullptr;
+}
+
+inline int mbedtls_md_hmac(const mbedtls_md_info_t* info, const unsigned char* key, size_t keylen,
+                           const unsigned char* input, size_t ilen, unsigned char* output) {
+  if (!info || info->type != MBEDTLS_MD_SHA256) return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+  uint8_t k[64] = {0};
+  HostSha256 c;
+  if (keylen > sizeof(k)) {
+    hostSha256Init(c);
+    hostSha256Update(c, key, keylen);
+    hostSha256Final(c, k);
+  } else {
+    memcpy(k, key, keylen);
+  }
+  uint8_t pad[64];
+  uint8_t inner[32];
+  for (int i = 0; i < 64; i++) pad[i] = k[i] ^ 0x36;
+  hostSha256Init(c);
+  hostSha256Update(c, pad, sizeof(pad));
+  hostSha256Update(c, input, ilen);
+  hostSha256Final(c, inner);
+  for (int i = 0; i < 64; i++) pad[i] = k[i] ^ 0x5c;
+  hostSha256Init(c);
+  hostSha256Update(c, pad, sizeof(pad));
+  hostSha256Update(c, inner, sizeof(inner));
+  hostSha256Final(c, output);
+  return 0;
+}
+
+#endif // MBEDTLS_MD_STUB_H
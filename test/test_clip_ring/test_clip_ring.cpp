@@ -0,0 +1,290 @@
+/*
+  test_clip_ring.cpp - Кольцо кадров с предзаписью для роликов кормлений
+
+  Кадры разного размера несут своё время и узор байт по всей длине, так
+  что наложение кадров в кольце видно по содержимому. Случайная
+  последовательность push/dropBefore/freeze проверяется на инварианты:
+  кадры по порядку, целые, без наложений, память в пределах области.
+  Предзапись прогоняется как в задаче ролика (clip_recorder.cpp): кадры
+  FileFrameSource с частотой CLIP_FPS, кормление замораживает кольцо,
+  дописывается CLIP_POSTROLL_MS.
+*/
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "clip_ring.h"
+#include "file_frame_source.h"
+#include "storage.h"
+#include "config.h"
+
+#define FRAME_MAX 16384
+
+static uint8_t frameBuf[FRAME_MAX];
+
+static uint8_t patternByte(uint32_t timeMs, uint32_t pos) {
+  return (uint8_t)(timeMs * 13 + pos * 7 + (pos >> 8));
+}
+
+// Кадр с временем в первых байтах и узором дальше
+static const uint8_t* makeFrame(uint32_t timeMs, size_t len) {
+  for (size_t p = 0; p < len; p++) frameBuf[p] = patternByte(timeMs, p);
+  memcpy(frameBuf, &timeMs, len < 4 ? len : 4);
+  return frameBuf;
+}
+
+static bool frameIntact(const uint8_t* data, size_t len, uint32_t timeMs) {
+  uint32_t stored = 0;
+  memcpy(&stored, data, len < 4 ? len : 4);
+  if (len >= 4 && stored != timeMs) return false;
+  for (size_t p = 4; p < len; p++) {
+    if (data[p] != patternByte(timeMs, p)) return false;
+  }
+  return true;
+}
+
+// Инварианты кольца: порядок по времени, целые кадры, без наложений,
+// счётчик байт. Выход за область ловит сборка с -fsanitize=address
+static void checkRing(const ClipRing& ring, size_t bytes, uint16_t maxFrames) {
+  TEST_ASSERT_LESS_OR_EQUAL(maxFrames, ring.count());
+  TEST_ASSERT_LESS_OR_EQUAL(bytes, ring.bytesUsed());
+
+  const uint8_t* from[64];
+  const uint8_t* to[64];
+  TEST_ASSERT_LESS_OR_EQUAL(64, maxFrames);
+  size_t used = 0;
+  uint32_t prevTime = 0;
+  for (uint16_t i = 0; i < ring.count(); i++) {
+    const uint8_t* data;
+    size_t len;
+    uint32_t timeMs;
+    TEST_ASSERT_TRUE(ring.frame(i, data, len, timeMs));
+    TEST_ASSERT_TRUE_MESSAGE(i == 0 || (int32_t)(timeMs - prevTime) > 0, "Кадры кольца не по порядку");
+    TEST_ASSERT_TRUE_MESSAGE(frameIntact(data, len, timeMs), "Кадр в кольце испорчен");
+    for (uint16_t j = 0; j < i; j++) {
+      TEST_ASSERT_TRUE_MESSAGE(data + len <= from[j] || to[j] <= data, "Кадры кольца наложились");
+    }
+    from[i] = data;
+    to[i] = data + len;
+    prevTime = timeMs;
+    used += len;
+  }
+  TEST_ASSERT_EQUAL_UINT(used, ring.bytesUsed());
+
+  const uint8_t* data;
+  size_t len;
+  uint32_t timeMs;
+  TEST_ASSERT_FALSE(ring.frame(ring.count(), data, len, timeMs));
+}
+
+static uint32_t rnd = 12345;
+static uint32_t next(uint32_t n) {
+  rnd = rnd * 1103515245u + 12345u;
+  return (rnd >> 8) % n;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_keeps_newest_frames() {
+  static ClipRing ring;
+  TEST_ASSERT_TRUE(ring.begin(10000, 8));
+  TEST_ASSERT_EQUAL_UINT16(0, ring.count());
+
+  // Кадры по 3000: в области помещаются три, новые вытесняют старые
+  for (uint32_t t = 1; t <= 10; t++) {
+    TEST_ASSERT_TRUE(ring.push(makeFrame(t, 3000), 3000, t));
+    checkRing(ring, 10000, 8);
+  }
+  TEST_ASSERT_EQUAL_UINT16(3, ring.count());
+  const uint8_t* data;
+  size_t len;
+  uint32_t timeMs;
+  ring.frame(0, data, len, timeMs);
+  TEST_ASSERT_EQUAL_UINT32(8, timeMs);
+  ring.frame(2, data, len, timeMs);
+  TEST_ASSERT_EQUAL_UINT32(10, timeMs);
+
+  // Мелкие кадры упираются в предел числа кадров
+  for (uint32_t t = 11; t <= 30; t++) TEST_ASSERT_TRUE(ring.push(makeFrame(t, 100), 100, t));
+  TEST_ASSERT_EQUAL_UINT16(8, ring.count());
+  ring.frame(0, data, len, timeMs);
+  TEST_ASSERT_EQUAL_UINT32(23, timeMs);
+  checkRing(ring, 10000, 8);
+
+  // Больше области и пустой кадр не принимаются, кольцо не тронуто
+  TEST_ASSERT_FALSE(ring.push(frameBuf, 10001, 31));
+  TEST_ASSERT_FALSE(ring.push(frameBuf, 0, 31));
+  TEST_ASSERT_EQUAL_UINT16(8, ring.count());
+
+  ring.clear();
+  TEST_ASSERT_EQUAL_UINT16(0, ring.count());
+  TEST_ASSERT_EQUAL_UINT(0, ring.bytesUsed());
+  TEST_ASSERT_TRUE(ring.push(makeFrame(40, 10000), 10000, 40));
+  checkRing(ring, 10000, 8);
+}
+
+void test_drop_before() {
+  static ClipRing ring;
+  TEST_ASSERT_TRUE(ring.begin(20000, 16));
+  for (uint32_t t = 100; t <= 1000; t += 100) ring.push(makeFrame(t, 500), 500, t);
+  ring.dropBefore(650);
+  TEST_ASSERT_EQUAL_UINT16(4, ring.count());
+  checkRing(ring, 20000, 16);
+
+  // Переход времени через 0 (millis() переполняется)
+  ring.clear();
+  for (uint32_t i = 0; i < 10; i++) ring.push(makeFrame(0xFFFFFE00u + i * 100, 500), 500, 0xFFFFFE00u + i * 100);
+  ring.dropBefore(0xFFFFFE00u + 500);
+  TEST_ASSERT_EQUAL_UINT16(5, ring.count());
+
+  // Замороженное кольцо не чистится
+  ring.freeze();
+  ring.dropBefore(0x10000000u);
+  TEST_ASSERT_EQUAL_UINT16(5, ring.count());
+  ring.clear();
+  TEST_ASSERT_FALSE(ring.frozen());
+}
+
+void test_frozen_appends_until_full() {
+  static ClipRing ring;
+  TEST_ASSERT_TRUE(ring.begin(10000, 16));
+  for (uint32_t t = 1; t <= 5; t++) ring.push(makeFrame(t, 1500), 1500, t);
+  uint16_t preroll = ring.count();
+  const uint8_t* data;
+  size_t len;
+  uint32_t first;
+  ring.frame(0, data, len, first);
+
+  ring.freeze();
+  TEST_ASSERT_TRUE(ring.frozen());
+  uint32_t t = 6;
+  while (ring.push(makeFrame(t, 1500), 1500, t)) t++;
+  // Предзапись на месте, место кончилось - ничего не вытеснено
+  uint32_t timeMs;
+  ring.frame(0, data, len, timeMs);
+  TEST_ASSERT_EQUAL_UINT32(first, timeMs);
+  TEST_ASSERT_GREATER_THAN(preroll, ring.count());
+  TEST_ASSERT_GREATER_THAN(10000 - 1500 * 2, ring.bytesUsed());
+  checkRing(ring, 10000, 16);
+  TEST_ASSERT_FALSE(ring.push(makeFrame(t + 1, 1500), 1500, t + 1));
+  ring.frame(0, data, len, timeMs);
+  TEST_ASSERT_EQUAL_UINT32(first, timeMs);
+  // Меньший кадр ещё помещается в остаток
+  TEST_ASSERT_TRUE(ring.push(makeFrame(t + 2, 100), 100, t + 2));
+  checkRing(ring, 10000, 16);
+}
+
+void test_random_sequence() {
+  static const size_t bytes = 30000;
+  static const uint16_t maxFrames = 24;
+  static ClipRing ring;
+  TEST_ASSERT_TRUE(ring.begin(bytes, maxFrames));
+
+  uint32_t now = 0;
+  uint32_t lastPushed = 0;
+  for (int step = 0; step < 20000; step++) {
+    now += 1 + next(300);
+    uint32_t op = next(100);
+    if (op < 80) {
+      size_t len = 1 + next(next(4) ? 3000 : 10000);
+      bool frozen = ring.frozen();
+      uint16_t before = ring.count();
+      bool ok = ring.push(makeFrame(now, len), len, now);
+      if (!frozen) {
+        // Обычное кольцо всегда принимает кадр, влезающий в область
+        TEST_ASSERT_TRUE(ok);
+      } else {
+        TEST_ASSERT_EQUAL_UINT16(before + (ok ? 1 : 0), ring.count());
+      }
+      if (ok) {
+        const uint8_t* data;
+        size_t flen;
+        uint32_t timeMs;
+        ring.frame(ring.count() - 1, data, flen, timeMs);
+        TEST_ASSERT_EQUAL_UINT32(now, timeMs);
+        TEST_ASSERT_EQUAL_UINT(len, flen);
+        lastPushed = now;
+      }
+    } else if (op < 90) {
+      ring.dropBefore(now - next(5000));
+    } else if (op < 95) {
+      ring.freeze();
+    } else {
+      ring.clear();
+    }
+    checkRing(ring, bytes, maxFrames);
+  }
+  TEST_ASSERT_GREATER_THAN(0, lastPushed);
+}
+
+void test_preroll_with_file_source() {
+  // Кадры с диска по кругу, время кадра - момент захвата
+  char root[] = "/tmp/feeder_clip_XXXXXX";
+  TEST_ASSERT_NOT_NULL(mkdtemp(root));
+  storageSetRoot(root);
+  storageSetup();
+  char path[32];
+  for (unsigned i = 0; i < 5; i++) {
+    size_t len = 3000 + i * 700;
+    memset(frameBuf, 0x40 + i, len);
+    frameBuf[0] = 0xFF;
+    frameBuf[1] = 0xD8;
+    snprintf(path, sizeof(path), "/frames/%03u.jpg", i);
+    TEST_ASSERT_TRUE(storageWrite(path, frameBuf, len));
+  }
+  FileFrameSource source("/frames");
+  TEST_ASSERT_TRUE(source.begin(CLIP_SIZE));
+
+  static ClipRing ring;
+  TEST_ASSERT_TRUE(ring.begin(CLIP_RING_BYTES, CLIP_RING_FRAMES));
+  static uint8_t capture[FRAME_MAX];
+  const uint32_t period = 1000 / CLIP_FPS;
+  const uint32_t triggerMs = 60000;
+
+  // Минута фонового захвата, кормление, запись после кормления - в том
+  // же порядке, что в задаче ролика: кадр, заморозка, обрезка предзаписи
+  for (uint32_t now = 0;; now += period) {
+    FrameInfo info = {};
+    TEST_ASSERT_TRUE(source.capture(capture, sizeof(capture), info));
+    TEST_ASSERT_TRUE_MESSAGE(ring.push(capture, info.len, now), "Ролик обрезан");
+    TEST_ASSERT_LESS_OR_EQUAL(CLIP_RING_BYTES, ring.bytesUsed());
+    if (now == triggerMs) ring.freeze();
+    if (!ring.frozen()) {
+      ring.dropBefore(now - CLIP_PREROLL_MS);
+      TEST_ASSERT_LESS_OR_EQUAL(CLIP_PREROLL_MS / period + 1, ring.count());
+    } else if (now - triggerMs >= CLIP_POSTROLL_MS) {
+      break;
+    }
+  }
+
+  // Ролик: не меньше CLIP_PREROLL_MS до кормления (плюс кадр, снятый в
+  // момент кормления) и CLIP_POSTROLL_MS после, кадры подряд
+  const uint32_t firstMs = triggerMs - CLIP_PREROLL_MS - period;
+  TEST_ASSERT_EQUAL_UINT16((CLIP_PREROLL_MS + CLIP_POSTROLL_MS) / period + 2, ring.count());
+  for (uint16_t i = 0; i < ring.count(); i++) {
+    const uint8_t* data;
+    size_t len;
+    uint32_t timeMs;
+    ring.frame(i, data, len, timeMs);
+    TEST_ASSERT_EQUAL_UINT32(firstMs + i * period, timeMs);
+    unsigned index = (timeMs / period) % 5;
+    TEST_ASSERT_EQUAL_UINT(3000 + index * 700, len);
+    TEST_ASSERT_EQUAL_UINT8(0xD8, data[1]);
+    TEST_ASSERT_EQUAL_UINT8(0x40 + index, data[len - 1]);
+  }
+  TEST_ASSERT_EQUAL_UINT32(triggerMs + CLIP_POSTROLL_MS, firstMs + (ring.count() - 1) * period);
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_keeps_newest_frames);
+  RUN_TEST(test_drop_before);
+  RUN_TEST(test_frozen_appends_until_full);
+  RUN_TEST(test_random_sequence);
+  RUN_TEST(test_preroll_with_file_source);
+  return UNITY_END();
+}
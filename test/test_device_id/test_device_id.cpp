@@ -0,0 +1,261 @@
+/*
+  test_device_id.cpp - Кормушки на одном брокере не пересекаются
+
+  Много устройств с разными eFuse MAC по очереди подключаются к брокеру
+  в памяти (заглушка PubSubClient): идентификатор, топики mqttSetup,
+  подписки и публикации каждого. Брокер хранит подписки всех прежних
+  клиентов, поэтому видно, кому достанется команда в чужой топик.
+*/
+
+#include <unity.h>
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <WiFi.h>
+#include <stdlib.h>
+#include <string.h>
+#include "device_id.h"
+#include "mqtt_handler.h"
+#include "storage.h"
+#include "json_stream.h"
+#include "config.h"
+
+void setup();
+void loop();
+
+#define DEVICES 100
+
+static char ids[DEVICES][DEVICE_ID_LEN];
+
+// MAC с общим OUI Espressif (байты 0..2) и разными байтами 3..5
+static uint64_t macFor(int i) {
+  uint8_t b[8] = {0x24, 0x0A, 0xC4, (uint8_t)i, (uint8_t)(i * 37), (uint8_t)(i * 101), 0, 0};
+  if (i == DEVICES - 1) memset(b + 3, 0xFF, 3);
+  if (i == 0) memset(b + 3, 0, 3);
+  uint64_t mac;
+  memcpy(&mac, b, sizeof(mac));
+  return mac;
+}
+
+// Топик принадлежит устройству: один из уровней равен идентификатору
+static bool ownsTopic(const char* topic, const char* id) {
+  size_t n = strlen(id);
+  for (const char* p = topic; p; p = strchr(p, '/')) {
+    if (*p == '/') p++;
+    if (strncmp(p, id, n) == 0 && (p[n] == '/' || p[n] == '\0')) return true;
+  }
+  return false;
+}
+
+// Идентификатор другого устройства в данных (топике или сообщении)
+static int foreignId(const void* data, size_t len, int self) {
+  for (int j = 0; j < DEVICES; j++) {
+    if (j != self && memmem(data, len, ids[j], strlen(ids[j]))) return j;
+  }
+  return -1;
+}
+
+// Новое устройство: идентификатор, топики и подключение к брокеру
+static void bootDevice(int i) {
+  ESP.efuseMac = macFor(i);
+  deviceIdSetup();
+  mqttSetup();
+  mqttReconfigure();
+  bootTimePublished = false;
+  for (int n = 0; n < 50 && !mqttConnected; n++) loop();
+}
+
+static bool isDiscoveryConfig(const char* topic) {
+  size_t len = strlen(topic);
+  return strncmp(topic, "homeassistant/", 14) == 0 && len > 7 &&
+         strcmp(topic + len - 7, "/config") == 0;
+}
+
+// Конфигурация Discovery - целый JSON документ
+static bool validJson(const char* data, size_t len) {
+  JsonStream json;
+  json.begin([](void*, const JsonStream&, JsonType, const char*) {}, nullptr);
+  json.feed(data, len);
+  return json.done() && !json.failed();
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_ids_unique_and_formatted() {
+  for (int i = 0; i < DEVICES; i++) {
+    ESP.efuseMac = macFor(i);
+    deviceIdSetup();
+    const char* id = deviceId();
+    TEST_ASSERT_EQUAL_INT(13, strlen(id));
+    TEST_ASSERT_EQUAL_INT(0, strncmp(id, "feeder_", 7));
+    TEST_ASSERT_EQUAL_INT(strlen(id), strspn(id, "feeder_0123456789abcdef"));
+    strcpy(ids[i], id);
+    for (int j = 0; j < i; j++) {
+      TEST_ASSERT_FALSE_MESSAGE(strcmp(ids[i], ids[j]) == 0, "Одинаковые идентификаторы у разных MAC");
+    }
+  }
+  TEST_ASSERT_EQUAL_STRING("feeder_000000", ids[0]);
+  TEST_ASSERT_EQUAL_STRING("feeder_ffffff", ids[DEVICES - 1]);
+}
+
+// Имя из DEVICE_NAME: допустимое остаётся как есть, изменённое при
+// приведении (кириллица, регистр, длина) получает хэш исходного имени
+void test_ids_from_names() {
+  char a[DEVICE_ID_LEN], b[DEVICE_ID_LEN];
+  deviceIdFromName("feeder_kitchen", a, sizeof(a));
+  TEST_ASSERT_EQUAL_STRING("feeder_kitchen", a);
+
+  deviceIdFromName("Кухня", a, sizeof(a));
+  deviceIdFromName("Дача", b, sizeof(b));
+  TEST_ASSERT_FALSE_MESSAGE(strcmp(a, b) == 0, "Кириллические имена совпали");
+  for (const char* id : {a, b}) {
+    TEST_ASSERT_LESS_THAN(DEVICE_ID_LEN, strlen(id));
+    TEST_ASSERT_EQUAL_INT(strlen(id), strspn(id, "abcdefghijklmnopqrstuvwxyz0123456789_"));
+  }
+
+  deviceIdFromName("Kitchen", a, sizeof(a));
+  TEST_ASSERT_EQUAL_INT(14, strlen(a));
+  TEST_ASSERT_EQUAL_INT(0, strncmp(a, "kitchen_", 8));
+  deviceIdFromName("kitchen", b, sizeof(b));
+  TEST_ASSERT_FALSE(strcmp(a, b) == 0);
+
+  // Длинные имена с общим началом обрезаются, но не совпадают
+  deviceIdFromName("feeder_in_the_big_kitchen_near_window", a, sizeof(a));
+  deviceIdFromName("feeder_in_the_big_kitchen_near_door", b, sizeof(b));
+  TEST_ASSERT_EQUAL_INT(DEVICE_ID_LEN - 1, strlen(a));
+  TEST_ASSERT_EQUAL_INT(DEVICE_ID_LEN - 1, strlen(b));
+  TEST_ASSERT_FALSE(strcmp(a, b) == 0);
+}
+
+void test_boot_firmware() {
+  char root[] = "/tmp/feeder_ids_XXXXXX";
+  TEST_ASSERT_NOT_NULL(mkdtemp(root));
+  storageSetRoot(root);
+  setup();
+  while (!mqttConnected && millis() < 60000) loop();
+  TEST_ASSERT_TRUE(mqttConnected);
+  hostBroker.reset();
+}
+
+void test_devices_publish_only_own_topics() {
+  for (int i = 0; i < DEVICES; i++) {
+    hostBroker.messageCount = 0;
+    bootDevice(i);
+    TEST_ASSERT_TRUE(mqttConnected);
+    TEST_ASSERT_EQUAL_STRING(ids[i], mqttClient.clientId());
+
+    // Все виды публикаций устройства
+    loop();
+    publishLastFeeding(0, 3, "test", -1);
+    publishPetPresence(true);
+    publishEatingDuration(42);
+    publishMetrics();
+    publishTelemetry();
+    publishShadowReported();
+
+    TEST_ASSERT_GREATER_THAN(10, hostBroker.messageCount);
+    TEST_ASSERT_EQUAL_UINT32(0, hostBroker.dropped);
+    size_t discovery = 0;
+    for (size_t m = 0; m < hostBroker.messageCount; m++) {
+      const HostMqttMessage& msg = hostBroker.messages[m];
+      if (isDiscoveryConfig(msg.topic)) {
+        discovery++;
+        TEST_ASSERT_TRUE_MESSAGE(validJson((const char*)msg.payload, msg.len), msg.topic);
+      }
+      TEST_ASSERT_EQUAL_STRING(ids[i], msg.client);
+      TEST_ASSERT_TRUE_MESSAGE(ownsTopic(msg.topic, ids[i]), msg.topic);
+      TEST_ASSERT_EQUAL_INT_MESSAGE(-1, foreignId(msg.topic, strlen(msg.topic), i), msg.topic);
+      TEST_ASSERT_EQUAL_INT_MESSAGE(-1, foreignId(msg.payload, msg.len, i), msg.topic);
+    }
+    TEST_ASSERT_GREATER_THAN(0, discovery);
+  }
+}
+
+void test_subscriptions_isolated() {
+  TEST_ASSERT_LESS_THAN(HOST_MQTT_SUBS, hostBroker.subCount);
+  for (size_t s = 0; s < hostBroker.subCount; s++) {
+    const HostMqttSub& sub = hostBroker.subs[s];
+    // Общий топик настроек - намеренно один на всех
+    if (strcmp(sub.filter, MQTT_TOPIC_CONFIG_FLEET) == 0) continue;
+    TEST_ASSERT_TRUE_MESSAGE(ownsTopic(sub.filter, sub.client), sub.filter);
+    TEST_ASSERT_NULL(strchr(sub.filter, '+'));
+    TEST_ASSERT_NULL(strchr(sub.filter, '#'));
+  }
+
+  // Команды и настройки устройства получает только оно
+  static const char* const formats[] = {
+    MQTT_TOPIC_FEED_CMD, MQTT_TOPIC_LOG_LEVEL, MQTT_TOPIC_CONFIG, MQTT_TOPIC_SHADOW_DESIRED
+  };
+  char topic[MQTT_TOPIC_LEN];
+  for (int i = 0; i < DEVICES; i++) {
+    for (const char* format : formats) {
+      snprintf(topic, sizeof(topic), format, ids[i]);
+      for (int j = 0; j < DEVICES; j++) {
+        TEST_ASSERT_EQUAL_INT_MESSAGE(i == j, hostBroker.subscribed(ids[j], topic), topic);
+      }
+    }
+  }
+  for (int j = 0; j < DEVICES; j++) {
+    TEST_ASSERT_TRUE(hostBroker.subscribed(ids[j], MQTT_TOPIC_CONFIG_FLEET));
+  }
+}
+
+void test_foreign_command_ignored() {
+  // Подключено последнее устройство: команда кормления первому до него не доходит
+  char topic[MQTT_TOPIC_LEN];
+  snprintf(topic, sizeof(topic), MQTT_TOPIC_FEED_CMD, ids[0]);
+  TEST_ASSERT_FALSE(mqttClient.hostDeliver(topic, "1"));
+  snprintf(topic, sizeof(topic), MQTT_TOPIC_FEED_CMD, ids[DEVICES - 1]);
+  TEST_ASSERT_TRUE(mqttClient.hostDeliver(topic, "1"));
+}
+
+// Конфигурации Discovery уходят по одной за проход loop, не чаще
+// MQTT_DISCOVERY_INTERVAL, и сам проход при этом не ждёт
+void test_discovery_paced() {
+  hostBroker.messageCount = 0;
+  bootDevice(1);
+  TEST_ASSERT_TRUE(mqttConnected);
+  // Первая ушла в проходе, где установилось подключение
+  size_t configs = 0;
+  for (size_t m = 0; m < hostBroker.messageCount; m++) {
+    if (isDiscoveryConfig(hostBroker.messages[m].topic)) configs++;
+  }
+  TEST_ASSERT_LESS_OR_EQUAL(1, configs);
+  unsigned long lastConfig = 0;
+  bool timed = false;
+  for (int pass = 0; pass < 1000; pass++) {
+    size_t before = hostBroker.messageCount;
+    unsigned long start = millis();
+    loop();
+    TEST_ASSERT_LESS_THAN(MQTT_DISCOVERY_INTERVAL, millis() - start);
+    size_t sent = 0;
+    for (size_t m = before; m < hostBroker.messageCount; m++) {
+      if (isDiscoveryConfig(hostBroker.messages[m].topic)) sent++;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(1, sent);
+    if (sent) {
+      if (timed) TEST_ASSERT_GREATER_OR_EQUAL(MQTT_DISCOVERY_INTERVAL, millis() - lastConfig);
+      lastConfig = millis();
+      timed = true;
+      configs += sent;
+    }
+  }
+  // Доступность, время загрузки, последнее кормление, кнопки шнеков,
+  // кот у миски, время еды и сенсоры диагностики
+  TEST_ASSERT_EQUAL_UINT32(5 + NUM_AUGERS + (METRICS_MQTT_ENABLED ? 7 : 0), configs);
+  TEST_ASSERT_EQUAL_UINT32(0, hostBroker.dropped);
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_ids_unique_and_formatted);
+  RUN_TEST(test_ids_from_names);
+  RUN_TEST(test_boot_firmware);
+  RUN_TEST(test_devices_publish_only_own_topics);
+  RUN_TEST(test_subscriptions_isolated);
+  RUN_TEST(test_foreign_command_ignored);
+  RUN_TEST(test_discovery_paced);
+  return UNITY_END();
+}
@@ -0,0 +1,296 @@
+/*
+  test_feed_journal.cpp - Журнал кормлений: сброс и отключение питания
+
+  Перезагрузка - повторный journalSetup(): NVS заглушки переживает её как
+  флеш-память, RTC память (секция rtcnoinit, esp_attr.h) после
+  программного сброса или просадки питания остаётся, после отключения
+  питания заполняется мусором. Кормление обрывается на каждом обороте:
+    - RTC цела: остаток докармливается ровно до цели, один раз;
+      повторный сброс при докармливании - частичное;
+    - питание пропадало: частичное, без докармливания, выданное по NVS
+      не больше настоящего и отстаёт меньше чем на контрольную точку.
+  Номера кормлений растут через перезагрузки, записей во флеш - не больше
+  контрольных точек. В конце прошивка целиком загружается с прерванным
+  кормлением: докармливает остаток и публикует итог в MQTT.
+*/
+
+#include <unity.h>
+#include <Arduino.h>
+#include <Preferences.h>
+#include <PubSubClient.h>
+#include <esp_system.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "feed_journal.h"
+#include "feeder.h"
+#include "device_id.h"
+#include "mqtt_handler.h"
+#include "storage.h"
+#include "config.h"
+
+#ifndef __APPLE__
+extern uint8_t __start_rtcnoinit[];
+extern uint8_t __stop_rtcnoinit[];
+#endif
+
+void setup();
+void loop();
+
+static uint32_t rng = 2024;
+static char json[JOURNAL_JSON_MAX];
+
+void setUp() {}
+void tearDown() {}
+
+static uint32_t nextRandom() {
+  rng = rng * 1103515245u + 12345u;
+  return rng >> 8;
+}
+
+// Программный сброс, сторожевой таймер, просадка питания: RTC цела
+static void reset(esp_reset_reason_t reason) {
+  hostResetReason = reason;
+  journalSetup();
+}
+
+// Отключение питания: в RTC памяти мусор, NVS - последняя запись
+static void powerCut() {
+#ifndef __APPLE__
+  for (uint8_t* p = __start_rtcnoinit; p < __stop_rtcnoinit; p++) *p = nextRandom();
+#endif
+  hostResetReason = ESP_RST_POWERON;
+  journalSetup();
+}
+
+// Чистое устройство: пустая NVS, мусор в RTC
+static void freshDevice() {
+  hostNvsErase();
+  powerCut();
+  TEST_ASSERT_FALSE(journalHasRecovery());
+}
+
+// Число из JSON журнала: первое "key": после from
+static long jsonField(const char* from, const char* key) {
+  char pattern[32];
+  snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+  const char* p = strstr(from, pattern);
+  TEST_ASSERT_NOT_NULL_MESSAGE(p, key);
+  return strtol(p + strlen(pattern), nullptr, 10);
+}
+
+// Оборот за оборотом, как feederLoop
+static void feedRevs(int from, int to) {
+  for (int done = from + 1; done <= to; done++) journalProgress(0, done);
+}
+
+void test_completed_feed_leaves_nothing() {
+  freshDevice();
+  journalBegin(0, 25, "schedule");
+  feedRevs(0, 25);
+  journalEnd(0, 25);
+  reset(ESP_RST_SW);
+  TEST_ASSERT_FALSE(journalHasRecovery());
+  JournalRecord rec;
+  TEST_ASSERT_FALSE(journalTakeResume(0, rec));
+
+  powerCut();
+  TEST_ASSERT_FALSE(journalHasRecovery());
+}
+
+// Порция выдана, сброс до отметки о завершении - не прерывание
+void test_reset_after_last_rev_is_not_interrupted() {
+  freshDevice();
+  journalBegin(0, 12, "web");
+  feedRevs(0, 12);
+  reset(ESP_RST_BROWNOUT);
+  TEST_ASSERT_FALSE(journalHasRecovery());
+  TEST_ASSERT_GREATER_THAN(0, journalStatusJson(json, sizeof(json)));
+  TEST_ASSERT_NOT_NULL(strstr(json, "\"state\":\"idle\""));
+}
+
+// Сброс на каждом обороте при целой RTC: докормлено ровно до цели
+void test_soft_reset_resumes_remainder() {
+  const int target = 23;
+  for (int cut = 0; cut < target; cut++) {
+    freshDevice();
+    journalBegin(0, target, "schedule");
+    feedRevs(0, cut);
+    reset(ESP_RST_BROWNOUT);
+
+    TEST_ASSERT_TRUE(journalHasRecovery());
+    TEST_ASSERT_GREATER_THAN(0, journalRecoveryJson(json, sizeof(json)));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"reset\":\"brownout\""));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"outcome\":\"resumed\""));
+    TEST_ASSERT_EQUAL_INT(cut, jsonField(json, "done"));
+
+    JournalRecord rec;
+    TEST_ASSERT_TRUE(journalTakeResume(0, rec));
+    TEST_ASSERT_FALSE(journalTakeResume(0, rec));
+    TEST_ASSERT_EQUAL_INT(target, rec.target);
+    TEST_ASSERT_EQUAL_INT(cut, rec.done);
+    TEST_ASSERT_EQUAL_UINT8(1, rec.attempts);
+    TEST_ASSERT_EQUAL_STRING("schedule", rec.source);
+
+    // Докармливание: прогресс от выданного до сброса
+    feedRevs(cut, target);
+    journalEnd(0, target);
+    reset(ESP_RST_SW);
+    TEST_ASSERT_FALSE(journalHasRecovery());
+  }
+}
+
+// Второй сброс во время докармливания: повторов больше нет
+void test_reset_during_resume_is_partial() {
+  freshDevice();
+  journalBegin(0, 30, "schedule");
+  feedRevs(0, 8);
+  reset(ESP_RST_TASK_WDT);
+  JournalRecord rec;
+  TEST_ASSERT_TRUE(journalTakeResume(0, rec));
+  feedRevs(8, 17);
+  reset(ESP_RST_PANIC);
+
+  TEST_ASSERT_TRUE(journalHasRecovery());
+  TEST_ASSERT_GREATER_THAN(0, journalRecoveryJson(json, sizeof(json)));
+  TEST_ASSERT_NOT_NULL(strstr(json, "\"reset\":\"panic\""));
+  TEST_ASSERT_NOT_NULL(strstr(json, "\"outcome\":\"partial\""));
+  TEST_ASSERT_EQUAL_INT(17, jsonField(json, "done"));
+  TEST_ASSERT_FALSE(journalTakeResume(0, rec));
+
+  // Отметка частичного уже во флеш: следующая загрузка чистая
+  reset(ESP_RST_SW);
+  TEST_ASSERT_FALSE(journalHasRecovery());
+  powerCut();
+  TEST_ASSERT_FALSE(journalHasRecovery());
+}
+
+// Отключение питания на каждом обороте: частичное по последней записи NVS
+void test_power_cut_is_partial_from_checkpoint() {
+#ifdef __APPLE__
+  TEST_IGNORE_MESSAGE("Секция rtcnoinit - только ELF");
+#else
+  const int target = 37;
+  for (int cut = 0; cut < target; cut++) {
+    freshDevice();
+    journalBegin(0, target, "mqtt");
+    feedRevs(0, cut);
+    powerCut();
+
+    TEST_ASSERT_TRUE(journalHasRecovery());
+    TEST_ASSERT_GREATER_THAN(0, journalRecoveryJson(json, sizeof(json)));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"reset\":\"poweron\""));
+    TEST_ASSERT_NOT_NULL(strstr(json, "\"outcome\":\"partial\""));
+    long done = jsonField(json, "done");
+    TEST_ASSERT_LESS_OR_EQUAL(cut, done);
+    TEST_ASSERT_GREATER_THAN(cut - FEED_JOURNAL_CHECKPOINT_REVS, done);
+    TEST_ASSERT_EQUAL_INT(cut / FEED_JOURNAL_CHECKPOINT_REVS * FEED_JOURNAL_CHECKPOINT_REVS, done);
+    JournalRecord rec;
+    TEST_ASSERT_FALSE(journalTakeResume(0, rec));
+
+    powerCut();
+    TEST_ASSERT_FALSE(journalHasRecovery());
+  }
+#endif
+}
+
+// Новое кормление раньше докармливания: остаток прерванного не выдаётся
+void test_new_feed_before_resume_cancels_it() {
+  freshDevice();
+  journalBegin(0, 20, "schedule");
+  feedRevs(0, 5);
+  reset(ESP_RST_SW);
+  journalBegin(0, 10, "button");
+  JournalRecord rec;
+  TEST_ASSERT_FALSE(journalTakeResume(0, rec));
+  TEST_ASSERT_GREATER_THAN(0, journalRecoveryJson(json, sizeof(json)));
+  TEST_ASSERT_NOT_NULL(strstr(json, "\"outcome\":\"partial\""));
+}
+
+// Номер кормления растёт через сбросы и отключения питания
+void test_ids_grow_across_reboots() {
+  freshDevice();
+  long last = 0;
+  for (int i = 0; i < 20; i++) {
+    journalBegin(0, 15, "schedule");
+    TEST_ASSERT_GREATER_THAN(0, journalStatusJson(json, sizeof(json)));
+    // Текущие записи - последний "feeds" (первый может быть в итоге восстановления)
+    const char* feeds = nullptr;
+    for (const char* p = json; (p = strstr(p, "\"feeds\":[")); p++) feeds = p;
+    TEST_ASSERT_NOT_NULL(feeds);
+    long id = jsonField(feeds, "id");
+    TEST_ASSERT_GREATER_THAN(last, id);
+    last = id;
+    feedRevs(0, nextRandom() % 16);
+    if (nextRandom() & 1) powerCut();
+    else reset(ESP_RST_SW);
+  }
+}
+
+// Запись во флеш - начало, контрольные точки, конец
+void test_flash_writes_bounded() {
+  freshDevice();
+  const int target = 95;
+  uint32_t writes = hostNvsWrites;
+  journalBegin(0, target, "schedule");
+  feedRevs(0, target);
+  journalEnd(0, target);
+  TEST_ASSERT_LESS_OR_EQUAL(2 + target / FEED_JOURNAL_CHECKPOINT_REVS, hostNvsWrites - writes);
+}
+
+// Прошивка целиком: сброс от просадки питания посреди порции, загрузка,
+// докармливание через FEED_JOURNAL_RESUME_DELAY и итог в MQTT
+void test_firmware_resumes_after_brownout() {
+  const int target = 20, cut = 7;
+  char root[] = "/tmp/feeder_journal_XXXXXX";
+  TEST_ASSERT_NOT_NULL(mkdtemp(root));
+  storageSetRoot(root);
+
+  freshDevice();
+  journalBegin(0, target, "schedule");
+  feedRevs(0, cut);
+  hostResetReason = ESP_RST_BROWNOUT;
+  setup();
+  while (!mqttConnected && millis() < 60000) loop();
+  TEST_ASSERT_TRUE(mqttConnected);
+
+  uint32_t start = millis();
+  while (feederGetStats().feeds == 0 && millis() - start < 120000) loop();
+  TEST_ASSERT_EQUAL_UINT32(1, feederGetStats().feeds);
+  TEST_ASSERT_EQUAL_INT(target - cut, feederGetStats().revolutions);
+  TEST_ASSERT_EQUAL_STRING("resume", feederGetStats().lastSource);
+  TEST_ASSERT_GREATER_OR_EQUAL(FEED_JOURNAL_RESUME_DELAY, millis());
+
+  char topic[MQTT_TOPIC_LEN];
+  snprintf(topic, sizeof(topic), MQTT_TOPIC_FEED_RECOVERY, deviceId());
+  const HostMqttMessage* m = hostBroker.last(topic);
+  TEST_ASSERT_NOT_NULL(m);
+  TEST_ASSERT_TRUE(m->retained);
+  TEST_ASSERT_EQUAL_INT(1, (int)hostBroker.count(topic));
+  char payload[sizeof(m->payload) + 1];
+  memcpy(payload, m->payload, m->len);
+  payload[m->len] = '\0';
+  TEST_ASSERT_NOT_NULL(strstr(payload, "\"reset\":\"brownout\""));
+  TEST_ASSERT_NOT_NULL(strstr(payload, "\"outcome\":\"resumed\""));
+  TEST_ASSERT_EQUAL_INT(cut, jsonField(payload, "done"));
+
+  // Журнал закрыт: следующая загрузка без восстановления
+  reset(ESP_RST_SW);
+  TEST_ASSERT_FALSE(journalHasRecovery());
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_completed_feed_leaves_nothing);
+  RUN_TEST(test_reset_after_last_rev_is_not_interrupted);
+  RUN_TEST(test_soft_reset_resumes_remainder);
+  RUN_TEST(test_reset_during_resume_is_partial);
+  RUN_TEST(test_power_cut_is_partial_from_checkpoint);
+  RUN_TEST(test_new_feed_before_resume_cancels_it);
+  RUN_TEST(test_ids_grow_across_reboots);
+  RUN_TEST(test_flash_writes_bounded);
+  RUN_TEST(test_firmware_resumes_after_brownout);
+  return UNITY_END();
+}
@@ -0,0 +1,197 @@
+/*
+  fixtures.h - Архивы gzip для test_gzip
+
+  Сжаты zlib (Python): тело - raw deflate (wbits -15), заголовок и трейлер
+  собраны вручную. Содержимое восстанавливается в тесте:
+    GZ_TEXT   - textLine() x40, уровень 9 (динамические коды Хаффмана)
+    GZ_STORED - первые 600 байт того же текста, уровень 0 (хранимый блок)
+    GZ_FIXED  - "feed feed feed feed", уровень 9 (фиксированные коды)
+    GZ_HEADER - то же с FEXTRA, FNAME "firmware.bin", FCOMMENT и FHCRC
+    GZ_REPEAT - 1000 байт lcgBytes() x100 (100 КБ: словарь переполняется)
+    GZ_EMPTY  - пустой поток
+*/
+
+#ifndef TEST_GZIP_FIXTURES_H
+#define TEST_GZIP_FIXTURES_H
+
+#include <stdint.h>
+
+static const uint8_t GZ_TEXT[] = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xed, 0xcd, 0xc1, 0x09, 0x02, 0x31,
+  0x10, 0x05, 0xd0, 0xbb, 0x55, 0x4c, 0x01, 0x41, 0x12, 0x73, 0x91, 0x54, 0xe7, 0xee, 0x82, 0x78,
+  0xd3, 0x52, 0xa2, 0x10, 0x58, 0x16, 0x13, 0x5b, 0xf8, 0xd3, 0x91, 0xdf, 0x6d, 0xc2, 0xcb, 0xbf,
+  0x7c, 0x66, 0x60, 0xe6, 0x3f, 0x3c, 0xf0, 0xf2, 0x19, 0x03, 0x1b, 0x86, 0x5f, 0xf0, 0xf6, 0xc5,
+  0x6f, 0x9c, 0x6b, 0x31, 0x6e, 0xd5, 0x27, 0x7c, 0xb0, 0x32, 0x2b, 0x3a, 0x56, 0x34, 0x8b, 0xe7,
+  0x12, 0xa3, 0xa5, 0xfc, 0xcb, 0x53, 0x64, 0x06, 0xe3, 0x7d, 0x47, 0xc3, 0x66, 0x29, 0x18, 0xaf,
+  0xd9, 0xe2, 0x57, 0xfe, 0xdc, 0x2d, 0x1b, 0x6b, 0x9f, 0x7b, 0xed, 0x20, 0x51, 0x8f, 0x07, 0x08,
+  0x13, 0x26, 0x4c, 0x98, 0x30, 0x61, 0xc2, 0x84, 0x09, 0x13, 0x26, 0x4c, 0x98, 0x30, 0x61, 0xc2,
+  0x84, 0xfd, 0x0f, 0xfb, 0x02, 0xf6, 0xf4, 0x67, 0x5f, 0x08, 0x11, 0x00, 0x00,
+};
+
+static const uint8_t GZ_STORED[] = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x01, 0x58, 0x02, 0xa7, 0xfd, 0xd0,
+  0x90, 0xd0, 0xb2, 0xd1, 0x82, 0xd0, 0xbe, 0xd0, 0xba, 0xd0, 0xbe, 0xd1, 0x80, 0xd0, 0xbc, 0xd1,
+  0x83, 0xd1, 0x88, 0xd0, 0xba, 0xd0, 0xb0, 0x3a, 0x20, 0xd1, 0x80, 0xd0, 0xb0, 0xd1, 0x81, 0xd0,
+  0xbf, 0xd0, 0xb8, 0xd1, 0x81, 0xd0, 0xb0, 0xd0, 0xbd, 0xd0, 0xb8, 0xd0, 0xb5, 0x20, 0x30, 0x38,
+  0x3a, 0x30, 0x30, 0x20, 0x31, 0x33, 0x3a, 0x30, 0x30, 0x20, 0x32, 0x30, 0x3a, 0x30, 0x30, 0x2c,
+  0x20, 0xd1, 0x88, 0xd0, 0xbd, 0xd0, 0xb5, 0xd0, 0xba, 0x20, 0x31, 0x2c, 0x20, 0xd0, 0xbf, 0xd0,
+  0xbe, 0xd1, 0x80, 0xd1, 0x86, 0xd0, 0xb8, 0xd1, 0x8f, 0x20, 0x33, 0x20, 0xd0, 0xbe, 0xd0, 0xb1,
+  0xd0, 0xbe, 0xd1, 0x80, 0xd0, 0xbe, 0xd1, 0x82, 0xd0, 0xb0, 0x2e, 0x0a, 0xd0, 0x90, 0xd0, 0xb2,
+  0xd1, 0x82, 0xd0, 0xbe, 0xd0, 0xba, 0xd0, 0xbe, 0xd1, 0x80, 0xd0, 0xbc, 0xd1, 0x83, 0xd1, 0x88,
+  0xd0, 0xba, 0xd0, 0xb0, 0x3a, 0x20, 0xd1, 0x80, 0xd0, 0xb0, 0xd1, 0x81, 0xd0, 0xbf, 0xd0, 0xb8,
+  0xd1, 0x81, 0xd0, 0xb0, 0xd0, 0xbd, 0xd0, 0xb8, 0xd0, 0xb5, 0x20, 0x30, 0x38, 0x3a, 0x30, 0x30,
+  0x20, 0x31, 0x33, 0x3a, 0x30, 0x30, 0x20, 0x32, 0x30, 0x3a, 0x30, 0x30, 0x2c, 0x20, 0xd1, 0x88,
+  0xd0, 0xbd, 0xd0, 0xb5, 0xd0, 0xba, 0x20, 0x31, 0x2c, 0x20, 0xd0, 0xbf, 0xd0, 0xbe, 0xd1, 0x80,
+  0xd1, 0x86, 0xd0, 0xb8, 0xd1, 0x8f, 0x20, 0x33, 0x20, 0xd0, 0xbe, 0xd0, 0xb1, 0xd0, 0xbe, 0xd1,
+  0x80, 0xd0, 0xbe, 0xd1, 0x82, 0xd0, 0xb0, 0x2e, 0x0a, 0xd0, 0x90, 0xd0, 0xb2, 0xd1, 0x82, 0xd0,
+  0xbe, 0xd0, 0xba, 0xd0, 0xbe, 0xd1, 0x80, 0xd0, 0xbc, 0xd1, 0x83, 0xd1, 0x88, 0xd0, 0xba, 0xd0,
+  0xb0, 0x3a, 0x20, 0xd1, 0x80, 0xd0, 0xb0, 0xd1, 0x81, 0xd0, 0xbf, 0xd0, 0xb8, 0xd1, 0x81, 0xd0,
+  0xb0, 0xd0, 0xbd, 0xd0, 0xb8, 0xd0, 0xb5, 0x20, 0x30, 0x38, 0x3a, 0x30, 0x30, 0x20, 0x31, 0x33,
+  0x3a, 0x30, 0x30, 0x20, 0x32, 0x30, 0x3a, 0x30, 0x30, 0x2c, 0x20, 0xd1, 0x88, 0xd0, 0xbd, 0xd0,
+  0xb5, 0xd0, 0xba, 0x20, 0x31, 0x2c, 0x20, 0xd0, 0xbf, 0xd0, 0xbe, 0xd1, 0x80, 0xd1, 0x86, 0xd0,
+  0xb8, 0xd1, 0x8f, 0x20, 0x33, 0x20, 0xd0, 0xbe, 0xd0, 0xb1, 0xd0, 0xbe, 0xd1, 0x80, 0xd0, 0xbe,
+  0xd1, 0x82, 0xd0, 0xb0, 0x2e, 0x0a, 0xd0, 0x90, 0xd0, 0xb2, 0xd1, 0x82, 0xd0, 0xbe, 0xd0, 0xba,
+  0xd0, 0xbe, 0xd1, 0x80, 0xd0, 0xbc, 0xd1, 0x83, 0xd1, 0x88, 0xd0, 0xba, 0xd0, 0xb0, 0x3a, 0x20,
+  0xd1, 0x80, 0xd0, 0xb0, 0xd1, 0x81, 0xd0, 0xbf, 0xd0, 0xb8, 0xd1, 0x81, 0xd0, 0xb0, 0xd0, 0xbd,
+  0xd0, 0xb8, 0xd0, 0xb5, 0x20, 0x30, 0x38, 0x3a, 0x30, 0x30, 0x20, 0x31, 0x33, 0x3a, 0x30, 0x30,
+  0x20, 0x32, 0x30, 0x3a, 0x30, 0x30, 0x2c, 0x20, 0xd1, 0x88, 0xd0, 0xbd, 0xd0, 0xb5, 0xd0, 0xba,
+  0x20, 0x31, 0x2c, 0x20, 0xd0, 0xbf, 0xd0, 0xbe, 0xd1, 0x80, 0xd1, 0x86, 0xd0, 0xb8, 0xd1, 0x8f,
+  0x20, 0x33, 0x20, 0xd0, 0xbe, 0xd0, 0xb1, 0xd0, 0xbe, 0xd1, 0x80, 0xd0, 0xbe, 0xd1, 0x82, 0xd0,
+  0xb0, 0x2e, 0x0a, 0xd0, 0x90, 0xd0, 0xb2, 0xd1, 0x82, 0xd0, 0xbe, 0xd0, 0xba, 0xd0, 0xbe, 0xd1,
+  0x80, 0xd0, 0xbc, 0xd1, 0x83, 0xd1, 0x88, 0xd0, 0xba, 0xd0, 0xb0, 0x3a, 0x20, 0xd1, 0x80, 0xd0,
+  0xb0, 0xd1, 0x81, 0xd0, 0xbf, 0xd0, 0xb8, 0xd1, 0x81, 0xd0, 0xb0, 0xd0, 0xbd, 0xd0, 0xb8, 0xd0,
+  0xb5, 0x20, 0x30, 0x38, 0x3a, 0x30, 0x30, 0x20, 0x31, 0x33, 0x3a, 0x30, 0x30, 0x20, 0x32, 0x30,
+  0x3a, 0x30, 0x30, 0x2c, 0x20, 0xd1, 0x88, 0xd0, 0xbd, 0xd0, 0xb5, 0xd0, 0xba, 0x20, 0x31, 0x2c,
+  0x20, 0xd0, 0xbf, 0xd0, 0xbe, 0xd1, 0x80, 0xd1, 0x86, 0xd0, 0xb8, 0xd1, 0x8f, 0x20, 0x33, 0x20,
+  0xd0, 0xbe, 0xd0, 0xb1, 0xd0, 0xbe, 0xd1, 0x80, 0xd0, 0xbe, 0xd1, 0x82, 0xd0, 0xb0, 0x2e, 0x0a,
+  0xd0, 0x90, 0xd0, 0xb2, 0xd1, 0x82, 0xd0, 0xbe, 0xd0, 0xba, 0xd0, 0xbe, 0xd1, 0x80, 0xd0, 0xbc,
+  0xd1, 0x83, 0xd1, 0x88, 0xd0, 0xba, 0xd0, 0xb0, 0x3a, 0x20, 0xd1, 0x80, 0xd0, 0xb0, 0xd1, 0x81,
+  0xd0, 0xbf, 0xd0, 0xb8, 0xd1, 0x81, 0xd0, 0xb0, 0xd0, 0xbd, 0xd0, 0xb8, 0xd0, 0xb5, 0x20, 0x30,
+  0x38, 0x3a, 0x30, 0x30, 0x20, 0x31, 0x33, 0x12, 0x7e, 0x4f, 0x27, 0x58, 0x02, 0x00, 0x00,
+};
+
+static const uint8_t GZ_FIXED[] = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x4b, 0x4b, 0x4d, 0x4d, 0x51, 0x48,
+  0x43, 0x21, 0x00, 0x07, 0x29, 0xa9, 0x8b, 0x13, 0x00, 0x00, 0x00,
+};
+
+static const uint8_t GZ_HEADER[] = {
+  0x1f, 0x8b, 0x08, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x06, 0x00, 0x61, 0x62, 0x02, 0x00,
+  0x78, 0x79, 0x66, 0x69, 0x72, 0x6d, 0x77, 0x61, 0x72, 0x65, 0x2e, 0x62, 0x69, 0x6e, 0x00, 0x76,
+  0x32, 0x00, 0x53, 0x9d, 0x4b, 0x4b, 0x4d, 0x4d, 0x51, 0x48, 0x43, 0x21, 0x00, 0x07, 0x29, 0xa9,
+  0x8b, 0x13, 0x00, 0x00, 0x00,
+};
+
+static const uint8_t GZ_REPEAT[] = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xed, 0xd3, 0x09, 0x33, 0x15, 0x08,
+  0x00, 0xc0, 0x71, 0x2f, 0xd1, 0x4a, 0x6f, 0x2c, 0x92, 0x12, 0xdd, 0xb6, 0xdb, 0x91, 0x48, 0x4a,
+  0x0d, 0xd6, 0x59, 0x72, 0xee, 0x73, 0xe4, 0x48, 0x87, 0x8a, 0xe4, 0xd8, 0xb6, 0xc8, 0xb1, 0x9a,
+  0xd6, 0x15, 0x21, 0xaa, 0xc9, 0xa6, 0x1c, 0x1b, 0x29, 0x1d, 0x8e, 0x8e, 0x59, 0x72, 0xe5, 0x2a,
+  0xe9, 0x50, 0x4a, 0x8e, 0xf0, 0xd6, 0xa3, 0xa1, 0x49, 0x5b, 0xed, 0x92, 0xa8, 0xf6, 0x73, 0xec,
+  0xcc, 0xff, 0xf7, 0x1d, 0x7e, 0x0d, 0x51, 0x47, 0xfc, 0x37, 0x8d, 0xff, 0x35, 0xee, 0x3c, 0x52,
+  0xd1, 0x13, 0xa1, 0x2e, 0x8e, 0x13, 0x54, 0xe9, 0x76, 0x8b, 0x42, 0x14, 0x2c, 0x77, 0xfb, 0xc6,
+  0xb9, 0x5d, 0x8e, 0x5f, 0xef, 0x36, 0x24, 0x52, 0x0e, 0x7f, 0x1a, 0x93, 0xf3, 0x72, 0xbd, 0xf3,
+  0x4f, 0xda, 0x6b, 0xae, 0xed, 0xda, 0xda, 0x31, 0x29, 0xec, 0x4c, 0x73, 0x9f, 0xda, 0xc1, 0x64,
+  0xef, 0xf6, 0x8c, 0x94, 0xb9, 0x1b, 0x0d, 0x86, 0xcd, 0x42, 0x6d, 0x85, 0x9f, 0x2b, 0xf3, 0x3b,
+  0x24, 0xb1, 0xc9, 0x5d, 0x4b, 0x03, 0xb6, 0x7c, 0x13, 0x89, 0x83, 0xe6, 0x8d, 0xa7, 0x14, 0xbb,
+  0xca, 0xa4, 0xd6, 0xcb, 0x75, 0x39, 0x3d, 0xbc, 0xbc, 0xce, 0x2a, 0xc3, 0xf1, 0x99, 0xe3, 0x39,
+  0xd9, 0xac, 0xa1, 0x9b, 0x77, 0x65, 0x95, 0xcf, 0x58, 0x97, 0x08, 0xe6, 0x5c, 0x59, 0x15, 0xaf,
+  0x9b, 0xe9, 0x68, 0x71, 0x2a, 0xd8, 0x20, 0xc5, 0x65, 0x64, 0xad, 0xc6, 0x8c, 0xcf, 0xf1, 0x07,
+  0xfe, 0x3d, 0x13, 0xa1, 0xea, 0x61, 0x52, 0x1e, 0x10, 0x9c, 0xac, 0x10, 0xe4, 0xd6, 0x28, 0x98,
+  0xad, 0xad, 0x67, 0x7c, 0xa2, 0x5a, 0x23, 0x4f, 0x28, 0x2c, 0xd4, 0x3b, 0x1e, 0xe5, 0x95, 0xb2,
+  0x61, 0x60, 0xcf, 0x81, 0x7c, 0xa3, 0xe2, 0xda, 0x74, 0xc5, 0x82, 0x9d, 0x8d, 0x9d, 0x4d, 0xbd,
+  0xdb, 0xc4, 0x1f, 0xab, 0xe4, 0xa4, 0x76, 0xe7, 0xf6, 0x69, 0x66, 0xcf, 0xd7, 0x8d, 0x7b, 0xbe,
+  0xbd, 0xbe, 0xc0, 0x2e, 0x4a, 0x4b, 0xce, 0xff, 0x64, 0x56, 0x51, 0xc0, 0xa5, 0xf3, 0xee, 0xf2,
+  0x16, 0x41, 0xd1, 0xb7, 0x1e, 0x5b, 0x4e, 0xcb, 0xcf, 0x5b, 0xf6, 0xf2, 0xca, 0x78, 0xf6, 0x9b,
+  0xdb, 0x61, 0x8b, 0x42, 0x16, 0xa6, 0x59, 0x45, 0xd7, 0xe7, 0x5f, 0x8c, 0xb9, 0xdd, 0x96, 0x94,
+  0x2a, 0x29, 0xdc, 0xf1, 0xa3, 0xa3, 0x6f, 0x5f, 0xa6, 0x9e, 0xe6, 0x98, 0xd7, 0xe5, 0xb2, 0x9f,
+  0xb7, 0x79, 0x6e, 0x0a, 0x8e, 0xaa, 0xbc, 0x94, 0xe4, 0x32, 0x2b, 0xb8, 0xb6, 0xc9, 0xab, 0x7f,
+  0x99, 0xde, 0x95, 0x78, 0x07, 0xdf, 0x9c, 0xf0, 0x5f, 0x76, 0xef, 0xfc, 0x7d, 0xef, 0xbb, 0x40,
+  0x91, 0x69, 0xb6, 0x86, 0x43, 0xfd, 0xa4, 0xd1, 0xf2, 0x34, 0xf3, 0xca, 0x40, 0xe1, 0x2d, 0xc3,
+  0xe6, 0xef, 0xbf, 0x94, 0x3b, 0x3b, 0xa8, 0x87, 0x4f, 0x39, 0xb9, 0x38, 0x3d, 0x32, 0xad, 0xb6,
+  0xb5, 0x21, 0xcf, 0xc7, 0x41, 0x60, 0x68, 0x78, 0xb1, 0xea, 0xfd, 0x64, 0xa1, 0xca, 0xd9, 0xe8,
+  0xb9, 0x47, 0x9f, 0x5f, 0xd8, 0x1b, 0x1f, 0x91, 0x75, 0x4b, 0xd0, 0x91, 0xae, 0x6a, 0x9e, 0xa8,
+  0x54, 0x32, 0x49, 0xcf, 0xc3, 0xfe, 0x85, 0x58, 0x74, 0xe1, 0xaa, 0xa9, 0x8d, 0xc7, 0xab, 0x58,
+  0x9f, 0x41, 0x69, 0x25, 0xb1, 0xc2, 0xd9, 0xa1, 0x1f, 0x56, 0xf8, 0x74, 0x6d, 0xb7, 0xf2, 0x0f,
+  0x98, 0xde, 0x2b, 0x1d, 0x63, 0x13, 0x62, 0xd1, 0x71, 0xfa, 0x5e, 0xa4, 0x7a, 0x8b, 0xcc, 0x86,
+  0xfe, 0xb4, 0x20, 0x33, 0xef, 0x7d, 0xd2, 0x32, 0xa5, 0x6f, 0x4a, 0xe7, 0xe9, 0xdb, 0x46, 0xf9,
+  0xda, 0x0b, 0x0c, 0xaa, 0xf5, 0xc4, 0x0a, 0xf7, 0x0d, 0xb5, 0x06, 0x97, 0xce, 0xb2, 0xf3, 0x2a,
+  0x6e, 0xb1, 0x4e, 0x5c, 0xe7, 0xf4, 0x25, 0x6b, 0xe3, 0xb0, 0xa6, 0xa6, 0x7e, 0xb8, 0x50, 0xf1,
+  0xfa, 0x66, 0xc5, 0xa4, 0x55, 0xad, 0x1d, 0xbf, 0xbe, 0x9c, 0xe1, 0x22, 0xce, 0x7f, 0x14, 0x59,
+  0x73, 0x6d, 0x7b, 0x95, 0xb2, 0x24, 0x6e, 0xb3, 0x51, 0x4d, 0xe9, 0x34, 0xb7, 0x0c, 0x4b, 0x57,
+  0xf7, 0x8a, 0xd0, 0x88, 0x32, 0x7b, 0xc1, 0xdb, 0xd9, 0x43, 0xc7, 0xac, 0xe3, 0x87, 0x5f, 0x4c,
+  0x8f, 0x29, 0x2c, 0x5a, 0xd1, 0xad, 0x9f, 0xae, 0xb8, 0x52, 0xa0, 0xde, 0xb6, 0xc4, 0x4c, 0xe7,
+  0x75, 0xd1, 0x77, 0x6f, 0xc3, 0x32, 0x94, 0x1d, 0x9e, 0x1a, 0x1d, 0xba, 0x6a, 0x7c, 0xe3, 0x53,
+  0x63, 0x93, 0xf4, 0x82, 0xa7, 0xf7, 0x1b, 0x16, 0x2b, 0x4c, 0x7e, 0x74, 0x78, 0x63, 0xf5, 0x9e,
+  0x15, 0x8f, 0x43, 0xfc, 0xe4, 0xee, 0x9a, 0x4a, 0x85, 0x78, 0x99, 0xac, 0xfe, 0x74, 0x7a, 0xef,
+  0xc6, 0x0a, 0x23, 0xd7, 0x13, 0x89, 0xe2, 0xe6, 0xdc, 0xe2, 0xb4, 0x57, 0x87, 0x72, 0xf4, 0xbf,
+  0x7e, 0xdc, 0x74, 0xa7, 0xb8, 0x6f, 0x8d, 0xa2, 0xb0, 0x71, 0x57, 0xe5, 0x7b, 0x9f, 0x7e, 0x2f,
+  0xd9, 0x6f, 0xfa, 0x8d, 0x07, 0x13, 0x3c, 0xff, 0xd9, 0x6f, 0xd3, 0x7c, 0xd3, 0x39, 0xea, 0xbd,
+  0xca, 0xbd, 0xec, 0x8c, 0x14, 0x8f, 0x20, 0xf9, 0x77, 0xd3, 0x1b, 0xfa, 0xa7, 0x66, 0xce, 0xba,
+  0xa1, 0xb1, 0xf9, 0x91, 0x48, 0xb6, 0xcb, 0x54, 0x51, 0xf3, 0xf5, 0xe9, 0x40, 0x85, 0xf9, 0xc6,
+  0x3d, 0x63, 0x2e, 0x96, 0xc2, 0x9e, 0xe5, 0x7e, 0x13, 0x87, 0x8e, 0x3f, 0x1f, 0x6c, 0x1f, 0xbb,
+  0xd9, 0xfb, 0x26, 0xe4, 0x37, 0xb5, 0x64, 0xd3, 0xe9, 0x1a, 0xc7, 0xf6, 0x7b, 0xa7, 0x19, 0x8d,
+  0xcb, 0xf7, 0x8f, 0x48, 0xaa, 0xb3, 0xcc, 0x5f, 0x2c, 0x3b, 0x5a, 0x55, 0xfc, 0xd0, 0xaf, 0xae,
+  0x2a, 0xa9, 0xbb, 0xa7, 0x64, 0x34, 0x6c, 0x74, 0x9b, 0xcb, 0xc4, 0x3a, 0xe3, 0x70, 0xad, 0x07,
+  0x99, 0x26, 0xe1, 0x8b, 0xf3, 0xfa, 0xac, 0x5c, 0x55, 0xa6, 0xa8, 0xf6, 0xfe, 0x19, 0xe3, 0xbd,
+  0xa3, 0x60, 0x64, 0xa9, 0x92, 0x99, 0x94, 0x5f, 0xe7, 0xf0, 0xce, 0x45, 0x8e, 0x89, 0x75, 0xeb,
+  0x3c, 0xcb, 0xf5, 0x67, 0xe6, 0x3e, 0x4b, 0xf8, 0x56, 0x92, 0xed, 0xa6, 0xf3, 0xa1, 0xf3, 0x79,
+  0x8d, 0xad, 0xdf, 0x26, 0x83, 0x4c, 0xcf, 0xd0, 0x81, 0x27, 0x7f, 0xa4, 0x09, 0xfb, 0x53, 0x15,
+  0x8b, 0x62, 0x15, 0x4c, 0x56, 0x47, 0xe7, 0x27, 0x54, 0x0c, 0x6a, 0x87, 0x5a, 0x0a, 0xed, 0x4f,
+  0xc5, 0xcd, 0xae, 0xea, 0xfb, 0xf5, 0xe4, 0x1a, 0x03, 0x49, 0xe0, 0x5a, 0x43, 0xed, 0x69, 0x47,
+  0x8d, 0x62, 0x7a, 0x1c, 0xee, 0x58, 0xb5, 0x8b, 0xca, 0xc3, 0x4e, 0x85, 0x55, 0xb4, 0x5a, 0xd9,
+  0x9f, 0xbb, 0xb4, 0xcb, 0x53, 0x35, 0x42, 0x59, 0x5e, 0xc9, 0xc3, 0x6e, 0x77, 0xd1, 0x64, 0xf1,
+  0xf9, 0x99, 0xa5, 0x52, 0x46, 0x5f, 0x1f, 0xd4, 0xa9, 0x8f, 0x2e, 0xb7, 0x37, 0x8c, 0xda, 0x52,
+  0xae, 0x5c, 0x3f, 0xaf, 0xf6, 0xab, 0xf1, 0x05, 0x1d, 0x05, 0x89, 0xe5, 0x54, 0x89, 0xa3, 0xe0,
+  0xb0, 0xea, 0x11, 0xdd, 0xe8, 0x68, 0x6f, 0x7d, 0xf7, 0x95, 0x2a, 0xcd, 0x45, 0x0b, 0x54, 0x56,
+  0x46, 0xb7, 0x0c, 0x48, 0x9a, 0x5d, 0xaf, 0x07, 0xca, 0x44, 0xc6, 0x64, 0xea, 0xfb, 0x1d, 0xc8,
+  0xfe, 0x7b, 0x89, 0xdd, 0xe8, 0x58, 0x97, 0xa1, 0x54, 0x69, 0xdd, 0xb0, 0xf3, 0x96, 0xf7, 0xed,
+  0x43, 0x57, 0xef, 0xb6, 0xbd, 0x99, 0xb5, 0xa8, 0x4e, 0x54, 0x90, 0xf8, 0xc0, 0xd9, 0xff, 0x7a,
+  0x90, 0xab, 0xfb, 0x14, 0xb7, 0xaf, 0x52, 0xb2, 0x3d, 0x39, 0x03, 0x33, 0xdd, 0xca, 0x6a, 0xb6,
+  0x2e, 0x9c, 0xd8, 0x3a, 0x27, 0x48, 0xc7, 0x54, 0xad, 0xf5, 0xc9, 0xaa, 0x90, 0x54, 0x5f, 0xd3,
+  0x7d, 0xe7, 0x72, 0x5b, 0xde, 0x1e, 0xda, 0xa0, 0x73, 0xeb, 0x5a, 0x9a, 0xd0, 0x47, 0x6b, 0x24,
+  0x57, 0xcd, 0xba, 0x33, 0x47, 0x23, 0xa1, 0xa0, 0xfb, 0x83, 0xa1, 0xa8, 0xcc, 0xbf, 0xb0, 0xc9,
+  0xc9, 0xdd, 0x69, 0x24, 0x40, 0xf9, 0xc8, 0xb5, 0xb9, 0x79, 0x13, 0x36, 0xc6, 0x6d, 0xe6, 0x82,
+  0x04, 0xc9, 0x05, 0xa9, 0x33, 0x23, 0xe3, 0xb6, 0xb1, 0x3b, 0x2d, 0xbc, 0xdd, 0xae, 0x34, 0xf0,
+  0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39,
+  0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e,
+  0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7,
+  0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73,
+  0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c,
+  0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce,
+  0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7,
+  0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79,
+  0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c,
+  0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf,
+  0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3,
+  0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39,
+  0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e,
+  0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7,
+  0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73,
+  0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c,
+  0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce,
+  0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7,
+  0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79,
+  0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c,
+  0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf,
+  0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3,
+  0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39,
+  0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e,
+  0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7,
+  0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73,
+  0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c,
+  0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce,
+  0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7,
+  0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79,
+  0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c,
+  0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf,
+  0x79, 0xce, 0x73, 0x9e, 0xf3, 0x9c, 0xe7, 0x3c, 0xe7, 0x39, 0xcf, 0x79, 0xce, 0xf3, 0xff, 0xed,
+  0xf3, 0xff, 0x00, 0xc0, 0x46, 0x01, 0x41, 0xa0, 0x86, 0x01, 0x00,
+};
+
+static const uint8_t GZ_EMPTY[] = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+};
+
+#endif // TEST_GZIP_FIXTURES_H
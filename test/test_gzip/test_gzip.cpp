@@ -0,0 +1,258 @@
+/*
+  test_gzip.cpp - Потоковая распаковка gzip и приём сжатого образа OTA
+
+  Архивы из fixtures.h подаются целиком, кусками всех мелких размеров
+  и случайными кусками; испорченные (CRC, длина, обрезка, поток deflate)
+  не должны дойти до finished(). Докачка - через otaChunkBegin/Write/End
+  с отклонёнными кусками не по порядку.
+*/
+
+#include <unity.h>
+#include <Arduino.h>
+#include <esp_ota_ops.h>
+#include <string.h>
+#include "gzip_stream.h"
+#include "ota_update.h"
+#include "fixtures.h"
+
+#define OUT_MAX 100000
+
+static uint8_t out[OUT_MAX];
+static size_t outLen;
+static bool outOverflow;
+
+static uint8_t text[8192];
+static size_t textLen;
+static uint8_t repeat[OUT_MAX];
+
+static bool sink(const uint8_t* data, size_t len, void* ctx) {
+  (void)ctx;
+  if (outLen + len > sizeof(out)) {
+    outOverflow = true;
+    return false;
+  }
+  memcpy(out + outLen, data, len);
+  outLen += len;
+  return true;
+}
+
+struct Fixture {
+  const char* name;
+  const uint8_t* gz;
+  size_t gzLen;
+  const uint8_t* raw;
+  size_t rawLen;
+};
+
+static const uint8_t FEED[] = "feed feed feed feed";
+
+static Fixture fixtures[] = {
+  {"text", GZ_TEXT, sizeof(GZ_TEXT), text, 0},
+  {"stored", GZ_STORED, sizeof(GZ_STORED), text, 600},
+  {"fixed", GZ_FIXED, sizeof(GZ_FIXED), FEED, sizeof(FEED) - 1},
+  {"header", GZ_HEADER, sizeof(GZ_HEADER), FEED, sizeof(FEED) - 1},
+  {"repeat", GZ_REPEAT, sizeof(GZ_REPEAT), repeat, sizeof(repeat)},
+  {"empty", GZ_EMPTY, sizeof(GZ_EMPTY), FEED, 0},
+};
+
+// Распаковка кусками: sizes по кругу (0 - пустая запись); false - ошибка
+static bool inflateChunks(GzipStream& gz, const uint8_t* data, size_t len, const size_t* sizes, size_t count) {
+  outLen = 0;
+  outOverflow = false;
+  TEST_ASSERT_TRUE(gz.begin(sink, nullptr));
+  for (size_t pos = 0, i = 0; pos < len; i++) {
+    size_t n = sizes[i % count];
+    if (n > len - pos) n = len - pos;
+    if (!gz.write(data + pos, n)) return false;
+    pos += n;
+  }
+  return true;
+}
+
+static bool inflateAll(GzipStream& gz, const uint8_t* data, size_t len) {
+  return inflateChunks(gz, data, len, &len, 1);
+}
+
+static void assertOutput(const Fixture& f, const GzipStream& gz) {
+  TEST_ASSERT_TRUE_MESSAGE(gz.finished(), f.name);
+  TEST_ASSERT_EQUAL_UINT_MESSAGE(f.rawLen, outLen, f.name);
+  TEST_ASSERT_EQUAL_UINT_MESSAGE(f.rawLen, gz.outputSize(), f.name);
+  TEST_ASSERT_TRUE_MESSAGE(memcmp(f.raw, out, f.rawLen) == 0, f.name);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_good_archives() {
+  GzipStream gz;
+  for (const Fixture& f : fixtures) {
+    TEST_ASSERT_TRUE(GzipStream::isGzip(f.gz, f.gzLen));
+    TEST_ASSERT_TRUE_MESSAGE(inflateAll(gz, f.gz, f.gzLen), f.name);
+    assertOutput(f, gz);
+    gz.end();
+  }
+}
+
+void test_split_chunks() {
+  GzipStream gz;
+  for (const Fixture& f : fixtures) {
+    for (size_t size = 1; size <= 64; size++) {
+      TEST_ASSERT_TRUE_MESSAGE(inflateChunks(gz, f.gz, f.gzLen, &size, 1), f.name);
+      assertOutput(f, gz);
+    }
+    // Кусок HTTP загрузки и неровные куски с пустыми записями
+    static const size_t sizes[] = {1436, 1, 0, 7, 300, 2, 0, 4096, 13};
+    TEST_ASSERT_TRUE_MESSAGE(inflateChunks(gz, f.gz, f.gzLen, sizes, sizeof(sizes) / sizeof(sizes[0])), f.name);
+    assertOutput(f, gz);
+    gz.end();
+  }
+}
+
+void test_trailing_data_ignored() {
+  GzipStream gz;
+  uint8_t buf[sizeof(GZ_FIXED) + 4];
+  memcpy(buf, GZ_FIXED, sizeof(GZ_FIXED));
+  memset(buf + sizeof(GZ_FIXED), 0xAA, 4);
+  TEST_ASSERT_TRUE(inflateAll(gz, buf, sizeof(buf)));
+  assertOutput(fixtures[2], gz);
+  gz.end();
+}
+
+void test_bad_crc_and_size() {
+  GzipStream gz;
+  uint8_t buf[sizeof(GZ_TEXT)];
+  memcpy(buf, GZ_TEXT, sizeof(buf));
+  buf[sizeof(buf) - 8] ^= 0x01;
+  TEST_ASSERT_FALSE(inflateAll(gz, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("CRC mismatch", gz.error());
+  TEST_ASSERT_FALSE(gz.finished());
+
+  memcpy(buf, GZ_TEXT, sizeof(buf));
+  buf[sizeof(buf) - 4] ^= 0x01;
+  TEST_ASSERT_FALSE(inflateAll(gz, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("size mismatch", gz.error());
+  gz.end();
+}
+
+void test_bad_header() {
+  GzipStream gz;
+  uint8_t buf[sizeof(GZ_FIXED)];
+  memcpy(buf, GZ_FIXED, sizeof(buf));
+  buf[2] = 7;
+  TEST_ASSERT_FALSE(inflateAll(gz, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("unsupported compression method", gz.error());
+
+  buf[0] = 0xE9;
+  TEST_ASSERT_FALSE(GzipStream::isGzip(buf, sizeof(buf)));
+  TEST_ASSERT_FALSE(inflateAll(gz, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("not a gzip stream", gz.error());
+  gz.end();
+}
+
+void test_truncated() {
+  // Обрыв в любом месте: ошибки нет, но поток не завершён
+  GzipStream gz;
+  for (const Fixture& f : fixtures) {
+    size_t step = f.gzLen > 200 ? 7 : 1;
+    for (size_t len = 0; len < f.gzLen; len += step) {
+      size_t chunk = 5;
+      TEST_ASSERT_TRUE_MESSAGE(inflateChunks(gz, f.gz, len, &chunk, 1), f.name);
+      TEST_ASSERT_FALSE_MESSAGE(gz.finished(), f.name);
+    }
+  }
+  gz.end();
+}
+
+void test_corrupted_deflate() {
+  // Порча любого байта тела: ошибка или несовпадение CRC, но не finished()
+  // с другими данными (биты выравнивания после потока ни на что не влияют)
+  GzipStream gz;
+  const Fixture* checked[] = {&fixtures[0], &fixtures[2], &fixtures[4]};
+  for (const Fixture* f : checked) {
+    uint8_t* buf = (uint8_t*)malloc(f->gzLen);
+    for (size_t pos = 10; pos < f->gzLen - 8; pos++) {
+      for (uint8_t flip : {0x01, 0x80, 0xFF}) {
+        memcpy(buf, f->gz, f->gzLen);
+        buf[pos] ^= flip;
+        bool ok = inflateAll(gz, buf, f->gzLen);
+        if (ok && gz.finished()) {
+          TEST_ASSERT_EQUAL_UINT_MESSAGE(f->rawLen, outLen, f->name);
+          TEST_ASSERT_TRUE_MESSAGE(memcmp(f->raw, out, f->rawLen) == 0, f->name);
+        }
+        TEST_ASSERT_FALSE(ok && outOverflow);
+      }
+    }
+    free(buf);
+  }
+  gz.end();
+}
+
+void test_sink_abort() {
+  GzipStream gz;
+  TEST_ASSERT_TRUE(gz.begin([](const uint8_t*, size_t, void*) { return false; }, nullptr));
+  TEST_ASSERT_FALSE(gz.write(GZ_TEXT, sizeof(GZ_TEXT)));
+  TEST_ASSERT_EQUAL_STRING("write failed", gz.error());
+  gz.end();
+}
+
+void test_ota_truncated_image() {
+  // Объявлен размер меньше архива: все байты приняты, поток не закончен
+  uint32_t size = sizeof(GZ_REPEAT) - 8;
+  TEST_ASSERT_TRUE(otaChunkBegin(0, size));
+  TEST_ASSERT_TRUE(otaChunkWrite(GZ_REPEAT, size));
+  TEST_ASSERT_FALSE(otaChunkEnd());
+  TEST_ASSERT_TRUE(hostBoot == &hostAppPartitions[0]);
+}
+
+void test_ota_resumed_chunks() {
+  const uint32_t size = sizeof(GZ_REPEAT);
+  const uint32_t chunk = 200;
+  uint32_t offset = 0;
+  int n = 0;
+  while (offset < size) {
+    uint32_t len = size - offset < chunk ? size - offset : chunk;
+    if (n == 3) {
+      // Обрыв: кусок пропущен, следующий отклонён, повтор принятого тоже
+      TEST_ASSERT_FALSE(otaChunkBegin(offset + chunk, size));
+      TEST_ASSERT_FALSE(otaChunkBegin(offset - chunk, size));
+    }
+    TEST_ASSERT_TRUE(otaChunkBegin(offset, size));
+    TEST_ASSERT_TRUE(otaChunkWrite(GZ_REPEAT + offset, len));
+    TEST_ASSERT_TRUE(otaChunkEnd());
+    offset += len;
+    n++;
+  }
+  TEST_ASSERT_EQUAL_UINT(sizeof(repeat), hostOtaWritten);
+  TEST_ASSERT_TRUE(hostBoot == &hostAppPartitions[1]);
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  static const char line[] = "Автокормушка: расписание 08:00 13:00 20:00, шнек 1, порция 3 оборота.\n";
+  for (int i = 0; i < 40; i++) {
+    memcpy(text + textLen, line, sizeof(line) - 1);
+    textLen += sizeof(line) - 1;
+  }
+  fixtures[0].rawLen = textLen;
+  // Тот же генератор, что у архива: x = x * 1103515245 + 12345 (mod 2^31)
+  uint32_t x = 1;
+  for (size_t i = 0; i < 1000; i++) {
+    x = (x * 1103515245u + 12345u) & 0x7FFFFFFF;
+    repeat[i] = (x >> 16) & 0xFF;
+  }
+  for (size_t i = 1000; i < sizeof(repeat); i++) repeat[i] = repeat[i - 1000];
+
+  UNITY_BEGIN();
+  RUN_TEST(test_good_archives);
+  RUN_TEST(test_split_chunks);
+  RUN_TEST(test_trailing_data_ignored);
+  RUN_TEST(test_bad_crc_and_size);
+  RUN_TEST(test_bad_header);
+  RUN_TEST(test_truncated);
+  RUN_TEST(test_corrupted_deflate);
+  RUN_TEST(test_sink_abort);
+  RUN_TEST(test_ota_truncated_image);
+  RUN_TEST(test_ota_resumed_chunks);
+  return UNITY_END();
+}
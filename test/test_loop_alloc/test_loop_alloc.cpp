@@ -0,0 +1,150 @@
+/*
+  test_loop_alloc.cpp - loop() в установившемся режиме не выделяет память
+
+  Прошивка целиком (setup() и loop() из main.cpp) на заглушках test/stubs,
+  часы виртуальные. malloc/calloc/realloc обёрнуты alloc_track (сборка
+  с ALLOC_TRACKING), operator new/delete ниже идут через malloc, чтобы
+  выделения C++ тоже учитывались. После прогрева каждый сценарий крутит
+  loop() и требует, чтобы ни одна итерация не выделила память; ALLOC_WEB
+  разрешён только в итерации с HTTP запросом (alloc_track.h).
+
+  Заглушки не выделяют сами, поэтому внутренние выделения библиотек
+  устройства (NVS, LittleFS, lwIP) здесь не видны - их ловит сборка
+  esp32cam_alloc на плате.
+*/
+
+#include <unity.h>
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <WebServer.h>
+#include <new>
+#include <stdlib.h>
+#include "alloc_track.h"
+#include "device_id.h"
+#include "feeder.h"
+#include "mqtt_handler.h"
+#include "storage.h"
+#include "config.h"
+
+void setup();
+void loop();
+
+extern WebServer server;
+
+void* operator new(size_t size) {
+  void* p = malloc(size);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+static char topic[MQTT_TOPIC_LEN];
+
+// n итераций loop(); false - какая-то из них выделила память
+static bool runLoop(int n) {
+  uint32_t before = allocLoopViolations();
+  for (int i = 0; i < n; i++) loop();
+  return allocLoopViolations() == before;
+}
+
+// loop() до момента now + ms
+static bool runFor(uint32_t ms) {
+  uint32_t before = allocLoopViolations();
+  unsigned long end = millis() + ms;
+  while ((long)(millis() - end) < 0) loop();
+  return allocLoopViolations() == before;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_boot_and_warmup() {
+  char root[] = "/tmp/feeder_alloc_XXXXXX";
+  TEST_ASSERT_NOT_NULL(mkdtemp(root));
+  storageSetRoot(root);
+  setup();
+  runFor(ALLOC_WARMUP_MS + 1000);
+  TEST_ASSERT_TRUE(mqttConnected);
+  TEST_ASSERT_TRUE(mqttClient.connected());
+}
+
+void test_idle() {
+  TEST_ASSERT_TRUE_MESSAGE(runFor(120000), "loop() выделяет память в простое");
+}
+
+void test_feed() {
+  uint32_t feeds = feederGetStats().feeds;
+  TEST_ASSERT_TRUE(feed(0, 2, "test"));
+  uint32_t before = allocLoopViolations();
+  for (int i = 0; i < 20000 && feederGetStats().feeds == feeds; i++) loop();
+  TEST_ASSERT_EQUAL_UINT32(feeds + 1, feederGetStats().feeds);
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(before, allocLoopViolations(), "loop() выделяет память при кормлении");
+  snprintf(topic, sizeof(topic), MQTT_TOPIC_LAST_FEEDING, deviceId());
+  TEST_ASSERT_NOT_NULL(hostBroker.last(topic));
+}
+
+void test_mqtt_command() {
+  uint32_t feeds = feederGetStats().feeds;
+  snprintf(topic, sizeof(topic), MQTT_TOPIC_FEED_CMD, deviceId());
+  uint32_t before = allocLoopViolations();
+  TEST_ASSERT_TRUE(mqttClient.hostDeliver(topic, "1"));
+  for (int i = 0; i < 20000 && feederGetStats().feeds == feeds; i++) loop();
+  TEST_ASSERT_EQUAL_UINT32(feeds + 1, feederGetStats().feeds);
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(before, allocLoopViolations(), "loop() выделяет память по команде MQTT");
+
+  snprintf(topic, sizeof(topic), MQTT_TOPIC_LOG_LEVEL, deviceId());
+  TEST_ASSERT_TRUE(mqttClient.hostDeliver(topic, "W"));
+  TEST_ASSERT_TRUE_MESSAGE(runLoop(10), "loop() выделяет память после команды журнала");
+}
+
+void test_status_publish() {
+  snprintf(topic, sizeof(topic), MQTT_TOPIC_METRICS, deviceId());
+  size_t metrics = hostBroker.count(topic);
+  snprintf(topic, sizeof(topic), MQTT_TOPIC_TELEMETRY, deviceId());
+  size_t telemetry = hostBroker.count(topic);
+  TEST_ASSERT_TRUE_MESSAGE(runFor(METRICS_MQTT_INTERVAL + 1000), "loop() выделяет память при публикации статуса");
+  TEST_ASSERT_GREATER_THAN(telemetry, hostBroker.count(topic));
+  snprintf(topic, sizeof(topic), MQTT_TOPIC_METRICS, deviceId());
+  TEST_ASSERT_GREATER_THAN(metrics, hostBroker.count(topic));
+}
+
+void test_web_request() {
+  // Запрос: выделения веб-сервера разрешены только в этой итерации
+  server.hostRequest(HTTP_GET, "/api/time");
+  TEST_ASSERT_TRUE_MESSAGE(runLoop(1), "обработчик /api/time выделяет память вне веб-сервера");
+  TEST_ASSERT_EQUAL_INT(200, hostResponse.code);
+  TEST_ASSERT_TRUE_MESSAGE(runLoop(100), "веб-сервер выделяет память без запросов");
+
+  server.hostRequest(HTTP_GET, "/no/such/page");
+  TEST_ASSERT_TRUE(runLoop(1));
+  TEST_ASSERT_EQUAL_INT(404, hostResponse.code);
+}
+
+void test_reconnect() {
+  // Обрыв WiFi и переподключение WiFi и MQTT
+  WiFi.hostDrop(200);
+  TEST_ASSERT_TRUE_MESSAGE(runFor(30000), "loop() выделяет память при переподключении");
+  TEST_ASSERT_TRUE(mqttConnected);
+
+  mqttClient.hostDrop();
+  TEST_ASSERT_TRUE_MESSAGE(runFor(MQTT_RECONNECT_INTERVAL * 2), "loop() выделяет память при переподключении MQTT");
+  TEST_ASSERT_TRUE(mqttConnected);
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_boot_and_warmup);
+  RUN_TEST(test_idle);
+  RUN_TEST(test_feed);
+  RUN_TEST(test_mqtt_command);
+  RUN_TEST(test_status_publish);
+  RUN_TEST(test_web_request);
+  RUN_TEST(test_reconnect);
+  return UNITY_END();
+}
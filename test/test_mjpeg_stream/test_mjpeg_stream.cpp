@@ -0,0 +1,390 @@
+/*
+  test_mjpeg_stream.cpp - Пул кадров и MJPEG поток для нескольких зрителей
+
+  Кадры берутся из FileFrameSource (каталог во временном хранилище),
+  зрители - настоящие TCP сокеты на loopback. Каждый кадр несёт свой
+  номер файла и узор байт по всей длине: если слот пула перезаписан,
+  пока его отдают в сокет, тело кадра у зрителя не сойдётся. Время
+  виртуальное - service() получает его аргументом.
+
+  Медленный зритель (маленький приёмный буфер, не читает) пропускает
+  кадры и держит не больше одного слота; остальные получают свежие
+  кадры; по CAMERA_STREAM_STALL_MS медленного отключают и слот
+  возвращается в пул. Спрос захвата (частота, разрешение) следует за
+  скоростью самого быстрого зрителя. Пулы в тестах статические: у
+  FramePool нет освобождения, на устройстве он живёт всё время.
+*/
+
+#include <unity.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "file_frame_source.h"
+#include "frame_pool.h"
+#include "mjpeg_stream.h"
+#include "storage.h"
+#include "config.h"
+
+#define TEST_PORT 18081
+#define FRAME_FILES 8
+#define TICK_MS 10
+
+static FileFrameSource source("/frames");
+static FramePool pool;
+static MjpegStreamer streamer;
+static uint32_t now = 1000;
+
+// Размер кадра из файла index
+static uint32_t frameLen(unsigned index) {
+  return 20000 + index * 5000;
+}
+
+static uint8_t patternByte(unsigned index, uint32_t pos) {
+  return (uint8_t)(index * 31 + pos * 7 + (pos >> 8));
+}
+
+// Кадр: SOI, номер файла, узор, EOI
+static void writeFrames() {
+  static uint8_t buf[CAMERA_FRAME_MAX];
+  char path[32];
+  for (unsigned i = 0; i < FRAME_FILES; i++) {
+    uint32_t len = frameLen(i);
+    for (uint32_t p = 0; p < len; p++) buf[p] = patternByte(i, p);
+    buf[0] = 0xFF;
+    buf[1] = 0xD8;
+    buf[2] = i;
+    buf[len - 2] = 0xFF;
+    buf[len - 1] = 0xD9;
+    snprintf(path, sizeof(path), "/frames/%03u.jpg", i);
+    TEST_ASSERT_TRUE(storageWrite(path, buf, len));
+  }
+}
+
+// Тело кадра целое: длина по номеру файла и узор по всей длине
+static bool frameIntact(const uint8_t* body, uint32_t len) {
+  if (len < 4 || body[0] != 0xFF || body[1] != 0xD8 || body[2] >= FRAME_FILES) return false;
+  unsigned index = body[2];
+  if (len != frameLen(index) || body[len - 2] != 0xFF || body[len - 1] != 0xD9) return false;
+  for (uint32_t p = 3; p < len - 2; p++) {
+    if (body[p] != patternByte(index, p)) return false;
+  }
+  return true;
+}
+
+// Зритель: сокет и разбор multipart ответа
+struct Viewer {
+  int fd = -1;
+  std::string data;
+  size_t pos = 0;
+  bool headerSeen = false;
+  uint32_t frames = 0;
+  uint32_t torn = 0;
+  uint32_t lastTs = 0;
+  bool ordered = true;
+  bool closed = false;
+};
+
+static int connectTo(int rcvbuf) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  TEST_ASSERT_TRUE(fd >= 0);
+  // Приёмный буфер задаётся до connect, иначе окно уже объявлено
+  if (rcvbuf) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(TEST_PORT);
+  TEST_ASSERT_EQUAL_INT(0, connect(fd, (struct sockaddr*)&addr, sizeof(addr)));
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  return fd;
+}
+
+static void openViewer(Viewer& v, const char* request, int rcvbuf = 0) {
+  v = Viewer();
+  v.fd = connectTo(rcvbuf);
+  TEST_ASSERT_EQUAL_INT((int)strlen(request), send(v.fd, request, strlen(request), 0));
+}
+
+static void closeViewer(Viewer& v) {
+  if (v.fd >= 0) close(v.fd);
+  v.fd = -1;
+}
+
+// Разбор принятого: заголовок ответа, затем части --frame
+static void parse(Viewer& v) {
+  if (!v.headerSeen) {
+    size_t end = v.data.find("\r\n\r\n");
+    if (end == std::string::npos) return;
+    v.headerSeen = true;
+    v.pos = end + 4;
+  }
+  for (;;) {
+    size_t end = v.data.find("\r\n\r\n", v.pos);
+    if (end == std::string::npos) return;
+    const char* head = v.data.c_str() + v.pos;
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, strncmp(head, "--frame\r\nContent-Type: image/jpeg\r\n", 35), "Заголовок части");
+    const char* lenField = strstr(head, "Content-Length: ");
+    const char* tsField = strstr(head, "X-Timestamp: ");
+    TEST_ASSERT_NOT_NULL(lenField);
+    TEST_ASSERT_NOT_NULL(tsField);
+    uint32_t len = strtoul(lenField + 16, nullptr, 10);
+    uint32_t ts = strtoul(tsField + 13, nullptr, 10);
+    if (v.data.size() < end + 4 + len + 2) return;
+
+    const uint8_t* body = (const uint8_t*)v.data.data() + end + 4;
+    if (!frameIntact(body, len)) v.torn++;
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, memcmp(body + len, "\r\n", 2), "Конец части");
+    if (ts <= v.lastTs) v.ordered = false;
+    v.lastTs = ts;
+    v.frames++;
+    v.pos = end + 4 + len + 2;
+  }
+}
+
+// Забрать всё, что пришло, не больше limit байт
+static void drain(Viewer& v, size_t limit = SIZE_MAX) {
+  char buf[16384];
+  while (v.fd >= 0 && limit > 0) {
+    ssize_t n = recv(v.fd, buf, limit < sizeof(buf) ? limit : sizeof(buf), 0);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+      v.closed = true;
+      break;
+    }
+    if (n < 0) break;
+    v.data.append(buf, n);
+    limit -= n;
+  }
+  parse(v);
+}
+
+// Один шаг: захват (если нужен), проход сервера, чтение зрителей
+static void tick(Viewer* viewers, int count, bool capture, size_t limit = SIZE_MAX) {
+  now += TICK_MS;
+  if (capture) pool.captureFrom(source, now);
+  streamer.service(now);
+  for (int i = 0; i < count; i++) drain(viewers[i], limit);
+}
+
+// Ответ целиком (сервер закрывает соединение после него)
+static std::string readResponse(Viewer& v) {
+  for (int i = 0; i < 100 && !v.closed; i++) {
+    streamer.service(now);
+    drain(v);
+    usleep(1000);
+  }
+  TEST_ASSERT_TRUE_MESSAGE(v.closed, "Сервер не закрыл соединение");
+  closeViewer(v);
+  return v.data;
+}
+
+// Ни один слот не удержан: можно захватить и взять по ссылке каждый слот
+// пула, и каждую ссылку держим только мы
+static void assertPoolIdle() {
+  FrameSlot* held[CAMERA_POOL_SLOTS];
+  uint32_t dropped = pool.droppedNoSlot();
+  for (int i = 0; i < CAMERA_POOL_SLOTS; i++) {
+    TEST_ASSERT_TRUE_MESSAGE(pool.captureFrom(source, now), "Слот пула не вернулся");
+    held[i] = pool.acquireLatest();
+    TEST_ASSERT_NOT_NULL(held[i]);
+    TEST_ASSERT_EQUAL_UINT16(1, held[i]->refs.load());
+  }
+  TEST_ASSERT_FALSE(pool.captureFrom(source, now));
+  TEST_ASSERT_EQUAL_UINT32(dropped + 1, pool.droppedNoSlot());
+  for (FrameSlot* slot : held) pool.release(slot);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_frame_files() {
+  writeFrames();
+  TEST_ASSERT_TRUE(source.begin(FRAME_QVGA));
+  TEST_ASSERT_EQUAL_UINT16(FRAME_FILES, source.count());
+}
+
+void test_pool_refcounts() {
+  static FramePool p;
+  TEST_ASSERT_TRUE(p.begin(3, CAMERA_FRAME_MAX));
+  TEST_ASSERT_NULL(p.acquireLatest());
+  TEST_ASSERT_EQUAL_UINT32(0, p.latestSeq());
+
+  TEST_ASSERT_TRUE(p.captureFrom(source, 100));
+  FrameSlot* a = p.acquireLatest();
+  TEST_ASSERT_NOT_NULL(a);
+  TEST_ASSERT_EQUAL_UINT32(1, a->info.seq);
+  TEST_ASSERT_EQUAL_UINT32(100, a->info.timeMs);
+  TEST_ASSERT_EQUAL_UINT16(1, a->refs.load());
+  // Не новее уже взятого - ссылка не добавляется
+  TEST_ASSERT_NULL(p.acquireLatest(1));
+  TEST_ASSERT_EQUAL_UINT16(1, a->refs.load());
+
+  // Читатель держит кадр 1, захват идёт по двум другим слотам
+  for (uint32_t seq = 2; seq <= 4; seq++) {
+    TEST_ASSERT_TRUE(p.captureFrom(source, 100 + seq));
+    TEST_ASSERT_EQUAL_UINT32(seq, p.latestSeq());
+  }
+  FrameSlot* b = p.acquireLatest(1);
+  TEST_ASSERT_NOT_NULL(b);
+  TEST_ASSERT_EQUAL_UINT32(4, b->info.seq);
+  TEST_ASSERT_TRUE(p.captureFrom(source, 105));
+
+  // Заняты оба читателями и последний: кадр теряется, взятые не тронуты
+  TEST_ASSERT_FALSE(p.captureFrom(source, 106));
+  TEST_ASSERT_EQUAL_UINT32(1, p.droppedNoSlot());
+  TEST_ASSERT_EQUAL_UINT32(5, p.latestSeq());
+  TEST_ASSERT_EQUAL_UINT32(1, a->info.seq);
+  TEST_ASSERT_TRUE(frameIntact(a->data, a->info.len));
+  TEST_ASSERT_TRUE(frameIntact(b->data, b->info.len));
+
+  p.release(a);
+  TEST_ASSERT_TRUE(p.captureFrom(source, 107));
+  TEST_ASSERT_EQUAL_UINT32(6, p.latestSeq());
+  p.release(b);
+  TEST_ASSERT_EQUAL_UINT16(0, a->refs.load());
+  TEST_ASSERT_EQUAL_UINT16(0, b->refs.load());
+}
+
+void test_source_without_frames() {
+  FileFrameSource empty("/no_frames");
+  TEST_ASSERT_FALSE(empty.begin(FRAME_QVGA));
+  static FramePool p;
+  TEST_ASSERT_TRUE(p.begin(2, CAMERA_FRAME_MAX));
+  TEST_ASSERT_FALSE(p.captureFrom(empty, 100));
+  TEST_ASSERT_EQUAL_UINT32(0, p.latestSeq());
+  TEST_ASSERT_EQUAL_UINT32(0, p.droppedNoSlot());
+}
+
+void test_stream_begin() {
+  TEST_ASSERT_TRUE(pool.begin(CAMERA_POOL_SLOTS, CAMERA_FRAME_MAX));
+  TEST_ASSERT_TRUE(streamer.begin(TEST_PORT, &pool));
+  streamer.service(now);
+  StreamDemand d = streamer.demand();
+  TEST_ASSERT_EQUAL_UINT8(0, d.clients);
+  TEST_ASSERT_EQUAL_UINT16(CAMERA_MAX_FPS, d.fps);
+}
+
+void test_not_found() {
+  Viewer v;
+  openViewer(v, "GET /api/capture HTTP/1.1\r\nHost: feeder\r\n\r\n");
+  std::string r = readResponse(v);
+  TEST_ASSERT_EQUAL_INT(0, r.find("HTTP/1.1 404 "));
+  TEST_ASSERT_EQUAL_UINT8(0, streamer.stats().clients);
+}
+
+void test_viewers_share_capture() {
+  static const char request[] = "GET /api/stream HTTP/1.1\r\nHost: feeder\r\n\r\n";
+  Viewer viewers[CAMERA_STREAM_MAX_CLIENTS];
+  Viewer& slow = viewers[CAMERA_STREAM_MAX_CLIENTS - 1];
+  for (int i = 0; i < CAMERA_STREAM_MAX_CLIENTS - 1; i++) openViewer(viewers[i], request);
+  openViewer(slow, request, 4096);
+  for (int i = 0; i < 5; i++) tick(viewers, CAMERA_STREAM_MAX_CLIENTS - 1, false);
+  TEST_ASSERT_EQUAL_UINT8(CAMERA_STREAM_MAX_CLIENTS, streamer.demand().clients);
+
+  // Мест нет - лишний зритель получает 503
+  Viewer extra;
+  openViewer(extra, request);
+  std::string r = readResponse(extra);
+  TEST_ASSERT_EQUAL_INT(0, r.find("HTTP/1.1 503 "));
+
+  // Быстрые читают всё, медленный - ничего
+  uint32_t captured = 0;
+  for (int i = 0; i < 300; i++) {
+    tick(viewers, CAMERA_STREAM_MAX_CLIENTS - 1, true);
+    captured = pool.latestSeq();
+  }
+  StreamStats st = streamer.stats();
+  TEST_ASSERT_EQUAL_UINT8(CAMERA_STREAM_MAX_CLIENTS, st.clients);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, st.framesSkipped);
+  TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, pool.droppedNoSlot(), "Медленный зритель занял больше одного слота");
+
+  // Захват остановлен: быстрые получают последний кадр, медленный отстал
+  for (int i = 0; i < 20; i++) tick(viewers, CAMERA_STREAM_MAX_CLIENTS - 1, false);
+  for (int i = 0; i < CAMERA_STREAM_MAX_CLIENTS - 1; i++) {
+    Viewer& v = viewers[i];
+    TEST_ASSERT_FALSE(v.closed);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, v.torn, "Кадр перезаписан во время отправки");
+    TEST_ASSERT_TRUE_MESSAGE(v.ordered, "Кадры не по порядку");
+    TEST_ASSERT_GREATER_THAN_UINT32(captured / 2, v.frames);
+    TEST_ASSERT_EQUAL_UINT32(now - 20 * TICK_MS, v.lastTs);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, slow.frames);
+
+  // Медленный не забирает данные - отключается по таймауту, остальные живы
+  for (uint32_t t = 0; t <= CAMERA_STREAM_STALL_MS + TICK_MS; t += TICK_MS) {
+    tick(viewers, CAMERA_STREAM_MAX_CLIENTS - 1, false);
+  }
+  TEST_ASSERT_EQUAL_UINT8(CAMERA_STREAM_MAX_CLIENTS - 1, streamer.stats().clients);
+  drain(slow);
+  TEST_ASSERT_EQUAL_UINT32(0, slow.torn);
+  closeViewer(slow);
+
+  for (int i = 0; i < CAMERA_STREAM_MAX_CLIENTS - 1; i++) closeViewer(viewers[i]);
+  for (int i = 0; i < 5; i++) tick(viewers, 0, false);
+  TEST_ASSERT_EQUAL_UINT8(0, streamer.demand().clients);
+  assertPoolIdle();
+}
+
+void test_stalled_request_closed() {
+  // Соединение без запроса закрывается по таймауту
+  Viewer v;
+  v.fd = connectTo(0);
+  for (uint32_t t = 0; t <= CAMERA_STREAM_STALL_MS + TICK_MS; t += TICK_MS) tick(&v, 1, false);
+  TEST_ASSERT_TRUE(v.closed);
+  TEST_ASSERT_EQUAL_UINT32(0, v.data.size());
+  closeViewer(v);
+}
+
+void test_adapts_to_throughput() {
+  static const char request[] = "GET /api/stream HTTP/1.1\r\n\r\n";
+  Viewer fast;
+  openViewer(fast, request);
+  // Быстрый зритель: частота до предела, разрешение растёт до наибольшего
+  for (int i = 0; i < 3 * CAMERA_ADAPT_INTERVAL / TICK_MS; i++) tick(&fast, 1, true);
+  StreamDemand d = streamer.demand();
+  TEST_ASSERT_EQUAL_UINT8(1, d.clients);
+  TEST_ASSERT_EQUAL_UINT16(CAMERA_MAX_FPS, d.fps);
+  TEST_ASSERT_EQUAL_INT(CAMERA_MAX_SIZE, d.size);
+  closeViewer(fast);
+
+  // Единственный зритель читает 512 байт за шаг (50 КБ/с): кадр идёт
+  // больше полсекунды - частота падает ниже CAMERA_MIN_FPS, разрешение уменьшается
+  Viewer slow;
+  openViewer(slow, request, 4096);
+  for (int i = 0; i < 5 * CAMERA_ADAPT_INTERVAL / TICK_MS; i++) tick(&slow, 1, true, 512);
+  d = streamer.demand();
+  TEST_ASSERT_EQUAL_UINT8(1, d.clients);
+  TEST_ASSERT_LESS_THAN_UINT16(CAMERA_MIN_FPS, d.fps);
+  TEST_ASSERT_LESS_THAN_INT(CAMERA_MAX_SIZE, d.size);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, slow.frames);
+  TEST_ASSERT_EQUAL_UINT32(0, slow.torn);
+  closeViewer(slow);
+
+  for (int i = 0; i < 5; i++) tick(nullptr, 0, false);
+  assertPoolIdle();
+  streamer.end();
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  char root[] = "/tmp/feeder_mjpeg_XXXXXX";
+  if (!mkdtemp(root)) return 1;
+  storageSetRoot(root);
+  storageSetup();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_frame_files);
+  RUN_TEST(test_pool_refcounts);
+  RUN_TEST(test_source_without_frames);
+  RUN_TEST(test_stream_begin);
+  RUN_TEST(test_not_found);
+  RUN_TEST(test_viewers_share_capture);
+  RUN_TEST(test_stalled_request_closed);
+  RUN_TEST(test_adapts_to_throughput);
+  return UNITY_END();
+}
@@ -0,0 +1,252 @@
+/*
+  test_ota.cpp - HTTP OTA: пароль на загрузку, подтверждение и откат прошивки
+
+  Прошивка на заглушках принимает куски POST /api/ota через WebServer.
+  Кусок без пароля (или с неверным) получает 401 и не трогает сессию:
+  ни новую не открывает, ни начатую чужим offset=0 не сбрасывает.
+  Пароль сборки native - OTA_PASSWORD из platformio.ini.
+
+  Подтверждение новой прошивки: вердикты ota_validate.h и путь отметки
+  pending/boots/prev через NVS (заглушка Preferences переживает
+  "перезагрузку" - повторный otaUpdateSetup() в другом разделе). Откат -
+  раздел загрузки hostBoot переключён на prev и вызван ESP.restart().
+*/
+
+#include <unity.h>
+#include <Arduino.h>
+#include <WebServer.h>
+#include <esp_ota_ops.h>
+#include <stdlib.h>
+#include <string.h>
+#include <esp_sntp.h>
+#include <Preferences.h>
+#include "ota_update.h"
+#include "ota_validate.h"
+#include "mqtt_handler.h"
+#include "wifi_manager.h"
+#include "storage.h"
+#include "config.h"
+
+void setup();
+void loop();
+
+extern WebServer server;
+
+#define IMAGE_SIZE 4096
+
+// Начало несжатого образа ESP32 (байт 0xE9); нулей нет - тело заглушки строка
+static const char chunk[] = "\xE9\x05\x02\x20" "firmware-chunk-data";
+#define CHUNK_LEN (sizeof(chunk) - 1)
+
+// Кусок со смещения offset; user/pass == nullptr - без авторизации
+static int postChunk(uint32_t offset, const char* user, const char* pass) {
+  char args[64];
+  snprintf(args, sizeof(args), "offset=%u&size=%u", offset, IMAGE_SIZE);
+  TEST_ASSERT_TRUE(server.hostRequest(HTTP_POST, "/api/ota", args, chunk, user, pass));
+  loop();
+  TEST_ASSERT_FALSE(server.hostPending());
+  return hostResponse.code;
+}
+
+static const esp_partition_t* const app0 = &hostAppPartitions[0];
+static const esp_partition_t* const app1 = &hostAppPartitions[1];
+
+// Перезагрузка в раздел part: отметка читается из NVS заново
+static void rebootInto(const esp_partition_t* part) {
+  hostRunning = part;
+  hostBoot = part;
+  otaUpdateSetup();
+}
+
+// Прошивка из раздела from записала новую и перезагрузилась в неё
+static void installFrom(const esp_partition_t* from) {
+  hostRunning = from;
+  otaMarkPending();
+  rebootInto(esp_ota_get_next_update_partition(nullptr));
+}
+
+static bool nvsPending() {
+  Preferences prefs;
+  prefs.begin("ota", true);
+  bool pending = prefs.getBool("pending", false);
+  prefs.end();
+  return pending;
+}
+
+static uint8_t nvsBoots() {
+  Preferences prefs;
+  prefs.begin("ota", true);
+  uint8_t boots = prefs.getUChar("boots", 0xFF);
+  prefs.end();
+  return boots;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_boot_firmware() {
+  char root[] = "/tmp/feeder_ota_XXXXXX";
+  TEST_ASSERT_NOT_NULL(mkdtemp(root));
+  storageSetRoot(root);
+  setup();
+  for (int i = 0; i < 20; i++) loop();
+  TEST_ASSERT_EQUAL(OTA_IDLE, otaUpdateStatus().state);
+}
+
+void test_unauthenticated_chunk_refused() {
+  TEST_ASSERT_EQUAL_INT(401, postChunk(0, nullptr, nullptr));
+  TEST_ASSERT_EQUAL_INT(401, postChunk(0, WEB_ADMIN_USER, "wrong"));
+  TEST_ASSERT_EQUAL_INT(401, postChunk(0, "root", OTA_PASSWORD));
+  TEST_ASSERT_EQUAL_INT(401, postChunk(0, WEB_ADMIN_USER, ""));
+
+  OtaStatus st = otaUpdateStatus();
+  TEST_ASSERT_EQUAL(OTA_IDLE, st.state);
+  TEST_ASSERT_EQUAL_UINT32(0, st.received);
+  TEST_ASSERT_EQUAL_UINT32(0, hostOtaWritten);
+}
+
+void test_authenticated_chunk_accepted() {
+  TEST_ASSERT_EQUAL_INT(200, postChunk(0, WEB_ADMIN_USER, OTA_PASSWORD));
+  OtaStatus st = otaUpdateStatus();
+  TEST_ASSERT_EQUAL(OTA_RECEIVING, st.state);
+  TEST_ASSERT_EQUAL_UINT32(CHUNK_LEN, st.received);
+  TEST_ASSERT_EQUAL_UINT32(CHUNK_LEN, hostOtaWritten);
+}
+
+// Начатую передачу чужой кусок не сбрасывает и не продолжает
+void test_unauthenticated_chunk_keeps_session() {
+  TEST_ASSERT_EQUAL_INT(401, postChunk(0, nullptr, nullptr));
+  TEST_ASSERT_EQUAL_INT(401, postChunk(CHUNK_LEN, nullptr, nullptr));
+  OtaStatus st = otaUpdateStatus();
+  TEST_ASSERT_EQUAL(OTA_RECEIVING, st.state);
+  TEST_ASSERT_EQUAL_UINT32(CHUNK_LEN, st.received);
+
+  // Состояние можно читать без пароля, продолжение - с паролем
+  server.hostRequest(HTTP_GET, "/api/ota");
+  loop();
+  TEST_ASSERT_EQUAL_INT(200, hostResponse.code);
+  TEST_ASSERT_NOT_NULL(strstr(hostResponse.body, "\"state\":\"receiving\""));
+  TEST_ASSERT_EQUAL_INT(200, postChunk(CHUNK_LEN, WEB_ADMIN_USER, OTA_PASSWORD));
+  TEST_ASSERT_EQUAL_UINT32(2 * CHUNK_LEN, otaUpdateStatus().received);
+}
+
+void test_validate_verdicts() {
+  const uint32_t timeout = OTA_VALIDATE_TIMEOUT;
+  const OtaSelfTest all = {true, true, true};
+  TEST_ASSERT_EQUAL(OTA_VERDICT_VALID, otaValidate(all, 0, timeout));
+  TEST_ASSERT_EQUAL(OTA_VERDICT_VALID, otaValidate(all, timeout, timeout));
+  TEST_ASSERT_EQUAL(OTA_VERDICT_VALID, otaValidate(all, UINT32_MAX, timeout));
+
+  // Любая непройденная проверка: ждать до таймаута, затем откат
+  for (int mask = 0; mask < 7; mask++) {
+    OtaSelfTest t = {(mask & 1) != 0, (mask & 2) != 0, (mask & 4) != 0};
+    TEST_ASSERT_EQUAL(OTA_VERDICT_WAIT, otaValidate(t, 0, timeout));
+    TEST_ASSERT_EQUAL(OTA_VERDICT_WAIT, otaValidate(t, timeout - 1, timeout));
+    TEST_ASSERT_EQUAL(OTA_VERDICT_ROLLBACK, otaValidate(t, timeout, timeout));
+    TEST_ASSERT_EQUAL(OTA_VERDICT_ROLLBACK, otaValidate(t, UINT32_MAX, timeout));
+  }
+}
+
+void test_boots_exhausted() {
+  for (uint8_t boots = 1; boots <= OTA_MAX_BOOT_ATTEMPTS; boots++) {
+    TEST_ASSERT_FALSE(otaBootsExhausted(boots, OTA_MAX_BOOT_ATTEMPTS));
+  }
+  TEST_ASSERT_TRUE(otaBootsExhausted(OTA_MAX_BOOT_ATTEMPTS + 1, OTA_MAX_BOOT_ATTEMPTS));
+  TEST_ASSERT_TRUE(otaBootsExhausted(255, OTA_MAX_BOOT_ATTEMPTS));
+}
+
+// Отметка переживает перезагрузки; после OTA_MAX_BOOT_ATTEMPTS загрузок
+// без подтверждения - откат на prev
+void test_pending_survives_reboots_until_exhausted() {
+  uint32_t restarts = hostRestarts;
+  hostRunning = app0;
+  otaMarkPending();
+  TEST_ASSERT_TRUE(nvsPending());
+  TEST_ASSERT_EQUAL_UINT8(0, nvsBoots());
+  Preferences prefs;
+  char prev[17] = "";
+  prefs.begin("ota", true);
+  prefs.getString("prev", prev, sizeof(prev));
+  prefs.end();
+  TEST_ASSERT_EQUAL_STRING("app0", prev);
+
+  for (uint8_t boot = 1; boot <= OTA_MAX_BOOT_ATTEMPTS; boot++) {
+    rebootInto(app1);
+    TEST_ASSERT_TRUE(otaUpdateStatus().validating);
+    TEST_ASSERT_TRUE(nvsPending());
+    TEST_ASSERT_EQUAL_UINT8(boot, nvsBoots());
+    TEST_ASSERT_EQUAL_PTR(app1, hostBoot);
+    TEST_ASSERT_EQUAL_UINT32(restarts, hostRestarts);
+  }
+
+  rebootInto(app1);
+  TEST_ASSERT_EQUAL_PTR(app0, hostBoot);
+  TEST_ASSERT_EQUAL_UINT32(restarts + 1, hostRestarts);
+  TEST_ASSERT_FALSE(nvsPending());
+  TEST_ASSERT_FALSE(otaUpdateStatus().validating);
+
+  // Прошлая прошивка загружается без проверок
+  rebootInto(app0);
+  TEST_ASSERT_FALSE(otaUpdateStatus().validating);
+  TEST_ASSERT_EQUAL_UINT32(restarts + 1, hostRestarts);
+}
+
+// Самопроверки не прошли за OTA_VALIDATE_TIMEOUT - откат
+void test_timeout_rolls_back() {
+  uint32_t restarts = hostRestarts;
+  installFrom(app0);
+  TEST_ASSERT_TRUE(otaUpdateStatus().validating);
+
+  mqttConnected = false;
+  hostAdvance(OTA_VALIDATE_TIMEOUT - 1);
+  otaUpdateLoop();
+  TEST_ASSERT_TRUE(otaUpdateStatus().validating);
+  TEST_ASSERT_EQUAL_UINT32(restarts, hostRestarts);
+
+  hostAdvance(1);
+  otaUpdateLoop();
+  TEST_ASSERT_FALSE(otaUpdateStatus().validating);
+  TEST_ASSERT_EQUAL_UINT32(restarts + 1, hostRestarts);
+  TEST_ASSERT_EQUAL_PTR(app0, hostBoot);
+  TEST_ASSERT_FALSE(nvsPending());
+}
+
+// WiFi, MQTT и NTP есть - прошивка подтверждена и остаётся после перезагрузки
+void test_self_tests_pass_confirms() {
+  uint32_t restarts = hostRestarts;
+  rebootInto(app0);
+  hostNtpSync(1760000000);
+  for (int i = 0; i < 2000 && !mqttConnected; i++) loop();
+  TEST_ASSERT_TRUE(wifiLinkUp());
+  TEST_ASSERT_TRUE(mqttConnected);
+
+  installFrom(app0);
+  TEST_ASSERT_TRUE(otaUpdateStatus().validating);
+  otaUpdateLoop();
+  TEST_ASSERT_FALSE(otaUpdateStatus().validating);
+  TEST_ASSERT_FALSE(nvsPending());
+  TEST_ASSERT_EQUAL_PTR(app1, hostBoot);
+
+  hostAdvance(OTA_VALIDATE_TIMEOUT);
+  otaUpdateLoop();
+  rebootInto(app1);
+  TEST_ASSERT_FALSE(otaUpdateStatus().validating);
+  TEST_ASSERT_EQUAL_PTR(app1, hostBoot);
+  TEST_ASSERT_EQUAL_UINT32(restarts, hostRestarts);
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_boot_firmware);
+  RUN_TEST(test_unauthenticated_chunk_refused);
+  RUN_TEST(test_authenticated_chunk_accepted);
+  RUN_TEST(test_unauthenticated_chunk_keeps_session);
+  RUN_TEST(test_validate_verdicts);
+  RUN_TEST(test_boots_exhausted);
+  RUN_TEST(test_pending_survives_reboots_until_exhausted);
+  RUN_TEST(test_timeout_rolls_back);
+  RUN_TEST(test_self_tests_pass_confirms);
+  return UNITY_END();
+}
@@ -0,0 +1,98 @@
+/*
+  fixtures.h - Сцены у миски для test_presence_detect
+
+  Записей с камеры в репозитории нет, поэтому кадры PRESENCE_W x PRESENCE_H
+  синтезируются детерминированно: фон с градиентом и текстурой (пол, миска),
+  шум сенсора +-3, кот - текстурное пятно 24x16, свет - сдвиг яркости всего
+  кадра. Сцена задаётся отрезками по PRESENCE_FPS кадров в секунду; каждый
+  кадр воспроизводится по номеру, так что тест и бенчмарк видят одни и те
+  же кадры.
+*/
+
+#ifndef TEST_PRESENCE_FIXTURES_H
+#define TEST_PRESENCE_FIXTURES_H
+
+#include <stdint.h>
+#include <string.h>
+#include "config.h"
+
+#define FRAME_PIXELS (PRESENCE_W * PRESENCE_H)
+#define FRAME_MS (1000 / PRESENCE_FPS)
+
+// Отрезок сцены: кот (from -> to за отрезок), свет (from -> to), сдвинутая миска
+struct SceneSegment {
+  const char* name;
+  uint16_t frames;
+  bool cat;
+  int8_t catFromX, catToX;   // Левый край кота; отрицательный - за кадром
+  int8_t catY;
+  int16_t lightFrom, lightTo;
+  bool bowlMoved;
+  int8_t catSize;            // 0 - полный кот (24x16), иначе квадрат catSize
+};
+
+static inline uint8_t clampPixel(int v) {
+  return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+static inline uint32_t fixtureNoise(uint32_t& seed) {
+  seed = seed * 1103515245u + 12345u;
+  return seed >> 16;
+}
+
+// Кадр frame отрезка seg
+static void renderFrame(const SceneSegment& seg, uint16_t frame, uint32_t seed, uint8_t* out) {
+  int span = seg.frames > 1 ? seg.frames - 1 : 1;
+  int light = seg.lightFrom + (seg.lightTo - seg.lightFrom) * frame / span;
+  int catX = seg.catFromX + (seg.catToX - seg.catFromX) * frame / span;
+  int catW = seg.catSize ? seg.catSize : 24;
+  int catH = seg.catSize ? seg.catSize : 16;
+
+  for (int y = 0; y < PRESENCE_H; y++) {
+    for (int x = 0; x < PRESENCE_W; x++) {
+      int v = 50 + x + y / 2 + (((x * 7) ^ (y * 13)) & 15);
+      // Миска: светлое кольцо; сдвинутая - на другом месте
+      int bx = seg.bowlMoved ? 16 : 48;
+      int dx = x - bx - 8, dy = y - 36;
+      if (dx * dx + dy * dy < 100) v = 170 + ((x + y) & 7);
+      if (seg.cat && x >= catX && x < catX + catW && y >= seg.catY && y < seg.catY + catH) {
+        // Полосатая шерсть, чуть колышется от кадра к кадру
+        v = 25 + (((x + frame) / 3 + y) % 4) * 20;
+      }
+      out[y * PRESENCE_W + x] = clampPixel(v + light + (int)(fixtureNoise(seed) % 7) - 3);
+    }
+  }
+}
+
+// Кормление: пусто, кот подходит и ест, уходит
+static const SceneSegment FEEDING[] = {
+  {"пусто", 40, false, 0, 0, 0, 0, 0, false, 0},
+  {"подходит", 8, true, -24, 40, 28, 0, 0, false, 0},
+  {"ест", 80, true, 40, 44, 28, 0, 0, false, 0},
+  {"уходит", 8, true, 44, 80, 28, 0, 0, false, 0},
+  {"пусто", 60, false, 0, 0, 0, 0, 0, false, 0},
+};
+
+// Свет: плавный закат, затем резко включили лампу
+static const SceneSegment LIGHTING[] = {
+  {"пусто", 20, false, 0, 0, 0, 0, 0, false, 0},
+  {"закат", 240, false, 0, 0, 0, 0, -60, false, 0},
+  {"сумерки", 20, false, 0, 0, 0, -60, -60, false, 0},
+  {"лампа", 40, false, 0, 0, 0, 40, 40, false, 0},
+};
+
+// Мелочь у миски (хвост, муха) - один блок, не кот
+static const SceneSegment SMALL[] = {
+  {"пусто", 20, false, 0, 0, 0, 0, 0, false, 0},
+  {"хвост", 60, true, 8, 12, 8, 0, 0, false, 8},
+};
+
+// Миску сдвинули: отличие держится дольше PRESENCE_RELEARN_MS
+static const SceneSegment BOWL[] = {
+  {"пусто", 20, false, 0, 0, 0, 0, 0, false, 0},
+  {"сдвинута", PRESENCE_RELEARN_MS / FRAME_MS + 40, false, 0, 0, 0, 0, 0, true, 0},
+};
+
+#define SCENE_LEN(s) (sizeof(s) / sizeof((s)[0]))
+
+#endif // TEST_PRESENCE_FIXTURES_H
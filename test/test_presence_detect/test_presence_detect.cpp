@@ -0,0 +1,257 @@
+/*
+  test_presence_detect.cpp - Детектор кота у миски и его ядра
+
+  Упакованные ядра (четыре пикселя в 32-битном слове) сверяются со
+  скалярными эталонами: SAD - на случайных и крайних кадрах всех ширин,
+  подтягивание фона - на всех парах байт для каждого сдвига. Детектор
+  прогоняется по сценам из fixtures.h: кормление, закат и лампа, мелкое
+  движение, сдвинутая миска.
+
+  Бенчмарк (test_benchmark) печатает время ядер и полного update() на
+  кадр по сцене кормления - упакованных и эталонных. На хосте это только
+  сравнение версий между собой: бюджет PRESENCE_CPU_PERCENT считается
+  для ESP32, где задача детектора сама замеряет своё время.
+*/
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "presence_detect.h"
+#include "fixtures.h"
+
+#define MAX_FRAMES 4096
+
+static uint8_t frameA[FRAME_PIXELS + 4];
+static uint8_t frameB[FRAME_PIXELS + 4];
+static bool presentLog[PRESENCE_RELEARN_MS / FRAME_MS + 100];
+
+static uint32_t rnd = 1;
+static uint32_t next(uint32_t n) {
+  rnd = rnd * 1103515245u + 12345u;
+  return (rnd >> 8) % n;
+}
+
+// Прогон сцены: состояние после каждого кадра в presentLog
+static size_t playScene(PresenceDetector& det, const SceneSegment* scene, size_t segments, uint32_t& now) {
+  size_t n = 0;
+  uint32_t seed = 7;
+  for (size_t s = 0; s < segments; s++) {
+    for (uint16_t f = 0; f < scene[s].frames; f++) {
+      renderFrame(scene[s], f, seed++, frameA);
+      now += FRAME_MS;
+      TEST_ASSERT_LESS_THAN(sizeof(presentLog), n);
+      presentLog[n++] = det.update(frameA, now);
+    }
+  }
+  return n;
+}
+
+static size_t segmentStart(const SceneSegment* scene, size_t index) {
+  size_t start = 0;
+  for (size_t s = 0; s < index; s++) start += scene[s].frames;
+  return start;
+}
+
+// Первый кадр в [from, to) с состоянием state (-1 - нет)
+static int findState(size_t from, size_t to, bool state) {
+  for (size_t i = from; i < to; i++) {
+    if (presentLog[i] == state) return i;
+  }
+  return -1;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_sad_matches_reference() {
+  uint16_t ref[(PRESENCE_W / 8) * (PRESENCE_H / 8)];
+  uint16_t out[(PRESENCE_W / 8) * (PRESENCE_H / 8)];
+
+  // Крайние значения: максимум SAD блока 64 * 255
+  memset(frameA, 0, sizeof(frameA));
+  memset(frameB, 255, sizeof(frameB));
+  presenceSad(frameA, frameB, PRESENCE_W, PRESENCE_H, out);
+  presenceSad(frameB, frameA, PRESENCE_W, PRESENCE_H, ref);
+  for (size_t i = 0; i < sizeof(out) / sizeof(out[0]); i++) {
+    TEST_ASSERT_EQUAL_UINT16(64 * 255, out[i]);
+    TEST_ASSERT_EQUAL_UINT16(64 * 255, ref[i]);
+  }
+
+  // Случайные кадры всех ширин и высот, в том числе невыровненные
+  for (int iter = 0; iter < 2000; iter++) {
+    uint16_t w = 8 * (1 + next(PRESENCE_W / 8));
+    uint16_t h = 1 + next(PRESENCE_H);
+    size_t offA = next(4), offB = next(4);
+    uint8_t* a = frameA + offA;
+    uint8_t* b = frameB + offB;
+    uint32_t mode = next(3);
+    for (size_t i = 0; i < (size_t)w * h; i++) {
+      a[i] = next(256);
+      // Близкие кадры, случайные и крайние
+      b[i] = mode == 0 ? clampPixel(a[i] + (int)next(9) - 4) : mode == 1 ? next(256) : (next(2) ? 0 : 255);
+    }
+    size_t blocks = (w / 8) * (h / 8);
+    memset(ref, 0xAA, sizeof(ref));
+    memset(out, 0x55, sizeof(out));
+    presenceSadRef(a, b, w, h, ref);
+    presenceSad(a, b, w, h, out);
+    TEST_ASSERT_EQUAL_MEMORY(ref, out, blocks * sizeof(uint16_t));
+    // За пределами блоков кадра ничего не пишется
+    if (blocks < sizeof(out) / sizeof(out[0])) TEST_ASSERT_EQUAL_UINT16(0x5555, out[blocks]);
+  }
+}
+
+void test_blend_matches_reference() {
+  // Все пары (фон, кадр) для каждого сдвига
+  static uint8_t bgRef[65536], bgOut[65536], cur[65536];
+  for (uint8_t shift = 1; shift <= 7; shift++) {
+    for (size_t i = 0; i < 65536; i++) {
+      bgRef[i] = bgOut[i] = i >> 8;
+      cur[i] = i & 0xFF;
+    }
+    presenceBlendRef(bgRef, cur, sizeof(cur), shift);
+    presenceBlend(bgOut, cur, sizeof(cur), shift);
+    TEST_ASSERT_EQUAL_MEMORY(bgRef, bgOut, sizeof(bgRef));
+
+    // Фон сдвигается к кадру, но не проскакивает его
+    for (size_t i = 0; i < 65536; i++) {
+      int b = i >> 8, c = i & 0xFF, v = bgRef[i];
+      TEST_ASSERT_TRUE(b <= c ? (v >= b && v <= c) : (v <= b && v >= c));
+    }
+  }
+}
+
+void test_feeding_scene() {
+  static PresenceDetector det;
+  TEST_ASSERT_TRUE(det.begin(PRESENCE_W, PRESENCE_H));
+  TEST_ASSERT_EQUAL_UINT16((PRESENCE_W / 8) * (PRESENCE_H / 8), det.blocks());
+  uint32_t now = 0;
+  size_t n = playScene(det, FEEDING, SCENE_LEN(FEEDING), now);
+
+  size_t approach = segmentStart(FEEDING, 1);
+  size_t eating = segmentStart(FEEDING, 2);
+  size_t leaving = segmentStart(FEEDING, 3);
+  size_t gone = segmentStart(FEEDING, 4);
+
+  TEST_ASSERT_EQUAL_INT_MESSAGE(-1, findState(0, approach, true), "Кот в пустой сцене");
+  // Кот есть не раньше PRESENCE_ON_FRAMES кадров с движением и до того, как сел есть
+  int presentAt = findState(approach, n, true);
+  TEST_ASSERT_GREATER_OR_EQUAL((int)approach + PRESENCE_ON_FRAMES - 1, presentAt);
+  TEST_ASSERT_LESS_OR_EQUAL((int)eating, presentAt);
+  TEST_ASSERT_EQUAL_INT_MESSAGE(-1, findState(presentAt, gone, false), "Кот пропал во время еды");
+
+  // Ушёл: "кота нет" через PRESENCE_OFF_MS после последнего движения
+  int absentAt = findState(gone, n, false);
+  TEST_ASSERT_GREATER_OR_EQUAL((int)leaving + PRESENCE_OFF_MS / FRAME_MS, absentAt);
+  TEST_ASSERT_LESS_OR_EQUAL((int)gone + PRESENCE_OFF_MS / FRAME_MS + 1, absentAt);
+  TEST_ASSERT_EQUAL_INT(-1, findState(absentAt, n, true));
+  TEST_ASSERT_EQUAL_UINT32(1, det.relearns());
+}
+
+void test_lighting_scene() {
+  static PresenceDetector det;
+  TEST_ASSERT_TRUE(det.begin(PRESENCE_W, PRESENCE_H));
+  uint32_t now = 0;
+  size_t n = playScene(det, LIGHTING, SCENE_LEN(LIGHTING), now);
+  TEST_ASSERT_EQUAL_INT_MESSAGE(-1, findState(0, n, true), "Свет принят за кота");
+  // Закат догоняется фоном, лампа переучивает его один раз
+  TEST_ASSERT_EQUAL_UINT32(2, det.relearns());
+}
+
+void test_small_motion_ignored() {
+  static PresenceDetector det;
+  TEST_ASSERT_TRUE(det.begin(PRESENCE_W, PRESENCE_H));
+  uint32_t now = 0;
+  size_t n = playScene(det, SMALL, SCENE_LEN(SMALL), now);
+  TEST_ASSERT_EQUAL_INT_MESSAGE(-1, findState(0, n, true), "Мелкое движение принято за кота");
+  TEST_ASSERT_LESS_THAN(PRESENCE_MIN_BLOCKS, det.activeBlocks());
+}
+
+void test_moved_bowl_relearned() {
+  static PresenceDetector det;
+  TEST_ASSERT_TRUE(det.begin(PRESENCE_W, PRESENCE_H));
+  uint32_t now = 0;
+  size_t n = playScene(det, BOWL, SCENE_LEN(BOWL), now);
+  // Сначала сдвинутая миска похожа на кота, через PRESENCE_RELEARN_MS
+  // она становится фоном
+  size_t moved = segmentStart(BOWL, 1);
+  int presentAt = findState(moved, n, true);
+  TEST_ASSERT_GREATER_OR_EQUAL(0, presentAt);
+  int relearnAt = findState(presentAt, n, false);
+  TEST_ASSERT_GREATER_OR_EQUAL(presentAt + PRESENCE_RELEARN_MS / FRAME_MS - 1, relearnAt);
+  TEST_ASSERT_LESS_OR_EQUAL(presentAt + PRESENCE_RELEARN_MS / FRAME_MS + 1, relearnAt);
+  TEST_ASSERT_EQUAL_INT(-1, findState(relearnAt, n, true));
+  TEST_ASSERT_EQUAL_UINT32(2, det.relearns());
+}
+
+static double elapsedUs(const timespec& from) {
+  timespec to;
+  clock_gettime(CLOCK_MONOTONIC, &to);
+  return (to.tv_sec - from.tv_sec) * 1e6 + (to.tv_nsec - from.tv_nsec) / 1e3;
+}
+
+void test_benchmark() {
+  // Кадры сцены кормления заранее, чтобы мерить только ядра
+  static uint8_t frames[MAX_FRAMES][FRAME_PIXELS];
+  size_t n = 0;
+  uint32_t seed = 7;
+  for (size_t s = 0; s < SCENE_LEN(FEEDING); s++) {
+    for (uint16_t f = 0; f < FEEDING[s].frames; f++) renderFrame(FEEDING[s], f, seed++, frames[n++]);
+  }
+
+  static uint8_t bg[FRAME_PIXELS];
+  uint16_t sad[(PRESENCE_W / 8) * (PRESENCE_H / 8)];
+  const int rounds = 50;
+  volatile uint32_t sink = 0;
+  timespec start;
+
+  double us[4];
+  for (int kernel = 0; kernel < 4; kernel++) {
+    memcpy(bg, frames[0], sizeof(bg));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < rounds; r++) {
+      for (size_t i = 0; i < n; i++) {
+        switch (kernel) {
+          case 0: presenceSad(frames[i], bg, PRESENCE_W, PRESENCE_H, sad); break;
+          case 1: presenceSadRef(frames[i], bg, PRESENCE_W, PRESENCE_H, sad); break;
+          case 2: presenceBlend(bg, frames[i], FRAME_PIXELS, PRESENCE_BG_SHIFT); break;
+          case 3: presenceBlendRef(bg, frames[i], FRAME_PIXELS, PRESENCE_BG_SHIFT); break;
+        }
+        sink += sad[0] + bg[0];
+      }
+    }
+    us[kernel] = elapsedUs(start) / (rounds * n);
+  }
+
+  static PresenceDetector det;
+  TEST_ASSERT_TRUE(det.begin(PRESENCE_W, PRESENCE_H));
+  uint32_t now = 0;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < n; i++) sink += det.update(frames[i], now += FRAME_MS);
+  }
+  double update = elapsedUs(start) / (rounds * n);
+  (void)sink;
+
+  printf("presence_detect %dx%d, %u кадров x %d:\n", PRESENCE_W, PRESENCE_H, (unsigned)n, rounds);
+  printf("  SAD    %.2f мкс/кадр (эталон %.2f, x%.1f)\n", us[0], us[1], us[1] / us[0]);
+  printf("  фон    %.2f мкс/кадр (эталон %.2f, x%.1f)\n", us[2], us[3], us[3] / us[2]);
+  printf("  update %.2f мкс/кадр\n", update);
+  TEST_ASSERT_GREATER_THAN(0, det.relearns());
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_sad_matches_reference);
+  RUN_TEST(test_blend_matches_reference);
+  RUN_TEST(test_feeding_scene);
+  RUN_TEST(test_lighting_scene);
+  RUN_TEST(test_small_motion_ignored);
+  RUN_TEST(test_moved_bowl_relearned);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
@@ -0,0 +1,194 @@
+/*
+  test_settings_json.cpp - Поля настроек в документе настроек и дельте тени
+
+  Порции и расписания разбираются общим кодом settings_json.cpp: одна и та
+  же ошибка в документе (provisioning.h) и в дельте (shadow.h) даёт один и
+  тот же текст, ни один из разборщиков ничего не применяет. Различаются
+  они только неизвестными полями расписания: документ их пропускает,
+  дельта отклоняет (опечатка не должна тихо пропасть).
+*/
+
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "settings_json.h"
+#include "provisioning.h"
+#include "shadow.h"
+#include "schedule.h"
+#include "feeder.h"
+#include "storage.h"
+#include "config.h"
+
+void setup();
+void loop();
+
+static char error[SETTINGS_ERROR_LEN];
+
+void setUp() {
+  error[0] = '\0';
+}
+void tearDown() {}
+
+static ProvisionResult provision(const char* doc) {
+  provisionBegin("test", PROV_ALLOW_LOCAL);
+  provisionFeed(doc, strlen(doc));
+  return provisionEnd();
+}
+
+// Дельта тени на текущей версии: {"version":N,"state":{...}}
+static ShadowResult desired(const char* state) {
+  char doc[256];
+  int n = snprintf(doc, sizeof(doc), "{\"version\":%u,\"state\":%s}", shadowVersion(), state);
+  return shadowApplyDesired(doc, n, "test");
+}
+
+static bool sameSchedules(const Schedule* a, const Schedule* b) {
+  for (int i = 0; i < MAX_SCHEDULES; i++) {
+    if (a[i].hour != b[i].hour || a[i].minute != b[i].minute || a[i].amount != b[i].amount ||
+        a[i].auger != b[i].auger || a[i].enabled != b[i].enabled) return false;
+  }
+  return true;
+}
+
+void test_boot_firmware() {
+  char root[] = "/tmp/feeder_settings_XXXXXX";
+  TEST_ASSERT_NOT_NULL(mkdtemp(root));
+  storageSetRoot(root);
+  setup();
+  for (int i = 0; i < 20; i++) loop();
+}
+
+void test_schedule_field_ranges() {
+  Schedule s = {};
+  TEST_ASSERT_TRUE(settingsScheduleField(error, s, "hour", JSON_NUMBER, "23"));
+  TEST_ASSERT_TRUE(settingsScheduleField(error, s, "minute", JSON_NUMBER, "0"));
+  TEST_ASSERT_TRUE(settingsScheduleField(error, s, "auger", JSON_NUMBER, "1"));
+  TEST_ASSERT_TRUE(settingsScheduleField(error, s, "enabled", JSON_TRUE, ""));
+  char amount[8];
+  snprintf(amount, sizeof(amount), "%d", PROV_MAX_AMOUNT);
+  TEST_ASSERT_TRUE(settingsScheduleField(error, s, "amount", JSON_NUMBER, amount));
+  TEST_ASSERT_EQUAL_STRING("", error);
+  TEST_ASSERT_EQUAL_UINT8(23, s.hour);
+  TEST_ASSERT_EQUAL_UINT8(0, s.auger);
+  TEST_ASSERT_EQUAL_INT(PROV_MAX_AMOUNT, s.amount);
+  TEST_ASSERT_TRUE(s.enabled);
+
+  static const struct {
+    const char* key;
+    JsonType type;
+    const char* text;
+    const char* error;
+  } bad[] = {
+    {"hour", JSON_NUMBER, "24", "hour: out of range"},
+    {"minute", JSON_NUMBER, "-1", "minute: out of range"},
+    {"minute", JSON_NUMBER, "1.5", "minute: expected integer"},
+    {"amount", JSON_NUMBER, "0", "amount: out of range"},
+    {"amount", JSON_STRING, "5", "amount: expected integer"},
+    {"auger", JSON_NUMBER, "0", "auger: out of range"},
+    {"enabled", JSON_NUMBER, "1", "enabled: expected boolean"},
+  };
+  for (const auto& b : bad) {
+    Schedule before = s;
+    error[0] = '\0';
+    TEST_ASSERT_TRUE(settingsScheduleField(error, s, b.key, b.type, b.text));
+    TEST_ASSERT_EQUAL_STRING(b.error, error);
+    TEST_ASSERT_EQUAL_MEMORY(&before, &s, sizeof(s));
+  }
+
+  // Первая ошибка не перетирается
+  settingsScheduleField(error, s, "hour", JSON_NUMBER, "99");
+  TEST_ASSERT_EQUAL_STRING("enabled: expected boolean", error);
+
+  error[0] = '\0';
+  TEST_ASSERT_FALSE(settingsScheduleField(error, s, "hours", JSON_NUMBER, "8"));
+  TEST_ASSERT_EQUAL_STRING("", error);
+}
+
+// Одинаковая ошибка - одинаковый ответ обоих разборщиков, настройки не меняются
+void test_same_errors_in_document_and_delta() {
+  static const struct {
+    const char* document;
+    const char* state;
+    const char* error;
+  } cases[] = {
+    {"{\"schedules\":[{\"hour\":24}]}", "{\"schedules\":[{\"hour\":24}]}", "hour: out of range"},
+    {"{\"schedules\":[{\"minute\":60}]}", "{\"schedules\":[{\"minute\":60}]}", "minute: out of range"},
+    {"{\"schedules\":[{\"amount\":201}]}", "{\"schedules\":[{\"amount\":201}]}", "amount: out of range"},
+    {"{\"schedules\":[{\"auger\":9}]}", "{\"schedules\":[{\"auger\":9}]}", "auger: out of range"},
+    {"{\"schedules\":[{\"enabled\":1}]}", "{\"schedules\":[{\"enabled\":1}]}", "enabled: expected boolean"},
+    {"{\"feedAmount\":0}", "{\"feedAmount\":0}", "feedAmount: out of range"},
+    {"{\"feedAmount\":[\"5\"]}", "{\"feedAmount\":[\"5\"]}", "feedAmount: expected integer"},
+  };
+  static_assert(PROV_MAX_AMOUNT == 200, "amount cases assume PROV_MAX_AMOUNT 200");
+
+  Schedule saved[MAX_SCHEDULES];
+  int amounts[NUM_AUGERS];
+  for (const auto& c : cases) {
+    memcpy(saved, schedules, sizeof(saved));
+    memcpy(amounts, feedAmount, sizeof(amounts));
+    uint32_t version = shadowVersion();
+
+    ProvisionResult p = provision(c.document);
+    TEST_ASSERT_FALSE_MESSAGE(p.ok, c.document);
+    TEST_ASSERT_EQUAL_STRING(c.error, p.error);
+
+    ShadowResult s = desired(c.state);
+    TEST_ASSERT_FALSE_MESSAGE(s.ok, c.state);
+    TEST_ASSERT_EQUAL_STRING(c.error, s.error);
+
+    TEST_ASSERT_TRUE(sameSchedules(saved, schedules));
+    TEST_ASSERT_EQUAL_MEMORY(amounts, feedAmount, sizeof(amounts));
+    TEST_ASSERT_EQUAL_UINT32(version, shadowVersion());
+  }
+}
+
+void test_valid_schedule_applies_through_both() {
+  ProvisionResult p = provision("{\"schedules\":[{\"hour\":7,\"minute\":30,\"amount\":12,\"auger\":1}]}");
+  TEST_ASSERT_TRUE(p.ok);
+  TEST_ASSERT_EQUAL_UINT8(7, schedules[0].hour);
+  TEST_ASSERT_EQUAL_UINT8(30, schedules[0].minute);
+  TEST_ASSERT_EQUAL_INT(12, schedules[0].amount);
+  TEST_ASSERT_TRUE(schedules[0].enabled);
+  TEST_ASSERT_FALSE(schedules[1].enabled);
+
+  // Тень видит изменение на следующей проверке
+  for (int i = 0; i < 20; i++) {
+    delay(SHADOW_CHECK_INTERVAL);
+    loop();
+  }
+  ShadowResult s = desired("{\"schedules\":[{\"hour\":8,\"amount\":15}]}");
+  TEST_ASSERT_TRUE_MESSAGE(s.ok, s.error);
+  TEST_ASSERT_EQUAL_UINT8(8, schedules[0].hour);
+  TEST_ASSERT_EQUAL_UINT8(30, schedules[0].minute);
+  TEST_ASSERT_EQUAL_INT(15, schedules[0].amount);
+}
+
+// Неизвестное поле расписания: документ пропускает, дельта отклоняет
+void test_unknown_schedule_field() {
+  ProvisionResult p = provision("{\"schedules\":[{\"hour\":9,\"note\":\"утро\"}]}");
+  TEST_ASSERT_TRUE(p.ok);
+  TEST_ASSERT_EQUAL_UINT8(9, schedules[0].hour);
+
+  for (int i = 0; i < 20; i++) {
+    delay(SHADOW_CHECK_INTERVAL);
+    loop();
+  }
+  ShadowResult s = desired("{\"schedules\":[{\"hours\":10}]}");
+  TEST_ASSERT_FALSE(s.ok);
+  TEST_ASSERT_EQUAL_STRING("hours: unknown field", s.error);
+  TEST_ASSERT_EQUAL_UINT8(9, schedules[0].hour);
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_boot_firmware);
+  RUN_TEST(test_schedule_field_ranges);
+  RUN_TEST(test_same_errors_in_document_and_delta);
+  RUN_TEST(test_valid_schedule_applies_through_both);
+  RUN_TEST(test_unknown_schedule_field);
+  return UNITY_END();
+}
@@ -0,0 +1,453 @@
+/*
+  test_telemetry.cpp - CBOR событий и телеметрии: кодирование, размер, разбор
+
+  CborWriter сверяется с примерами RFC 8949 (приложение A) и крайними
+  значениями каждой длины аргумента; переполнение проверяется на всех
+  размерах буфера с охранными байтами за его концом. Сообщения telemetry.h
+  разбираются обратно небольшим декодером ниже (то же подмножество CBOR,
+  что читает tools/telemetry_decode.py) и не превышают TELEMETRY_MAX_LEN
+  на крайних значениях.
+
+  Прошивка на заглушках публикует кормление и метрики: CBOR из топиков
+  events/telemetry сверяется по полям с JSON для Home Assistant.
+  test_benchmark печатает размер и время кодирования обоих форматов.
+*/
+
+#include <unity.h>
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <WiFi.h>
+#include <esp_sntp.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cbor_writer.h"
+#include "telemetry.h"
+#include "device_id.h"
+#include "mqtt_handler.h"
+#include "storage.h"
+#include "time_service.h"
+#include "config.h"
+
+void setup();
+void loop();
+
+#define GUARD 0xA5
+
+// ==================== ДЕКОДЕР ====================
+// Значение CBOR из сообщений кормушки: целое, строка, bool/null, тег 1
+struct CborValue {
+  uint8_t major;      // 0, 1 - целые, 3 - строка, 5 - карта, 7 - простые
+  bool epochTag;      // Под тегом 1
+  uint64_t arg;
+  int64_t i;          // Значение целого
+  const uint8_t* str;
+};
+
+static bool readHead(const uint8_t*& p, const uint8_t* end, uint8_t& major, uint64_t& arg) {
+  if (p >= end) return false;
+  major = *p >> 5;
+  uint8_t info = *p++ & 0x1F;
+  if (info < 24) {
+    arg = info;
+    return true;
+  }
+  if (info > 27) return false;
+  size_t n = (size_t)1 << (info - 24);
+  if ((size_t)(end - p) < n) return false;
+  arg = 0;
+  for (size_t k = 0; k < n; k++) arg = (arg << 8) | *p++;
+  // Кратчайшая форма: писатель не тратит лишних байт
+  uint64_t min = info == 24 ? 24 : info == 25 ? 0x100 : info == 26 ? 0x10000 : 0x100000000ull;
+  return arg >= min;
+}
+
+static bool readValue(const uint8_t*& p, const uint8_t* end, CborValue& v) {
+  v = CborValue();
+  if (!readHead(p, end, v.major, v.arg)) return false;
+  if (v.major == 6) {
+    if (v.arg != 1) return false;
+    v.epochTag = true;
+    if (!readHead(p, end, v.major, v.arg) || v.major != 0) return false;
+  }
+  switch (v.major) {
+    case 0: v.i = (int64_t)v.arg; return v.arg <= INT64_MAX;
+    case 1: v.i = -1 - (int64_t)v.arg; return v.arg <= INT64_MAX;
+    case 3:
+      if ((uint64_t)(end - p) < v.arg) return false;
+      v.str = p;
+      p += v.arg;
+      return true;
+    case 7: return v.arg >= 20 && v.arg <= 22;
+    default: return false;
+  }
+}
+
+// Сообщение: карта целых ключей без повторов, разобранная до конца
+struct Message {
+  bool has[32];
+  CborValue v[32];
+  size_t pairs;
+};
+
+static bool decodeMessage(const uint8_t* data, size_t len, Message& m) {
+  memset(&m, 0, sizeof(m));
+  const uint8_t* p = data;
+  const uint8_t* end = data + len;
+  uint8_t major;
+  uint64_t pairs;
+  if (!readHead(p, end, major, pairs) || major != 5) return false;
+  for (uint64_t k = 0; k < pairs; k++) {
+    CborValue key;
+    if (!readValue(p, end, key) || key.major != 0 || key.arg >= 32 || m.has[key.arg]) return false;
+    m.has[key.arg] = true;
+    if (!readValue(p, end, m.v[key.arg])) return false;
+  }
+  m.pairs = pairs;
+  return p == end;
+}
+
+static int64_t intField(const Message& m, TelemetryKey key) {
+  TEST_ASSERT_TRUE_MESSAGE(m.has[key], "Нет ключа");
+  TEST_ASSERT_TRUE(m.v[key].major <= 1);
+  return m.v[key].i;
+}
+
+// ==================== ЗАПИСЬ ====================
+struct Vector {
+  const char* hex;
+  void (*write)(CborWriter& w);
+};
+
+static size_t fromHex(const char* hex, uint8_t* out) {
+  size_t n = 0;
+  for (; hex[0] && hex[1]; hex += 2) {
+    unsigned b;
+    sscanf(hex, "%2x", &b);
+    out[n++] = b;
+  }
+  return n;
+}
+
+// RFC 8949, приложение A (значения, которые умеет писать CborWriter)
+static const Vector RFC_VECTORS[] = {
+  {"00", [](CborWriter& w) { w.unsignedInt(0); }},
+  {"17", [](CborWriter& w) { w.unsignedInt(23); }},
+  {"1818", [](CborWriter& w) { w.unsignedInt(24); }},
+  {"1864", [](CborWriter& w) { w.unsignedInt(100); }},
+  {"1903e8", [](CborWriter& w) { w.unsignedInt(1000); }},
+  {"1a000f4240", [](CborWriter& w) { w.unsignedInt(1000000); }},
+  {"1b000000e8d4a51000", [](CborWriter& w) { w.unsignedInt(1000000000000ull); }},
+  {"1bffffffffffffffff", [](CborWriter& w) { w.unsignedInt(UINT64_MAX); }},
+  {"20", [](CborWriter& w) { w.signedInt(-1); }},
+  {"29", [](CborWriter& w) { w.signedInt(-10); }},
+  {"3863", [](CborWriter& w) { w.signedInt(-100); }},
+  {"3903e7", [](CborWriter& w) { w.signedInt(-1000); }},
+  {"3b7fffffffffffffff", [](CborWriter& w) { w.signedInt(INT64_MIN); }},
+  {"f4", [](CborWriter& w) { w.boolean(false); }},
+  {"f5", [](CborWriter& w) { w.boolean(true); }},
+  {"f6", [](CborWriter& w) { w.null(); }},
+  {"c11a514b67b0", [](CborWriter& w) { w.epochTag().unsignedInt(1363896240); }},
+  {"60", [](CborWriter& w) { w.text(""); }},
+  {"6161", [](CborWriter& w) { w.text("a"); }},
+  {"6449455446", [](CborWriter& w) { w.text("IETF"); }},
+  {"62c3bc", [](CborWriter& w) { w.text("\xc3\xbc"); }},
+  {"80", [](CborWriter& w) { w.array(0); }},
+  {"83010203", [](CborWriter& w) { w.array(3).unsignedInt(1).unsignedInt(2).unsignedInt(3); }},
+  {"a0", [](CborWriter& w) { w.map(0); }},
+  {"a201020304", [](CborWriter& w) { w.map(2).unsignedInt(1).unsignedInt(2).unsignedInt(3).unsignedInt(4); }},
+  {"a26161016162820203", [](CborWriter& w) {
+    w.map(2).text("a").unsignedInt(1).text("b").array(2).unsignedInt(2).unsignedInt(3);
+  }},
+};
+
+// Запись в буфер каждого размера меньше нужного: 0 байт за пределами,
+// overflow(); полный размер - ровно эталон
+static void checkSizes(void (*write)(CborWriter& w), const uint8_t* expected, size_t len) {
+  uint8_t buf[96 + 8];
+  for (size_t size = 0; size <= len; size++) {
+    memset(buf, GUARD, sizeof(buf));
+    CborWriter w(buf, size);
+    write(w);
+    for (size_t k = size; k < sizeof(buf); k++) TEST_ASSERT_EQUAL_UINT8_MESSAGE(GUARD, buf[k], "Запись за концом буфера");
+    if (size < len) {
+      TEST_ASSERT_TRUE(w.overflow());
+      TEST_ASSERT_LESS_OR_EQUAL(size, w.length());
+    } else {
+      TEST_ASSERT_FALSE(w.overflow());
+      TEST_ASSERT_EQUAL_UINT(len, w.length());
+      TEST_ASSERT_EQUAL_MEMORY(expected, buf, len);
+    }
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_rfc8949_vectors() {
+  for (const Vector& v : RFC_VECTORS) {
+    uint8_t expected[64];
+    size_t len = fromHex(v.hex, expected);
+    checkSizes(v.write, expected, len);
+  }
+}
+
+void test_integer_boundaries() {
+  // Каждая граница длины аргумента - обе стороны, положительные и отрицательные
+  static const uint64_t bounds[] = {23, 24, 0xFF, 0x100, 0xFFFF, 0x10000, 0xFFFFFFFFull, 0x100000000ull};
+  static const size_t sizes[] = {1, 2, 2, 3, 3, 5, 5, 9};
+  for (size_t i = 0; i < sizeof(bounds) / sizeof(bounds[0]); i++) {
+    uint8_t buf[32];
+    CborWriter w(buf, sizeof(buf));
+    w.unsignedInt(bounds[i]).signedInt(-1 - (int64_t)bounds[i]);
+    TEST_ASSERT_FALSE(w.overflow());
+    TEST_ASSERT_EQUAL_UINT(2 * sizes[i], w.length());
+
+    const uint8_t* p = buf;
+    CborValue v;
+    TEST_ASSERT_TRUE(readValue(p, buf + w.length(), v));
+    TEST_ASSERT_EQUAL_UINT8(0, v.major);
+    TEST_ASSERT_TRUE(v.arg == bounds[i]);
+    TEST_ASSERT_TRUE(readValue(p, buf + w.length(), v));
+    TEST_ASSERT_EQUAL_UINT8(1, v.major);
+    TEST_ASSERT_TRUE(v.i == -1 - (int64_t)bounds[i]);
+  }
+}
+
+void test_messages_round_trip() {
+  uint8_t buf[TELEMETRY_MAX_LEN];
+  Message m;
+
+  size_t len = telemetryFeeding(buf, sizeof(buf), 1760000000, 3600, 1, 5, "schedule", 12);
+  TEST_ASSERT_TRUE(decodeMessage(buf, len, m));
+  TEST_ASSERT_EQUAL_UINT(7, m.pairs);
+  TEST_ASSERT_EQUAL_INT(TLM_FEEDING, intField(m, TLM_KEY_TYPE));
+  TEST_ASSERT_TRUE(m.v[TLM_KEY_TIME].epochTag);
+  TEST_ASSERT_TRUE(intField(m, TLM_KEY_TIME) == 1760000000);
+  TEST_ASSERT_EQUAL_INT(3600, intField(m, TLM_KEY_UPTIME));
+  TEST_ASSERT_EQUAL_INT(5, intField(m, TLM_KEY_AMOUNT));
+  TEST_ASSERT_EQUAL_INT(2, intField(m, TLM_KEY_AUGER));
+  TEST_ASSERT_EQUAL_INT(3, m.v[TLM_KEY_SOURCE].major);
+  TEST_ASSERT_EQUAL_INT(0, memcmp("schedule", m.v[TLM_KEY_SOURCE].str, m.v[TLM_KEY_SOURCE].arg));
+  TEST_ASSERT_EQUAL_INT(12, intField(m, TLM_KEY_CLIP));
+
+  // Без часов и без ролика ключей времени и ролика нет
+  len = telemetryFeeding(buf, sizeof(buf), 0, 5, 0, -2, "mqtt", -1);
+  TEST_ASSERT_TRUE(decodeMessage(buf, len, m));
+  TEST_ASSERT_EQUAL_UINT(5, m.pairs);
+  TEST_ASSERT_FALSE(m.has[TLM_KEY_TIME]);
+  TEST_ASSERT_FALSE(m.has[TLM_KEY_CLIP]);
+  TEST_ASSERT_EQUAL_INT(-2, intField(m, TLM_KEY_AMOUNT));
+
+  len = telemetryPresence(buf, sizeof(buf), 1760000000, 10, true);
+  TEST_ASSERT_TRUE(decodeMessage(buf, len, m));
+  TEST_ASSERT_EQUAL_INT(TLM_PRESENCE, intField(m, TLM_KEY_TYPE));
+  TEST_ASSERT_EQUAL_UINT8(7, m.v[TLM_KEY_PRESENT].major);
+  TEST_ASSERT_TRUE(m.v[TLM_KEY_PRESENT].arg == 21);
+  // Самое частое событие - короче 16 байт
+  TEST_ASSERT_LESS_THAN(16, len);
+
+  len = telemetryEating(buf, sizeof(buf), 0, 10, 754);
+  TEST_ASSERT_TRUE(decodeMessage(buf, len, m));
+  TEST_ASSERT_EQUAL_INT(TLM_EATING, intField(m, TLM_KEY_TYPE));
+  TEST_ASSERT_EQUAL_INT(754, intField(m, TLM_KEY_SECONDS));
+
+  TelemetryMetrics metrics = {123456, 98765, 65536, 3, 4200, -67};
+  len = telemetryMetrics(buf, sizeof(buf), 1760000000, 86400, metrics);
+  TEST_ASSERT_TRUE(decodeMessage(buf, len, m));
+  TEST_ASSERT_EQUAL_UINT(9, m.pairs);
+  TEST_ASSERT_EQUAL_INT(TLM_METRICS, intField(m, TLM_KEY_TYPE));
+  TEST_ASSERT_EQUAL_INT(123456, intField(m, TLM_KEY_HEAP_FREE));
+  TEST_ASSERT_EQUAL_INT(98765, intField(m, TLM_KEY_HEAP_MIN));
+  TEST_ASSERT_EQUAL_INT(65536, intField(m, TLM_KEY_HEAP_LARGEST));
+  TEST_ASSERT_EQUAL_INT(3, intField(m, TLM_KEY_WIFI_OUTAGES));
+  TEST_ASSERT_EQUAL_INT(4200, intField(m, TLM_KEY_WIFI_RECONNECT_MS));
+  TEST_ASSERT_EQUAL_INT(-67, intField(m, TLM_KEY_RSSI));
+}
+
+void test_worst_case_fits() {
+  // Крайние значения всех полей помещаются в TELEMETRY_MAX_LEN, а меньший
+  // буфер даёт 0, а не обрезанное сообщение
+  uint8_t buf[TELEMETRY_MAX_LEN + 8];
+  TelemetryMetrics metrics = {UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX, INT8_MIN};
+  const time_t epoch = (time_t)INT64_MAX;
+  size_t lens[4];
+  lens[0] = telemetryFeeding(buf, TELEMETRY_MAX_LEN, epoch, UINT32_MAX, 255, INT_MIN, "schedule", INT_MAX);
+  lens[1] = telemetryPresence(buf, TELEMETRY_MAX_LEN, epoch, UINT32_MAX, false);
+  lens[2] = telemetryEating(buf, TELEMETRY_MAX_LEN, epoch, UINT32_MAX, UINT32_MAX);
+  lens[3] = telemetryMetrics(buf, TELEMETRY_MAX_LEN, epoch, UINT32_MAX, metrics);
+  for (size_t len : lens) {
+    TEST_ASSERT_GREATER_THAN(0, len);
+    TEST_ASSERT_LESS_OR_EQUAL(TELEMETRY_MAX_LEN, len);
+  }
+
+  for (size_t size = 0; size < lens[3]; size++) {
+    memset(buf, GUARD, sizeof(buf));
+    TEST_ASSERT_EQUAL_UINT(0, telemetryMetrics(buf, size, epoch, UINT32_MAX, metrics));
+    for (size_t k = size; k < sizeof(buf); k++) TEST_ASSERT_EQUAL_UINT8(GUARD, buf[k]);
+  }
+  for (size_t size = 0; size < lens[0]; size++) {
+    memset(buf, GUARD, sizeof(buf));
+    TEST_ASSERT_EQUAL_UINT(0, telemetryFeeding(buf, size, epoch, UINT32_MAX, 255, INT_MIN, "schedule", INT_MAX));
+    for (size_t k = size; k < sizeof(buf); k++) TEST_ASSERT_EQUAL_UINT8(GUARD, buf[k]);
+  }
+}
+
+// ==================== ПРОШИВКА ====================
+static char topic[MQTT_TOPIC_LEN];
+static char jsonTopic[MQTT_TOPIC_LEN];
+
+// JSON кормления в том же формате, что publishLastFeeding (сверяется
+// с опубликованным ниже, поэтому не разойдётся с прошивкой молча)
+static int feedingJson(char* json, size_t size, const char* isoTime, int amount, uint8_t auger,
+                       const char* source, int clip) {
+  char clipUrl[40] = "";
+  if (clip >= 0) snprintf(clipUrl, sizeof(clipUrl), ",\"clip\":\"/api/clip?id=%d\"", clip);
+  return snprintf(json, size, "{\"timestamp\":\"%s\",\"amount\":%d,\"auger\":%d,\"source\":\"%s\"%s}",
+                  isoTime, amount, auger + 1, source, clipUrl);
+}
+
+void test_boot_firmware() {
+  char root[] = "/tmp/feeder_tlm_XXXXXX";
+  TEST_ASSERT_NOT_NULL(mkdtemp(root));
+  storageSetRoot(root);
+  setup();
+  while (!mqttConnected && millis() < 60000) loop();
+  TEST_ASSERT_TRUE(mqttConnected);
+  hostNtpSync(1760000000);
+  for (int i = 0; i < 10; i++) loop();
+  TEST_ASSERT_GREATER_THAN(0, timeEpoch());
+}
+
+void test_published_feeding_matches_json() {
+  hostBroker.messageCount = 0;
+  publishLastFeeding(1, 4, "web", 9);
+  time_t epoch = timeEpoch();
+
+  snprintf(jsonTopic, sizeof(jsonTopic), MQTT_TOPIC_LAST_FEEDING, deviceId());
+  snprintf(topic, sizeof(topic), MQTT_TOPIC_EVENTS, deviceId());
+  const HostMqttMessage* json = hostBroker.last(jsonTopic);
+  const HostMqttMessage* cbor = hostBroker.last(topic);
+  TEST_ASSERT_NOT_NULL(json);
+  TEST_ASSERT_NOT_NULL(cbor);
+
+  Message m;
+  TEST_ASSERT_TRUE(decodeMessage(cbor->payload, cbor->len, m));
+  TEST_ASSERT_EQUAL_INT(TLM_FEEDING, intField(m, TLM_KEY_TYPE));
+  TEST_ASSERT_TRUE(intField(m, TLM_KEY_TIME) == epoch);
+
+  // Те же поля в JSON: время из CBOR в ISO 8601 и остальное по формату
+  char iso[40];
+  timeIsoAt(intField(m, TLM_KEY_TIME), iso, sizeof(iso));
+  char source[16] = "";
+  memcpy(source, m.v[TLM_KEY_SOURCE].str, m.v[TLM_KEY_SOURCE].arg);
+  char expected[192];
+  feedingJson(expected, sizeof(expected), iso, intField(m, TLM_KEY_AMOUNT),
+              intField(m, TLM_KEY_AUGER) - 1, source, intField(m, TLM_KEY_CLIP));
+  TEST_ASSERT_EQUAL_UINT(strlen(expected), json->len);
+  TEST_ASSERT_EQUAL_MEMORY(expected, json->payload, json->len);
+
+  printf("кормление: JSON %u байт, CBOR %u байт\n", (unsigned)json->len, (unsigned)cbor->len);
+  TEST_ASSERT_LESS_THAN(json->len / 2, cbor->len);
+}
+
+void test_published_metrics_match_json() {
+  hostBroker.messageCount = 0;
+  publishMetrics();
+  publishTelemetry();
+
+  snprintf(jsonTopic, sizeof(jsonTopic), MQTT_TOPIC_METRICS, deviceId());
+  snprintf(topic, sizeof(topic), MQTT_TOPIC_TELEMETRY, deviceId());
+  const HostMqttMessage* json = hostBroker.last(jsonTopic);
+  const HostMqttMessage* cbor = hostBroker.last(topic);
+  TEST_ASSERT_NOT_NULL(json);
+  TEST_ASSERT_NOT_NULL(cbor);
+
+  Message m;
+  TEST_ASSERT_TRUE(decodeMessage(cbor->payload, cbor->len, m));
+  TEST_ASSERT_EQUAL_INT(TLM_METRICS, intField(m, TLM_KEY_TYPE));
+  char text[HOST_MQTT_PAYLOAD + 1];
+  memcpy(text, json->payload, json->len);
+  text[json->len] = '\0';
+
+  static const struct { const char* name; TelemetryKey key; } fields[] = {
+    {"\"heap_free\":", TLM_KEY_HEAP_FREE},
+    {"\"heap_min\":", TLM_KEY_HEAP_MIN},
+    {"\"heap_largest\":", TLM_KEY_HEAP_LARGEST},
+    {"\"uptime\":", TLM_KEY_UPTIME},
+    {"\"wifi_outages\":", TLM_KEY_WIFI_OUTAGES},
+    {"\"wifi_reconnect_ms\":", TLM_KEY_WIFI_RECONNECT_MS},
+    {"\"rssi\":", TLM_KEY_RSSI},
+  };
+  for (const auto& f : fields) {
+    const char* at = strstr(text, f.name);
+    TEST_ASSERT_NOT_NULL_MESSAGE(at, f.name);
+    TEST_ASSERT_TRUE_MESSAGE(strtoll(at + strlen(f.name), nullptr, 10) == intField(m, f.key), f.name);
+  }
+
+  printf("метрики: JSON %u байт, CBOR %u байт\n", (unsigned)json->len, (unsigned)cbor->len);
+  TEST_ASSERT_LESS_THAN(json->len / 2, cbor->len);
+}
+
+static double elapsedNs(const timespec& from, int count) {
+  timespec to;
+  clock_gettime(CLOCK_MONOTONIC, &to);
+  return ((to.tv_sec - from.tv_sec) * 1e9 + (to.tv_nsec - from.tv_nsec)) / count;
+}
+
+void test_benchmark() {
+  // Кодирование кормления: CBOR против snprintf JSON с уже готовым временем
+  // (как в publishLastFeeding, без timeIso)
+  const int rounds = 200000;
+  volatile size_t sink = 0;
+  uint8_t cbor[TELEMETRY_MAX_LEN];
+  char json[192];
+  char iso[40];
+  timeIsoAt(1760000000, iso, sizeof(iso));
+  timespec start;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < rounds; i++) {
+    sink += telemetryFeeding(cbor, sizeof(cbor), 1760000000 + i, 3600 + i, i & 1, 3, "schedule", i & 0xFF);
+  }
+  double cborNs = elapsedNs(start, rounds);
+  size_t cborLen = telemetryFeeding(cbor, sizeof(cbor), 1760000000, 3600, 0, 3, "schedule", 12);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < rounds; i++) {
+    sink += feedingJson(json, sizeof(json), iso, 3, i & 1, "schedule", i & 0xFF);
+  }
+  double jsonNs = elapsedNs(start, rounds);
+  size_t jsonLen = feedingJson(json, sizeof(json), iso, 3, 0, "schedule", 12);
+
+  TelemetryMetrics metrics = {123456, 98765, 65536, 3, 4200, -67};
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < rounds; i++) {
+    metrics.heapFree = 123456 + i;
+    sink += telemetryMetrics(cbor, sizeof(cbor), 1760000000, 86400 + i, metrics);
+  }
+  double metricsNs = elapsedNs(start, rounds);
+  (void)sink;
+
+  printf("кормление: CBOR %u байт за %.0f нс, JSON %u байт за %.0f нс\n",
+         (unsigned)cborLen, cborNs, (unsigned)jsonLen, jsonNs);
+  printf("метрики:   CBOR за %.0f нс\n", metricsNs);
+  TEST_ASSERT_LESS_THAN(jsonLen, cborLen);
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_rfc8949_vectors);
+  RUN_TEST(test_integer_boundaries);
+  RUN_TEST(test_messages_round_trip);
+  RUN_TEST(test_worst_case_fits);
+  RUN_TEST(test_boot_firmware);
+  RUN_TEST(test_published_feeding_matches_json);
+  RUN_TEST(test_published_metrics_match_json);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
@@ -0,0 +1,176 @@
+/*
+  test_tls_session.cpp - Сохранённая TLS сессия в RTC памяти
+
+  tls_client.cpp на хосте не собирается (нужен mbedtls устройства), его
+  кэш сессии - tls_session.cpp - проверяется отдельно. Содержимое RTC
+  памяти подменяется через секцию rtcnoinit (esp_attr.h): программный
+  сброс её не трогает, включение питания оставляет мусор. Возобновление
+  предлагается только той же паре host:port, мусор и любая порча записи
+  не выдаются за сессию, сессия больше TLS_SESSION_MAX не сохраняется.
+*/
+
+#include <unity.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tls_session.h"
+#include "config.h"
+
+#ifndef __APPLE__
+extern uint8_t __start_rtcnoinit[];
+extern uint8_t __stop_rtcnoinit[];
+#endif
+
+#define BROKER "broker.local"
+#define BROKER_PORT 8883
+
+static uint8_t session[TLS_SESSION_MAX];
+
+void setUp() {}
+void tearDown() {}
+
+static uint32_t rng = 12345;
+static uint32_t nextRandom() {
+  rng = rng * 1103515245u + 12345u;
+  return rng >> 8;
+}
+
+// Сессия из len байт, как после mbedtls_ssl_session_save
+static bool storeSession(const char* host, uint16_t port, size_t len, uint8_t seed) {
+  for (size_t i = 0; i < len; i++) session[i] = (uint8_t)(seed + i * 31);
+  memcpy(tlsSessionBuffer(), session, len);
+  return tlsSessionStore(host, port, len);
+}
+
+static bool findsSession(const char* host, uint16_t port, size_t len) {
+  size_t got = 0;
+  const uint8_t* data = tlsSessionFind(host, port, &got);
+  return data && got == len && memcmp(data, session, len) == 0;
+}
+
+// Включение питания: в RTC памяти случайные байты
+static void powerOn() {
+#ifndef __APPLE__
+  for (uint8_t* p = __start_rtcnoinit; p < __stop_rtcnoinit; p++) *p = nextRandom();
+#endif
+}
+
+void test_power_on_garbage_is_not_a_session() {
+#ifdef __APPLE__
+  TEST_IGNORE_MESSAGE("Секция rtcnoinit - только ELF");
+#else
+  for (int i = 0; i < 2000; i++) {
+    powerOn();
+    size_t len = 0;
+    TEST_ASSERT_NULL(tlsSessionFind(BROKER, BROKER_PORT, &len));
+  }
+  // Обнулённая память
+  memset(__start_rtcnoinit, 0, __stop_rtcnoinit - __start_rtcnoinit);
+  size_t len = 0;
+  TEST_ASSERT_NULL(tlsSessionFind(BROKER, BROKER_PORT, &len));
+#endif
+}
+
+// Полное рукопожатие сохранило сессию, сброс её не трогает - следующее
+// подключение к тому же брокеру её предлагает
+void test_session_survives_reset() {
+  powerOn();
+  TEST_ASSERT_TRUE(storeSession(BROKER, BROKER_PORT, 181, 1));
+  TEST_ASSERT_TRUE(findsSession(BROKER, BROKER_PORT, 181));
+  // Новый билет после возобновления заменяет прежний
+  TEST_ASSERT_TRUE(storeSession(BROKER, BROKER_PORT, 240, 2));
+  TEST_ASSERT_TRUE(findsSession(BROKER, BROKER_PORT, 240));
+}
+
+void test_other_broker_gets_nothing() {
+  TEST_ASSERT_TRUE(storeSession(BROKER, BROKER_PORT, 200, 3));
+  size_t len = 0;
+  TEST_ASSERT_NULL(tlsSessionFind("broker.loca", BROKER_PORT, &len));
+  TEST_ASSERT_NULL(tlsSessionFind("broker.local2", BROKER_PORT, &len));
+  TEST_ASSERT_NULL(tlsSessionFind("192.168.1.10", BROKER_PORT, &len));
+  TEST_ASSERT_NULL(tlsSessionFind(BROKER, 1883, &len));
+  TEST_ASSERT_NULL(tlsSessionFind(BROKER, BROKER_PORT + 256, &len));
+  TEST_ASSERT_TRUE(findsSession(BROKER, BROKER_PORT, 200));
+
+  // Сессия другого брокера вытесняет прежнюю
+  TEST_ASSERT_TRUE(storeSession("10.0.0.2", 8884, 120, 4));
+  TEST_ASSERT_NULL(tlsSessionFind(BROKER, BROKER_PORT, &len));
+  TEST_ASSERT_TRUE(findsSession("10.0.0.2", 8884, 120));
+}
+
+// Любой испорченный байт записи: либо сессии нет, либо она та же самая
+// (байт за пределами len); сессия никогда не выдаётся изменённой
+void test_corrupted_byte_never_returns_wrong_session() {
+#ifdef __APPLE__
+  TEST_IGNORE_MESSAGE("Секция rtcnoinit - только ELF");
+#else
+  const size_t len = 300;
+  size_t size = __stop_rtcnoinit - __start_rtcnoinit;
+  size_t detected = 0;
+  for (size_t i = 0; i < size; i++) {
+    TEST_ASSERT_TRUE(storeSession(BROKER, BROKER_PORT, len, 5));
+    __start_rtcnoinit[i] ^= 1 << (i % 8);
+    size_t got = 0;
+    const uint8_t* data = tlsSessionFind(BROKER, BROKER_PORT, &got);
+    if (!data) {
+      detected++;
+      continue;
+    }
+    TEST_ASSERT_EQUAL_UINT32(len, got);
+    TEST_ASSERT_EQUAL_MEMORY(session, data, len);
+  }
+  // Заголовок (16 байт) и сами данные сессии
+  TEST_ASSERT_GREATER_OR_EQUAL(len + 16, detected);
+#endif
+}
+
+void test_size_limit() {
+  TEST_ASSERT_TRUE(storeSession(BROKER, BROKER_PORT, TLS_SESSION_MAX, 6));
+  TEST_ASSERT_TRUE(findsSession(BROKER, BROKER_PORT, TLS_SESSION_MAX));
+  // Не влезла - сессии нет (буфер мог быть уже перезаписан)
+  TEST_ASSERT_FALSE(tlsSessionStore(BROKER, BROKER_PORT, TLS_SESSION_MAX + 1));
+  size_t len = 0;
+  TEST_ASSERT_NULL(tlsSessionFind(BROKER, BROKER_PORT, &len));
+  // Пустая сессия допустима
+  TEST_ASSERT_TRUE(storeSession(BROKER, BROKER_PORT, 0, 7));
+  TEST_ASSERT_NOT_NULL(tlsSessionFind(BROKER, BROKER_PORT, &len));
+  TEST_ASSERT_EQUAL_UINT32(0, len);
+}
+
+// Сериализация не закончена (ошибка до записи или сброс посреди неё) -
+// прежней сессии уже нет, а новой ещё нет
+void test_unfinished_save_forgets_old_session() {
+  size_t len = 0;
+  TEST_ASSERT_TRUE(storeSession(BROKER, BROKER_PORT, 100, 8));
+  tlsSessionBuffer();
+  TEST_ASSERT_NULL(tlsSessionFind(BROKER, BROKER_PORT, &len));
+
+  TEST_ASSERT_TRUE(storeSession(BROKER, BROKER_PORT, 100, 8));
+  memset(tlsSessionBuffer(), 0xEE, 50);
+  TEST_ASSERT_NULL(tlsSessionFind(BROKER, BROKER_PORT, &len));
+}
+
+// Рукопожатие с предложенной сессией не удалось - она забывается,
+// следующая попытка полная
+void test_forget() {
+  TEST_ASSERT_TRUE(storeSession(BROKER, BROKER_PORT, 150, 9));
+  tlsSessionForget();
+  size_t len = 0;
+  TEST_ASSERT_NULL(tlsSessionFind(BROKER, BROKER_PORT, &len));
+  TEST_ASSERT_TRUE(storeSession(BROKER, BROKER_PORT, 150, 9));
+  TEST_ASSERT_TRUE(findsSession(BROKER, BROKER_PORT, 150));
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_power_on_garbage_is_not_a_session);
+  RUN_TEST(test_session_survives_reset);
+  RUN_TEST(test_other_broker_gets_nothing);
+  RUN_TEST(test_corrupted_byte_never_returns_wrong_session);
+  RUN_TEST(test_size_limit);
+  RUN_TEST(test_unfinished_save_forgets_old_session);
+  RUN_TEST(test_forget);
+  return UNITY_END();
+}
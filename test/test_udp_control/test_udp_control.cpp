@@ -0,0 +1,403 @@
+/*
+  test_udp_control.cpp - UDP управление: подпись HMAC и защита от повтора
+
+  HMAC-SHA256 заглушки mbedtls сверяется с векторами RFC 4231 и с
+  пакетом, подписанным как в tools/udp_feed.py. Дальше прошивка целиком
+  принимает настоящие датаграммы на loopback (порт UDP_CONTROL_PORT,
+  ключ задан в [env:native]): пакет с чужой подписью, неверной длиной,
+  magic или версией отбрасывается без ответа, повторный или старый
+  counter кормления - UDP_REPLAY, запрос состояния counter не расходует,
+  принятый counter сохраняется в NVS. Задача приёма на хосте не
+  запускается, её шаг выполняет udpControlPoll().
+*/
+
+#include <unity.h>
+#include <Arduino.h>
+#include <Preferences.h>
+#include <PubSubClient.h>
+#include <mbedtls/md.h>
+#include <lwip/sockets.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "udp_control.h"
+#include "feeder.h"
+#include "metrics.h"
+#include "mqtt_handler.h"
+#include "storage.h"
+#include "config.h"
+
+void setup();
+void loop();
+
+static int client = -1;
+static sockaddr_in feeder;
+
+void setUp() {}
+void tearDown() {}
+
+static void fromHex(const char* hex, uint8_t* out) {
+  for (size_t i = 0; hex[2 * i]; i++) {
+    unsigned v;
+    sscanf(hex + 2 * i, "%2x", &v);
+    out[i] = v;
+  }
+}
+
+static void hmac(const void* key, size_t keyLen, const void* data, size_t len, uint8_t* out) {
+  TEST_ASSERT_EQUAL_INT(0, mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+                                           (const uint8_t*)key, keyLen,
+                                           (const uint8_t*)data, len, out));
+}
+
+static uint32_t counterValue(const char* name) {
+  for (Metric* m = Metric::first(); m; m = m->next()) {
+    if (strcmp(m->name(), name) == 0) return ((Counter*)m)->value();
+  }
+  TEST_FAIL_MESSAGE(name);
+  return 0;
+}
+
+// RFC 4231, случаи 1-4, 6, 7 (5 - усечённый HMAC, его проверяет пакет ниже)
+void test_hmac_rfc4231() {
+  struct Vector {
+    uint8_t keyByte;          // 0 - ключ из key
+    size_t keyLen;
+    const char* key;
+    uint8_t dataByte;         // 0 - данные из data
+    size_t dataLen;
+    const char* data;
+    const char* mac;
+  };
+  static const Vector vectors[] = {
+    {0x0b, 20, nullptr, 0, 8, "Hi There",
+     "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7"},
+    {0, 4, "Jefe", 0, 28, "what do ya want for nothing?",
+     "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"},
+    {0xaa, 20, nullptr, 0xdd, 50, nullptr,
+     "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe"},
+    {0, 25, "\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f\x10"
+            "\x11\x12\x13\x14\x15\x16\x17\x18\x19", 0xcd, 50, nullptr,
+     "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b"},
+    {0xaa, 131, nullptr, 0, 54, "Test Using Larger Than Block-Size Key - Hash Key First",
+     "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54"},
+    {0xaa, 131, nullptr, 0, 152,
+     "This is a test using a larger than block-size key and a larger than block-size data. "
+     "The key needs to be hashed before being used by the HMAC algorithm.",
+     "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2"},
+  };
+  uint8_t key[131], data[152], expected[32], mac[32];
+  for (const Vector& v : vectors) {
+    if (v.key) memcpy(key, v.key, v.keyLen);
+    else memset(key, v.keyByte, v.keyLen);
+    if (v.data) memcpy(data, v.data, v.dataLen);
+    else memset(data, v.dataByte, v.dataLen);
+    fromHex(v.mac, expected);
+    hmac(key, v.keyLen, data, v.dataLen, mac);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, mac, 32);
+  }
+}
+
+// Длины вокруг границы блока SHA-256 (дополнение в тот же или следующий блок);
+// эталон - hmac.new(b"key", b"a" * n, hashlib.sha256) в Python
+void test_hmac_block_boundaries() {
+  static const struct { size_t len; const char* mac; } vectors[] = {
+    {55, "5c753ac4cf15a28e7b5a045ba8ce75e02545a313f326021d770912f768fb53ef"},
+    {56, "e9613a403652aa5873dba8b56f223826236e87559a8d8ac63190613796d2319a"},
+    {63, "c5531cccae97b1a3e84ffd19fb9468e928c41d6acb9279cf4bac4aaf314196ae"},
+    {64, "77207571ea4243ad8e0f220679a62f9033b6d2f59f8d44517d8e9c4857b96fa0"},
+    {65, "4361807d77bd8d84a0ec7bc26ddb24e62e4ab3c65196d1c63ef12db96ce974d0"},
+    {119, "4ffbedd6a1157e63e62d3fa284549bcfe39fb98dbb77ac48a89120aed5747d6b"},
+    {120, "d1cd515a6389be4c26cf09c03af5b128fe8fcc95992b8e2bae38bef7e54b3ef1"},
+    {128, "b8e3a64cbd7ba55e73230992b611446c6c7f0a1e151f2f474acca2c8fd4a2f09"},
+  };
+  uint8_t data[128], expected[32], mac[32];
+  memset(data, 'a', sizeof(data));
+  for (const auto& v : vectors) {
+    fromHex(v.mac, expected);
+    hmac("key", 3, data, v.len, mac);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY_MESSAGE(expected, mac, 32, v.mac);
+  }
+}
+
+// Пакет, подписанный как в tools/udp_feed.py ключом native-test-key:
+// REQUEST.pack(0x46, 1, CMD_FEED, 1, 3, 0, 1) + hmac(...)[:16]
+static const char PY_FEED[] =
+  "460101010300000001000000561c05ec546ae31592e3c873007d1767";
+
+void test_request_signed_like_python() {
+  TEST_ASSERT_EQUAL_STRING("native-test-key", UDP_CONTROL_KEY);
+  uint8_t packet[sizeof(UdpRequest)];
+  fromHex(PY_FEED, packet);
+
+  UdpRequest req = {};
+  req.magic = UDP_MAGIC;
+  req.version = UDP_VERSION;
+  req.cmd = UDP_CMD_FEED;
+  req.auger = 1;
+  req.amount = 3;
+  req.counter = 1;
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(packet, &req, offsetof(UdpRequest, mac));
+
+  uint8_t mac[32];
+  hmac(UDP_CONTROL_KEY, strlen(UDP_CONTROL_KEY), &req, offsetof(UdpRequest, mac), mac);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(packet + offsetof(UdpRequest, mac), mac, UDP_MAC_LEN);
+}
+
+// Подпись пакета ключом key (nullptr - ключ прошивки)
+static void signRequest(UdpRequest& req, const char* key = nullptr) {
+  if (!key) key = UDP_CONTROL_KEY;
+  uint8_t mac[32];
+  hmac(key, strlen(key), &req, offsetof(UdpRequest, mac), mac);
+  memcpy(req.mac, mac, UDP_MAC_LEN);
+}
+
+static UdpRequest makeRequest(uint8_t cmd, uint32_t counter, uint8_t auger = 1, uint16_t amount = 0) {
+  UdpRequest req = {};
+  req.magic = UDP_MAGIC;
+  req.version = UDP_VERSION;
+  req.cmd = cmd;
+  req.auger = auger;
+  req.amount = amount;
+  req.counter = counter;
+  signRequest(req);
+  return req;
+}
+
+static void sendRaw(const void* data, size_t len) {
+  TEST_ASSERT_EQUAL_INT((int)len, sendto(client, data, len, 0, (const sockaddr*)&feeder, sizeof(feeder)));
+}
+
+// Шаг задачи приёма и loop(); ответ с проверенной подписью (false - ответа нет)
+static bool exchange(UdpReply& reply) {
+  while (udpControlPoll()) {}
+  loop();
+  pollfd p = {client, POLLIN, 0};
+  if (poll(&p, 1, 100) <= 0) return false;
+  uint8_t buf[sizeof(UdpReply) + 1];
+  TEST_ASSERT_EQUAL_INT(sizeof(UdpReply), recv(client, buf, sizeof(buf), 0));
+  memcpy(&reply, buf, sizeof(reply));
+  TEST_ASSERT_EQUAL_UINT8(UDP_MAGIC, reply.magic);
+  TEST_ASSERT_EQUAL_UINT8(UDP_VERSION, reply.version);
+  uint8_t mac[32];
+  hmac(UDP_CONTROL_KEY, strlen(UDP_CONTROL_KEY), &reply, offsetof(UdpReply, mac), mac);
+  TEST_ASSERT_EQUAL_HEX8_ARRAY(mac, reply.mac, UDP_MAC_LEN);
+  return true;
+}
+
+static UdpReply request(const UdpRequest& req) {
+  sendRaw(&req, sizeof(req));
+  UdpReply reply;
+  TEST_ASSERT_TRUE_MESSAGE(exchange(reply), "нет ответа");
+  TEST_ASSERT_EQUAL_UINT8(req.cmd | UDP_REPLY_FLAG, reply.cmd);
+  TEST_ASSERT_EQUAL_UINT32(req.counter, reply.counter);
+  return reply;
+}
+
+static uint32_t savedCounter() {
+  Preferences prefs;
+  prefs.begin("udp", true);
+  uint32_t counter = prefs.getUInt("counter", 0);
+  prefs.end();
+  return counter;
+}
+
+// Кормление до конца (виртуальные часы идут в loop)
+static void finishFeed() {
+  for (int i = 0; i < 100000 && feederBusy(0); i++) loop();
+  TEST_ASSERT_FALSE(feederBusy(0));
+}
+
+void test_boot_firmware() {
+  char root[] = "/tmp/feeder_udp_XXXXXX";
+  TEST_ASSERT_NOT_NULL(mkdtemp(root));
+  storageSetRoot(root);
+  setup();
+  while (!mqttConnected && millis() < 60000) loop();
+  TEST_ASSERT_TRUE(mqttConnected);
+
+  client = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  TEST_ASSERT_GREATER_OR_EQUAL(0, client);
+  feeder.sin_family = AF_INET;
+  feeder.sin_port = htons(UDP_CONTROL_PORT);
+  feeder.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  // Порт открыт прошивкой, датаграмм ещё нет
+  TEST_ASSERT_FALSE(udpControlPoll());
+}
+
+void test_status_reports_last_counter() {
+  UdpReply r = request(makeRequest(UDP_CMD_STATUS, 0));
+  TEST_ASSERT_EQUAL_UINT8(UDP_OK, r.result);
+  TEST_ASSERT_EQUAL_UINT32(0, r.lastCounter);
+  TEST_ASSERT_EQUAL_UINT8(0, r.busyMask);
+}
+
+void test_python_packet_feeds() {
+  uint32_t feeds = feederGetStats().feeds;
+  uint8_t packet[sizeof(UdpRequest)];
+  fromHex(PY_FEED, packet);
+  sendRaw(packet, sizeof(packet));
+  UdpReply r;
+  TEST_ASSERT_TRUE(exchange(r));
+  TEST_ASSERT_EQUAL_UINT8(UDP_CMD_FEED | UDP_REPLY_FLAG, r.cmd);
+  TEST_ASSERT_EQUAL_UINT8(UDP_OK, r.result);
+  TEST_ASSERT_EQUAL_UINT32(1, r.counter);
+  TEST_ASSERT_EQUAL_UINT32(1, r.lastCounter);
+  TEST_ASSERT_EQUAL_UINT8(1, r.busyMask & 1);
+  // counter записан во flash после ответа
+  TEST_ASSERT_EQUAL_UINT32(1, savedCounter());
+
+  finishFeed();
+  TEST_ASSERT_EQUAL_UINT32(feeds + 1, feederGetStats().feeds);
+  TEST_ASSERT_EQUAL_INT(3, feederGetStats().lastAmount);
+  TEST_ASSERT_EQUAL_STRING("udp", feederGetStats().lastSource);
+}
+
+void test_replayed_packet_rejected() {
+  uint32_t feeds = feederGetStats().feeds;
+  uint32_t replays = counterValue("feeder_udp_replays_total");
+
+  // Перехваченный пакет дословно
+  uint8_t packet[sizeof(UdpRequest)];
+  fromHex(PY_FEED, packet);
+  sendRaw(packet, sizeof(packet));
+  UdpReply r;
+  TEST_ASSERT_TRUE(exchange(r));
+  TEST_ASSERT_EQUAL_UINT8(UDP_REPLAY, r.result);
+  TEST_ASSERT_EQUAL_UINT32(1, r.lastCounter);
+
+  // Честно подписанный, но старый counter
+  r = request(makeRequest(UDP_CMD_FEED, 0));
+  TEST_ASSERT_EQUAL_UINT8(UDP_REPLAY, r.result);
+
+  TEST_ASSERT_FALSE(feederBusy(0));
+  for (int i = 0; i < 10; i++) loop();
+  TEST_ASSERT_EQUAL_UINT32(feeds, feederGetStats().feeds);
+  TEST_ASSERT_EQUAL_UINT32(replays + 2, counterValue("feeder_udp_replays_total"));
+  TEST_ASSERT_EQUAL_UINT32(1, savedCounter());
+}
+
+void test_status_does_not_consume_counter() {
+  UdpReply r = request(makeRequest(UDP_CMD_STATUS, 500));
+  TEST_ASSERT_EQUAL_UINT8(UDP_OK, r.result);
+  TEST_ASSERT_EQUAL_UINT32(1, r.lastCounter);
+
+  // Следующий за последним принятым counter проходит
+  r = request(makeRequest(UDP_CMD_FEED, 2));
+  TEST_ASSERT_EQUAL_UINT8(UDP_OK, r.result);
+  TEST_ASSERT_EQUAL_UINT32(2, r.lastCounter);
+  finishFeed();
+  TEST_ASSERT_EQUAL_UINT32(2, savedCounter());
+}
+
+void test_counter_may_jump_but_not_go_back() {
+  UdpReply r = request(makeRequest(UDP_CMD_FEED, 1000));
+  TEST_ASSERT_EQUAL_UINT8(UDP_OK, r.result);
+  finishFeed();
+  r = request(makeRequest(UDP_CMD_FEED, 999));
+  TEST_ASSERT_EQUAL_UINT8(UDP_REPLAY, r.result);
+  TEST_ASSERT_EQUAL_UINT32(1000, r.lastCounter);
+  TEST_ASSERT_EQUAL_UINT32(1000, savedCounter());
+}
+
+// Подписанное, но невыполнимое кормление всё равно расходует counter
+// (повтор не пройдёт); неизвестная команда - нет
+void test_busy_bad_auger_bad_request() {
+  UdpReply r = request(makeRequest(UDP_CMD_FEED, 1001, 1, 50));
+  TEST_ASSERT_EQUAL_UINT8(UDP_OK, r.result);
+  r = request(makeRequest(UDP_CMD_FEED, 1002));
+  TEST_ASSERT_EQUAL_UINT8(UDP_BUSY, r.result);
+  TEST_ASSERT_EQUAL_UINT32(1002, r.lastCounter);
+  finishFeed();
+
+  r = request(makeRequest(UDP_CMD_FEED, 1003, NUM_AUGERS + 1));
+  TEST_ASSERT_EQUAL_UINT8(UDP_BAD_AUGER, r.result);
+  r = request(makeRequest(7, 1004));
+  TEST_ASSERT_EQUAL_UINT8(UDP_BAD_REQUEST, r.result);
+  TEST_ASSERT_EQUAL_UINT32(1003, r.lastCounter);
+  TEST_ASSERT_FALSE(feederBusy(0));
+
+  r = request(makeRequest(UDP_CMD_FEED, 1003));
+  TEST_ASSERT_EQUAL_UINT8(UDP_REPLAY, r.result);
+  TEST_ASSERT_EQUAL_UINT32(1003, savedCounter());
+}
+
+// Чужая подпись, правка после подписи, длина, magic, версия - без ответа
+void test_forged_packets_dropped() {
+  uint32_t rejected = counterValue("feeder_udp_rejected_total");
+  uint32_t commands = counterValue("feeder_udp_commands_total");
+  UdpReply r;
+
+  UdpRequest req = makeRequest(UDP_CMD_FEED, 2000);
+  signRequest(req, "other-key");
+  sendRaw(&req, sizeof(req));
+  TEST_ASSERT_FALSE(exchange(r));
+
+  // Подпись от counter 2000, counter подменён
+  req = makeRequest(UDP_CMD_FEED, 2000);
+  req.counter = 2001;
+  sendRaw(&req, sizeof(req));
+  TEST_ASSERT_FALSE(exchange(r));
+
+  // Один бит подписи
+  req = makeRequest(UDP_CMD_FEED, 2000);
+  req.mac[UDP_MAC_LEN - 1] ^= 1;
+  sendRaw(&req, sizeof(req));
+  TEST_ASSERT_FALSE(exchange(r));
+
+  // Короче и длиннее (лишний байт после верного пакета)
+  req = makeRequest(UDP_CMD_FEED, 2000);
+  sendRaw(&req, sizeof(req) - 1);
+  TEST_ASSERT_FALSE(exchange(r));
+  uint8_t longer[sizeof(UdpRequest) + 1] = {};
+  memcpy(longer, &req, sizeof(req));
+  sendRaw(longer, sizeof(longer));
+  TEST_ASSERT_FALSE(exchange(r));
+
+  // Подписанные пакеты с чужим magic и версией
+  req = makeRequest(UDP_CMD_FEED, 2000);
+  req.magic = UDP_MAGIC + 1;
+  signRequest(req);
+  sendRaw(&req, sizeof(req));
+  TEST_ASSERT_FALSE(exchange(r));
+  req = makeRequest(UDP_CMD_FEED, 2000);
+  req.version = UDP_VERSION + 1;
+  signRequest(req);
+  sendRaw(&req, sizeof(req));
+  TEST_ASSERT_FALSE(exchange(r));
+
+  // Пустая датаграмма
+  sendRaw("", 0);
+  TEST_ASSERT_FALSE(exchange(r));
+
+  TEST_ASSERT_EQUAL_UINT32(rejected + 8, counterValue("feeder_udp_rejected_total"));
+  TEST_ASSERT_EQUAL_UINT32(commands, counterValue("feeder_udp_commands_total"));
+  TEST_ASSERT_FALSE(feederBusy(0));
+
+  // Ни один не сдвинул counter: 2000 ещё свободен
+  r = request(makeRequest(UDP_CMD_STATUS, 0));
+  TEST_ASSERT_EQUAL_UINT32(1003, r.lastCounter);
+  r = request(makeRequest(UDP_CMD_FEED, 2000));
+  TEST_ASSERT_EQUAL_UINT8(UDP_OK, r.result);
+  finishFeed();
+  TEST_ASSERT_EQUAL_UINT32(2000, savedCounter());
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_hmac_rfc4231);
+  RUN_TEST(test_hmac_block_boundaries);
+  RUN_TEST(test_request_signed_like_python);
+  RUN_TEST(test_boot_firmware);
+  RUN_TEST(test_status_reports_last_counter);
+  RUN_TEST(test_python_packet_feeds);
+  RUN_TEST(test_replayed_packet_rejected);
+  RUN_TEST(test_status_does_not_consume_counter);
+  RUN_TEST(test_counter_may_jump_but_not_go_back);
+  RUN_TEST(test_busy_bad_auger_bad_request);
+  RUN_TEST(test_forged_packets_dropped);
+  return UNITY_END();
+}
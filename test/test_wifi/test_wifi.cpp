@@ -0,0 +1,117 @@
+/*
+  test_wifi.cpp - Переподключение WiFi по кэшу точки доступа
+
+  Прошивка на заглушках, точка доступа управляется тестом (WiFi.h).
+  После первого подключения каждое переподключение - и после обрыва, а
+  не только после сброса - идёт быстрым путём (канал и BSSID из кэша),
+  но адрес всегда выдаёт DHCP: новая аренда с другим адресом
+  применяется. Неудачная быстрая попытка сразу переходит к полному
+  подключению, смена сети (wifiReconnect) кэш сбрасывает.
+*/
+
+#include <unity.h>
+#include <Arduino.h>
+#include <WiFi.h>
+#include <stdlib.h>
+#include "wifi_manager.h"
+#include "storage.h"
+#include "config.h"
+
+void setup();
+void loop();
+
+void setUp() {}
+void tearDown() {}
+
+// loop() до поднятия линка (не дольше ms)
+static bool runUntilUp(uint32_t ms) {
+  unsigned long end = millis() + ms;
+  while (!wifiLinkUp() && (long)(millis() - end) < 0) loop();
+  return wifiLinkUp();
+}
+
+// Обрыв и переподключение; true - линк снова поднят
+static bool dropAndReconnect() {
+  WiFi.hostDrop(200);
+  loop();
+  return runUntilUp(WIFI_CONNECT_TIMEOUT);
+}
+
+static bool sameIp(IPAddress a, IPAddress b) {
+  return (uint32_t)a == (uint32_t)b;
+}
+
+void test_boot_full_connect() {
+  char root[] = "/tmp/feeder_wifi_XXXXXX";
+  TEST_ASSERT_NOT_NULL(mkdtemp(root));
+  storageSetRoot(root);
+  setup();
+  TEST_ASSERT_TRUE(runUntilUp(WIFI_BOOT_WAIT));
+  TEST_ASSERT_FALSE(WiFi.lastFast);
+  TEST_ASSERT_EQUAL_UINT32(0, wifiGetStats().fastConnects);
+  TEST_ASSERT_TRUE(sameIp(WiFi.dhcpIp, WiFi.localIP()));
+}
+
+void test_reconnect_after_drop_is_fast() {
+  for (uint32_t i = 1; i <= 3; i++) {
+    uint32_t begins = WiFi.begins;
+    TEST_ASSERT_TRUE(dropAndReconnect());
+    TEST_ASSERT_EQUAL_UINT32(begins + 1, WiFi.begins);
+    TEST_ASSERT_TRUE(WiFi.lastFast);
+    TEST_ASSERT_EQUAL_INT32(WiFi.apChannel, WiFi.lastChannel);
+    TEST_ASSERT_EQUAL_UINT32(i, wifiGetStats().fastConnects);
+  }
+}
+
+// Быстрый путь не назначает адрес сам: новая аренда DHCP применяется
+void test_fast_path_keeps_dhcp() {
+  WiFi.dhcpIp = IPAddress(192, 168, 1, 77);
+  TEST_ASSERT_TRUE(dropAndReconnect());
+  TEST_ASSERT_TRUE(WiFi.lastFast);
+  TEST_ASSERT_TRUE(sameIp(IPAddress(192, 168, 1, 77), WiFi.localIP()));
+}
+
+// Точка доступа не отвечает на старом канале - сразу полный путь,
+// после подключения следующее снова быстрое
+void test_failed_fast_attempt_falls_back() {
+  uint32_t fast = wifiGetStats().fastConnects;
+  WiFi.autoConnect = false;
+  WiFi.hostDrop(200);
+  loop();
+  TEST_ASSERT_TRUE(WiFi.lastFast);
+  unsigned long end = millis() + WIFI_FAST_CONNECT_TIMEOUT + 1000;
+  while ((long)(millis() - end) < 0 && WiFi.lastFast) loop();
+  TEST_ASSERT_FALSE(WiFi.lastFast);
+
+  WiFi.apChannel = 11;
+  WiFi.hostConnect();
+  TEST_ASSERT_TRUE(runUntilUp(1000));
+  TEST_ASSERT_EQUAL_UINT32(fast, wifiGetStats().fastConnects);
+  WiFi.autoConnect = true;
+
+  TEST_ASSERT_TRUE(dropAndReconnect());
+  TEST_ASSERT_TRUE(WiFi.lastFast);
+  TEST_ASSERT_EQUAL_INT32(11, WiFi.lastChannel);
+  TEST_ASSERT_EQUAL_UINT32(fast + 1, wifiGetStats().fastConnects);
+}
+
+// Новая сеть: кэш прежней точки доступа не используется
+void test_new_network_connects_fully() {
+  wifiReconnect();
+  TEST_ASSERT_TRUE(runUntilUp(WIFI_CONNECT_TIMEOUT));
+  TEST_ASSERT_FALSE(WiFi.lastFast);
+  TEST_ASSERT_TRUE(dropAndReconnect());
+  TEST_ASSERT_TRUE(WiFi.lastFast);
+}
+
+int main(int argc, char** argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_boot_full_connect);
+  RUN_TEST(test_reconnect_after_drop_is_fast);
+  RUN_TEST(test_fast_path_keeps_dhcp);
+  RUN_TEST(test_failed_fast_attempt_falls_back);
+  RUN_TEST(test_new_network_connects_fully);
+  return UNITY_END();
+}
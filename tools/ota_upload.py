@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""
+ota_upload.py - Загрузка прошивки через HTTP OTA (POST /api/ota)
+
+Образ сжимается gzip и отправляется кусками. При обрыве загрузка
+продолжается со смещения, которое вернула кормушка (поле "received").
+Пароль - OTA_PASSWORD из .env (или WEB_ADMIN_PASSWORD, если OTA_PASSWORD
+пуст), берётся из --password или переменных окружения.
+
+    python tools/ota_upload.py 192.168.1.50 .pio/build/esp32cam/firmware.bin
+    python tools/ota_upload.py 192.168.1.50 firmware.bin --no-gzip --chunk 16384
+"""
+
+import argparse
+import base64
+import gzip
+import json
+import os
+import sys
+import time
+import urllib.error
+import urllib.request
+
+
+def request(url, data=None, auth=None, timeout=30):
+    req = urllib.request.Request(url, data=data, method="POST" if data is not None else "GET")
+    if data is not None:
+        req.add_header("Content-Type", "application/octet-stream")
+    if auth:
+        req.add_header("Authorization", "Basic " + base64.b64encode(auth.encode()).decode())
+    try:
+        with urllib.request.urlopen(req, timeout=timeout) as resp:
+            return resp.status, json.loads(resp.read() or b"{}")
+    except urllib.error.HTTPError as e:
+        return e.code, json.loads(e.read() or b"{}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="HTTP OTA для кормушки")
+    parser.add_argument("host", help="IP или имя кормушки")
+    parser.add_argument("firmware", help="firmware.bin")
+    parser.add_argument("--chunk", type=int, default=32768, help="размер куска (байт)")
+    parser.add_argument("--no-gzip", action="store_true", help="отправить без сжатия")
+    parser.add_argument("--retries", type=int, default=10, help="попыток на обрыв")
+    parser.add_argument("--user", default="admin", help="пользователь (WEB_ADMIN_USER)")
+    parser.add_argument("--password",
+                        default=os.environ.get("OTA_PASSWORD") or os.environ.get("WEB_ADMIN_PASSWORD"),
+                        help="OTA_PASSWORD (или WEB_ADMIN_PASSWORD)")
+    args = parser.parse_args()
+    if not args.password:
+        sys.exit("Нужен пароль: --password или OTA_PASSWORD в окружении")
+    auth = f"{args.user}:{args.password}"
+
+    with open(args.firmware, "rb") as f:
+        image = f.read()
+    if not args.no_gzip:
+        raw_size = len(image)
+        image = gzip.compress(image, compresslevel=9)
+        print(f"Сжато: {raw_size} -> {len(image)} байт")
+
+    base = f"http://{args.host}/api/ota"
+    size = len(image)
+    offset = 0
+    retries = 0
+
+    while offset < size:
+        chunk = image[offset:offset + args.chunk]
+        try:
+            code, status = request(f"{base}?offset={offset}&size={size}", chunk, auth)
+        except (OSError, ValueError) as e:
+            # Обрыв: узнаём, сколько кормушка успела принять
+            retries += 1
+            if retries > args.retries:
+                sys.exit(f"Обрыв связи: {e}")
+            print(f"Обрыв ({e}), продолжаем...")
+            time.sleep(2)
+            try:
+                code, status = request(base)
+            except (OSError, ValueError):
+                continue
+            if status.get("state") != "receiving":
+                offset = 0
+                continue
+            offset = status["received"]
+            continue
+
+        if code == 200:
+            offset = status["received"]
+            print(f"\r{offset * 100 // size:3d}%  {offset}/{size}", end="", flush=True)
+        elif code == 401:
+            sys.exit("\nНеверный пароль (401)")
+        elif code == 409:
+            offset = status["received"] if status.get("state") == "receiving" else 0
+            print(f"\nПродолжение со смещения {offset}")
+        else:
+            sys.exit(f"\nОшибка {code}: {status.get('error')}")
+
+    print("\nОбраз записан, кормушка перезагружается. Новая прошивка будет "
+          "подтверждена после самопроверок (WiFi, MQTT, время).")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""
+power_sim.py - Оценка суточной нагрузки кормушки в режимах питания
+
+Повторяет правила power_manager.h: активный режим, пока крутится шнек,
+смотрят поток или открыта веб-страница, и ещё POWER_IDLE_DELAY после
+события (кнопка, HTTP, MQTT, UDP); остальное время - простой. Параметры
+прошивки берутся из include/config.h, события дня раскладываются
+случайно (--seed повторяет раскладку).
+
+Камера как в прошивке: в активном режиме сенсор снимает всегда (ролики,
+детектор), в простое - с частотой POWER_IDLE_CAMERA_FPS, а при 0 сенсор
+в standby. Light sleep считается только для сборки с CONFIG_PM_ENABLE
+(--light-sleep) и только пока сенсор в standby: камера держит блокировку
+сна. Пробуждения в простое - от тех же периодов, что в прошивке: loop(),
+сторожевой таймер трассировки, фронты маяка светодиодов, задачи камеры.
+
+Токи - типичные для ESP32-CAM, уточните их своим амперметром (--current).
+
+    python tools/power_sim.py
+    python tools/power_sim.py --feeds 07:00,19:00 --web 1 --mqtt 10 --idle-camera-fps 0 --light-sleep
+    python tools/power_sim.py --current idle=25 --battery 20000
+"""
+
+import argparse
+import os
+import random
+import re
+import sys
+
+DAY = 86400.0
+
+# Ток, мА: ядро и WiFi по режимам, камера и мотор - добавки
+CURRENTS = {
+    "active": 120.0,   # 240 МГц, WiFi без энергосбережения
+    "idle": 32.0,      # 80 МГц, modem sleep (DTIM 3)
+    "sleep": 2.5,      # Light sleep между пробуждениями, WiFi на маяках
+    "camera": 45.0,    # Сенсор и захват кадров
+    "standby": 1.0,    # Сенсор в standby
+    "motor": 160.0,    # Шаговый мотор при кормлении
+}
+WAKE_COST_MS = 0.6     # Пробуждение из light sleep: вход, работа, возврат
+
+CONFIG_KEYS = (
+    "POWER_MANAGEMENT", "POWER_IDLE_DELAY", "POWER_ACTIVE_LOOP_MS", "POWER_IDLE_LOOP_MS",
+    "POWER_IDLE_CAMERA_FPS", "FEED_SPEED", "STEPS_FRW", "STEPS_BKW", "DEFAULT_FEED_AMOUNT",
+    "LED_BEACON_OK_PERIOD", "TRACE_WATCHDOG_PERIOD",
+    "CAMERA_ACCEPT_POLL_MS", "CAMERA_STANDBY_POLL_MS",
+)
+
+
+def load_config(path):
+    """Числовые #define из config.h."""
+    values = {}
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            m = re.match(r"\s*#define\s+(\w+)\s+(\d+)\b", line)
+            if m and m.group(1) in CONFIG_KEYS:
+                values[m.group(1)] = int(m.group(2))
+    missing = [k for k in CONFIG_KEYS if k not in values]
+    if missing:
+        raise SystemExit(f"В {path} нет: {', '.join(missing)}")
+    return values
+
+
+def parse_times(text):
+    times = []
+    for item in filter(None, text.split(",")):
+        h, _, m = item.partition(":")
+        times.append(int(h) * 3600 + int(m or 0) * 60)
+    return times
+
+
+def merge(intervals):
+    """Объединение пересекающихся интервалов [начало, конец), обрезка по суткам."""
+    out = []
+    for start, end in sorted((max(0.0, s), min(DAY, e)) for s, e in intervals):
+        if end <= start:
+            continue
+        if out and start <= out[-1][1]:
+            out[-1][1] = max(out[-1][1], end)
+        else:
+            out.append([start, end])
+    return out
+
+
+def total(intervals):
+    return sum(e - s for s, e in intervals)
+
+
+def simulate(cfg, args):
+    rng = random.Random(args.seed)
+    delay = cfg["POWER_IDLE_DELAY"] / 1000.0
+    rev_s = (cfg["STEPS_FRW"] + cfg["STEPS_BKW"]) * cfg["FEED_SPEED"] / 1e6
+    feed_s = args.amount * rev_s
+
+    busy = []        # Интервалы работы
+    motor = []
+    events = []      # Мгновенные события
+
+    for t in parse_times(args.feeds):
+        busy.append((t, t + feed_s))
+        motor.append((t, t + feed_s))
+    for _ in range(args.button):
+        t = rng.uniform(0, DAY)
+        events.append(t)
+        busy.append((t, t + feed_s))
+        motor.append((t, t + feed_s))
+    for _ in range(args.web):
+        t = rng.uniform(0, DAY)
+        busy.append((t, t + args.web_minutes * 60))
+    if args.stream:
+        t = rng.uniform(0, DAY - args.stream * 60)
+        busy.append((t, t + args.stream * 60))
+    for _ in range(args.mqtt + args.udp):
+        events.append(rng.uniform(0, DAY))
+
+    if cfg["POWER_MANAGEMENT"]:
+        active = merge([(s, e + delay) for s, e in busy] + [(t, t + delay) for t in events])
+    else:
+        active = [[0.0, DAY]]
+    active_s = total(active)
+    idle_s = DAY - active_s
+    motor_s = total(merge(motor))
+
+    wake_active = active_s * 1000 / cfg["POWER_ACTIVE_LOOP_MS"]
+    wake_idle = idle_s * 1000 / cfg["POWER_IDLE_LOOP_MS"]
+    wake_before = DAY * 1000 / cfg["POWER_ACTIVE_LOOP_MS"]
+
+    # Сенсор в простое: снимает или в standby (тогда возможен light sleep)
+    standby = cfg["POWER_MANAGEMENT"] and args.idle_camera_fps == 0
+    light = args.light_sleep and standby
+    awake = 1.0
+    if light:
+        # Пробуждения в простое: loop(), трассировка, два фронта маяка за
+        # период, задачи камеры (захват, детектор, ролики, приём зрителей)
+        per_sec = (1000.0 / cfg["POWER_IDLE_LOOP_MS"] + 1000.0 / cfg["TRACE_WATCHDOG_PERIOD"]
+                   + 2000.0 / cfg["LED_BEACON_OK_PERIOD"] + 3000.0 / cfg["CAMERA_STANDBY_POLL_MS"]
+                   + 1000.0 / cfg["CAMERA_ACCEPT_POLL_MS"])
+        awake = min(1.0, per_sec * WAKE_COST_MS / 1000.0)
+    c = CURRENTS
+    idle_ma = awake * c["idle"] + (1 - awake) * c["sleep"] if light else c["idle"]
+    idle_ma += c["standby"] if standby else c["camera"]
+
+    charge = (active_s * (c["active"] + c["camera"]) + idle_s * idle_ma + motor_s * c["motor"]) / 3600
+    before = DAY * (c["active"] + c["camera"]) / 3600 + motor_s * c["motor"] / 3600
+
+    return {
+        "feed_s": feed_s, "active_s": active_s, "idle_s": idle_s, "motor_s": motor_s,
+        "wakeups": wake_active + wake_idle, "wakeups_before": wake_before,
+        "standby": standby, "light": light, "awake": awake, "idle_ma": idle_ma,
+        "mah": charge, "mah_before": before,
+    }
+
+
+def hms(seconds):
+    s = int(round(seconds))
+    return f"{s // 3600:02d}:{s % 3600 // 60:02d}:{s % 60:02d}"
+
+
+def report(cfg, args, r):
+    feeds = len(parse_times(args.feeds))
+    print(f"Нагрузка: кормлений {feeds} по {args.amount} об. ({r['feed_s']:.1f} с), кнопка {args.button}, "
+          f"веб {args.web} x {args.web_minutes} мин, поток {args.stream} мин, MQTT {args.mqtt}, UDP {args.udp}")
+    if not cfg["POWER_MANAGEMENT"]:
+        print("POWER_MANAGEMENT = 0: всегда активный режим")
+    print(f"Активный режим:   {hms(r['active_s'])}  ({100 * r['active_s'] / DAY:.2f} % суток)")
+    print(f"Простой:          {hms(r['idle_s'])}")
+    print(f"Мотор:            {hms(r['motor_s'])}")
+    print(f"Пробуждений loop: {r['wakeups']:,.0f} (без управления питанием {r['wakeups_before']:,.0f})"
+          .replace(",", " "))
+    if r["standby"]:
+        print("Камера в простое: standby")
+    else:
+        print(f"Камера в простое: {args.idle_camera_fps} кадр/с")
+    if args.light_sleep and not r["standby"]:
+        print("Light sleep:      невозможен, пока сенсор снимает (нужен POWER_IDLE_CAMERA_FPS 0)")
+    elif r["light"]:
+        print(f"Light sleep:      бодрствование в простое {100 * r['awake']:.1f} %")
+    print(f"Ток простоя:      {r['idle_ma']:.1f} мА")
+    print(f"Средний ток:      {r['mah'] / 24:.1f} мА (без управления питанием {r['mah_before'] / 24:.1f} мА)")
+    print(f"Расход за сутки:  {r['mah']:.0f} мАч (было {r['mah_before']:.0f} мАч)")
+    if args.battery:
+        print(f"Батарея {args.battery} мАч: {args.battery / r['mah']:.1f} сут (было {args.battery / r['mah_before']:.1f})")
+
+
+def main():
+    root = os.path.join(os.path.dirname(__file__), "..")
+    parser = argparse.ArgumentParser(description="Оценка суточной нагрузки в режимах питания")
+    parser.add_argument("--config", default=os.path.join(root, "include", "config.h"))
+    parser.add_argument("--feeds", default="08:00,13:00,20:00", help="время кормлений по расписанию")
+    parser.add_argument("--amount", type=int, help="оборотов на кормление (по умолчанию DEFAULT_FEED_AMOUNT)")
+    parser.add_argument("--button", type=int, default=0, help="кормлений кнопкой за сутки")
+    parser.add_argument("--web", type=int, default=2, help="открытий веб-страницы за сутки")
+    parser.add_argument("--web-minutes", type=float, default=2, help="минут на странице")
+    parser.add_argument("--stream", type=float, default=0, help="минут MJPEG потока за сутки")
+    parser.add_argument("--mqtt", type=int, default=4, help="команд MQTT за сутки")
+    parser.add_argument("--udp", type=int, default=0, help="команд UDP за сутки")
+    parser.add_argument("--idle-camera-fps", type=int,
+                        help="фоновый захват в простое, как POWER_IDLE_CAMERA_FPS (по умолчанию из config.h)")
+    parser.add_argument("--light-sleep", action="store_true", help="сборка с CONFIG_PM_ENABLE")
+    parser.add_argument("--current", action="append", default=[], metavar="ИМЯ=МА",
+                        help=f"ток, мА ({', '.join(CURRENTS)})")
+    parser.add_argument("--battery", type=float, default=10000, help="ёмкость батареи, мАч (0 - не считать)")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    cfg = load_config(args.config)
+    if args.amount is None:
+        args.amount = cfg["DEFAULT_FEED_AMOUNT"]
+    if args.idle_camera_fps is None:
+        args.idle_camera_fps = cfg["POWER_IDLE_CAMERA_FPS"]
+    for item in args.current:
+        name, _, value = item.partition("=")
+        if name not in CURRENTS:
+            parser.error(f"неизвестный ток {name}")
+        CURRENTS[name] = float(value)
+
+    report(cfg, args, simulate(cfg, args))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
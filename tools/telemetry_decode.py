@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+"""
+telemetry_decode.py - Декодер событий и телеметрии кормушки (CBOR)
+
+Номера ключей и видов сообщений читаются из include/telemetry.h, так что
+схема одна на прошивку и декодер. Без зависимостей: разбирается только
+то подмножество CBOR, которое пишет cbor_writer.
+
+    # Сообщения из брокера (mosquitto_sub -F %x - полезная нагрузка в hex)
+    mosquitto_sub -h BROKER_IP -t "+/events" -t "+/telemetry" -F "%t %x" | \\
+        python tools/telemetry_decode.py
+    # Одно сообщение
+    python tools/telemetry_decode.py a30002020507f5
+"""
+
+import argparse
+import datetime
+import json
+import os
+import re
+import struct
+import sys
+
+SCHEMA = os.path.join(os.path.dirname(__file__), "..", "include", "telemetry.h")
+
+
+def load_schema(path):
+    """Перечисления TelemetryType и TelemetryKey из заголовка прошивки."""
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+
+    def enum(name, prefix):
+        body = re.search(r"enum\s+%s\s*\{(.*?)\}" % name, text, re.S).group(1)
+        return {int(v): k[len(prefix):].lower()
+                for k, v in re.findall(r"(TLM_\w+)\s*=\s*(\d+)", body)}
+
+    return enum("TelemetryType", "TLM_"), enum("TelemetryKey", "TLM_KEY_")
+
+
+class CborError(ValueError):
+    pass
+
+
+def decode(data):
+    """Одно значение CBOR; возвращает (значение, длина)."""
+
+    def item(pos):
+        if pos >= len(data):
+            raise CborError("unexpected end")
+        major, info = data[pos] >> 5, data[pos] & 0x1F
+        pos += 1
+        if major == 7:
+            simple = {20: False, 21: True, 22: None}
+            if info in simple:
+                return simple[info], pos
+            if info in (25, 26, 27):
+                fmt, n = {25: (">e", 2), 26: (">f", 4), 27: (">d", 8)}[info]
+                return struct.unpack(fmt, data[pos:pos + n])[0], pos + n
+            raise CborError("unsupported simple value %d" % info)
+        if info < 24:
+            arg = info
+        elif info <= 27:
+            n = 1 << (info - 24)
+            if pos + n > len(data):
+                raise CborError("unexpected end")
+            arg = int.from_bytes(data[pos:pos + n], "big")
+            pos += n
+        else:
+            raise CborError("indefinite lengths are not used")
+
+        if major == 0:
+            return arg, pos
+        if major == 1:
+            return -1 - arg, pos
+        if major in (2, 3):
+            raw = data[pos:pos + arg]
+            if len(raw) != arg:
+                raise CborError("unexpected end")
+            return (raw if major == 2 else raw.decode("utf-8")), pos + arg
+        if major == 4:
+            out = []
+            for _ in range(arg):
+                v, pos = item(pos)
+                out.append(v)
+            return out, pos
+        if major == 5:
+            out = {}
+            for _ in range(arg):
+                k, pos = item(pos)
+                v, pos = item(pos)
+                out[k] = v
+            return out, pos
+        # major == 6: тег 1 - время эпохи, остальные теги прозрачны
+        v, pos = item(pos)
+        if arg == 1:
+            v = datetime.datetime.fromtimestamp(v, datetime.timezone.utc).isoformat()
+        return v, pos
+
+    return item(0)
+
+
+def to_record(payload, types, keys):
+    """Сообщение кормушки -> словарь с именами ключей из схемы."""
+    value, used = decode(payload)
+    if used != len(payload):
+        raise CborError("%d trailing bytes" % (len(payload) - used))
+    if not isinstance(value, dict):
+        raise CborError("not a map")
+    record = {}
+    for k, v in value.items():
+        name = keys.get(k, "key_%s" % k)
+        if name == "type":
+            v = types.get(v, "type_%s" % v)
+        record[name] = v
+    return record
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Декодер CBOR телеметрии кормушки")
+    parser.add_argument("hex", nargs="*", help="сообщения в hex (без них - строки stdin: [топик] hex)")
+    parser.add_argument("--schema", default=SCHEMA, help="путь к telemetry.h")
+    args = parser.parse_args()
+
+    types, keys = load_schema(args.schema)
+    lines = args.hex or sys.stdin
+    status = 0
+    for line in lines:
+        parts = line.split()
+        if not parts:
+            continue
+        topic, hexdata = (parts[0], parts[-1]) if len(parts) > 1 else (None, parts[0])
+        try:
+            record = to_record(bytes.fromhex(hexdata), types, keys)
+        except (ValueError, CborError) as e:
+            print("error: %s" % e, file=sys.stderr)
+            status = 1
+            continue
+        if topic:
+            record = {"topic": topic, **record}
+        print(json.dumps(record, ensure_ascii=False), flush=True)
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
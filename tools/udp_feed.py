@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""
+udp_feed.py - Клиент UDP управления кормушкой (include/udp_control.h)
+
+Ключ - UDP_CONTROL_KEY: из --key, переменной окружения или .env проекта.
+Нумерация команд не хранится: перед кормлением клиент спрашивает
+состояние и берёт counter на единицу больше последнего принятого.
+Адрес кормушки в сети: avahi-browse -rt _feeder._udp
+
+    python tools/udp_feed.py 192.168.1.50 status
+    python tools/udp_feed.py 192.168.1.50 feed --auger 2 --amount 20
+    python tools/udp_feed.py 192.168.1.50 bench -n 200
+    python tools/udp_feed.py 192.168.1.50 selftest
+"""
+
+import argparse
+import hashlib
+import hmac
+import os
+import socket
+import struct
+import sys
+import time
+
+MAGIC = 0x46
+VERSION = 1
+MAC_LEN = 16
+CMD_FEED = 1
+CMD_STATUS = 2
+REPLY_FLAG = 0x80
+RESULTS = {0: "ok", 1: "busy", 2: "bad auger", 3: "replay", 4: "bad request"}
+
+# Раскладка пакетов - как UdpRequest / UdpReply (little-endian, без выравнивания)
+REQUEST = struct.Struct("<BBBBHHI")
+REPLY = struct.Struct("<BBBBIIIIBBH")
+
+
+def load_key(path):
+    key = os.environ.get("UDP_CONTROL_KEY", "")
+    if key or not os.path.exists(path):
+        return key
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            name, _, value = line.strip().partition("=")
+            if name.strip() == "UDP_CONTROL_KEY":
+                return value.strip()
+    return ""
+
+
+class Feeder:
+    def __init__(self, host, port, key, timeout):
+        self.addr = (host, port)
+        self.key = key.encode()
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.settimeout(timeout)
+
+    def sign(self, data):
+        return hmac.new(self.key, data, hashlib.sha256).digest()[:MAC_LEN]
+
+    def request(self, cmd, counter, auger=0, amount=0):
+        """Запрос и проверенный ответ: словарь и время в мс (None - нет ответа)."""
+        body = REQUEST.pack(MAGIC, VERSION, cmd, auger, amount, 0, counter)
+        start = time.perf_counter()
+        self.sock.sendto(body + self.sign(body), self.addr)
+        while True:
+            try:
+                data, _ = self.sock.recvfrom(64)
+            except socket.timeout:
+                return None, None
+            rtt = (time.perf_counter() - start) * 1000
+            if len(data) != REPLY.size + MAC_LEN:
+                continue
+            body, mac = data[:REPLY.size], data[REPLY.size:]
+            if not hmac.compare_digest(mac, self.sign(body)):
+                continue
+            fields = REPLY.unpack(body)
+            # Только ответ на этот запрос (старые ответы после таймаута - мимо)
+            if fields[0] != MAGIC or fields[2] != cmd | REPLY_FLAG or fields[4] != counter:
+                continue
+            return {
+                "result": RESULTS.get(fields[3], fields[3]),
+                "last_counter": fields[5],
+                "uptime": fields[6],
+                "epoch": fields[7],
+                "busy": [i + 1 for i in range(8) if fields[8] & (1 << i)],
+                "pet_present": bool(fields[9]),
+            }, rtt
+
+    def status(self):
+        return self.request(CMD_STATUS, 0)
+
+    def feed(self, auger, amount):
+        st, _ = self.status()
+        if st is None:
+            return None, None
+        return self.request(CMD_FEED, st["last_counter"] + 1, auger, amount)
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+
+def bench(feeder, n):
+    """Время ответа на запрос состояния (кормушка его не расходует)."""
+    rtts = []
+    lost = 0
+    for _ in range(n):
+        st, rtt = feeder.status()
+        if st is None:
+            lost += 1
+        else:
+            rtts.append(rtt)
+    if not rtts:
+        print("нет ответов")
+        return 1
+    print(f"ответов {len(rtts)}/{n}, мс: min {min(rtts):.2f}  p50 {percentile(rtts, 50):.2f}  "
+          f"p90 {percentile(rtts, 90):.2f}  p99 {percentile(rtts, 99):.2f}  max {max(rtts):.2f}")
+    return 1 if lost else 0
+
+
+def selftest(feeder):
+    """Проверка протокола на живой кормушке без кормления."""
+    failures = 0
+
+    def check(name, ok):
+        nonlocal failures
+        print(("OK   " if ok else "FAIL ") + name)
+        failures += not ok
+
+    st, _ = feeder.status()
+    check("ответ на запрос состояния", st is not None and st["result"] == "ok")
+    if st is None:
+        return 1
+
+    # Уже принятый counter: кормушка должна отказать, мотор не трогается
+    rep, _ = feeder.request(CMD_FEED, st["last_counter"])
+    check("повтор counter отклонён", rep is not None and rep["result"] == "replay")
+
+    check("неизвестная команда", (feeder.request(0x7F, 0)[0] or {}).get("result") == "bad request")
+
+    wrong = Feeder(*feeder.addr, key="wrong-key", timeout=0.5)
+    check("чужой ключ - без ответа", wrong.status()[0] is None)
+    return 1 if failures else 0
+
+
+def main():
+    root = os.path.join(os.path.dirname(__file__), "..")
+    parser = argparse.ArgumentParser(description="UDP управление кормушкой")
+    parser.add_argument("host", help="IP или имя кормушки")
+    parser.add_argument("--port", type=int, default=4210)
+    parser.add_argument("--key", help="UDP_CONTROL_KEY (по умолчанию - окружение или .env)")
+    parser.add_argument("--timeout", type=float, default=1.0, help="ожидание ответа (с)")
+    sub = parser.add_subparsers(dest="command", required=True)
+    sub.add_parser("status", help="состояние")
+    feed = sub.add_parser("feed", help="покормить")
+    feed.add_argument("--auger", type=int, default=1, help="номер шнека (с единицы)")
+    feed.add_argument("--amount", type=int, default=0, help="оборотов (0 - базовая порция)")
+    b = sub.add_parser("bench", help="время ответа")
+    b.add_argument("-n", type=int, default=100, help="запросов")
+    sub.add_parser("selftest", help="проверка протокола без кормления")
+    args = parser.parse_args()
+
+    key = args.key or load_key(os.path.join(root, ".env"))
+    if not key:
+        print("Не задан UDP_CONTROL_KEY", file=sys.stderr)
+        return 2
+    feeder = Feeder(args.host, args.port, key, args.timeout)
+
+    if args.command == "bench":
+        return bench(feeder, args.n)
+    if args.command == "selftest":
+        return selftest(feeder)
+    if args.command == "feed":
+        reply, rtt = feeder.feed(args.auger, args.amount)
+    else:
+        reply, rtt = feeder.status()
+    if reply is None:
+        print("Нет ответа (адрес, порт или ключ?)", file=sys.stderr)
+        return 1
+    print(f"{reply}  ({rtt:.2f} мс)")
+    return 0 if reply["result"] == "ok" else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())